@@ -63,6 +63,19 @@ struct av_input{
   int video_swapendian;
 };
 
+typedef struct ladder_rung ladder_rung;
+
+/*An extra output coded from the same input at another quality.*/
+struct ladder_rung {
+  int video_q;
+  FILE *outfile;
+  ogg_stream_state vo;
+  daala_enc_ctx *dd;
+};
+
+/*The most outputs that --ladder may add.*/
+#define LADDER_MAX (32)
+
 #define SWAP(a, b)  do {a ^= b; b ^= a; a ^= b;} while(0)
 
 static int host_is_big_endian() {
@@ -86,6 +99,19 @@ static void daala_to_ogg_packet(ogg_packet *op, daala_packet *dp) {
   op->packetno   = dp->packetno;
 }
 
+static void write_page(FILE *outfile, const ogg_page *page) {
+  if (fwrite(page->header, 1, page->header_len, outfile)
+   < (size_t)page->header_len) {
+    fprintf(stderr, "Could not write page header to file.\n");
+    exit(1);
+  }
+  if (fwrite(page->body, 1, page->body_len, outfile)
+   < (size_t)page->body_len) {
+    fprintf(stderr, "Could not write page body to file.\n");
+    exit(1);
+  }
+}
+
 static int y4m_parse_tags(av_input *avin, char *tags) {
   int got_w;
   int got_h;
@@ -428,8 +454,10 @@ static void id_file(av_input *avin, const char *file) {
 
 int fetch_and_process_video(av_input *avin, ogg_page *page,
  ogg_stream_state *vo, daala_enc_ctx *dd, int video_ready,
- int *limit, int *skip) {
+ int *limit, int *skip, FILE *twopass_file, ladder_rung *rungs,
+ int nrungs) {
   daala_packet dp;
+  int ri;
   /*No more input frames to the encoder?*/
   static int end_of_input = 0;
   /*All the input frames are encoded?*/
@@ -510,6 +538,32 @@ int fetch_and_process_video(av_input *avin, ogg_page *page,
       ogg_packet op;
       daala_to_ogg_packet(&op, &dp);
       ogg_stream_packetin(vo, &op);
+      /*Save the first-pass statistics for this frame.*/
+      if (twopass_file != NULL) {
+        unsigned char *stats;
+        int nstats;
+        nstats = daala_encode_ctl(dd, OD_2PASS_OUT, &stats, sizeof(stats));
+        if (nstats < 0 || fwrite(stats, 1, nstats, twopass_file)
+         < (size_t)nstats) {
+          fprintf(stderr, "Could not write first-pass statistics.\n");
+          exit(1);
+        }
+      }
+    }
+    /*Each call that codes a frame in dd also codes it in every rung of the
+       ladder, so they all have their last packet at the same time.
+      Their pages go straight to their own files.*/
+    for (ri = 0; ri < nrungs; ri++) {
+      while (daala_encode_packet_out(rungs[ri].dd, end_of_input &&
+       !input_frames_left_encoder_buffer, &dp)) {
+        ogg_packet op;
+        ogg_page og;
+        daala_to_ogg_packet(&op, &dp);
+        ogg_stream_packetin(&rungs[ri].vo, &op);
+        while (ogg_stream_pageout(&rungs[ri].vo, &og) > 0) {
+          write_page(rungs[ri].outfile, &og);
+        }
+      }
     }
     /*Submit the current frame for encoding.*/
     daala_encode_img_in(dd, &avin->video_img, 0, end_of_input,
@@ -543,6 +597,11 @@ static const struct option OPTIONS[] = {
   { "mv-res-min", required_argument, NULL, 0 },
   { "mv-level-min", required_argument, NULL, 0 },
   { "mv-level-max", required_argument, NULL, 0 },
+  { "tiles", required_argument, NULL, 0 },
+  { "threads", required_argument, NULL, 0 },
+  { "first-pass", required_argument, NULL, 0 },
+  { "second-pass", required_argument, NULL, 0 },
+  { "ladder", required_argument, NULL, 0 },
   { "version", no_argument, NULL, 0},
   { NULL, 0, NULL, 0 }
 };
@@ -565,10 +624,10 @@ static void usage(void) {
    "                                 lowest video quality; 1 yields the\n"
    "                                 highest quality, but large files;\n"
    "                                 0 is lossless.\n\n"
-   "  -V --video-rate-target <n>     bitrate target for Daala video;\n"
+   "  -V --video-rate-target <n>     bitrate target for Daala video in kbps;\n"
    "                                 use -v and not -V if at all possible,\n"
    "                                 as -v gives higher quality for a given\n"
-   "                                 bitrate. (Not yet implemented)\n\n"
+   "                                 bitrate.\n\n"
    "  -s --serial <n>                Specify a serial number for the stream.\n"
    "  -S --skip <n>                  Number of input frames to skip before\n"
    "                                 encoding.\n\n"
@@ -596,11 +655,82 @@ static void usage(void) {
    "                                 0 (default) and 6.\n"
    "     --mv-level-max <n>          Maximum motion vectors level between\n"
    "                                 0 and 6 (default).\n"
+   "     --tiles <c>x<r>             Split each frame into c columns and r\n"
+   "                                 rows of independently coded tiles.\n"
+   "                                 Default: 1x1.\n"
+   "     --threads <n>               Number of threads used to encode the\n"
+   "                                 tiles of each frame. Default: 1.\n"
+   "     --first-pass <filename>     Run the first pass of a two-pass\n"
+   "                                 encode, writing statistics to the file.\n"
+   "                                 Requires -V.\n"
+   "     --second-pass <filename>    Run the second pass of a two-pass\n"
+   "                                 encode, reading statistics from the\n"
+   "                                 file. Requires -V.\n"
+   "     --ladder <n>:<filename>     Also encode the input at quality <n>\n"
+   "                                 into the given file, sharing the input\n"
+   "                                 analysis with the main encode.\n"
+   "                                 May be repeated (up to 32 times).\n"
    "     --version                   Displays version information.\n"
    " encoder_example accepts only uncompressed YUV4MPEG2 video.\n\n");
   exit(1);
 }
 
+static void write_headers(daala_enc_ctx *dd, daala_comment *dc,
+ ogg_stream_state *vo, FILE *outfile) {
+  ogg_page og;
+  ogg_packet op;
+  daala_packet dp;
+  int ret;
+  /*Write the bitstream header packets with proper page interleave.*/
+  /*The first packet for each logical stream will get its own page
+     automatically.*/
+  if (daala_encode_flush_header(dd, dc, &dp) <= 0) {
+    fprintf(stderr, "Internal Daala library error.\n");
+    exit(1);
+  }
+  daala_to_ogg_packet(&op, &dp);
+  ogg_stream_packetin(vo, &op);
+  if (ogg_stream_pageout(vo, &og) != 1) {
+    fprintf(stderr, "Internal Ogg library error.\n");
+    exit(1);
+  }
+  if (fwrite(og.header, 1, og.header_len, outfile) < (size_t)og.header_len) {
+    fprintf(stderr, "Could not complete write to file.\n");
+    exit(1);
+  }
+  if (fwrite(og.body, 1, og.body_len, outfile) < (size_t)og.body_len) {
+    fprintf(stderr, "Could not complete write to file.\n");
+    exit(1);
+  }
+  /*Create and buffer the remaining Daala headers.*/
+  for (;;) {
+    ret = daala_encode_flush_header(dd, dc, &dp);
+    if (ret < 0) {
+      fprintf(stderr, "Internal Daala library error.\n");
+      exit(1);
+    }
+    else if (!ret) break;
+    daala_to_ogg_packet(&op, &dp);
+    ogg_stream_packetin(vo, &op);
+  }
+  for (;;) {
+    ret = ogg_stream_flush(vo, &og);
+    if (ret < 0) {
+      fprintf(stderr, "Internal Ogg library error.\n");
+      exit(1);
+    }
+    else if (!ret) break;
+    if (fwrite(og.header, 1, og.header_len, outfile) < (size_t)og.header_len) {
+      fprintf(stderr, "Could not write header to file.\n");
+      exit(1);
+    }
+    if (fwrite(og.body, 1, og.body_len, outfile) < (size_t)og.body_len) {
+      fprintf(stderr, "Could not write body to file.\n");
+      exit(1);
+    }
+  }
+}
+
 static void version(void) {
   fprintf(stderr, "%s\n", daala_version_string());
   exit(0);
@@ -611,9 +741,10 @@ int main(int argc, char **argv) {
   av_input avin;
   ogg_stream_state vo;
   ogg_page og;
-  ogg_packet op;
-  daala_packet dp;
   daala_enc_ctx *dd;
+  ladder_rung rungs[LADDER_MAX];
+  int nrungs;
+  int ri;
   daala_info di;
   daala_comment dc;
   ogg_int64_t video_bytesout;
@@ -621,9 +752,9 @@ int main(int argc, char **argv) {
   double time_spent;
   int c;
   int loi;
-  int ret;
   double video_kbps;
   int video_q;
+  int video_r;
   int video_keyframe_rate;
   int video_ready;
   int pli;
@@ -644,6 +775,10 @@ int main(int argc, char **argv) {
   int current_frame_no;
   int output_provided;
   int b_frames;
+  int tiles[2];
+  int nthreads;
+  int twopass;
+  FILE *twopass_file;
   char default_filename[1024];
   clock_t t0;
   clock_t t1;
@@ -663,6 +798,7 @@ int main(int argc, char **argv) {
   avin.video_par_d = -1;
   /* Set default options */
   video_q = 10;
+  video_r = 0;
   video_keyframe_rate = 256;
   video_bytesout = 0;
   fixedserial = 0;
@@ -679,6 +815,11 @@ int main(int argc, char **argv) {
   mv_level_max = 6;
   output_provided = 0;
   b_frames = 0;
+  tiles[0] = tiles[1] = 1;
+  nthreads = 1;
+  twopass = 0;
+  twopass_file = NULL;
+  nrungs = 0;
   while ((c = getopt_long(argc, argv, OPTSTRING, OPTIONS, &loi)) != EOF) {
     switch (c) {
       case 'o': {
@@ -717,9 +858,11 @@ int main(int argc, char **argv) {
         break;
       }
       case 'V': {
-        fprintf(stderr,
-         "Target video bitrate is not yet implemented, use -v instead.\n");
-        exit(1);
+        video_r = (int)(atof(optarg)*1000 + 0.5);
+        if (video_r < 1) {
+          fprintf(stderr, "Illegal video bitrate (must be positive)\n");
+          exit(1);
+        }
         break;
       }
       case 's': {
@@ -821,6 +964,56 @@ int main(int argc, char **argv) {
             exit(1);
           }
         }
+        else if (strcmp(OPTIONS[loi].name, "tiles") == 0) {
+          if (sscanf(optarg, "%ix%i", &tiles[0], &tiles[1]) != 2
+           || tiles[0] < 1 || tiles[1] < 1) {
+            fprintf(stderr, "Illegal value for --tiles\n");
+            exit(1);
+          }
+        }
+        else if (strcmp(OPTIONS[loi].name, "threads") == 0) {
+          nthreads = atoi(optarg);
+          if (nthreads < 1) {
+            fprintf(stderr, "Illegal value for --threads\n");
+            exit(1);
+          }
+        }
+        else if (strcmp(OPTIONS[loi].name, "first-pass") == 0
+         || strcmp(OPTIONS[loi].name, "second-pass") == 0) {
+          if (twopass_file != NULL) {
+            fprintf(stderr,
+             "Only one of --first-pass and --second-pass may be given\n");
+            exit(1);
+          }
+          twopass = OPTIONS[loi].name[0] == 'f' ? 1 : 2;
+          twopass_file = fopen(optarg, twopass == 1 ? "wb" : "rb");
+          if (twopass_file == NULL) {
+            fprintf(stderr, "Unable to open two-pass statistics file '%s'\n",
+             optarg);
+            exit(1);
+          }
+        }
+        else if (strcmp(OPTIONS[loi].name, "ladder") == 0) {
+          char *filename;
+          if (nrungs >= LADDER_MAX) {
+            fprintf(stderr, "Too many --ladder outputs (at most %i)\n",
+             LADDER_MAX);
+            exit(1);
+          }
+          rungs[nrungs].video_q = (int)strtol(optarg, &filename, 10);
+          if (filename == optarg || *filename != ':'
+           || rungs[nrungs].video_q < 0 || rungs[nrungs].video_q > 511) {
+            fprintf(stderr, "Illegal value for --ladder\n");
+            exit(1);
+          }
+          filename++;
+          rungs[nrungs].outfile = fopen(filename, "wb");
+          if (rungs[nrungs].outfile == NULL) {
+            fprintf(stderr, "Unable to open output file '%s'\n", filename);
+            exit(1);
+          }
+          nrungs++;
+        }
         else if (strcmp(OPTIONS[loi].name, "version") == 0) {
           version();
         }
@@ -844,11 +1037,18 @@ int main(int argc, char **argv) {
     fprintf(stderr, "No video files submitted for compression.\n");
     exit(1);
   }
+  if (twopass && video_r <= 0) {
+    fprintf(stderr, "Two-pass encoding requires a bitrate target (-V)\n");
+    exit(1);
+  }
   if (!fixedserial) {
     srand(time(NULL));
     serial = rand();
   }
   ogg_stream_init(&vo, serial);
+  for (ri = 0; ri < nrungs; ri++) {
+    ogg_stream_init(&rungs[ri].vo, serial + 1 + ri);
+  }
   daala_info_init(&di);
   di.pic_width = avin.video_pic_w;
   di.pic_height = avin.video_pic_h;
@@ -890,67 +1090,81 @@ int main(int argc, char **argv) {
   daala_comment_init(&dc);
   /*Set up encoder.*/
   daala_encode_ctl(dd, OD_SET_QUANT, &video_q, sizeof(video_q));
-  daala_encode_ctl(dd, OD_SET_COMPLEXITY, &complexity, sizeof(complexity));
-  daala_encode_ctl(dd, OD_SET_MC_CHROMA, &mc_use_chroma,
-   sizeof(mc_use_chroma));
-  daala_encode_ctl(dd, OD_SET_MC_SATD, &mc_use_satd,
-   sizeof(mc_use_satd));
-  daala_encode_ctl(dd, OD_SET_ACTIVITY_MASKING, &use_activity_masking,
-   sizeof(use_activity_masking));
-  daala_encode_ctl(dd, OD_SET_DERING, &use_dering,
-   sizeof(use_dering));
-  daala_encode_ctl(dd, OD_SET_MV_RES_MIN, &mv_res_min, sizeof(mv_res_min));
-  daala_encode_ctl(dd, OD_SET_QM, &qm, sizeof(qm));
-  daala_encode_ctl(dd, OD_SET_MV_LEVEL_MIN, &mv_level_min, sizeof(mv_level_min));
-  daala_encode_ctl(dd, OD_SET_MV_LEVEL_MAX, &mv_level_max, sizeof(mv_level_max));
-  daala_encode_ctl(dd, OD_SET_B_FRAMES, &b_frames, sizeof(b_frames));
-  /*Write the bitstream header packets with proper page interleave.*/
-  /*The first packet for each logical stream will get its own page
-     automatically.*/
-  if (daala_encode_flush_header(dd, &dc, &dp) <= 0) {
-    fprintf(stderr, "Internal Daala library error.\n");
-    exit(1);
-  }
-  daala_to_ogg_packet(&op, &dp);
-  ogg_stream_packetin(&vo, &op);
-  if (ogg_stream_pageout(&vo, &og) != 1) {
-    fprintf(stderr, "Internal Ogg library error.\n");
-    exit(1);
+  if (video_r > 0) {
+    daala_encode_ctl(dd, OD_SET_BITRATE, &video_r, sizeof(video_r));
   }
-  if (fwrite(og.header, 1, og.header_len, outfile) < (size_t)og.header_len) {
-    fprintf(stderr, "Could not complete write to file.\n");
-    exit(1);
-  }
-  if (fwrite(og.body, 1, og.body_len, outfile) < (size_t)og.body_len) {
-    fprintf(stderr, "Could not complete write to file.\n");
-    exit(1);
+  for (ri = 0; ri < nrungs; ri++) {
+    rungs[ri].dd = daala_encode_create(&di);
+    daala_encode_ctl(rungs[ri].dd, OD_SET_QUANT, &rungs[ri].video_q,
+     sizeof(rungs[ri].video_q));
   }
-  /*Create and buffer the remaining Daala headers.*/
-  for (;;) {
-    ret = daala_encode_flush_header(dd, &dc, &dp);
-    if (ret < 0) {
-      fprintf(stderr, "Internal Daala library error.\n");
-      exit(1);
+  /*The rungs of the ladder use all the other settings of the main encoder.*/
+  for (ri = -1; ri < nrungs; ri++) {
+    daala_enc_ctx *enc;
+    enc = ri < 0 ? dd : rungs[ri].dd;
+    daala_encode_ctl(enc, OD_SET_COMPLEXITY, &complexity,
+     sizeof(complexity));
+    daala_encode_ctl(enc, OD_SET_MC_CHROMA, &mc_use_chroma,
+     sizeof(mc_use_chroma));
+    daala_encode_ctl(enc, OD_SET_MC_SATD, &mc_use_satd,
+     sizeof(mc_use_satd));
+    daala_encode_ctl(enc, OD_SET_ACTIVITY_MASKING, &use_activity_masking,
+     sizeof(use_activity_masking));
+    daala_encode_ctl(enc, OD_SET_DERING, &use_dering,
+     sizeof(use_dering));
+    daala_encode_ctl(enc, OD_SET_MV_RES_MIN, &mv_res_min,
+     sizeof(mv_res_min));
+    daala_encode_ctl(enc, OD_SET_QM, &qm, sizeof(qm));
+    daala_encode_ctl(enc, OD_SET_MV_LEVEL_MIN, &mv_level_min,
+     sizeof(mv_level_min));
+    daala_encode_ctl(enc, OD_SET_MV_LEVEL_MAX, &mv_level_max,
+     sizeof(mv_level_max));
+    daala_encode_ctl(enc, OD_SET_B_FRAMES, &b_frames, sizeof(b_frames));
+    if (tiles[0] > 1 || tiles[1] > 1) {
+      if (daala_encode_ctl(enc, OD_SET_TILES, tiles, sizeof(tiles))
+       != OD_SUCCESS) {
+        fprintf(stderr, "Frame too small for %ix%i tiles.\n",
+         tiles[0], tiles[1]);
+        exit(1);
+      }
     }
-    else if (!ret) break;
-    daala_to_ogg_packet(&op, &dp);
-    ogg_stream_packetin(&vo, &op);
+    daala_encode_ctl(enc, OD_SET_THREADS, &nthreads, sizeof(nthreads));
   }
-  for (;;) {
-    ret = ogg_stream_flush(&vo, &og);
-    if (ret < 0) {
-      fprintf(stderr, "Internal Ogg library error.\n");
+  if (nrungs > 0) {
+    daala_enc_ctx *ladder[LADDER_MAX];
+    for (ri = 0; ri < nrungs; ri++) ladder[ri] = rungs[ri].dd;
+    if (daala_encode_ctl(dd, OD_SET_LADDER, ladder,
+     nrungs*sizeof(*ladder)) != OD_SUCCESS) {
+      fprintf(stderr, "Could not set up the --ladder outputs.\n");
       exit(1);
     }
-    else if (!ret) break;
-    if (fwrite(og.header, 1, og.header_len, outfile) < (size_t)og.header_len) {
-      fprintf(stderr, "Could not write header to file.\n");
+  }
+  if (twopass == 1) {
+    unsigned char *stats;
+    /*Start the first pass; there are no statistics yet.*/
+    if (daala_encode_ctl(dd, OD_2PASS_OUT, &stats, sizeof(stats)) < 0) {
+      fprintf(stderr, "Could not start the first pass.\n");
       exit(1);
     }
-    if (fwrite(og.body, 1, og.body_len, outfile) < (size_t)og.body_len) {
-      fprintf(stderr, "Could not write body to file.\n");
-      exit(1);
+  }
+  else if (twopass == 2) {
+    unsigned char buf[4096];
+    size_t nbuf;
+    /*Submit all of the first-pass statistics up front.*/
+    do {
+      nbuf = fread(buf, 1, sizeof(buf), twopass_file);
+      if (daala_encode_ctl(dd, OD_2PASS_IN, buf, nbuf) < 0) {
+        fprintf(stderr, "Invalid first-pass statistics.\n");
+        exit(1);
+      }
     }
+    while (nbuf == sizeof(buf));
+    fclose(twopass_file);
+    twopass_file = NULL;
+  }
+  write_headers(dd, &dc, &vo, outfile);
+  for (ri = 0; ri < nrungs; ri++) {
+    write_headers(rungs[ri].dd, &dc, &rungs[ri].vo, rungs[ri].outfile);
   }
   /*Setup complete.
      Main compression loop.*/
@@ -963,7 +1177,8 @@ int main(int argc, char **argv) {
     double video_fps = avin.video_fps_n/avin.video_fps_d;
     size_t bytes_written;
     video_ready = fetch_and_process_video(&avin, &video_page, &vo,
-     dd, video_ready, limit > -1 ? &limit : NULL, skip > 0 ? &skip : NULL);
+     dd, video_ready, limit > -1 ? &limit : NULL, skip > 0 ? &skip : NULL,
+     twopass_file, rungs, nrungs);
     /*TODO: Fetch the next video page.*/
     /*If no more pages are available, we've hit the end of the stream.*/
     if (!video_ready) break;
@@ -1002,6 +1217,15 @@ int main(int argc, char **argv) {
      (current_frame_no)/time_spent,
      (current_frame_no)/time_spent*60);
   }
+  for (ri = 0; ri < nrungs; ri++) {
+    /*Write out the end of the stream.*/
+    while (ogg_stream_flush(&rungs[ri].vo, &og) > 0) {
+      write_page(rungs[ri].outfile, &og);
+    }
+    ogg_stream_clear(&rungs[ri].vo);
+    daala_encode_free(rungs[ri].dd);
+    fclose(rungs[ri].outfile);
+  }
   ogg_stream_clear(&vo);
   daala_encode_free(dd);
   daala_comment_clear(&dc);
@@ -1009,6 +1233,7 @@ int main(int argc, char **argv) {
     _ogg_free(avin.video_img.planes[pli].data);
   }
   if (outfile != NULL && outfile != stdout) fclose(outfile);
+  if (twopass_file != NULL) fclose(twopass_file);
   fprintf(stderr, "\r    \ndone.\n\r");
   if (avin.video_infile != NULL && avin.video_infile != stdin) {
     fclose(avin.video_infile);
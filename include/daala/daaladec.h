@@ -46,6 +46,107 @@ extern "C" {
 #define OD_DECCTL_GET_ACCOUNTING   (7009)
 #define OD_DECCTL_SET_ACCOUNTING_ENABLED (7011)
 #define OD_DECCTL_SET_DERING_BUFFER (7013)
+/** Set the number of threads used to decode each frame.
+ * Superblock rows are reconstructed, postfiltered and deringed in parallel.
+ * The tiles of streams encoded with OD_SET_TILES are also decoded in
+ *  parallel.
+ * The output is identical for any number of threads.
+ * With OD_DECCTL_SET_FRAME_THREADS, each frame in flight uses this many
+ *  threads, so up to their product are used in all.
+ * \param[in]  <tt>int</tt>: The number of threads, including the calling
+ *              thread (1 to 64).
+ *              The default is 1, which decodes serially.
+ * \retval OD_EIMPL If the library was built without thread support and
+ *          more than one thread was requested. */
+#define OD_DECCTL_SET_THREADS (7015)
+/** Set the number of frames that may be decoded at the same time, each on
+ * its own thread.
+ * Frames that do not depend on each other, such as B-frames that share
+ * references, are decoded concurrently, and frames wait for the reference
+ * frames they predict from to finish.
+ * The decoded images and their order are unchanged, but each one is returned
+ * by daala_decode_img_out() up to (threads - 1) packets later, and the
+ * remaining frames are only returned after a packet with e_o_s set.
+ * daala_decode_img_out() must still be called after every packet.
+ * This must be set before the first data packet, and cannot be combined with
+ * the buffers and images used for analysis (OD_DECCTL_SET_BSIZE_BUFFER,
+ * OD_DECCTL_SET_FLAGS_BUFFER, OD_DECCTL_SET_MV_BUFFER, OD_DECCTL_SET_MC_IMG,
+ * OD_DECCTL_SET_DERING_BUFFER) or with accounting.
+ * \param[in]  <tt>int</tt>: The number of frame threads (1 to 64).
+ *              The default is 1, which decodes each packet before
+ *              daala_decode_packet_in() returns.
+ * \retval OD_EIMPL If the library was built without thread support and
+ *          more than one thread was requested. */
+#define OD_DECCTL_SET_FRAME_THREADS (7017)
+/** Reconstruct each frame a superblock row at a time, in a rolling window
+ * of working buffers, instead of in buffers the size of a frame.
+ * This cuts the working buffers of each decoder from 18 bytes per pixel to
+ * just over 2, at the cost of decoding each frame on a single thread (frame
+ * threads still work).
+ * The 2 bytes are the 16-bit input of the deringing filter, which is kept
+ * for the whole frame, since the deringing flags are only coded after all of
+ * the coefficients.
+ * The decoded images are unchanged.
+ * This cannot be changed while frame threads are decoding.
+ * \param[in]  <tt>int</tt>: Non-zero to stream, or 0 to use whole-frame
+ *              buffers (the default). */
+#define OD_DECCTL_SET_STREAMING (7019)
+/** Set a function to call as soon as each row of superblocks of a frame is
+ * fully reconstructed (postfiltered and deringed), so that it can be
+ * displayed before the rest of the frame is decoded.
+ * The rows of each frame are reported in order, with the frames in decoding
+ * order, and always before daala_decode_packet_in() returns.
+ * With OD_DECCTL_SET_THREADS, the function may be called from any of the
+ * decoder's threads, but never by two of them at once.
+ * Since the deringing flags are only coded after all of the coefficients of
+ * a frame, the rows of lossy frames are reported as the frame is deringed,
+ * after the coefficients have been decoded.
+ * With OD_DECCTL_SET_STREAMING, the rows of lossless frames are reported as
+ * they are decoded.
+ * This cannot be combined with OD_DECCTL_SET_FRAME_THREADS.
+ * \param[in]  <tt>daala_row_callback*</tt>: The function and its context.
+ *              A NULL function disables the callback (the default). */
+#define OD_DECCTL_SET_ROW_CALLBACK (7021)
+/** Hand out the decoded images in buffers from a pool, which stay valid
+ * until the application releases them, instead of copying each one to a
+ * buffer that the next packet overwrites.
+ * The images returned by daala_decode_img_out() are then valid until they are
+ * released with OD_DECCTL_RELEASE_IMG, or until the decoder is freed.
+ * Every image should be released once it is no longer needed, since the pool
+ * grows to hold all of the images that the application keeps.
+ * For 8-bit video, frames are decoded directly into the pool buffers, which
+ * saves copying each one, and the images keep serving as reference frames
+ * until they are released, so they must not be modified.
+ * Deeper video is still converted into the pool buffers.
+ * This must be set before the first data packet, and cannot be combined with
+ * OD_DECCTL_SET_FRAME_THREADS.
+ * \param[in]  <tt>daala_frame_allocator*</tt>: The functions that allocate
+ *              and free the buffers, or NULL functions to use the
+ *              decoder's own. */
+#define OD_DECCTL_SET_FRAME_POOL (7023)
+/** Release an image returned by daala_decode_img_out() when
+ * OD_DECCTL_SET_FRAME_POOL is set, so that its buffer can be reused.
+ * \param[in]  <tt>od_img*</tt>: The image, as it was returned.
+ * \retval OD_EINVAL If the image is not held by the application. */
+#define OD_DECCTL_RELEASE_IMG (7025)
+/** Keep the memory used by the decoder to a minimum.
+ * This turns on OD_DECCTL_SET_STREAMING, and for 8-bit video the images
+ * returned by daala_decode_img_out() are the reference frames themselves
+ * instead of copies.
+ * Those images are then only valid until the next call to
+ * daala_decode_packet_in(), and must not be modified.
+ * The input of the deringing filter still covers a whole frame.
+ * This must be set before the first data packet, and cannot be combined with
+ * OD_DECCTL_SET_FRAME_THREADS or OD_DECCTL_SET_FRAME_POOL.
+ * \param[in]  <tt>int</tt>: Non-zero to keep the memory to a minimum, or 0
+ *              (the default). */
+#define OD_DECCTL_SET_LOW_MEMORY (7027)
+/** Get the most bytes the decoder has held in its buffers, including its
+ * state, working buffers, images, frame pool and frame decoders, as measured
+ * at the end of each call to the decoder.
+ * Setting OD_DECCTL_SET_LOW_MEMORY starts the measurement over.
+ * \param[out] <tt>size_t</tt>: The number of bytes. */
+#define OD_DECCTL_GET_PEAK_BYTES (7029)
 
 
 #define OD_ACCT_FRAME (10)
@@ -90,6 +191,31 @@ typedef struct {
 } od_accounting;
 
 
+/** The type of the functions set with OD_DECCTL_SET_ROW_CALLBACK.
+ * \param ctx The context given along with the function.
+ * \param img The frame being decoded, which is the image that
+ *            daala_decode_img_out() will later return for it.
+ * \param y0  The first luma row that is now final.
+ * \param y1  One past the last luma row that is now final.
+ *            The chroma rows are those that cover the same area.
+ *            All of the rows above y0 were reported by earlier calls.*/
+typedef void (*daala_row_func)(void *ctx, const od_img *img, int y0, int y1);
+
+typedef struct {
+  daala_row_func func;
+  void *ctx;
+} daala_row_callback;
+
+/** The functions set with OD_DECCTL_SET_FRAME_POOL.
+ * alloc returns a buffer of \a size bytes aligned on a 32-byte boundary, or
+ *  NULL if it cannot, and free releases one, with the context given along
+ *  with them.*/
+typedef struct {
+  void *(*alloc)(void *ctx, size_t size);
+  void (*free)(void *ctx, void *ptr);
+  void *ctx;
+} daala_frame_allocator;
+
 /**\name Decoder state
    The following data structures are opaque, and their contents are not
     publicly defined by this API.
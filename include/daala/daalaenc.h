@@ -45,6 +45,16 @@ extern "C" {
 typedef struct daala_enc_ctx daala_enc_ctx;
 /*@}*/
 
+/** The type of the functions set with \ref OD_SET_INPUT_RELEASE.
+ * \param ctx The context given along with the function.
+ * \param img The image, as it was submitted to daala_encode_img_in().*/
+typedef void (*daala_img_release_func)(void *ctx, od_img *img);
+
+typedef struct {
+  daala_img_release_func func;
+  void *ctx;
+} daala_img_release;
+
 /**\defgroup encfuncs Functions for Encoding*/
 /*@{*/
 /**\name Functions for encoding
@@ -213,6 +223,139 @@ void daala_encode_free(daala_enc_ctx *enc);
  *                  Values must lie in the range 0...OD_MAX_B_FRAMES,
  *                  inclusive. */
 #define OD_SET_B_FRAMES 4110
+/** Split the following frames into a grid of tiles.
+ * Each tile is coded with its own entropy coder and adaptation state, and
+ *  does not predict from the other tiles, so the tiles of a frame can be
+ *  encoded and decoded in parallel (see \ref OD_SET_THREADS and
+ *  OD_DECCTL_SET_THREADS), at some cost in compression.
+ * The superblocks are split evenly between the tiles, so fewer tiles than
+ *  requested may be used.
+ * \param[in]  _buf <tt>int[2]</tt>: The number of tile columns and rows.
+ *                  Each must be at least 1, and at most the number of
+ *                   superblocks in that direction.
+ *                  The default, {1, 1}, does not split frames. */
+#define OD_SET_TILES 4112
+/** Set the number of threads used to encode each frame.
+ * The output does not depend on the number of threads.
+ * \param[in]  _buf <tt>int</tt>: The number of threads, including the
+ *                   calling thread (1 to 64).
+ *                  The default is 1, which encodes serially.
+ * \retval OD_EIMPL If the library was built without thread support and
+ *          more than one thread was requested. */
+#define OD_SET_THREADS 4114
+/** Enable one-pass average bitrate control.
+ * The quantizer of each frame is chosen to hit the target bitrate on
+ *  average, while keeping the decoder buffer described by
+ *  \ref OD_SET_RATE_BUFFER and \ref OD_SET_MAX_BITRATE from underflowing.
+ * \param[in]  _buf <tt>int</tt>: The target bitrate, in bits per second.
+ *                  0 (the default) disables rate control, and the
+ *                   quantizer set with \ref OD_SET_QUANT is used instead. */
+#define OD_SET_BITRATE 4116
+/** Set the size of the decoder buffer used by rate control.
+ * The buffer also sets how quickly rate control makes up for frames that
+ *  were larger or smaller than planned.
+ * \param[in]  _buf <tt>int</tt>: The buffer size, in bits.
+ *                  0 (the default) uses one second at the target bitrate. */
+#define OD_SET_RATE_BUFFER 4118
+/** Set the rate at which the decoder buffer used by rate control fills.
+ * \param[in]  _buf <tt>int</tt>: The maximum bitrate, in bits per second.
+ *                  0 (the default) uses the target bitrate. */
+#define OD_SET_MAX_BITRATE 4120
+/** Get the fullness of the decoder buffer used by rate control.
+ * \param[out] _buf <tt>int</tt>: The number of bits in the buffer before
+ *                   the next frame is removed from it. */
+#define OD_GET_RATE_BUFFER_FULLNESS 4122
+/** Enable the first pass of a two-pass encode, and get the statistics it
+ *  has produced since the last call.
+ * Bitrate control must already be enabled with \ref OD_SET_BITRATE, and the
+ *  first call must come before the first frame is submitted.
+ * Call this after each call to daala_encode_packet_out() and save the
+ *  statistics, in order, for \ref OD_2PASS_IN.
+ * The statistics of frames not returned yet are kept for the next call, so
+ *  they may also be collected less often, e.g., once at the end.
+ * The first pass spends less time on motion search and block size decisions,
+ *  so its packets are not meant to be kept.
+ * \param[out] _buf <tt>unsigned char *</tt>: Set to a buffer holding the
+ *                   statistics, which stays valid until the next call.
+ * \return The number of bytes of statistics in the buffer, or a negative
+ *          value on error. */
+#define OD_2PASS_OUT 4124
+/** Enable the second pass of a two-pass encode, and submit statistics from
+ *  \ref OD_2PASS_OUT.
+ * Bitrate control must already be enabled with \ref OD_SET_BITRATE, and the
+ *  first call must come before the first frame is submitted.
+ * The statistics may be split into pieces of any size; the more that are
+ *  submitted ahead of the frames they describe, the better the bits can be
+ *  spread over the whole encode.
+ * If the first pass ran without B frames, the second pass also moves
+ *  keyframes to scene cuts.
+ * \param[in]  _buf <tt>unsigned char[]</tt>: The statistics.
+ *                  \a _buf_sz is their size in bytes.
+ * \return The number of bytes consumed, or a negative value on error. */
+#define OD_2PASS_IN 4126
+/** Set how many frames the encoder looks ahead to choose frame types.
+ * With a lookahead, each frame is analyzed with a cheap motion search as
+ *  soon as it is submitted, and keyframes are placed at scene cuts, fewer
+ *  than \ref OD_SET_B_FRAMES B frames are used where the motion is too
+ *  complex for them to help, and golden frames are refreshed when they stop
+ *  being good predictors.
+ * The encoder buffers this many frames in addition to the B frames.
+ * This must be set before the first frame is submitted.
+ * \param[in]  _buf <tt>int</tt>: The number of frames, from 0 to 16.
+ *                  The default, 0, uses a fixed frame type pattern. */
+#define OD_SET_LOOKAHEAD 4128
+/** Use the images submitted to daala_encode_img_in() in place when
+ *  possible, instead of copying them, and set the function that gives each
+ *  image back to the application.
+ * An image is used in place if its planes have the same sample format as
+ *  the encoder's own buffers, which is the case for 8-bit video.
+ * Every plane must then have room for the frame size, which is the picture
+ *  size rounded up to a multiple of 64, plus \ref OD_INPUT_PADDING pixels on
+ *  every side, all scaled down for decimated planes.
+ * The encoder fills in everything outside of the picture itself, and must
+ *  be the only one to access the image until it is released, which happens
+ *  once its frame has left the B frame reorder buffer and the lookahead, and
+ *  has been encoded, or when the encoder is freed.
+ * Images that are not used in place are copied, and released before
+ *  daala_encode_img_in() returns.
+ * This must be set before the first frame is submitted.
+ * \param[in]  _buf <tt>daala_img_release</tt>: The function and its
+ *                   context.
+ *                  A NULL function (the default) copies every image. */
+#define OD_SET_INPUT_RELEASE 4130
+/** Code the images submitted to this encoder with other encoders as well,
+ *  each at its own quality, so that a single pass produces one stream per
+ *  encoder.
+ * The images are buffered, padded and analyzed once, and all of the
+ *  encoders use the frame types, keyframes and golden frames chosen by this
+ *  one and its lookahead (see \ref OD_SET_LOOKAHEAD).
+ * A motion search of each input frame against the input frames it is
+ *  predicted from is also done once, and gives every encoder the starting
+ *  vectors of its own motion search, which is then refined in fewer passes.
+ * The psy model statistics used by the block size decisions of the lowest
+ *  complexities are shared the same way.
+ * Each encoder still does the rest of the motion search, the block sizes
+ *  and everything after for its own frames, in a thread of its own if
+ *  \ref OD_SET_THREADS is above 1.
+ * The stream of every encoder of the ladder, this one included, therefore
+ *  differs from the one it would code alone, usually by about one percent
+ *  in size.
+ * The other encoders must take images of the same size and format, use as
+ *  many B frames as this one, and not have been given any image.
+ * They get their images from this encoder, so daala_encode_img_in() fails
+ *  on them, but each call that codes a frame here leaves a packet for
+ *  daala_encode_packet_out() in each of them.
+ * Their own quality, rate control, complexity, tiles and threads are used
+ *  for the rest.
+ * An encoder that is freed leaves the ladder.
+ * This must be set before the first frame is submitted.
+ * \param[in]  _buf <tt>daala_enc_ctx *[]</tt>: The other encoders.
+ *                  An empty array (the default) codes with this encoder
+ *                   alone. */
+#define OD_SET_LADDER 4132
+/** The number of pixels of padding around the frame of the images used in
+ *  place with \ref OD_SET_INPUT_RELEASE. */
+#define OD_INPUT_PADDING (8)
 /*@}*/
 
 # if OD_GNUC_PREREQ(4, 0, 0)
@@ -0,0 +1,191 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include "armint.h"
+
+#if defined(OD_NEON_INTRINSICS)
+#include <arm_neon.h>
+#include <stdio.h>
+#include "../entcode.h"
+
+/*See x86/sse2ec.c for how the CDFs are loaded.*/
+
+#if defined(OD_CHECKASM)
+static void od_ec_cdf_search_check(const uint16_t *cdf, int nsyms,
+ unsigned q, int ret) {
+  int ref_ret;
+  ref_ret = od_ec_cdf_search_c(cdf, nsyms, q);
+  if (ref_ret != ret) {
+    fprintf(stderr, "ASM mismatch: %i!=%i (nsyms %i, q %u)\n",
+     ref_ret, ret, nsyms, q);
+    fprintf(stderr, "od_ec_cdf_search check failed.\n");
+  }
+  OD_ASSERT(ref_ret == ret);
+}
+
+static void od_ec_cdf_adapt_check(const uint16_t *cdf, uint16_t *ref,
+ int val, int n, int increment) {
+  int failed;
+  int i;
+  od_ec_cdf_adapt_c(ref, val, n, increment);
+  failed = 0;
+  for (i = 0; i < n; i++) {
+    if (ref[i] != cdf[i]) {
+      fprintf(stderr, "ASM mismatch: 0x%04X!=0x%04X @ (%i)\n",
+       ref[i], cdf[i], i);
+      failed = 1;
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_ec_cdf_adapt check (val %i, n %i, increment %i) "
+     "failed.\n", val, n, increment);
+  }
+  OD_ASSERT(!failed);
+}
+#endif
+
+static const uint16_t OD_EC_CDF_LANES[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+/*Counts the lanes of cdf that are no larger than q.*/
+OD_SIMD_INLINE int od_ec_cdf_count_le8(uint16x8_t cdf, uint16x8_t q) {
+  uint64x2_t sum;
+  sum = vpaddlq_u32(vpaddlq_u16(vshrq_n_u16(vcleq_u16(cdf, q), 15)));
+  return (int)(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+}
+
+OD_SIMD_INLINE int od_ec_cdf_count_le4(uint16x4_t cdf, uint16x4_t q) {
+  return (int)vget_lane_u64(
+   vpaddl_u32(vpaddl_u16(vshr_n_u16(vcle_u16(cdf, q), 15))), 0);
+}
+
+int od_ec_cdf_search_neon(const uint16_t *cdf, int nsyms, unsigned q) {
+  int lo_count;
+  int n;
+  int ret;
+  if (nsyms < 4 || nsyms > 16) return od_ec_cdf_search_c(cdf, nsyms, q);
+  /*The CDF is non-decreasing, so if every lane of the first vector is no
+     larger than q, the answer lies in the second one, whose first lane is
+     entry nsyms - n.*/
+  if (nsyms >= 8) {
+    uint16x8_t qv;
+    qv = vdupq_n_u16((uint16_t)q);
+    n = 8;
+    lo_count = od_ec_cdf_count_le8(vld1q_u16(cdf), qv);
+    if (lo_count == n) {
+      ret = nsyms - n + od_ec_cdf_count_le8(vld1q_u16(cdf + nsyms - n), qv);
+    }
+    else ret = lo_count;
+  }
+  else {
+    uint16x4_t qv;
+    qv = vdup_n_u16((uint16_t)q);
+    n = 4;
+    lo_count = od_ec_cdf_count_le4(vld1_u16(cdf), qv);
+    if (lo_count == n) {
+      ret = nsyms - n + od_ec_cdf_count_le4(vld1_u16(cdf + nsyms - n), qv);
+    }
+    else ret = lo_count;
+  }
+#if defined(OD_CHECKASM)
+  od_ec_cdf_search_check(cdf, nsyms, q, ret);
+#endif
+  return ret;
+}
+
+/*Adapts the lanes of cdf, whose lane indices in the CDF are idx.*/
+OD_SIMD_INLINE uint16x8_t od_ec_cdf_adapt_lanes8(uint16x8_t cdf,
+ uint16x8_t idx, int renorm, uint16x8_t val, uint16x8_t increment) {
+  if (renorm) {
+    /*Second term ensures that the pdf is non-null.*/
+    cdf = vaddq_u16(vshrq_n_u16(cdf, 1), vaddq_u16(idx, vdupq_n_u16(1)));
+  }
+  return vaddq_u16(cdf, vandq_u16(vcgeq_u16(idx, val), increment));
+}
+
+OD_SIMD_INLINE uint16x4_t od_ec_cdf_adapt_lanes4(uint16x4_t cdf,
+ uint16x4_t idx, int renorm, uint16x4_t val, uint16x4_t increment) {
+  if (renorm) {
+    cdf = vadd_u16(vshr_n_u16(cdf, 1), vadd_u16(idx, vdup_n_u16(1)));
+  }
+  return vadd_u16(cdf, vand_u16(vcge_u16(idx, val), increment));
+}
+
+void od_ec_cdf_adapt_neon(uint16_t *cdf, int val, int n, int increment) {
+  int renorm;
+#if defined(OD_CHECKASM)
+  uint16_t ref[16];
+  if (n >= 4 && n <= 16) OD_COPY(ref, cdf, n);
+#endif
+  if (n < 4 || n > 16) {
+    od_ec_cdf_adapt_c(cdf, val, n, increment);
+    return;
+  }
+  renorm = cdf[n - 1] + increment > 32767;
+  /*Both vectors are loaded before either is stored, and lanes they share get
+     the same result, so the overlap is harmless.*/
+  if (n >= 8) {
+    uint16x8_t lo;
+    uint16x8_t hi;
+    uint16x8_t idx;
+    uint16x8_t valv;
+    uint16x8_t incv;
+    valv = vdupq_n_u16((uint16_t)val);
+    incv = vdupq_n_u16((uint16_t)increment);
+    idx = vld1q_u16(OD_EC_CDF_LANES);
+    lo = vld1q_u16(cdf);
+    hi = vld1q_u16(cdf + n - 8);
+    lo = od_ec_cdf_adapt_lanes8(lo, idx, renorm, valv, incv);
+    hi = od_ec_cdf_adapt_lanes8(hi, vaddq_u16(idx, vdupq_n_u16(n - 8)),
+     renorm, valv, incv);
+    vst1q_u16(cdf + n - 8, hi);
+    vst1q_u16(cdf, lo);
+  }
+  else {
+    uint16x4_t lo;
+    uint16x4_t hi;
+    uint16x4_t idx;
+    uint16x4_t valv;
+    uint16x4_t incv;
+    valv = vdup_n_u16((uint16_t)val);
+    incv = vdup_n_u16((uint16_t)increment);
+    idx = vld1_u16(OD_EC_CDF_LANES);
+    lo = vld1_u16(cdf);
+    hi = vld1_u16(cdf + n - 4);
+    lo = od_ec_cdf_adapt_lanes4(lo, idx, renorm, valv, incv);
+    hi = od_ec_cdf_adapt_lanes4(hi, vadd_u16(idx, vdup_n_u16(n - 4)),
+     renorm, valv, incv);
+    vst1_u16(cdf + n - 4, hi);
+    vst1_u16(cdf, lo);
+  }
+#if defined(OD_CHECKASM)
+  od_ec_cdf_adapt_check(cdf, ref, val, n, increment);
+#endif
+}
+
+#endif
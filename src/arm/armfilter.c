@@ -0,0 +1,225 @@
+/*Daala video codec
+Copyright (c) 2002-2013 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include "armint.h"
+
+#if defined(OD_NEON_INTRINSICS)
+#include <arm_neon.h>
+#include <stdio.h>
+#include "../filter.h"
+
+/*Moves the lanes of v up by n, shifting in zeros.*/
+#define OD_VSHLQ_LANES_S16(v, n) (vextq_s16(vdupq_n_s16(0), (v), 8 - (n)))
+/*Moves the lanes of v down by n, shifting in zeros.*/
+#define OD_VSHRQ_LANES_S16(v, n) (vextq_s16((v), vdupq_n_s16(0), (n)))
+
+#if defined(OD_CHECKASM)
+static void od_dir_find8_check(const int16_t *img, int stride, int32_t var,
+ int dir) {
+  int32_t ref_var;
+  int ref_dir;
+  ref_dir = od_dir_find8_c(img, stride, &ref_var);
+  if (ref_dir != dir || ref_var != var) {
+    fprintf(stderr, "ASM mismatch: dir %i!=%i, var %i!=%i\n",
+     ref_dir, dir, ref_var, var);
+    fprintf(stderr, "od_dir_find8 check failed.\n");
+  }
+  OD_ASSERT(ref_dir == dir && ref_var == var);
+}
+#endif
+
+/*Computes (x*m) >> 31 in each 32-bit lane.*/
+OD_SIMD_INLINE uint32x4_t od_divu31_neon(uint32x4_t x, const uint32_t *m) {
+  uint32x4_t m4;
+  m4 = vld1q_u32(m);
+  return vcombine_u32(
+   vshrn_n_u64(vmull_u32(vget_low_u32(x), vget_low_u32(m4)), 31),
+   vshrn_n_u64(vmull_u32(vget_high_u32(x), vget_high_u32(m4)), 31));
+}
+
+/*Squares the 8 partial sums in p and divides each one by its line length
+   using the reciprocals in m.*/
+OD_SIMD_INLINE uint32x4_t od_dir_cost8_neon(int16x8_t p, const uint32_t *m) {
+  uint32x4_t lo;
+  uint32x4_t hi;
+  lo = vreinterpretq_u32_s32(vmull_s16(vget_low_s16(p), vget_low_s16(p)));
+  hi = vreinterpretq_u32_s32(vmull_s16(vget_high_s16(p), vget_high_s16(p)));
+  return vaddq_u32(od_divu31_neon(lo, m), od_divu31_neon(hi, m + 4));
+}
+
+/*Computes the costs of directions 4 through 7 for the 8 rows in l.
+  The partial sums of each direction are kept in two vectors a and b, using
+   the layout described for OD_DIR_DIVU31.*/
+static uint32x4_t od_dir_costs4_neon(const int16x8_t *l) {
+  int16x8_t p4a;
+  int16x8_t p4b;
+  int16x8_t p5a;
+  int16x8_t p5b;
+  int16x8_t p6;
+  int16x8_t p7a;
+  int16x8_t p7b;
+  int16x8_t r;
+  uint32x4_t c4;
+  uint32x4_t c5;
+  uint32x4_t c6;
+  uint32x4_t c7;
+  uint32x2_t s4;
+  uint32x2_t s5;
+  uint32x2_t s6;
+  uint32x2_t s7;
+  /*Direction 4: row i adds pixel j to partial sum 7 + i - j.*/
+  p4a = l[0];
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[1], 1));
+  p4b = OD_VSHLQ_LANES_S16(l[1], 7);
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[2], 2));
+  p4b = vaddq_s16(p4b, OD_VSHLQ_LANES_S16(l[2], 6));
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[3], 3));
+  p4b = vaddq_s16(p4b, OD_VSHLQ_LANES_S16(l[3], 5));
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[4], 4));
+  p4b = vaddq_s16(p4b, OD_VSHLQ_LANES_S16(l[4], 4));
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[5], 5));
+  p4b = vaddq_s16(p4b, OD_VSHLQ_LANES_S16(l[5], 3));
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[6], 6));
+  p4b = vaddq_s16(p4b, OD_VSHLQ_LANES_S16(l[6], 2));
+  p4a = vaddq_s16(p4a, OD_VSHRQ_LANES_S16(l[7], 7));
+  p4b = vaddq_s16(p4b, OD_VSHLQ_LANES_S16(l[7], 1));
+  /*Directions 5, 6 and 7 work on pairs of rows r: pixel j goes to partial
+     sum 3 - r + j, j and r + j, respectively.*/
+  r = vaddq_s16(l[0], l[1]);
+  p5a = OD_VSHLQ_LANES_S16(r, 3);
+  p5b = OD_VSHRQ_LANES_S16(r, 5);
+  p6 = r;
+  p7a = r;
+  r = vaddq_s16(l[2], l[3]);
+  p5a = vaddq_s16(p5a, OD_VSHLQ_LANES_S16(r, 2));
+  p5b = vaddq_s16(p5b, OD_VSHRQ_LANES_S16(r, 6));
+  p6 = vaddq_s16(p6, r);
+  p7a = vaddq_s16(p7a, OD_VSHLQ_LANES_S16(r, 1));
+  p7b = OD_VSHRQ_LANES_S16(r, 7);
+  r = vaddq_s16(l[4], l[5]);
+  p5a = vaddq_s16(p5a, OD_VSHLQ_LANES_S16(r, 1));
+  p5b = vaddq_s16(p5b, OD_VSHRQ_LANES_S16(r, 7));
+  p6 = vaddq_s16(p6, r);
+  p7a = vaddq_s16(p7a, OD_VSHLQ_LANES_S16(r, 2));
+  p7b = vaddq_s16(p7b, OD_VSHRQ_LANES_S16(r, 6));
+  r = vaddq_s16(l[6], l[7]);
+  p5a = vaddq_s16(p5a, r);
+  p6 = vaddq_s16(p6, r);
+  p7a = vaddq_s16(p7a, OD_VSHLQ_LANES_S16(r, 3));
+  p7b = vaddq_s16(p7b, OD_VSHRQ_LANES_S16(r, 5));
+  c4 = vaddq_u32(od_dir_cost8_neon(p4a, OD_DIR_DIVU31[0]),
+   od_dir_cost8_neon(p4b, OD_DIR_DIVU31[1]));
+  c5 = vaddq_u32(od_dir_cost8_neon(p5a, OD_DIR_DIVU31[2]),
+   od_dir_cost8_neon(p5b, OD_DIR_DIVU31[3]));
+  c7 = vaddq_u32(od_dir_cost8_neon(p7a, OD_DIR_DIVU31[2]),
+   od_dir_cost8_neon(p7b, OD_DIR_DIVU31[3]));
+  /*All 8 lines of direction 6 have length 8.*/
+  c6 = vaddq_u32(
+   vshrq_n_u32(vreinterpretq_u32_s32(
+   vmull_s16(vget_low_s16(p6), vget_low_s16(p6))), 3),
+   vshrq_n_u32(vreinterpretq_u32_s32(
+   vmull_s16(vget_high_s16(p6), vget_high_s16(p6))), 3));
+  s4 = vadd_u32(vget_low_u32(c4), vget_high_u32(c4));
+  s5 = vadd_u32(vget_low_u32(c5), vget_high_u32(c5));
+  s6 = vadd_u32(vget_low_u32(c6), vget_high_u32(c6));
+  s7 = vadd_u32(vget_low_u32(c7), vget_high_u32(c7));
+  return vcombine_u32(vpadd_u32(s4, s5), vpadd_u32(s6, s7));
+}
+
+/*Transposes the 8x8 block in the rows l, flipping it vertically first, so
+   that t[i][j] = l[7 - j][i].*/
+static void od_dir_transpose_neon(int16x8_t *t, const int16x8_t *l) {
+  int16x8x2_t a0;
+  int16x8x2_t a1;
+  int16x8x2_t a2;
+  int16x8x2_t a3;
+  int32x4x2_t b0;
+  int32x4x2_t b1;
+  int32x4x2_t b2;
+  int32x4x2_t b3;
+  a0 = vtrnq_s16(l[7], l[6]);
+  a1 = vtrnq_s16(l[5], l[4]);
+  a2 = vtrnq_s16(l[3], l[2]);
+  a3 = vtrnq_s16(l[1], l[0]);
+  b0 = vtrnq_s32(vreinterpretq_s32_s16(a0.val[0]),
+   vreinterpretq_s32_s16(a1.val[0]));
+  b1 = vtrnq_s32(vreinterpretq_s32_s16(a0.val[1]),
+   vreinterpretq_s32_s16(a1.val[1]));
+  b2 = vtrnq_s32(vreinterpretq_s32_s16(a2.val[0]),
+   vreinterpretq_s32_s16(a3.val[0]));
+  b3 = vtrnq_s32(vreinterpretq_s32_s16(a2.val[1]),
+   vreinterpretq_s32_s16(a3.val[1]));
+  t[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b0.val[0]),
+   vget_low_s32(b2.val[0])));
+  t[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b1.val[0]),
+   vget_low_s32(b3.val[0])));
+  t[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b0.val[1]),
+   vget_low_s32(b2.val[1])));
+  t[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(b1.val[1]),
+   vget_low_s32(b3.val[1])));
+  t[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b0.val[0]),
+   vget_high_s32(b2.val[0])));
+  t[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b1.val[0]),
+   vget_high_s32(b3.val[0])));
+  t[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b0.val[1]),
+   vget_high_s32(b2.val[1])));
+  t[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(b1.val[1]),
+   vget_high_s32(b3.val[1])));
+}
+
+/*Directions 0 through 3 of a block are directions 4 through 7 of its
+   flipped transpose, so both halves of the search share the same code.*/
+int od_dir_find8_neon(const int16_t *img, int stride, int32_t *var) {
+  int16x8_t l[8];
+  int16x8_t t[8];
+  int32_t cost[8];
+  int best_cost;
+  int best_dir;
+  int i;
+  for (i = 0; i < 8; i++) {
+    l[i] = vshrq_n_s16(vld1q_s16(&img[i*stride]), OD_COEFF_SHIFT);
+  }
+  od_dir_transpose_neon(t, l);
+  vst1q_s32(&cost[0], vreinterpretq_s32_u32(od_dir_costs4_neon(t)));
+  vst1q_s32(&cost[4], vreinterpretq_s32_u32(od_dir_costs4_neon(l)));
+  best_cost = 0;
+  best_dir = 0;
+  for (i = 0; i < 8; i++) {
+    if (cost[i] > best_cost) {
+      best_cost = cost[i];
+      best_dir = i;
+    }
+  }
+  *var = best_cost - cost[(best_dir + 4) & 7];
+#if defined(OD_CHECKASM)
+  od_dir_find8_check(img, stride, *var, best_dir);
+#endif
+  return best_dir;
+}
+
+#endif
@@ -32,8 +32,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #  define OD_SIMD_INLINE static
 # endif
 
+/*NEON intrinsics need the compiler to target NEON; the CPU flags then only
+   choose whether to use them.*/
+# if defined(OD_ARM_MAY_HAVE_NEON) && \
+ (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#  define OD_NEON_INTRINSICS (1)
+# endif
+
 void od_state_opt_vtbl_init_arm(od_state *_state);
 
+int od_dir_find8_neon(const int16_t *img, int stride, int32_t *var);
+int od_ec_cdf_search_neon(const uint16_t *cdf, int nsyms, unsigned q);
+void od_ec_cdf_adapt_neon(uint16_t *cdf, int val, int n, int increment);
+
 void od_bin_fdct4x4_neon(od_coeff *y, int ystride,
  const od_coeff *x, int xstride);
 void od_bin_idct4x4_neon(od_coeff *y, int ystride,
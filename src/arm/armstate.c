@@ -34,6 +34,11 @@ void od_state_opt_vtbl_init_arm(od_state *_state){
   od_state_opt_vtbl_init_c(_state);
   _state->cpu_flags=od_cpu_flags_get();
   if(_state->cpu_flags&OD_CPU_ARM_NEON){
+#if defined(OD_NEON_INTRINSICS)
+    _state->opt_vtbl.dir_find8=od_dir_find8_neon;
+    _state->opt_vtbl.cdf_search=od_ec_cdf_search_neon;
+    _state->opt_vtbl.cdf_adapt=od_ec_cdf_adapt_neon;
+#endif
   }
 }
 
@@ -109,6 +109,10 @@ uint32_t od_cpu_flags_get(void)
         p = strstr(buf, " neon");
         if(p != NULL && (p[5] == ' ' || p[5] == '\n'))
           flags |= OD_CPU_ARM_NEON;
+        /* AArch64 reports NEON as Advanced SIMD */
+        p = strstr(buf, " asimd");
+        if(p != NULL && (p[6] == ' ' || p[6] == '\n'))
+          flags |= OD_CPU_ARM_NEON;
 #  endif
       }
 # endif
@@ -312,6 +312,29 @@ static float od_psy_var8x8(od_superblock_stats *psy_stats,
   return OD_MAXF(psy/(count*count) - 1.f, 0);
 }
 
+/* Computes the statistics of the psy model of a superblock.
+ * They only depend on the image, so they can be computed once and given to
+ * `od_split_superblock` by several encoders of the same input.
+ * @param [out] psy_stats Statistics of the superblock
+ * @param [in]  psy_img   Image on which to compute the psy model
+ * @param [in]  stride    Image stride
+ */
+void od_compute_psy_stats(od_superblock_stats *psy_stats,
+ const unsigned char *psy_img, int stride) {
+  signed char res[2*OD_SIZE2_SUMS][2*OD_SIZE2_SUMS];
+  const unsigned char *x0;
+  int i;
+  int j;
+  x0 = psy_img - OD_BLOCK_OFFSET(stride);
+  for (i = 0; i < 2*OD_SIZE2_SUMS; i++) {
+    for (j = 0; j < 2*OD_SIZE2_SUMS; j++) {
+      res[i][j] = (int)x0[i*stride + j] - 128;
+    }
+  }
+  od_compute_stats(&res[2*OD_MAX_OVERLAP][2*OD_MAX_OVERLAP],
+   2*OD_SIZE2_SUMS, psy_stats);
+}
+
 /* This function decides how to split a 32x32 superblock based on a simple
  * activity masking model. The masking at any given point is assumed to be
  * proportional to the local variance. The decision is made using a simple
@@ -323,6 +346,9 @@ static float od_psy_var8x8(od_superblock_stats *psy_stats,
  * @param [in]      pred        Prediction input (NULL means no prediction
  *                               available)
  * @param [in]      pred_stride Prediction input stride
+ * @param [in]      psy_stats   Statistics of psy_img computed beforehand
+ *                               with `od_compute_psy_stats` (NULL to
+ *                               compute them here)
  * @param [out]     bsize       Decision for each 8x8 block in the image
  *                               (see OD_BLOCK_* macros in block_size.h for
  *                               possible values)
@@ -331,6 +357,7 @@ static float od_psy_var8x8(od_superblock_stats *psy_stats,
 void od_split_superblock(od_block_size_comp *bs,
  const unsigned char *psy_img, int stride,
  const unsigned char *pred, int pred_stride,
+ const od_superblock_stats *psy_stats,
   int bsize[OD_BSIZE_GRID][OD_BSIZE_GRID], int q) {
   int i;
   int j;
@@ -344,15 +371,10 @@ void od_split_superblock(od_block_size_comp *bs,
   /* The passed in q value is now a quantizer with the same scaling as
      the coefficients. */
   psy_lambda = q ? 6*sqrt((double)(1<<OD_COEFF_SHIFT)/q) : 6;
-  for (i = 0; i < 2*OD_SIZE2_SUMS; i++) {
-    for (j = 0; j < 2*OD_SIZE2_SUMS; j++) {
-      bs->res[i][j] = (int)x0[i*stride + j] - 128;
-    }
-  }
   cg4 = OD_CG4;
   cg8 = OD_CG8;
-  od_compute_stats(&bs->res[2*OD_MAX_OVERLAP][2*OD_MAX_OVERLAP],
-   2*OD_SIZE2_SUMS, &bs->psy_stats);
+  if (psy_stats != NULL) OD_COPY(&bs->psy_stats, psy_stats, 1);
+  else od_compute_psy_stats(&bs->psy_stats, psy_img, stride);
   if (psy_img == pred || pred == NULL) {
     OD_COPY(&bs->img_stats, &bs->psy_stats, 1);
   }
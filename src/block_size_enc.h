@@ -112,9 +112,12 @@ typedef struct {
   float dec_gain16[2][2];
 } od_block_size_comp;
 
+void od_compute_psy_stats(od_superblock_stats *psy_stats,
+ const unsigned char *psy_img, int stride);
 void od_split_superblock(od_block_size_comp *bs,
  const unsigned char *psy_img, int stride,
  const unsigned char *pred, int pred_stride,
+ const od_superblock_stats *psy_stats,
   int dec[OD_BSIZE_GRID][OD_BSIZE_GRID], int q);
 
 #endif
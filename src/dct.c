@@ -2041,7 +2041,7 @@ void od_bin_idct32x32(od_coeff *x, int xstride,
   for (i = 0; i < 32; i++) od_bin_idct32(x + i, xstride, z + 32*i);
 }
 
-static const double OD_COS_TABLE64[] = {
+const double OD_COS_TABLE64[256] = {
   1.000000000000000, 0.999698818696204, 0.998795456205173, 0.997290456678690,
   0.995184726672198, 0.992479534598710, 0.989176509964781, 0.985277642388944,
   0.980785280403236, 0.975702130038531, 0.970031253194543, 0.963776065795439,
@@ -2199,6 +2199,12 @@ void od_dct_check(int bs, const od_coeff *ref, const od_coeff *x,
 #if defined(OD_X86ASM)
 # include "x86/cpu.h"
 # include "x86/x86int.h"
+/*The vectorized 64x64 DCTs are only bit-exact with SSE2 floating point.*/
+# if defined(OD_X86_SSE2_MATH)
+#  define OD_X86_DCT64(f) (f)
+# else
+#  define OD_X86_DCT64(f) (NULL)
+# endif
 #endif
 
 #if defined(OD_ARMASM)
@@ -3854,9 +3860,56 @@ static void check_transform(int bszi) {
   check_bias(bszi);
 }
 
+/*Checks that the 2-D transforms under test give exactly the same output as
+   the C versions, including the 64x64 ones, which are not covered by
+   check_transform().*/
+static void check_2d_exact(int bszi) {
+  od_coeff block[OD_BSIZE_MAX*2][OD_BSIZE_MAX*2];
+  od_coeff refout[OD_BSIZE_MAX*2][OD_BSIZE_MAX*2];
+  od_coeff testout[OD_BSIZE_MAX*2][OD_BSIZE_MAX*2];
+  int iter;
+  int i;
+  int j;
+  int n;
+  if (test_fdct_2d[bszi] == NULL || test_idct_2d[bszi] == NULL) return;
+  n = 1 << (OD_LOG_BSIZE0 + bszi);
+  ieee1180_srand(1);
+  for (iter = 0; iter < 100; iter++) {
+    for (i = 0; i < n; i++) {
+      for (j = 0; j < n; j++) {
+        block[i][j] = ieee1180_rand(256, 255)*OD_COEFF_SCALE;
+      }
+    }
+    (*OD_FDCT_2D_C[bszi])(refout[0], OD_BSIZE_MAX*2,
+     block[0], OD_BSIZE_MAX*2);
+    (*test_fdct_2d[bszi])(testout[0], OD_BSIZE_MAX*2,
+     block[0], OD_BSIZE_MAX*2);
+    for (i = 0; i < n; i++) {
+      if (memcmp(refout[i], testout[i], n*sizeof(testout[i][0])) != 0) {
+        printf("%ix%i fDCT mismatch in row %i.\n", n, n, i);
+        od_exit_code = EXIT_FAILURE;
+        return;
+      }
+    }
+    /*Feed the inverse realistic coefficients.*/
+    (*OD_IDCT_2D_C[bszi])(block[0], OD_BSIZE_MAX*2,
+     refout[0], OD_BSIZE_MAX*2);
+    (*test_idct_2d[bszi])(testout[0], OD_BSIZE_MAX*2,
+     refout[0], OD_BSIZE_MAX*2);
+    for (i = 0; i < n; i++) {
+      if (memcmp(block[i], testout[i], n*sizeof(testout[i][0])) != 0) {
+        printf("%ix%i iDCT mismatch in row %i.\n", n, n, i);
+        od_exit_code = EXIT_FAILURE;
+        return;
+      }
+    }
+  }
+}
+
 void run_test(void) {
   int bszi;
   for (bszi = 0; bszi <= OD_BLOCK_32X32; bszi++) check_transform(bszi);
+  for (bszi = 0; bszi <= OD_NBSIZES; bszi++) check_2d_exact(bszi);
 }
 
 int main(void) {
@@ -3869,15 +3922,17 @@ int main(void) {
   if (od_cpu_flags_get() & OD_CPU_X86_SSE2) {
     static const od_dct_func_2d OD_FDCT_2D_SSE2[OD_NBSIZES + 1] = {
       od_bin_fdct4x4_sse2,
-      od_bin_fdct8x8,
-      od_bin_fdct16x16,
-      od_bin_fdct32x32
+      od_bin_fdct8x8_sse2,
+      od_bin_fdct16x16_sse2,
+      od_bin_fdct32x32_sse2,
+      OD_X86_DCT64(od_bin_fdct64x64_sse2)
     };
     static const od_dct_func_2d OD_IDCT_2D_SSE2[OD_NBSIZES + 1] = {
       od_bin_idct4x4_sse2,
-      od_bin_idct8x8,
-      od_bin_idct16x16,
-      od_bin_idct32x32
+      od_bin_idct8x8_sse2,
+      od_bin_idct16x16_sse2,
+      od_bin_idct32x32_sse2,
+      OD_X86_DCT64(od_bin_idct64x64_sse2)
     };
     test_fdct_2d = OD_FDCT_2D_SSE2;
     test_idct_2d = OD_IDCT_2D_SSE2;
@@ -3889,15 +3944,17 @@ int main(void) {
   if (od_cpu_flags_get() & OD_CPU_X86_SSE4_1) {
     static const od_dct_func_2d OD_FDCT_2D_SSE41[OD_NBSIZES + 1] = {
       od_bin_fdct4x4_sse41,
-      od_bin_fdct8x8,
-      od_bin_fdct16x16,
-      od_bin_fdct32x32
+      od_bin_fdct8x8_sse41,
+      od_bin_fdct16x16_sse41,
+      od_bin_fdct32x32_sse41,
+      OD_X86_DCT64(od_bin_fdct64x64_sse41)
     };
     static const od_dct_func_2d OD_IDCT_2D_SSE41[OD_NBSIZES + 1] = {
       od_bin_idct4x4_sse41,
-      od_bin_idct8x8,
-      od_bin_idct16x16,
-      od_bin_idct32x32
+      od_bin_idct8x8_sse41,
+      od_bin_idct16x16_sse41,
+      od_bin_idct32x32_sse41,
+      OD_X86_DCT64(od_bin_idct64x64_sse41)
     };
     test_fdct_2d = OD_FDCT_2D_SSE41;
     test_idct_2d = OD_IDCT_2D_SSE41;
@@ -3910,14 +3967,16 @@ int main(void) {
     static const od_dct_func_2d OD_FDCT_2D_AVX2[OD_NBSIZES + 1] = {
       od_bin_fdct4x4_sse41,
       od_bin_fdct8x8_avx2,
-      od_bin_fdct16x16,
-      od_bin_fdct32x32
+      od_bin_fdct16x16_avx2,
+      od_bin_fdct32x32_avx2,
+      OD_X86_DCT64(od_bin_fdct64x64_avx2)
     };
     static const od_dct_func_2d OD_IDCT_2D_AVX2[OD_NBSIZES + 1] = {
       od_bin_idct4x4_sse41,
       od_bin_idct8x8_avx2,
-      od_bin_idct16x16,
-      od_bin_idct32x32
+      od_bin_idct16x16_avx2,
+      od_bin_idct32x32_avx2,
+      OD_X86_DCT64(od_bin_idct64x64_avx2)
     };
     test_fdct_2d = OD_FDCT_2D_AVX2;
     test_idct_2d = OD_IDCT_2D_AVX2;
@@ -3932,13 +3991,15 @@ int main(void) {
       od_bin_fdct4x4,
       od_bin_fdct8x8,
       od_bin_fdct16x16,
-      od_bin_fdct32x32
+      od_bin_fdct32x32,
+      od_bin_fdct64x64
     };
     static const od_dct_func_2d OD_IDCT_2D_NEON[OD_NBSIZES + 1] = {
       od_bin_idct4x4,
       od_bin_idct8x8,
       od_bin_idct16x16,
-      od_bin_idct32x32
+      od_bin_idct32x32,
+      od_bin_idct64x64
     };
     test_fdct_2d = OD_FDCT_2D_NEON;
     test_idct_2d = OD_IDCT_2D_NEON;
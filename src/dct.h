@@ -173,6 +173,12 @@ void od_bin_fdct64(od_coeff y[64], const od_coeff *x, int xstride);
   y:       The source vector (of size 64).*/
 void od_bin_idct64(od_coeff *x, int xstride, const od_coeff y[64]);
 
+/*The cosine table used by the 64-point transforms, indexed by
+   (i*(2*j + 1)) & 0xFF.
+  This is shared with the vectorized versions, which must match them
+   exactly.*/
+extern const double OD_COS_TABLE64[256];
+
 void od_bin_fdct64x64(od_coeff *y, int ystride,
  const od_coeff *x, int xstride);
 void od_bin_idct64x64(od_coeff *x, int xstride,
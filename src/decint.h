@@ -26,13 +26,47 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 # define _decint_H (1)
 # include "../include/daala/daaladec.h"
 # include "state.h"
+# include "thread.h"
 
 typedef struct daala_dec_ctx od_dec_ctx;
+typedef struct od_dec_frame  od_dec_frame;
+typedef struct od_dec_tile_worker od_dec_tile_worker;
+typedef struct od_dec_frame_buf od_dec_frame_buf;
 
 /*Constants for the packet state machine specific to the decoder.*/
 /*Next packet to read: Data packet.*/
 # define OD_PACKET_DATA (0)
 
+/*A frame queued for decoding on a frame thread.*/
+struct od_dec_frame {
+  /*The decoder that owns the queue.*/
+  od_dec_ctx *owner;
+  /*The decoder that does the work, with its own buffers and state.*/
+  od_dec_ctx *dec;
+  od_task task;
+  /*A copy of the packet, since the application may reuse its buffer.*/
+  unsigned char *packet;
+  size_t nbytes;
+  size_t packet_sz;
+  /*The index of this frame in decode order.*/
+  int64_t order;
+  int frame_type;
+  int e_o_s;
+  /*Indices into the owner's frame_imgs, in the same layout as ref_imgi.*/
+  int refs[OD_FRAME_MAX + 1];
+};
+
+/*A buffer of the output frame pool.*/
+struct od_dec_frame_buf {
+  /*The start of the buffer, including the padding.*/
+  unsigned char *data;
+  /*The image laid out in data, the size of the frame.*/
+  od_img img;
+  /*Set while the buffer is waiting to be returned by daala_decode_img_out(),
+     or after it was returned, until the application releases it.*/
+  int held;
+};
+
 struct daala_dec_ctx {
   od_state state;
   oggbyte_buffer obb;
@@ -67,6 +101,92 @@ struct daala_dec_ctx {
   /*User provided buffer for storing the deringing filter flags per superblock.
     This is set via daala_decode_ctl with OD_DECCTL_SET_DERING_BUFFER.*/
   unsigned char *user_dering;
+  /*Worker threads used to decode superblock rows in parallel.
+    This is set via daala_decode_ctl with OD_DECCTL_SET_THREADS.*/
+  od_thread_pool pool;
+  /*The number of superblock rows of the current frame that have been
+     entropy decoded and reconstructed.*/
+  od_progress sb_rows_decoded;
+  /*The macroblock context of the frame being decoded, for the row jobs.*/
+  struct od_mb_dec_ctx *jobs_mbctx;
+  /*The number of frames that can be decoded at once.
+    This is set via daala_decode_ctl with OD_DECCTL_SET_FRAME_THREADS.
+    When it is larger than 1, state.ref_imgi indexes frame_imgs.*/
+  int nframe_threads;
+  /*A ring buffer of nframe_threads frames, the oldest at frame_head.*/
+  od_dec_frame *frames;
+  int frame_head;
+  int nframes_queued;
+  /*The reference images of all the frame decoders, pooled, and for each one
+     whether the frame last decoded into it is finished.*/
+  od_img *frame_imgs;
+  od_progress *frame_img_done;
+  /*Set when a finished frame has been moved to the output buffer, but
+     daala_decode_img_out() has not been called for it yet.*/
+  int frame_retired;
+  /*The number of packets submitted to the frame threads, minus one.*/
+  int64_t frames_submitted;
+  /*The size of the tiles of the current frame in superblocks, or 0 if it is
+     not split into tiles.*/
+  int tile_w;
+  int tile_h;
+  /*The coded tiles, which follow the rest of the frame in the packet.*/
+  const unsigned char *tile_data;
+  uint32_t tile_nbytes;
+  /*The offset of each tile in tile_data, plus the end of the last one.*/
+  uint32_t *tile_offs;
+  /*The state of each thread that decodes tiles.*/
+  od_dec_tile_worker *tile_workers;
+  int ntile_workers;
+  /*Set when frames are reconstructed a few superblock rows at a time.
+    This is set via daala_decode_ctl with OD_DECCTL_SET_STREAMING.
+    The ctmp, dtmp, mctmp and mdtmp buffers of the state then live in
+     row_bufs, which only holds the rows in flight.*/
+  int streaming;
+  od_coeff *row_bufs[OD_NPLANES_MAX];
+  /*The function to call as each superblock row of a frame is finished.
+    This is set via daala_decode_ctl with OD_DECCTL_SET_ROW_CALLBACK.*/
+  daala_row_callback row_cb;
+  /*The number of superblock rows of the current frame reported to row_cb,
+     which keeps the rows in order when they are finished in parallel.*/
+  od_progress rows_output;
+  /*Set when output images are handed out from a pool of buffers that the
+     application releases, instead of being copied to output_img.
+    This is set via daala_decode_ctl with OD_DECCTL_SET_FRAME_POOL.*/
+  int frame_pool;
+  /*Set when the reference frames are decoded directly into the buffers of
+     the pool, because they have the same format as the output.*/
+  int frame_pool_refs;
+  daala_frame_allocator frame_alloc;
+  od_dec_frame_buf *frame_bufs;
+  int nframe_bufs;
+  /*The pool buffer of each reference image, or -1 if it is still in the
+     buffers of the state.*/
+  int ref_bufi[OD_FRAME_MAX + 1];
+  /*Set when the decoder keeps its memory to a minimum.
+    This is set via daala_decode_ctl with OD_DECCTL_SET_LOW_MEMORY.*/
+  int low_memory;
+  /*Set when the output images are the reference images they were decoded
+     into, instead of copies in output_img_data.*/
+  int output_refs;
+  /*The most bytes held by the buffers of the decoder at the end of any call,
+     returned by OD_DECCTL_GET_PEAK_BYTES.*/
+  size_t peak_bytes;
+};
+
+/*A thread that decodes tiles.
+  dec is a shallow copy of the decoder made at the start of each frame.
+  The frame buffers are shared, since each tile only writes to its own
+   superblocks, but the entropy decoder, the adaptation state and the
+   chroma-from-luma buffers are private.*/
+struct od_dec_tile_worker {
+  od_dec_ctx dec;
+  od_coeff *lbuf[OD_NPLANES_MAX];
+#if OD_ACCOUNTING
+  /*The position of the entropy decoder of this tile at the last symbol that
+     was accounted for, while tiles take turns decoding when streaming.*/
+  uint32_t last_tell;
+#endif
 };
 
 /*Stub for the daala_setup_info.*/
@@ -44,73 +44,373 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "quantizer.h"
 #include "accounting.h"
 
-static int od_dec_init(od_dec_ctx *dec, const daala_info *info,
- const daala_setup_info *setup) {
-  od_img *img;
-  od_img_plane *iplane;
-  size_t data_sz;
-  unsigned char *output_img_data;
-  int frame_buf_width;
-  int frame_buf_height;
-  int plane_buf_width;
-  int plane_buf_height;
-  int output_bytes;
-  int output_bits;
+static void od_dec_tile_workers_clear(od_dec_ctx *dec) {
+  int i;
+  for (i = 0; i < dec->ntile_workers; i++) {
+    int pli;
+    for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+      free(dec->tile_workers[i].lbuf[pli]);
+    }
+  }
+  free(dec->tile_workers);
+  dec->tile_workers = NULL;
+  dec->ntile_workers = 0;
+}
+
+/*Makes sure there are at least nworkers tile workers.
+  On failure, the existing ones are kept, so decoding can continue with
+   fewer threads.*/
+static int od_dec_tile_workers_reserve(od_dec_ctx *dec, int nworkers) {
+  od_dec_tile_worker *workers;
+  if (nworkers <= dec->ntile_workers) return OD_SUCCESS;
+  workers = (od_dec_tile_worker *)realloc(dec->tile_workers,
+   nworkers*sizeof(*workers));
+  if (OD_UNLIKELY(workers == NULL)) return OD_EFAULT;
+  dec->tile_workers = workers;
+  while (dec->ntile_workers < nworkers) {
+    od_dec_tile_worker *worker;
+    int pli;
+    worker = workers + dec->ntile_workers;
+    OD_CLEAR(worker->lbuf, OD_NPLANES_MAX);
+    for (pli = 1; pli < dec->state.info.nplanes; pli++) {
+      worker->lbuf[pli] = (od_coeff *)malloc(OD_BSIZE_MAX*OD_BSIZE_MAX*
+       sizeof(*worker->lbuf[pli]));
+      if (OD_UNLIKELY(worker->lbuf[pli] == NULL)) {
+        while (pli-- > 1) free(worker->lbuf[pli]);
+        return OD_EFAULT;
+      }
+    }
+    dec->ntile_workers++;
+  }
+  return OD_SUCCESS;
+}
+
+/*Sets the number of threads used to decode each frame.
+  On failure, the decoder falls back to decoding serially.*/
+static int od_dec_set_threads(od_dec_ctx *dec, int nthreads) {
   int ret;
+  /*Each thread needs its own tile worker to decode tiled frames.*/
+  ret = od_dec_tile_workers_reserve(dec, nthreads);
+  if (ret < 0) return ret;
+  if (nthreads != dec->pool.nthreads) {
+    od_thread_pool_clear(&dec->pool);
+    ret = od_thread_pool_init(&dec->pool, nthreads);
+    if (ret < 0) {
+      /*Fall back to decoding serially, which cannot fail.*/
+      od_thread_pool_init(&dec->pool, 1);
+      return ret;
+    }
+  }
+  return OD_SUCCESS;
+}
+
+/*When streaming, the number of superblock rows kept of each working buffer:
+   two of the reconstruction (the row being decoded, and the one above it,
+   which its postfilter still modifies), two of the transform coefficients
+   (the row above is used for intra prediction), two of the
+   motion-compensated prediction (the row below is needed to prefilter the
+   edge under the row being decoded) and one of its transform.*/
+#define OD_STREAM_NROWS (7)
+
+/*Returns the number of values in one superblock row of plane pli.*/
+static int od_dec_sb_row_size(od_dec_ctx *dec, int pli) {
+  return (dec->state.frame_width >> dec->state.info.plane_info[pli].xdec)
+   *(OD_BSIZE_MAX >> dec->state.info.plane_info[pli].ydec);
+}
+
+static void od_dec_row_bufs_clear(od_dec_ctx *dec) {
   int pli;
+  for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+    if (dec->row_bufs[pli] == NULL) continue;
+    free(dec->row_bufs[pli]);
+    dec->row_bufs[pli] = NULL;
+    /*These point into the row buffer.*/
+    dec->state.ctmp[pli] = NULL;
+    dec->state.dtmp[pli] = NULL;
+    dec->state.mctmp[pli] = NULL;
+    dec->state.mdtmp[pli] = NULL;
+  }
+}
+
+/*Switches between reconstructing whole frames and streaming, replacing the
+   frame-sized working buffers of the state with row-sized ones, or back.
+  On failure, the current buffers are kept.*/
+static int od_dec_set_streaming(od_dec_ctx *dec, int streaming) {
+  od_state *state;
+  od_coeff *bufs[OD_NPLANES_MAX][4];
+  int nplanes;
+  int pli;
+  int i;
+  state = &dec->state;
+  streaming = !!streaming;
+  if (streaming == dec->streaming) return OD_SUCCESS;
+  nplanes = state->info.nplanes;
+  OD_CLEAR(&bufs[0][0], OD_NPLANES_MAX*4);
+  for (pli = 0; pli < nplanes; pli++) {
+    size_t sz;
+    if (streaming) {
+      sz = OD_STREAM_NROWS*(size_t)od_dec_sb_row_size(dec, pli);
+      bufs[pli][0] = (od_coeff *)malloc(sz*sizeof(*bufs[pli][0]));
+      if (OD_UNLIKELY(bufs[pli][0] == NULL)) break;
+    }
+    else {
+      sz = (size_t)(state->frame_width >> state->info.plane_info[pli].xdec)
+       *(state->frame_height >> state->info.plane_info[pli].ydec);
+      for (i = 0; i < 4; i++) {
+        bufs[pli][i] = (od_coeff *)malloc(sz*sizeof(*bufs[pli][i]));
+        if (OD_UNLIKELY(bufs[pli][i] == NULL)) break;
+      }
+      if (i < 4) break;
+    }
+  }
+  if (OD_UNLIKELY(pli < nplanes)) {
+    for (pli = 0; pli < nplanes; pli++) {
+      for (i = 0; i < 4; i++) free(bufs[pli][i]);
+    }
+    return OD_EFAULT;
+  }
+  for (pli = 0; pli < nplanes; pli++) {
+    size_t sz;
+    /*The frame-sized buffers were allocated by od_state_init().*/
+    sz = 4*sizeof(od_coeff)
+     *(size_t)(state->frame_width >> state->info.plane_info[pli].xdec)
+     *(state->frame_height >> state->info.plane_info[pli].ydec);
+    if (streaming) state->nbytes -= sz;
+    else state->nbytes += sz;
+  }
+  if (streaming) {
+    for (pli = 0; pli < nplanes; pli++) {
+      free(state->ctmp[pli]);
+      free(state->dtmp[pli]);
+      free(state->mctmp[pli]);
+      free(state->mdtmp[pli]);
+      state->ctmp[pli] = state->dtmp[pli] = NULL;
+      state->mctmp[pli] = state->mdtmp[pli] = NULL;
+      dec->row_bufs[pli] = bufs[pli][0];
+    }
+  }
+  else {
+    od_dec_row_bufs_clear(dec);
+    for (pli = 0; pli < nplanes; pli++) {
+      state->ctmp[pli] = bufs[pli][0];
+      state->dtmp[pli] = bufs[pli][1];
+      state->mctmp[pli] = bufs[pli][2];
+      state->mdtmp[pli] = bufs[pli][3];
+    }
+  }
+  dec->streaming = streaming;
+  return OD_SUCCESS;
+}
+
+/*Initializes everything but the output buffers.*/
+static int od_dec_init_common(od_dec_ctx *dec, const daala_info *info) {
+  int ret;
   int imgi;
-  (void)setup;
-  ret = od_state_init(&dec->state, info);
+  ret = od_state_init(&dec->state, info, OD_EMU_BUFFER_PADDING);
   if (ret < 0) return ret;
+  dec->tile_w = dec->tile_h = 0;
+  dec->tile_data = NULL;
+  dec->tile_nbytes = 0;
+  dec->tile_workers = NULL;
+  dec->ntile_workers = 0;
+  dec->streaming = 0;
+  OD_CLEAR(dec->row_bufs, OD_NPLANES_MAX);
+  dec->tile_offs = (uint32_t *)malloc(
+   (dec->state.nhsb*dec->state.nvsb + 1)*sizeof(*dec->tile_offs));
+  if (OD_UNLIKELY(dec->tile_offs == NULL)
+   || OD_UNLIKELY(od_dec_tile_workers_reserve(dec, 1) < 0)) {
+    od_dec_tile_workers_clear(dec);
+    free(dec->tile_offs);
+    od_state_clear(&dec->state);
+    return OD_EFAULT;
+  }
   dec->packet_state = OD_PACKET_DATA;
   dec->user_bsize = NULL;
   dec->user_flags = NULL;
   dec->user_mv_grid = NULL;
   dec->user_mc_img = NULL;
   dec->user_dering = NULL;
-  data_sz = 0;
-  output_bits = 8 + (info->bitdepth_mode - OD_BITDEPTH_MODE_8)*2;
-  output_bytes = output_bits > 8 ? 2 : 1;
+  dec->jobs_mbctx = NULL;
+  dec->output_img_data = NULL;
+  dec->last_frame_decoded = 0;
+  dec->dec_order_count = -1;
+  dec->nframe_threads = 1;
+  dec->frames = NULL;
+  dec->frame_imgs = NULL;
+  dec->frame_img_done = NULL;
+  dec->nframes_queued = 0;
+  dec->frame_head = 0;
+  dec->frame_retired = 0;
+  dec->frames_submitted = -1;
+  ret = od_thread_pool_init(&dec->pool, 1);
+  if (OD_UNLIKELY(ret < 0)) {
+    od_dec_tile_workers_clear(dec);
+    free(dec->tile_offs);
+    od_state_clear(&dec->state);
+    return ret;
+  }
+  ret = od_progress_init(&dec->sb_rows_decoded);
+  if (OD_UNLIKELY(ret < 0)) {
+    od_thread_pool_clear(&dec->pool);
+    od_dec_tile_workers_clear(dec);
+    free(dec->tile_offs);
+    od_state_clear(&dec->state);
+    return ret;
+  }
+  ret = od_progress_init(&dec->rows_output);
+  if (OD_UNLIKELY(ret < 0)) {
+    od_progress_clear(&dec->sb_rows_decoded);
+    od_thread_pool_clear(&dec->pool);
+    od_dec_tile_workers_clear(dec);
+    free(dec->tile_offs);
+    od_state_clear(&dec->state);
+    return ret;
+  }
+  dec->row_cb.func = NULL;
+  dec->row_cb.ctx = NULL;
+  dec->frame_pool = dec->frame_pool_refs = 0;
+  dec->low_memory = dec->output_refs = 0;
+  dec->peak_bytes = 0;
+  dec->frame_bufs = NULL;
+  dec->nframe_bufs = 0;
+  for (imgi = 0; imgi <= OD_FRAME_MAX; imgi++) dec->ref_bufi[imgi] = -1;
+#if OD_ACCOUNTING
+  od_accounting_init(&dec->acct);
+  dec->acct_enabled = 0;
+#endif
+  return 0;
+}
+
+/*Returns the size of an image buffer padded like the reference images, with
+   the given number of bytes per sample.*/
+static size_t od_dec_img_buf_size(od_dec_ctx *dec, int bytes) {
+  const daala_info *info;
+  size_t data_sz;
+  int frame_buf_width;
+  int frame_buf_height;
+  int pli;
+  info = &dec->state.info;
   /*TODO: Check for overflow before allocating.*/
-  frame_buf_width = dec->state.frame_width + (OD_BUFFER_PADDING << 1);
-  frame_buf_height = dec->state.frame_height + (OD_BUFFER_PADDING << 1);
+  frame_buf_width = dec->state.frame_width + (OD_EMU_BUFFER_PADDING << 1);
+  frame_buf_height = dec->state.frame_height + (OD_EMU_BUFFER_PADDING << 1);
+  data_sz = 0;
   for (pli = 0; pli < info->nplanes; pli++) {
+    data_sz += (frame_buf_width >> info->plane_info[pli].xdec)
+     *(frame_buf_height >> info->plane_info[pli].ydec)*bytes;
+  }
+  return data_sz;
+}
+
+/*Lays out an image with the given bit depth in data, which holds
+   od_dec_img_buf_size() bytes, and returns the end of its buffer.*/
+static unsigned char *od_dec_img_layout(od_dec_ctx *dec, od_img *img,
+ unsigned char *data, int bits, int width, int height) {
+  const daala_info *info;
+  od_img_plane *iplane;
+  int frame_buf_width;
+  int frame_buf_height;
+  int plane_buf_width;
+  int plane_buf_height;
+  int pli;
+  info = &dec->state.info;
+  frame_buf_width = dec->state.frame_width + (OD_EMU_BUFFER_PADDING << 1);
+  frame_buf_height = dec->state.frame_height + (OD_EMU_BUFFER_PADDING << 1);
+  img->nplanes = info->nplanes;
+  img->width = width;
+  img->height = height;
+  for (pli = 0; pli < img->nplanes; pli++) {
     plane_buf_width = frame_buf_width >> info->plane_info[pli].xdec;
     plane_buf_height = frame_buf_height >> info->plane_info[pli].ydec;
-    data_sz += plane_buf_width*plane_buf_height*2*output_bytes;
-  }
-  dec->output_img_data = output_img_data =
-    (unsigned char *)od_aligned_malloc(data_sz, 32);
-  if (OD_UNLIKELY(!dec->output_img_data)) {
-    return OD_EFAULT;
+    iplane = img->planes + pli;
+    iplane->xdec = info->plane_info[pli].xdec;
+    iplane->ydec = info->plane_info[pli].ydec;
+    iplane->bitdepth = bits;
+    /*At this moment, our output is always planar.*/
+    iplane->xstride = bits > 8 ? 2 : 1;
+    iplane->ystride = plane_buf_width*iplane->xstride;
+    iplane->data = data
+      + iplane->xstride*(OD_EMU_BUFFER_PADDING >> info->plane_info[pli].xdec)
+      + iplane->ystride*(OD_EMU_BUFFER_PADDING >> info->plane_info[pli].ydec);
+    data += plane_buf_height*iplane->ystride;
+  }
+  return data;
+}
+
+static void od_dec_frame_pool_clear(od_dec_ctx *dec) {
+  int bufi;
+  for (bufi = 0; bufi < dec->nframe_bufs; bufi++) {
+    if (dec->frame_alloc.free != NULL) {
+      (*dec->frame_alloc.free)(dec->frame_alloc.ctx,
+       dec->frame_bufs[bufi].data);
+    }
+    else od_aligned_free(dec->frame_bufs[bufi].data);
   }
-  for (imgi = 0; imgi < 2; imgi++) {
-    img = dec->output_img + imgi;
-    img->nplanes = info->nplanes;
-    img->width = dec->state.info.pic_width;
-    img->height = dec->state.info.pic_height;
-    for (pli = 0; pli < img->nplanes; pli++) {
-      plane_buf_width = frame_buf_width >> info->plane_info[pli].xdec;
-      plane_buf_height = frame_buf_height >> info->plane_info[pli].ydec;
-      iplane = img->planes + pli;
-      iplane->xdec = info->plane_info[pli].xdec;
-      iplane->ydec = info->plane_info[pli].ydec;
-      iplane->bitdepth = output_bits;
-      /*At this moment, our output is always planar.*/
-      iplane->xstride = output_bytes;
-      iplane->ystride = plane_buf_width*iplane->xstride;
-      iplane->data = output_img_data
-        + iplane->xstride*(OD_BUFFER_PADDING >> info->plane_info[pli].xdec)
-        + iplane->ystride*(OD_BUFFER_PADDING >> info->plane_info[pli].ydec);
-      output_img_data += plane_buf_height*iplane->ystride;
+  free(dec->frame_bufs);
+  dec->frame_bufs = NULL;
+  dec->nframe_bufs = 0;
+}
+
+/*Returns a pool buffer that is neither held nor holding a reference image,
+   allocating a new one if there is none, or a negative value on failure.*/
+static int od_dec_frame_pool_get(od_dec_ctx *dec) {
+  od_dec_frame_buf *bufs;
+  od_img *ref;
+  unsigned char *data;
+  size_t data_sz;
+  int bits;
+  int bufi;
+  int imgi;
+  for (bufi = 0; bufi < dec->nframe_bufs; bufi++) {
+    if (dec->frame_bufs[bufi].held) continue;
+    for (imgi = 0; imgi <= OD_FRAME_MAX && dec->ref_bufi[imgi] != bufi;
+     imgi++);
+    if (imgi > OD_FRAME_MAX) return bufi;
+  }
+  bufs = (od_dec_frame_buf *)realloc(dec->frame_bufs,
+   (dec->nframe_bufs + 1)*sizeof(*bufs));
+  if (OD_UNLIKELY(bufs == NULL)) return OD_EFAULT;
+  dec->frame_bufs = bufs;
+  ref = dec->state.ref_imgs;
+  bits = dec->frame_pool_refs ? ref->planes[0].bitdepth
+   : dec->output_img[0].planes[0].bitdepth;
+  data_sz = od_dec_img_buf_size(dec, bits > 8 ? 2 : 1);
+  if (dec->frame_alloc.alloc != NULL) {
+    data = (unsigned char *)(*dec->frame_alloc.alloc)(dec->frame_alloc.ctx,
+     data_sz);
+  }
+  else data = (unsigned char *)od_aligned_malloc(data_sz, 32);
+  if (OD_UNLIKELY(data == NULL)) return OD_EFAULT;
+  bufi = dec->nframe_bufs++;
+  bufs[bufi].data = data;
+  od_dec_img_layout(dec, &bufs[bufi].img, data, bits, ref->width,
+   ref->height);
+  bufs[bufi].held = 0;
+  return bufi;
+}
+
+/*Picks the pool buffer that the current frame is output in and, if the
+   reference images live in the pool, decoded into.
+  A reference image whose buffer is still held by the application moves to
+   another buffer.*/
+static int od_dec_frame_pool_begin(od_dec_ctx *dec) {
+  od_img *out;
+  int imgi;
+  int bufi;
+  imgi = dec->state.ref_imgi[OD_FRAME_SELF];
+  bufi = dec->frame_pool_refs ? dec->ref_bufi[imgi] : -1;
+  if (bufi < 0 || dec->frame_bufs[bufi].held) {
+    bufi = od_dec_frame_pool_get(dec);
+    if (OD_UNLIKELY(bufi < 0)) return bufi;
+    if (dec->frame_pool_refs) {
+      dec->ref_bufi[imgi] = bufi;
+      dec->state.ref_imgs[imgi] = dec->frame_bufs[bufi].img;
     }
   }
-  dec->last_frame_decoded = 0;
-  dec->dec_order_count = -1;
-#if OD_ACCOUNTING
-  od_accounting_init(&dec->acct);
-  dec->acct_enabled = 0;
-#endif
+  dec->frame_bufs[bufi].held = 1;
+  out = dec->output_img + dec->curr_dec_frame;
+  *out = dec->frame_bufs[bufi].img;
+  out->width = dec->state.info.pic_width;
+  out->height = dec->state.info.pic_height;
   return 0;
 }
 
@@ -118,10 +418,197 @@ static void od_dec_clear(od_dec_ctx *dec) {
 #if OD_ACCOUNTING
   od_accounting_clear(&dec->acct);
 #endif
+  od_progress_clear(&dec->rows_output);
+  od_progress_clear(&dec->sb_rows_decoded);
+  od_thread_pool_clear(&dec->pool);
+  od_dec_tile_workers_clear(dec);
+  free(dec->tile_offs);
   od_aligned_free(dec->output_img_data);
+  od_dec_frame_pool_clear(dec);
+  od_dec_row_bufs_clear(dec);
   od_state_clear(&dec->state);
 }
 
+/*Allocates the two images that decoded frames are copied to for output.*/
+static int od_dec_output_imgs_init(od_dec_ctx *dec) {
+  unsigned char *output_img_data;
+  int output_bytes;
+  int output_bits;
+  int imgi;
+  output_bits = 8 + (dec->state.info.bitdepth_mode - OD_BITDEPTH_MODE_8)*2;
+  output_bytes = output_bits > 8 ? 2 : 1;
+  dec->output_img_data = output_img_data = (unsigned char *)od_aligned_malloc(
+   2*od_dec_img_buf_size(dec, output_bytes), 32);
+  if (OD_UNLIKELY(!dec->output_img_data)) return OD_EFAULT;
+  for (imgi = 0; imgi < 2; imgi++) {
+    output_img_data = od_dec_img_layout(dec, dec->output_img + imgi,
+     output_img_data, output_bits, dec->state.info.pic_width,
+     dec->state.info.pic_height);
+  }
+  return OD_SUCCESS;
+}
+
+static int od_dec_init(od_dec_ctx *dec, const daala_info *info,
+ const daala_setup_info *setup) {
+  int ret;
+  (void)setup;
+  ret = od_dec_init_common(dec, info);
+  if (ret < 0) return ret;
+  ret = od_dec_output_imgs_init(dec);
+  if (OD_UNLIKELY(ret < 0)) {
+    od_dec_clear(dec);
+    return ret;
+  }
+  return 0;
+}
+
+/*Returns the number of bytes in the buffers of the decoder, including those
+   of its state and of its frame decoders.*/
+static size_t od_dec_nbytes(od_dec_ctx *dec) {
+  size_t nbytes;
+  int pli;
+  int i;
+  nbytes = sizeof(*dec) + dec->state.nbytes
+   + (dec->state.nhsb*dec->state.nvsb + 1)*sizeof(*dec->tile_offs)
+   + dec->ntile_workers*(sizeof(*dec->tile_workers)
+   + (dec->state.info.nplanes - 1)*OD_BSIZE_MAX*OD_BSIZE_MAX*sizeof(od_coeff));
+  for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+    if (dec->row_bufs[pli] != NULL) {
+      nbytes += OD_STREAM_NROWS*sizeof(od_coeff)
+       *(size_t)od_dec_sb_row_size(dec, pli);
+    }
+  }
+  if (dec->output_img_data != NULL) {
+    nbytes += 2*od_dec_img_buf_size(dec, dec->output_img[0].planes[0].xstride);
+  }
+  for (i = 0; i < dec->nframe_bufs; i++) {
+    nbytes += sizeof(*dec->frame_bufs)
+     + od_dec_img_buf_size(dec, dec->frame_bufs[i].img.planes[0].xstride);
+  }
+  if (dec->frames != NULL) {
+    nbytes += dec->nframe_threads*(sizeof(*dec->frames)
+     + (OD_FRAME_MAX + 1)*(sizeof(*dec->frame_imgs)
+     + sizeof(*dec->frame_img_done)));
+    for (i = 0; i < dec->nframe_threads; i++) {
+      if (dec->frames[i].dec == NULL) continue;
+      nbytes += od_dec_nbytes(dec->frames[i].dec) + dec->frames[i].packet_sz;
+    }
+  }
+  return nbytes;
+}
+
+/*Records the current size of the buffers of the decoder in peak_bytes, if it
+   is the largest yet.*/
+static void od_dec_update_peak_bytes(od_dec_ctx *dec) {
+  size_t nbytes;
+  nbytes = od_dec_nbytes(dec);
+  if (nbytes > dec->peak_bytes) dec->peak_bytes = nbytes;
+}
+
+static void od_dec_frame_threads_clear(od_dec_ctx *dec) {
+  int i;
+  if (dec->frames == NULL) return;
+  for (i = 0; i < dec->nframe_threads; i++) {
+    od_dec_frame *frame;
+    frame = dec->frames + i;
+    if (frame->dec == NULL) continue;
+    od_task_clear(&frame->task);
+    free(frame->packet);
+    od_dec_clear(frame->dec);
+    free(frame->dec);
+  }
+  for (i = 0; i < dec->nframe_threads*(OD_FRAME_MAX + 1); i++) {
+    od_progress_clear(dec->frame_img_done + i);
+  }
+  free(dec->frame_img_done);
+  free(dec->frame_imgs);
+  free(dec->frames);
+  dec->frames = NULL;
+  dec->frame_imgs = NULL;
+  dec->frame_img_done = NULL;
+  dec->nframe_threads = 1;
+}
+
+/*Sets up nthreads frame decoders.
+  Each one has the working buffers of a complete decoder and runs on its own
+   thread.
+  The reference images of all of them are pooled and shared: a frame in
+   flight pins its own image and up to three references, and at most
+   nthreads - 1 other frames are in flight when a new one needs an image, so
+   OD_FRAME_MAX + 1 images per decoder are always enough.*/
+static int od_dec_frame_threads_init(od_dec_ctx *dec, int nthreads) {
+  int nimgs;
+  int i;
+  int ret;
+  nimgs = nthreads*(OD_FRAME_MAX + 1);
+  dec->frames = (od_dec_frame *)calloc(nthreads, sizeof(*dec->frames));
+  dec->frame_imgs = (od_img *)malloc(nimgs*sizeof(*dec->frame_imgs));
+  dec->frame_img_done =
+   (od_progress *)malloc(nimgs*sizeof(*dec->frame_img_done));
+  ret = OD_EFAULT;
+  if (OD_LIKELY(dec->frames != NULL && dec->frame_imgs != NULL
+   && dec->frame_img_done != NULL)) {
+    for (i = 0; i < nimgs; i++) {
+      ret = od_progress_init(dec->frame_img_done + i);
+      if (OD_UNLIKELY(ret < 0)) {
+        while (i-- > 0) od_progress_clear(dec->frame_img_done + i);
+        break;
+      }
+    }
+  }
+  if (OD_UNLIKELY(ret < 0)) {
+    free(dec->frame_img_done);
+    free(dec->frame_imgs);
+    free(dec->frames);
+    dec->frames = NULL;
+    dec->frame_imgs = NULL;
+    dec->frame_img_done = NULL;
+    return ret;
+  }
+  dec->nframe_threads = nthreads;
+  for (i = 0; i < nthreads; i++) {
+    od_dec_frame *frame;
+    int imgi;
+    frame = dec->frames + i;
+    frame->owner = dec;
+    frame->dec = (od_dec_ctx *)malloc(sizeof(*frame->dec));
+    if (OD_UNLIKELY(frame->dec == NULL)) {
+      od_dec_frame_threads_clear(dec);
+      return OD_EFAULT;
+    }
+    ret = od_dec_init_common(frame->dec, &dec->state.info);
+    if (OD_UNLIKELY(ret < 0)) {
+      free(frame->dec);
+      frame->dec = NULL;
+      od_dec_frame_threads_clear(dec);
+      return ret;
+    }
+    /*The frame decoders only need the layout of the output images.*/
+    OD_COPY(frame->dec->output_img, dec->output_img, 2);
+    frame->dec->curr_dec_frame = 0;
+    ret = od_dec_set_streaming(frame->dec, dec->streaming);
+    if (OD_LIKELY(ret >= 0)) {
+      /*Each frame is decoded with as many threads as the decoder would use
+         on its own.*/
+      ret = od_dec_set_threads(frame->dec, dec->pool.nthreads);
+    }
+    if (OD_LIKELY(ret >= 0)) ret = od_task_init(&frame->task);
+    if (OD_UNLIKELY(ret < 0)) {
+      od_dec_clear(frame->dec);
+      free(frame->dec);
+      frame->dec = NULL;
+      od_dec_frame_threads_clear(dec);
+      return ret;
+    }
+    for (imgi = 0; imgi <= OD_FRAME_MAX; imgi++) {
+      dec->frame_imgs[i*(OD_FRAME_MAX + 1) + imgi] =
+       frame->dec->state.ref_imgs[imgi];
+    }
+  }
+  for (i = 0; i <= OD_FRAME_MAX; i++) dec->state.ref_imgi[i] = -1;
+  return OD_SUCCESS;
+}
+
 daala_dec_ctx *daala_decode_create(const daala_info *info,
  const daala_setup_info *setup) {
   od_dec_ctx *dec;
@@ -131,23 +618,27 @@ daala_dec_ctx *daala_decode_create(const daala_info *info,
     free(dec);
     return NULL;
   }
+  od_dec_update_peak_bytes(dec);
   return dec;
 }
 
 void daala_decode_free(daala_dec_ctx *dec) {
   if (dec != NULL) {
+    od_dec_frame_threads_clear(dec);
     od_dec_clear(dec);
     free(dec);
   }
 }
 
-int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
+static int od_dec_ctl(daala_dec_ctx *dec, int req, void *buf,
+ size_t buf_sz) {
   (void)dec;
   (void)buf;
   (void)buf_sz;
   switch (req) {
     case OD_DECCTL_SET_BSIZE_BUFFER : {
       OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
       OD_RETURN_CHECK(buf, OD_EFAULT);
       /*Check that buf is large enough to hold the block sizes for a frame.*/
       OD_RETURN_CHECK(
@@ -159,6 +650,7 @@ int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
     }
     case OD_DECCTL_SET_FLAGS_BUFFER : {
       OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
       OD_RETURN_CHECK(buf, OD_EFAULT);
       /*Check that buf is large enough to hold the band flags for a frame.*/
       OD_RETURN_CHECK(
@@ -170,6 +662,7 @@ int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
     }
     case OD_DECCTL_SET_MV_BUFFER : {
       OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
       OD_RETURN_CHECK(buf, OD_EFAULT);
       OD_RETURN_CHECK(buf_sz ==
        sizeof(od_mv_grid_pt)*(dec->state.nhmvbs + 1)*(dec->state.nvmvbs + 1),
@@ -179,6 +672,7 @@ int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
     }
     case OD_DECCTL_SET_MC_IMG : {
       OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
       OD_RETURN_CHECK(buf, OD_EFAULT);
       OD_RETURN_CHECK((buf_sz == sizeof(od_img)), OD_EINVAL);
       dec->user_mc_img = buf;
@@ -187,6 +681,7 @@ int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
 #if OD_ACCOUNTING
     case OD_DECCTL_SET_ACCOUNTING_ENABLED: {
       OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
       OD_RETURN_CHECK(buf, OD_EFAULT);
       OD_RETURN_CHECK(buf_sz == sizeof(int), OD_EINVAL);
       dec->acct_enabled = *(int*)buf != 0;
@@ -205,6 +700,7 @@ int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
       int nhdr;
       int nvdr;
       OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
       OD_RETURN_CHECK(buf, OD_EFAULT);
       nhdr = dec->state.frame_width >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
       nvdr = dec->state.frame_height >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
@@ -213,22 +709,185 @@ int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
       dec->user_dering = (unsigned char *)buf;
       return OD_SUCCESS;
     }
+    case OD_DECCTL_SET_THREADS : {
+      int nthreads;
+      int ret;
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(int), OD_EINVAL);
+      nthreads = *(int *)buf;
+      OD_RETURN_CHECK(nthreads >= 1 && nthreads <= OD_THREADS_MAX, OD_EINVAL);
+      /*With frame threads, the frames are decoded by the frame decoders.*/
+      if (dec->frames != NULL) {
+        int i;
+        for (i = 0; i < dec->nframe_threads; i++) {
+          ret = od_dec_set_threads(dec->frames[i].dec, nthreads);
+          if (ret < 0) return ret;
+        }
+        return OD_SUCCESS;
+      }
+      return od_dec_set_threads(dec, nthreads);
+    }
+    case OD_DECCTL_SET_FRAME_THREADS : {
+      int nthreads;
+      int ret;
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(int), OD_EINVAL);
+      nthreads = *(int *)buf;
+      OD_RETURN_CHECK(nthreads >= 1 && nthreads <= OD_THREADS_MAX, OD_EINVAL);
+      /*The frame decoders take over the reference images, so this can only
+         change before the first frame.*/
+      OD_RETURN_CHECK(dec->dec_order_count < 0 && dec->frames_submitted < 0,
+       OD_EINVAL);
+      OD_RETURN_CHECK(dec->user_bsize == NULL && dec->user_flags == NULL
+       && dec->user_mv_grid == NULL && dec->user_mc_img == NULL
+       && dec->user_dering == NULL && dec->row_cb.func == NULL
+       && !dec->frame_pool && !dec->low_memory, OD_EINVAL);
+#if OD_ACCOUNTING
+      OD_RETURN_CHECK(!dec->acct_enabled, OD_EINVAL);
+#endif
+      if (nthreads != dec->nframe_threads) {
+        /*The threads of each frame move between this decoder's pool, which
+           only decodes without frame threads, and the frame decoders.*/
+        if (dec->frames != NULL) {
+          od_dec_set_threads(dec, dec->frames[0].dec->pool.nthreads);
+        }
+        od_dec_frame_threads_clear(dec);
+        if (nthreads > 1) {
+          ret = od_dec_frame_threads_init(dec, nthreads);
+          if (ret < 0) return ret;
+          od_dec_set_threads(dec, 1);
+        }
+      }
+      return OD_SUCCESS;
+    }
+    case OD_DECCTL_SET_STREAMING : {
+      int streaming;
+      int ret;
+      int i;
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(int), OD_EINVAL);
+      /*The frame decoders may still be using their buffers.*/
+      OD_RETURN_CHECK(dec->nframes_queued == 0, OD_EINVAL);
+      streaming = *(int *)buf;
+      ret = od_dec_set_streaming(dec, streaming);
+      for (i = 0; ret >= 0 && dec->frames != NULL
+       && i < dec->nframe_threads; i++) {
+        ret = od_dec_set_streaming(dec->frames[i].dec, streaming);
+      }
+      return ret;
+    }
+    case OD_DECCTL_SET_ROW_CALLBACK : {
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(daala_row_callback), OD_EINVAL);
+      /*Frames decoded in parallel finish out of order.*/
+      OD_RETURN_CHECK(dec->nframe_threads == 1, OD_EINVAL);
+      dec->row_cb = *(daala_row_callback *)buf;
+      return OD_SUCCESS;
+    }
+    case OD_DECCTL_SET_FRAME_POOL : {
+      daala_frame_allocator *alloc;
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(daala_frame_allocator), OD_EINVAL);
+      alloc = (daala_frame_allocator *)buf;
+      OD_RETURN_CHECK((alloc->alloc == NULL) == (alloc->free == NULL),
+       OD_EINVAL);
+      OD_RETURN_CHECK(dec->dec_order_count < 0 && dec->nframe_threads == 1
+       && !dec->low_memory, OD_EINVAL);
+      OD_ASSERT(dec->nframe_bufs == 0);
+      dec->frame_alloc = *alloc;
+      dec->frame_pool = 1;
+      dec->frame_pool_refs = dec->output_img[0].planes[0].bitdepth
+       == dec->state.ref_imgs[0].planes[0].bitdepth;
+      /*The images are all output from the pool from now on.*/
+      od_aligned_free(dec->output_img_data);
+      dec->output_img_data = NULL;
+      return OD_SUCCESS;
+    }
+    case OD_DECCTL_RELEASE_IMG : {
+      od_img *img;
+      int bufi;
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(od_img), OD_EINVAL);
+      img = (od_img *)buf;
+      for (bufi = 0; bufi < dec->nframe_bufs
+       && dec->frame_bufs[bufi].img.planes[0].data != img->planes[0].data;
+       bufi++);
+      OD_RETURN_CHECK(bufi < dec->nframe_bufs && dec->frame_bufs[bufi].held,
+       OD_EINVAL);
+      dec->frame_bufs[bufi].held = 0;
+      return OD_SUCCESS;
+    }
+    case OD_DECCTL_SET_LOW_MEMORY : {
+      int low_memory;
+      int ret;
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(int), OD_EINVAL);
+      OD_RETURN_CHECK(dec->dec_order_count < 0 && dec->nframe_threads == 1
+       && !dec->frame_pool, OD_EINVAL);
+      low_memory = !!*(int *)buf;
+      if (low_memory) {
+        ret = od_dec_set_streaming(dec, 1);
+        if (ret < 0) return ret;
+        /*Frames with the same format as the output are output from the
+           reference image they were decoded into.*/
+        if (dec->output_img[0].planes[0].bitdepth
+         == dec->state.ref_imgs[0].planes[0].bitdepth) {
+          od_aligned_free(dec->output_img_data);
+          dec->output_img_data = NULL;
+          dec->output_refs = 1;
+        }
+      }
+      else if (dec->output_refs) {
+        ret = od_dec_output_imgs_init(dec);
+        if (ret < 0) return ret;
+        dec->output_refs = 0;
+      }
+      dec->low_memory = low_memory;
+      /*Nothing has been decoded yet, so measure the peak from the buffers
+         that remain.*/
+      dec->peak_bytes = 0;
+      return OD_SUCCESS;
+    }
+    case OD_DECCTL_GET_PEAK_BYTES : {
+      OD_RETURN_CHECK(dec, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(size_t), OD_EINVAL);
+      od_dec_update_peak_bytes(dec);
+      *(size_t *)buf = dec->peak_bytes;
+      return OD_SUCCESS;
+    }
     default: return OD_EIMPL;
   }
 }
 
+int daala_decode_ctl(daala_dec_ctx *dec, int req, void *buf, size_t buf_sz) {
+  int ret;
+  ret = od_dec_ctl(dec, req, buf, buf_sz);
+  /*Keep track of the largest the buffers have been between calls.*/
+  if (dec != NULL) od_dec_update_peak_bytes(dec);
+  return ret;
+}
+
 static void od_dec_blank_img(od_img *img) {
   int pli;
   int frame_buf_height;
-  frame_buf_height = img->height + (OD_BUFFER_PADDING << 1);
+  frame_buf_height = img->height + (OD_EMU_BUFFER_PADDING << 1);
   for (pli = 0; pli < img->nplanes; pli++) {
     int plane_buf_size;
     int plane_buf_offset;
     plane_buf_size =
      (frame_buf_height >> img->planes[pli].ydec)*img->planes[pli].ystride;
     plane_buf_offset =
-     (OD_BUFFER_PADDING >> img->planes[pli].ydec)*img->planes[pli].ystride
-     + (OD_BUFFER_PADDING >> img->planes[pli].xdec)*img->planes[pli].xstride;
+     (OD_EMU_BUFFER_PADDING >> img->planes[pli].ydec)*img->planes[pli].ystride
+     + (OD_EMU_BUFFER_PADDING >> img->planes[pli].xdec)
+     *img->planes[pli].xstride;
     memset(img->planes[pli].data - plane_buf_offset, 128, plane_buf_size);
   }
 }
@@ -243,6 +902,15 @@ static void od_dec_init_dummy_frame(daala_dec_ctx *dec) {
   od_dec_blank_img(dec->state.ref_imgs + dec->state.ref_imgi[OD_FRAME_SELF]);
 }
 
+/*Initializes an entropy decoder to use the decoder's accelerated CDF
+   functions.*/
+static void od_dec_ec_init(daala_dec_ctx *dec, od_ec_dec *ec,
+ const unsigned char *buf, uint32_t storage) {
+  od_ec_dec_init(ec, buf, storage);
+  ec->cdf_search = dec->state.opt_vtbl.cdf_search;
+  ec->cdf_adapt = dec->state.opt_vtbl.cdf_adapt;
+}
+
 static void od_decode_mv(daala_dec_ctx *dec, int num_refs, od_mv_grid_pt *mvg,
  int vx, int vy, int level, int mv_res, int width, int height) {
   generic_encoder *model;
@@ -330,8 +998,10 @@ static void od_decode_compute_pred(daala_dec_ctx *dec, od_mb_dec_ctx *ctx,
     if (pli == 0 || OD_DISABLE_CFL || ctx->use_haar_wavelet) {
       OD_CLEAR(pred, n*n);
       if (pli == 0 && !ctx->use_haar_wavelet) {
-        od_hv_intra_pred(pred, d, w, bx, by, dec->state.bsize,
-         dec->state.bstride, bs);
+        od_hv_intra_pred(pred, d, w, bx, by,
+         dec->state.tile_sbx0 << (OD_LOG_BSIZE_MAX - OD_LOG_BSIZE0),
+         dec->state.tile_sby0 << (OD_LOG_BSIZE_MAX - OD_LOG_BSIZE0),
+         dec->state.bsize, dec->state.bstride, bs);
       }
     }
     else {
@@ -651,6 +1321,8 @@ static void od_decode_haar_dc_sb(daala_dec_ctx *dec, od_mb_dec_ctx *ctx,
   od_coeff sb_dc_pred;
   od_coeff sb_dc_curr;
   od_coeff *sb_dc_mem;
+  int has_up;
+  int has_left;
   (void)ydec;
   d = ctx->d[pli];
   w = dec->state.frame_width >> xdec;
@@ -664,7 +1336,10 @@ static void od_decode_haar_dc_sb(daala_dec_ctx *dec, od_mb_dec_ctx *ctx,
   nhsb = dec->state.nhsb;
   sb_dc_mem = dec->state.sb_dc_mem[pli];
   ln = OD_LOG_BSIZE_MAX - xdec;
-  if (by > 0 && bx > 0) {
+  /*Superblocks in other tiles are not available for prediction.*/
+  has_up = by > dec->state.tile_sby0;
+  has_left = bx > dec->state.tile_sbx0;
+  if (has_up && has_left) {
     /* These coeffs were LS-optimized on subset 1. */
     if (has_ur) {
       sb_dc_pred = (22*sb_dc_mem[by*nhsb + bx - 1]
@@ -678,8 +1353,8 @@ static void od_decode_haar_dc_sb(daala_dec_ctx *dec, od_mb_dec_ctx *ctx,
        + 19*sb_dc_mem[(by - 1)*nhsb + bx] + 16) >> 5;
     }
   }
-  else if (by > 0) sb_dc_pred = sb_dc_mem[(by - 1)*nhsb + bx];
-  else if (bx > 0) sb_dc_pred = sb_dc_mem[by*nhsb + bx - 1];
+  else if (has_up) sb_dc_pred = sb_dc_mem[(by - 1)*nhsb + bx];
+  else if (has_left) sb_dc_pred = sb_dc_mem[by*nhsb + bx - 1];
   else sb_dc_pred = 0;
   quant = generic_decode(&dec->ec, &dec->state.adapt.model_dc[pli], -1,
    &dec->state.adapt.ex_sb_dc[pli], 2, "haardc:mag:top");
@@ -689,8 +1364,8 @@ static void od_decode_haar_dc_sb(daala_dec_ctx *dec, od_mb_dec_ctx *ctx,
   sb_dc_curr = quant*dc_quant + sb_dc_pred;
   d[(by << ln)*w + (bx << ln)] = sb_dc_curr;
   sb_dc_mem[by*nhsb + bx] = sb_dc_curr;
-  if (by > 0) *ovgrad = sb_dc_mem[(by - 1)*nhsb + bx] - sb_dc_curr;
-  if (bx > 0) *ohgrad = sb_dc_mem[by*nhsb + bx - 1] - sb_dc_curr;
+  if (has_up) *ovgrad = sb_dc_mem[(by - 1)*nhsb + bx] - sb_dc_curr;
+  if (has_left) *ohgrad = sb_dc_mem[by*nhsb + bx - 1] - sb_dc_curr;
 }
 #endif
 
@@ -749,10 +1424,10 @@ static void od_decode_quantizer_scaling(daala_dec_ctx *dec, int bx, int by,
   if (!skip) {
     int above;
     int left;
-    above = sby > 0 ? dec->state.sb_q_scaling[(sby - 1)*dec->state.nhsb + sbx]
-     : 0;
-    left = sbx > 0 ? dec->state.sb_q_scaling[sby*dec->state.nhsb + (sbx - 1)]
-     : 0;
+    above = sby > dec->state.tile_sby0 ?
+     dec->state.sb_q_scaling[(sby - 1)*dec->state.nhsb + sbx] : 0;
+    left = sbx > dec->state.tile_sbx0 ?
+     dec->state.sb_q_scaling[sby*dec->state.nhsb + (sbx - 1)] : 0;
     q_scaling = od_decode_cdf_adapt(&dec->ec,
      dec->state.adapt.q_cdf[above + left*4], 4,
      dec->state.adapt.q_increment, "quant");
@@ -845,7 +1520,8 @@ static void od_decode_recursive(daala_dec_ctx *dec, od_mb_dec_ctx *ctx, int pli,
     hfilter = (bx + 1) << (OD_LOG_BSIZE0 + bs) <= dec->state.info.pic_width;
     vfilter = (by + 1) << (OD_LOG_BSIZE0 + bs) <= dec->state.info.pic_height;
     if (!ctx->is_keyframe) {
-      od_prefilter_split(ctx->mc + bo, w, bs, f, hfilter, vfilter);
+      od_prefilter_split(&dec->state, ctx->mc + bo, w, bs, f, hfilter,
+       vfilter);
     }
     if (ctx->is_keyframe) {
       od_decode_haar_dc_level(dec, ctx, pli, 2*bx, 2*by, bsi - 1, xdec, &hgrad,
@@ -861,7 +1537,8 @@ static void od_decode_recursive(daala_dec_ctx *dec, od_mb_dec_ctx *ctx, int pli,
      hgrad, vgrad);
     bs = bsi - xdec;
     bo = (by << (OD_LOG_BSIZE0 + bs))*w + (bx << (OD_LOG_BSIZE0 + bs));
-    od_postfilter_split(ctx->c + bo, w, bs, f, dec->state.coded_quantizer[pli],
+    od_postfilter_split(&dec->state, ctx->c + bo, w, bs, f,
+     dec->state.coded_quantizer[pli],
      &dec->state.bskip[pli][(by << bs)*dec->state.skip_stride + (bx << bs)],
      dec->state.skip_stride, hfilter, vfilter);
   }
@@ -959,31 +1636,604 @@ static void od_dec_mv_unpack(daala_dec_ctx *dec, int num_refs) {
   }
 }
 
-static void od_decode_coefficients(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
+/*Decodes and reconstructs one row of superblocks of the current tile in
+   every plane.
+  This is the only stage that reads from the entropy decoder, so the rows of
+   a tile must be decoded in order, by a single thread.*/
+static void od_decode_sb_row(od_dec_ctx *dec, od_mb_dec_ctx *mbctx, int sby) {
+  od_state *state;
   int nplanes;
+  int sbx;
   int pli;
-  int xdec;
+  state = &dec->state;
+  nplanes = state->info.nplanes;
+  for (sbx = state->tile_sbx0; sbx < state->tile_sbx1; sbx++) {
+    for (pli = 0; pli < nplanes; pli++) {
+      od_coeff hgrad;
+      od_coeff vgrad;
+      int xdec;
+      int ydec;
+      hgrad = vgrad = 0;
+      mbctx->c = state->ctmp[pli];
+      mbctx->d = state->dtmp;
+      mbctx->mc = state->mctmp[pli];
+      mbctx->md = state->mdtmp[pli];
+      mbctx->l = state->lbuf[pli];
+      xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
+      ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
+      if (mbctx->is_keyframe) {
+        od_decode_haar_dc_sb(dec, mbctx, pli, sbx, sby, xdec, ydec,
+         sby > state->tile_sby0 && sbx < state->tile_sbx1 - 1,
+         &hgrad, &vgrad);
+      }
+      od_decode_recursive(dec, mbctx, pli, sbx, sby, OD_NBSIZES - 1, xdec,
+       ydec, hgrad, vgrad);
+    }
+  }
+}
+
+/*Copies one row of superblocks of the postfiltered image into the deringing
+   input buffer.*/
+static void od_dec_copy_dering_input(od_dec_ctx *dec, int pli, int sby) {
+  od_state *state;
+  od_coeff *src;
+  int16_t *dst;
   int ydec;
-  int sby;
-  int sbx;
-  int w;
-  int y;
-  int x;
-  int frame_width;
-  int nvsb;
-  int nhsb;
+  int i;
+  int n;
+  state = &dec->state;
+  ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
+  n = (state->frame_width >> dec->output_img[dec->curr_dec_frame]
+   .planes[pli].xdec)*(OD_BSIZE_MAX >> ydec);
+  src = state->ctmp[pli] + sby*n;
+  dst = state->etmp[pli] + sby*n;
+  for (i = 0; i < n; i++) dst[i] = src[i];
+}
+
+/*Decodes the per-superblock deringing flags.
+  These are coded after all of the coefficients, and only depend on the skip
+   flags, so they can be read before any of the filtering is done.*/
+static void od_dec_dering_flags(od_dec_ctx *dec) {
+  od_state *state;
   int nhdr;
   int nvdr;
-  od_state *state;
-  od_img *rec;
+  int sbx;
+  int sby;
   state = &dec->state;
-  /*Initialize the data needed for each plane.*/
-  nplanes = state->info.nplanes;
-  nhsb = state->nhsb;
-  nvsb = state->nvsb;
-  frame_width = state->frame_width;
-  rec = state->ref_imgs + state->ref_imgi[OD_FRAME_SELF];
-  OD_ACCOUNTING_SET_LOCATION(dec, OD_ACCT_FRAME, 0, 0, 0);
+  nhdr = state->frame_width >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
+  nvdr = state->frame_height >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
+  for (sby = 0; sby < nvdr; sby++) {
+    for (sbx = 0; sbx < nhdr; sbx++) {
+      int c;
+      int up;
+      int left;
+      int i;
+      int j;
+      unsigned char *bskip;
+      state->dering_flags[sby*nhdr + sbx] = 0;
+      bskip = state->bskip[0] +
+       (sby << OD_LOG_DERING_GRID)*state->skip_stride +
+       (sbx << OD_LOG_DERING_GRID);
+      for (j = 0; j < 1 << OD_LOG_DERING_GRID; j++) {
+        for (i = 0; i < 1 << OD_LOG_DERING_GRID; i++) {
+          if (!bskip[j*state->skip_stride + i]) {
+            state->dering_flags[sby*nhdr + sbx] = 1;
+          }
+        }
+      }
+      if (!state->dering_flags[sby*nhdr + sbx]) {
+        continue;
+      }
+      up = 0;
+      if (sby > 0) {
+        up = state->dering_flags[(sby - 1)*nhdr + sbx];
+      }
+      left = 0;
+      if (sbx > 0) {
+        left = state->dering_flags[sby*nhdr + (sbx - 1)];
+      }
+      c = (up << 1) + left;
+      state->dering_flags[sby*nhdr + sbx] = od_decode_cdf_adapt(&dec->ec,
+       state->adapt.clpf_cdf[c], 2, state->adapt.clpf_increment, "clp");
+    }
+  }
+}
+
+/*Applies the deringing filter to one row of superblocks.
+  The filter reads the unfiltered copy in etmp (including the rows above and
+   below) and writes to ctmp, so rows are independent of each other.*/
+static void od_dec_dering_sb_row(od_dec_ctx *dec, int sby) {
+  od_state *state;
+  int nplanes;
+  int frame_width;
+  int nhdr;
+  int nvdr;
+  int sbx;
+  state = &dec->state;
+  nplanes = state->info.nplanes;
+  frame_width = state->frame_width;
+  nhdr = state->frame_width >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
+  nvdr = state->frame_height >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
+  for (sbx = 0; sbx < nhdr; sbx++) {
+    int pli;
+    if (!state->dering_flags[sby*nhdr + sbx]) continue;
+    for (pli = 0; pli < nplanes; pli++) {
+      int16_t buf[OD_BSIZE_MAX*OD_BSIZE_MAX];
+      od_coeff *output;
+      int xdec;
+      int ydec;
+      int ln;
+      int n;
+      int w;
+      int x;
+      int y;
+      int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS];
+      xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
+      ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
+      w = frame_width >> xdec;
+      ln = OD_LOG_DERING_GRID + OD_LOG_BSIZE0 - xdec;
+      n = 1 << ln;
+      OD_ASSERT(xdec == ydec);
+      /*buf is used for output so that we don't use filtered pixels in
+        the input to the filter, but because we look past block edges,
+        we do this anyway on the edge pixels. Unfortunately, this limits
+        potential parallelism.*/
+      od_dering(state, buf, n,
+       &state->etmp[pli][(sby << ln)*w +
+       (sbx << ln)], w, ln, sbx, sby, nhdr, nvdr,
+       state->quantizer[pli], xdec, dir, pli, &state->bskip[pli]
+       [(sby << (OD_LOG_DERING_GRID - ydec))*state->skip_stride
+       + (sbx << (OD_LOG_DERING_GRID - xdec))], state->skip_stride);
+      output = &state->ctmp[pli][(sby << ln)*w + (sbx << ln)];
+      for (y = 0; y < n; y++) {
+        for (x = 0; x < n; x++) {
+          output[y*w + x] = buf[y*n+ x];
+        }
+      }
+    }
+  }
+}
+
+/*Applies the keyframe smoothing to one row of superblocks, and moves,
+   scales and shifts the reconstructed values from transform storage back
+   into the SELF reference frame.*/
+static void od_dec_output_sb_row(od_dec_ctx *dec, od_mb_dec_ctx *mbctx,
+ int sby) {
+  od_state *state;
+  od_img *rec;
+  int nplanes;
+  int pli;
+  state = &dec->state;
+  nplanes = state->info.nplanes;
+  rec = state->ref_imgs + state->ref_imgi[OD_FRAME_SELF];
+  for (pli = 0; pli < nplanes; pli++) {
+    od_img_plane *iplane;
+    int xdec;
+    int ydec;
+    int w;
+    int h;
+    xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
+    ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
+    w = state->frame_width >> xdec;
+    if (state->quantizer[0] > 0 && mbctx->is_keyframe) {
+      int sbx;
+      for (sbx = 0; sbx < state->nhsb; sbx++) {
+        od_smooth_recursive(state->ctmp[pli], state->bsize,
+         state->bstride, sbx, sby, OD_NBSIZES - 1, w, xdec, ydec,
+         OD_BLOCK_32X32, state->quantizer[pli], pli);
+      }
+    }
+    iplane = rec->planes + pli;
+    OD_ASSERT(iplane->xdec == xdec && iplane->ydec == ydec);
+    h = OD_BSIZE_MAX >> ydec;
+    od_coeff_to_ref_buf(state,
+     iplane->data + sby*h*iplane->ystride, iplane->xstride, iplane->ystride,
+     state->ctmp[pli] + sby*h*w, w, OD_LOSSLESS(dec, pli), rec->width >> xdec,
+     h);
+  }
+}
+
+/*Reports superblock row sby of the frame to the row callback, once it has
+   been output and every row above it has been reported.
+  The rows are copied to the output image as they are reported, instead of
+   all at once after the frame is decoded, unless the frame is decoded
+   directly into its output image.*/
+static void od_dec_row_done(od_dec_ctx *dec, int sby) {
+  od_img *out;
+  od_img *rec;
+  int y0;
+  int y1;
+  int pli;
+  if (dec->row_cb.func == NULL) return;
+  od_progress_wait(&dec->rows_output, sby);
+  out = dec->output_img + dec->curr_dec_frame;
+  rec = dec->state.ref_imgs + dec->state.ref_imgi[OD_FRAME_SELF];
+  y0 = sby << OD_LOG_BSIZE_MAX;
+  y1 = OD_MINI(y0 + OD_BSIZE_MAX, out->height);
+  for (pli = 0; !dec->frame_pool_refs && !dec->output_refs
+   && pli < out->nplanes; pli++) {
+    int ydec;
+    ydec = out->planes[pli].ydec;
+    od_img_plane_copy_rows(out, rec, pli, y0 >> ydec,
+     (y1 + (1 << ydec) - 1) >> ydec);
+  }
+  if (y0 < y1) (*dec->row_cb.func)(dec->row_cb.ctx, out, y0, y1);
+  od_progress_set(&dec->rows_output, sby + 1);
+}
+
+/*Returns the number of jobs used to decode the tiles of the current frame.*/
+static int od_dec_tile_njobs(od_dec_ctx *dec) {
+#if OD_ACCOUNTING
+  /*With accounting, a single job takes over the accounting state of the
+     decoder while it runs.*/
+  if (dec->ec.acct != NULL) return 1;
+#endif
+  return OD_MINI(OD_MINI(dec->pool.nthreads, dec->ntile_workers),
+   od_state_ntiles(&dec->state, dec->tile_w, dec->tile_h));
+}
+
+/*Job j decodes tiles j, j + njobs, j + 2*njobs, ..., with tile worker j.
+  Tiles do not depend on each other, so they may be decoded in any order.*/
+static void od_dec_tile_job(void *ctx, int jobi) {
+  od_dec_ctx *dec;
+  od_dec_tile_worker *worker;
+  od_dec_ctx *tdec;
+  int ntiles;
+  int njobs;
+  int tilei;
+  int pli;
+  dec = (od_dec_ctx *)ctx;
+  worker = dec->tile_workers + jobi;
+  tdec = &worker->dec;
+  *tdec = *dec;
+  for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+    tdec->state.lbuf[pli] = worker->lbuf[pli];
+  }
+  ntiles = od_state_ntiles(&dec->state, dec->tile_w, dec->tile_h);
+  njobs = od_dec_tile_njobs(dec);
+  for (tilei = jobi; tilei < ntiles; tilei += njobs) {
+    od_mb_dec_ctx mbctx;
+    int sby;
+    mbctx = *dec->jobs_mbctx;
+    od_dec_ec_init(tdec, &tdec->ec, dec->tile_data + dec->tile_offs[tilei],
+     dec->tile_offs[tilei + 1] - dec->tile_offs[tilei]);
+#if OD_ACCOUNTING
+    if (dec->ec.acct != NULL) {
+      tdec->ec.acct = &tdec->acct;
+      tdec->acct.last_tell = 0;
+    }
+#endif
+    od_adapt_ctx_reset(&tdec->state.adapt, mbctx.is_keyframe);
+    od_state_set_tile(&tdec->state, dec->tile_w, dec->tile_h, tilei);
+    for (sby = tdec->state.tile_sby0; sby < tdec->state.tile_sby1; sby++) {
+      od_decode_sb_row(tdec, &mbctx, sby);
+    }
+  }
+#if OD_ACCOUNTING
+  if (dec->ec.acct != NULL) {
+    uint32_t last_tell;
+    last_tell = dec->acct.last_tell;
+    dec->acct = tdec->acct;
+    dec->acct.last_tell = last_tell;
+  }
+#endif
+}
+
+/*Job 0 decodes the superblock rows in order, unless the frame is split into
+   tiles, which have already been decoded.
+  Job 1 + pli trails behind it, postfiltering each row of plane pli once that
+   row has been decoded, and filling in the deringing input.*/
+static void od_dec_decode_job(void *ctx, int jobi) {
+  od_dec_ctx *dec;
+  od_mb_dec_ctx *mbctx;
+  od_state *state;
+  int nvsb;
+  int sby;
+  dec = (od_dec_ctx *)ctx;
+  mbctx = dec->jobs_mbctx;
+  state = &dec->state;
+  nvsb = state->nvsb;
+  if (jobi == 0) {
+    if (dec->tile_w > 0) return;
+    for (sby = 0; sby < nvsb; sby++) {
+      od_decode_sb_row(dec, mbctx, sby);
+      od_progress_set(&dec->sb_rows_decoded, sby + 1);
+    }
+  }
+  else {
+    int pli;
+    int xdec;
+    int ydec;
+    int w;
+    pli = jobi - 1;
+    xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
+    ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
+    w = state->frame_width >> xdec;
+    for (sby = 0; sby < nvsb; sby++) {
+      od_progress_wait(&dec->sb_rows_decoded, sby + 1);
+      if (!mbctx->use_haar_wavelet) {
+        od_apply_postfilter_sb_row(state, state->ctmp[pli], w, state->nhsb,
+         sby, xdec, ydec, state->coded_quantizer[pli], &state->bskip[pli][0],
+         state->skip_stride);
+      }
+      /*The row above is final once the edge between it and this row has
+         been filtered.*/
+      if (state->quantizer[0] > 0 && sby > 0) {
+        od_dec_copy_dering_input(dec, pli, sby - 1);
+      }
+    }
+    if (state->quantizer[0] > 0) {
+      od_dec_copy_dering_input(dec, pli, nvsb - 1);
+    }
+  }
+}
+
+/*Each job filters and outputs one superblock row.*/
+static void od_dec_filter_job(void *ctx, int sby) {
+  od_dec_ctx *dec;
+  dec = (od_dec_ctx *)ctx;
+  if (dec->state.quantizer[0] > 0) {
+    od_dec_dering_sb_row(dec, sby);
+  }
+  od_dec_output_sb_row(dec, dec->jobs_mbctx, sby);
+  od_dec_row_done(dec, sby);
+}
+
+/*Points the working buffers of the state at the rows kept when streaming,
+   so that row sby of the reconstruction and of the transform coefficients
+   comes right after the row above it, and row sby of the motion-compensated
+   prediction right before the row below it, at the same offsets from the
+   buffer pointers as in a whole frame.
+  The pointers themselves may lie outside of row_bufs, but only the rows kept
+   are ever accessed through them.*/
+static void od_dec_stream_window(od_dec_ctx *dec, int sby) {
+  od_state *state;
+  int nplanes;
+  int pli;
+  state = &dec->state;
+  nplanes = state->info.nplanes;
+  for (pli = 0; pli < nplanes; pli++) {
+    od_coeff *buf;
+    int n;
+    buf = dec->row_bufs[pli];
+    n = od_dec_sb_row_size(dec, pli);
+    state->ctmp[pli] = buf + (1 - sby)*n;
+    state->dtmp[pli] = buf + (3 - sby)*n;
+    state->mctmp[pli] = buf + (4 - sby)*n;
+    state->mdtmp[pli] = buf + (6 - sby)*n;
+  }
+}
+
+/*Finishes the motion-compensated prediction of row sby of plane pli when
+   streaming, by bringing in row sby + 1 from the SELF reference image and
+   prefiltering the edges around row sby.
+  The top of row sby has already been prefiltered along with the row
+   above.*/
+static void od_dec_stream_mc_rows(od_dec_ctx *dec, od_mb_dec_ctx *mbctx,
+ int pli, int sby) {
+  od_state *state;
+  od_img *rec;
+  od_img_plane *iplane;
+  int nvsb;
+  int sbyi;
+  int xdec;
+  int ydec;
+  int w;
+  int h;
+  state = &dec->state;
+  nvsb = state->nvsb;
+  rec = state->ref_imgs + state->ref_imgi[OD_FRAME_SELF];
+  iplane = rec->planes + pli;
+  xdec = iplane->xdec;
+  ydec = iplane->ydec;
+  w = state->frame_width >> xdec;
+  h = OD_BSIZE_MAX >> ydec;
+  /*Every row but the first was brought in along with the row above it.*/
+  for (sbyi = sby == 0 ? 0 : sby + 1; sbyi <= sby + 1 && sbyi < nvsb;
+   sbyi++) {
+    od_ref_buf_to_coeff(state, state->mctmp[pli] + sbyi*h*w, w,
+     OD_LOSSLESS(dec, pli), iplane->data + sbyi*h*iplane->ystride,
+     iplane->xstride, iplane->ystride, rec->width >> xdec, h);
+  }
+  if (!mbctx->use_haar_wavelet) {
+    od_apply_prefilter_sb_row(state, state->mctmp[pli], w, state->nhsb, nvsb,
+     sby, xdec, ydec);
+  }
+}
+
+/*Decodes row sby of every tile in the current row of tiles when streaming.
+  Each column of tiles has its own tile worker, which is set up at the top
+   of the tile and keeps its entropy decoder and adaptation state from one
+   row to the next.*/
+static void od_dec_stream_tile_row(od_dec_ctx *dec, od_mb_dec_ctx *mbctx,
+ int sby) {
+  od_state *state;
+  int ntcols;
+  int tx;
+  state = &dec->state;
+  ntcols = (state->nhsb + dec->tile_w - 1)/dec->tile_w;
+  OD_ASSERT(ntcols <= dec->ntile_workers);
+  for (tx = 0; tx < ntcols; tx++) {
+    od_dec_tile_worker *worker;
+    od_dec_ctx *tdec;
+    int pli;
+    worker = dec->tile_workers + tx;
+    tdec = &worker->dec;
+    if (sby % dec->tile_h == 0) {
+      int tilei;
+      tilei = sby/dec->tile_h*ntcols + tx;
+      *tdec = *dec;
+      for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+        tdec->state.lbuf[pli] = worker->lbuf[pli];
+      }
+      od_dec_ec_init(tdec, &tdec->ec, dec->tile_data + dec->tile_offs[tilei],
+       dec->tile_offs[tilei + 1] - dec->tile_offs[tilei]);
+#if OD_ACCOUNTING
+      worker->last_tell = 0;
+#endif
+      od_adapt_ctx_reset(&tdec->state.adapt, mbctx->is_keyframe);
+      od_state_set_tile(&tdec->state, dec->tile_w, dec->tile_h, tilei);
+    }
+    for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+      tdec->state.ctmp[pli] = state->ctmp[pli];
+      tdec->state.dtmp[pli] = state->dtmp[pli];
+      tdec->state.mctmp[pli] = state->mctmp[pli];
+      tdec->state.mdtmp[pli] = state->mdtmp[pli];
+    }
+#if OD_ACCOUNTING
+    /*The tiles take turns recording their symbols in the accounting of the
+       frame, each with the position of its own entropy decoder.*/
+    if (dec->ec.acct != NULL) {
+      uint32_t last_tell;
+      tdec->acct = dec->acct;
+      tdec->acct.last_tell = worker->last_tell;
+      tdec->ec.acct = &tdec->acct;
+      od_decode_sb_row(tdec, mbctx, sby);
+      worker->last_tell = tdec->acct.last_tell;
+      last_tell = dec->acct.last_tell;
+      dec->acct = tdec->acct;
+      dec->acct.last_tell = last_tell;
+      continue;
+    }
+#endif
+    od_decode_sb_row(tdec, mbctx, sby);
+  }
+}
+
+/*Decodes and postfilters the frame one superblock row at a time when
+   streaming.
+  The rows are output as soon as they are final for lossless frames, and
+   otherwise moved into the deringing input, since the deringing flags are
+   only coded after all of the coefficients.*/
+static void od_dec_stream_decode(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
+  od_state *state;
+  int nplanes;
+  int nvsb;
+  int sby;
+  int pli;
+  state = &dec->state;
+  nplanes = state->info.nplanes;
+  nvsb = state->nvsb;
+  for (sby = 0; sby < nvsb; sby++) {
+    od_dec_stream_window(dec, sby);
+    if (!mbctx->is_keyframe) {
+      for (pli = 0; pli < nplanes; pli++) {
+        od_dec_stream_mc_rows(dec, mbctx, pli, sby);
+      }
+    }
+    if (dec->tile_w > 0) od_dec_stream_tile_row(dec, mbctx, sby);
+    else od_decode_sb_row(dec, mbctx, sby);
+    for (pli = 0; pli < nplanes; pli++) {
+      if (!mbctx->use_haar_wavelet) {
+        od_apply_postfilter_sb_row(state, state->ctmp[pli],
+         state->frame_width >> state->info.plane_info[pli].xdec, state->nhsb,
+         sby, state->info.plane_info[pli].xdec,
+         state->info.plane_info[pli].ydec, state->coded_quantizer[pli],
+         &state->bskip[pli][0], state->skip_stride);
+      }
+      if (state->quantizer[0] > 0 && sby > 0) {
+        od_dec_copy_dering_input(dec, pli, sby - 1);
+      }
+    }
+    if (state->quantizer[0] == 0 && sby > 0) {
+      od_dec_output_sb_row(dec, mbctx, sby - 1);
+      od_dec_row_done(dec, sby - 1);
+    }
+    /*Slide the rows that are still needed up by one.*/
+    for (pli = 0; pli < nplanes; pli++) {
+      od_coeff *buf;
+      int n;
+      buf = dec->row_bufs[pli];
+      n = od_dec_sb_row_size(dec, pli);
+      OD_COPY(buf, buf + n, n);
+      if (pli == 0 && mbctx->is_keyframe && !mbctx->use_haar_wavelet) {
+        OD_COPY(buf + 2*n, buf + 3*n, n);
+      }
+      if (!mbctx->is_keyframe) OD_COPY(buf + 4*n, buf + 5*n, n);
+    }
+  }
+  od_dec_stream_window(dec, nvsb);
+  if (state->quantizer[0] > 0) {
+    for (pli = 0; pli < nplanes; pli++) {
+      od_dec_copy_dering_input(dec, pli, nvsb - 1);
+    }
+  }
+  else {
+    od_dec_output_sb_row(dec, mbctx, nvsb - 1);
+    od_dec_row_done(dec, nvsb - 1);
+  }
+}
+
+/*Derings and outputs the frame one superblock row at a time when streaming
+   a lossy frame, starting over from the deringing input.*/
+static void od_dec_stream_output(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
+  od_state *state;
+  int nplanes;
+  int nvsb;
+  int sby;
+  state = &dec->state;
+  nplanes = state->info.nplanes;
+  nvsb = state->nvsb;
+  for (sby = 0; sby < nvsb; sby++) {
+    int pli;
+    od_dec_stream_window(dec, sby);
+    for (pli = 0; pli < nplanes; pli++) {
+      od_coeff *dst;
+      int16_t *src;
+      int n;
+      int i;
+      n = od_dec_sb_row_size(dec, pli);
+      dst = state->ctmp[pli] + sby*n;
+      src = state->etmp[pli] + sby*n;
+      for (i = 0; i < n; i++) dst[i] = src[i];
+    }
+    od_dec_dering_sb_row(dec, sby);
+    od_dec_output_sb_row(dec, mbctx, sby);
+    od_dec_row_done(dec, sby);
+  }
+}
+
+/*Reads the offset of each tile in the tile data from the frame.
+  The size of every tile but the last is coded after the quantizers.*/
+static void od_dec_read_tile_offs(od_dec_ctx *dec) {
+  uint32_t offs;
+  int ntiles;
+  int tilei;
+  ntiles = od_state_ntiles(&dec->state, dec->tile_w, dec->tile_h);
+  offs = 0;
+  for (tilei = 0; tilei < ntiles - 1; tilei++) {
+    dec->tile_offs[tilei] = offs;
+    if (offs < dec->tile_nbytes) {
+      offs += od_ec_dec_uint(&dec->ec, dec->tile_nbytes - offs + 1, "tiles");
+    }
+  }
+  dec->tile_offs[ntiles - 1] = offs;
+  dec->tile_offs[ntiles] = dec->tile_nbytes;
+}
+
+static void od_decode_coefficients(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
+  int nplanes;
+  int pli;
+  int xdec;
+  int ydec;
+  int sby;
+  int sbx;
+  int w;
+  int frame_width;
+  int nvsb;
+  int nhsb;
+  int nhdr;
+  int nvdr;
+  od_state *state;
+  od_img *rec;
+  state = &dec->state;
+  /*Initialize the data needed for each plane.*/
+  nplanes = state->info.nplanes;
+  nhsb = state->nhsb;
+  nvsb = state->nvsb;
+  frame_width = state->frame_width;
+  rec = state->ref_imgs + state->ref_imgi[OD_FRAME_SELF];
+  OD_ACCOUNTING_SET_LOCATION(dec, OD_ACCT_FRAME, 0, 0, 0);
   /* Map our quantizers; we potentially need them to know what reference
      resolution we're working at. */
   for (pli = 0; pli < nplanes; pli++) {
@@ -992,8 +2242,9 @@ static void od_decode_coefficients(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
     dec->state.quantizer[pli] =
      od_codedquantizer_to_quantizer(dec->state.coded_quantizer[pli]);
   }
-  /*Apply the prefilter to the motion-compensated reference.*/
-  if (!mbctx->is_keyframe) {
+  /*Apply the prefilter to the motion-compensated reference.
+    When streaming, this is done a row at a time as the rows are decoded.*/
+  if (!mbctx->is_keyframe && !dec->streaming) {
     for (pli = 0; pli < nplanes; pli++) {
       xdec = rec->planes[pli].xdec;
       ydec = rec->planes[pli].ydec;
@@ -1002,124 +2253,35 @@ static void od_decode_coefficients(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
       od_ref_plane_to_coeff(state,
        state->mctmp[pli], OD_LOSSLESS(dec, pli), rec, pli);
       if (!mbctx->use_haar_wavelet) {
-        od_apply_prefilter_frame_sbs(state->mctmp[pli], w, nhsb, nvsb, xdec,
-         ydec);
+        od_apply_prefilter_frame_sbs(state, state->mctmp[pli], w, nhsb, nvsb,
+         xdec, ydec);
       }
     }
   }
-  for (sby = 0; sby < nvsb; sby++) {
-    for (sbx = 0; sbx < nhsb; sbx++) {
-      for (pli = 0; pli < nplanes; pli++) {
-        od_coeff hgrad;
-        od_coeff vgrad;
-        hgrad = vgrad = 0;
-        mbctx->c = state->ctmp[pli];
-        mbctx->d = state->dtmp;
-        mbctx->mc = state->mctmp[pli];
-        mbctx->md = state->mdtmp[pli];
-        mbctx->l = state->lbuf[pli];
-        xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
-        ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
-        if (mbctx->is_keyframe) {
-          od_decode_haar_dc_sb(dec, mbctx, pli, sbx, sby, xdec, ydec,
-           sby > 0 && sbx < nhsb - 1, &hgrad, &vgrad);
-        }
-        od_decode_recursive(dec, mbctx, pli, sbx, sby, OD_NBSIZES - 1, xdec,
-         ydec, hgrad, vgrad);
-      }
-    }
-  }
-  for (pli = 0; pli < nplanes; pli++) {
-    xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
-    ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
-    w = frame_width >> xdec;
-    if (!mbctx->use_haar_wavelet) {
-      od_apply_postfilter_frame_sbs(state->ctmp[pli], w, nhsb, nvsb, xdec,
-       ydec, dec->state.coded_quantizer[pli], &dec->state.bskip[pli][0],
-       dec->state.skip_stride);
+  /*Decode the superblock rows, postfiltering each one as soon as the row
+     below it is available.
+    With a single thread, this decodes the whole frame before filtering.
+    Tiles are all decoded first, in parallel, unless streaming.*/
+  dec->jobs_mbctx = mbctx;
+  od_progress_reset(&dec->rows_output);
+  if (dec->tile_w > 0) od_dec_read_tile_offs(dec);
+  if (dec->streaming) od_dec_stream_decode(dec, mbctx);
+  else {
+    od_progress_reset(&dec->sb_rows_decoded);
+    if (dec->tile_w > 0) {
+      od_thread_pool_run(&dec->pool, od_dec_tile_job, dec,
+       od_dec_tile_njobs(dec));
+      od_progress_set(&dec->sb_rows_decoded, nvsb);
     }
+    od_thread_pool_run(&dec->pool, od_dec_decode_job, dec, 1 + nplanes);
   }
   nhdr = state->frame_width >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
   nvdr = state->frame_height >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
+  /*The deringing grid currently coincides with the superblock grid, which
+     lets each row job dering exactly the superblocks it outputs.*/
+  OD_ASSERT(nhdr == nhsb && nvdr == nvsb);
   if (dec->state.quantizer[0] > 0) {
-    for (pli = 0; pli < nplanes; pli++) {
-      int i;
-      int size;
-      xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
-      ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
-      size = nvsb*nhsb*OD_BSIZE_MAX*OD_BSIZE_MAX >> xdec >> ydec;
-      for (i = 0; i < size; i++) {
-        state->etmp[pli][i] = state->ctmp[pli][i];
-      }
-    }
-    for (sby = 0; sby < nvdr; sby++) {
-      for (sbx = 0; sbx < nhdr; sbx++) {
-        int filtered;
-        int c;
-        int up;
-        int left;
-        int i;
-        int j;
-        unsigned char *bskip;
-        state->dering_flags[sby*nhdr + sbx] = 0;
-        bskip = dec->state.bskip[0] +
-         (sby << OD_LOG_DERING_GRID)*dec->state.skip_stride +
-         (sbx << OD_LOG_DERING_GRID);
-        for (j = 0; j < 1 << OD_LOG_DERING_GRID; j++) {
-          for (i = 0; i < 1 << OD_LOG_DERING_GRID; i++) {
-            if (!bskip[j*dec->state.skip_stride + i]) {
-              state->dering_flags[sby*nhdr + sbx] = 1;
-            }
-          }
-        }
-        if (!state->dering_flags[sby*nhdr + sbx]) {
-          continue;
-        }
-        up = 0;
-        if (sby > 0) {
-          up = state->dering_flags[(sby - 1)*nhdr + sbx];
-        }
-        left = 0;
-        if (sbx > 0) {
-          left = state->dering_flags[sby*nhdr + (sbx - 1)];
-        }
-        c = (up << 1) + left;
-        filtered = od_decode_cdf_adapt(&dec->ec, state->adapt.clpf_cdf[c], 2,
-         state->adapt.clpf_increment, "clp");
-        state->dering_flags[sby*nhdr + sbx] = filtered;
-        if (filtered) {
-          for (pli = 0; pli < nplanes; pli++) {
-            int16_t buf[OD_BSIZE_MAX*OD_BSIZE_MAX];
-            od_coeff *output;
-            int ln;
-            int n;
-            int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS];
-            xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
-            ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
-            w = frame_width >> xdec;
-            ln = OD_LOG_DERING_GRID + OD_LOG_BSIZE0 - xdec;
-            n = 1 << ln;
-            OD_ASSERT(xdec == ydec);
-            /*buf is used for output so that we don't use filtered pixels in
-              the input to the filter, but because we look past block edges,
-              we do this anyway on the edge pixels. Unfortunately, this limits
-              potential parallelism.*/
-            od_dering(state, buf, n,
-             &state->etmp[pli][(sby << ln)*w +
-             (sbx << ln)], w, ln, sbx, sby, nhdr, nvdr,
-             dec->state.quantizer[pli], xdec, dir, pli, &dec->state.bskip[pli]
-             [(sby << (OD_LOG_DERING_GRID - ydec))*dec->state.skip_stride
-             + (sbx << (OD_LOG_DERING_GRID - xdec))], dec->state.skip_stride);
-            output = &state->ctmp[pli][(sby << ln)*w + (sbx << ln)];
-            for (y = 0; y < n; y++) {
-              for (x = 0; x < n; x++) {
-                output[y*w + x] = buf[y*n+ x];
-              }
-            }
-          }
-        }
-      }
-    }
+    od_dec_dering_flags(dec);
     if (dec->user_dering != NULL) {
       for (sby = 0; sby < nvdr; sby++) {
         for (sbx = 0; sbx < nhdr; sbx++) {
@@ -1134,78 +2296,84 @@ static void od_decode_coefficients(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
       OD_CLEAR(dec->user_dering, nhdr*nvdr);
     }
   }
-  for (pli = 0; pli < nplanes; pli++) {
-    xdec = dec->output_img[dec->curr_dec_frame].planes[pli].xdec;
-    ydec = dec->output_img[dec->curr_dec_frame].planes[pli].ydec;
-    w = frame_width >> xdec;
-    if (dec->state.quantizer[0] > 0) {
-      for (sby = 0; sby < nvsb; sby++) {
-        for (sbx = 0; sbx < nhsb; sbx++) {
-          if (mbctx->is_keyframe) {
-            od_smooth_recursive(state->ctmp[pli], dec->state.bsize,
-             dec->state.bstride, sbx, sby, OD_NBSIZES - 1, w, xdec, ydec,
-             OD_BLOCK_32X32, dec->state.quantizer[pli], pli);
-          }
-        }
-      }
-    }
-    /*Move/scale/shift reconstructed data values from transform
-      storage back into the SELF reference frame.*/
-    od_coeff_to_ref_plane(state, rec, pli,
-     state->ctmp[pli], OD_LOSSLESS(dec, pli));
+  if (!dec->streaming) {
+    od_thread_pool_run(&dec->pool, od_dec_filter_job, dec, nvsb);
   }
+  else if (dec->state.quantizer[0] > 0) od_dec_stream_output(dec, mbctx);
+  dec->jobs_mbctx = NULL;
 }
 
-int daala_decode_packet_in(daala_dec_ctx *dec, const daala_packet *op) {
-  int refi;
-  od_mb_dec_ctx mbctx;
-  od_img *ref_img;
-  int frame_type;
-  dec->curr_dec_output = -1;
-  if (dec == NULL || op == NULL) return OD_EFAULT;
-  if (dec->packet_state != OD_PACKET_DATA) return OD_EINVAL;
-  if (op->e_o_s) {
-    dec->packet_state = OD_PACKET_DONE;
-    dec->last_frame_decoded = 1;
-  }
-  ++dec->dec_order_count;
-  od_ec_dec_init(&dec->ec, op->packet, op->bytes);
-#if OD_ACCOUNTING
-  if (dec->acct_enabled) {
-    od_accounting_reset(&dec->acct);
-    dec->ec.acct = &dec->acct;
-  }
-  else dec->ec.acct = NULL;
-#endif
+/*Reads the flags at the start of a frame packet.*/
+static int od_dec_read_frame_header(od_dec_ctx *dec, od_mb_dec_ctx *mbctx,
+ int *frame_type) {
   OD_ACCOUNTING_SET_LOCATION(dec, OD_ACCT_FRAME, 0, 0, 0);
   /*Read the packet type bit.*/
   if (od_ec_decode_bool_q15(&dec->ec, 16384, "flags")) return OD_EBADPACKET;
-  dec->curr_dec_frame = od_state_push_output_buff_tail(&dec->state);
-  dec->out_imgs_id[dec->curr_dec_frame] = dec->dec_order_count;
-  mbctx.is_keyframe = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
-  if (mbctx.is_keyframe) frame_type = OD_I_FRAME;
+  dec->tile_w = dec->tile_h = 0;
+  dec->tile_data = NULL;
+  dec->tile_nbytes = 0;
+  if (od_ec_decode_bool_q15(&dec->ec, 16384, "flags")) {
+    const unsigned char *buf;
+    uint32_t nbytes;
+    uint32_t nhead;
+    int nhsb;
+    int nvsb;
+#if OD_ACCOUNTING
+    od_accounting_internal *acct;
+#endif
+    /*A tiled frame is followed by its tiles, and then by the size of
+       everything before the tiles, as a 32-bit little-endian value.
+      Restart the entropy decoder on just that part, so that the raw bits at
+       its end can be found.
+      The two flags read so far do not depend on the data after them.*/
+    buf = dec->ec.buf;
+    nbytes = (uint32_t)(dec->ec.end - buf);
+    if (nbytes < 4) return OD_EBADPACKET;
+    nbytes -= 4;
+    nhead = buf[nbytes] | (uint32_t)buf[nbytes + 1] << 8
+     | (uint32_t)buf[nbytes + 2] << 16 | (uint32_t)buf[nbytes + 3] << 24;
+    if (nhead > nbytes) return OD_EBADPACKET;
+    dec->tile_data = buf + nhead;
+    dec->tile_nbytes = nbytes - nhead;
+#if OD_ACCOUNTING
+    acct = dec->ec.acct;
+    if (acct != NULL) od_accounting_reset(acct);
+#endif
+    od_dec_ec_init(dec, &dec->ec, buf, nhead);
+#if OD_ACCOUNTING
+    dec->ec.acct = acct;
+#endif
+    OD_ACCOUNTING_SET_LOCATION(dec, OD_ACCT_FRAME, 0, 0, 0);
+    if (od_ec_decode_bool_q15(&dec->ec, 16384, "flags")
+     || !od_ec_decode_bool_q15(&dec->ec, 16384, "flags")) {
+      return OD_EBADPACKET;
+    }
+    nhsb = dec->state.nhsb;
+    nvsb = dec->state.nvsb;
+    dec->tile_w = 1 + (nhsb > 1 ? od_ec_dec_uint(&dec->ec, nhsb, "flags") : 0);
+    dec->tile_h = 1 + (nvsb > 1 ? od_ec_dec_uint(&dec->ec, nvsb, "flags") : 0);
+  }
+  mbctx->is_keyframe = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
+  if (mbctx->is_keyframe) *frame_type = OD_I_FRAME;
   else {
     if (od_ec_decode_bool_q15(&dec->ec, 16384, "flags")) {
-      frame_type = OD_B_FRAME;
+      *frame_type = OD_B_FRAME;
     }
     else {
-      frame_type = OD_P_FRAME;
+      *frame_type = OD_P_FRAME;
     }
   }
-  dec->state.frame_type = frame_type;
-  if (frame_type != OD_I_FRAME) {
-    mbctx.num_refs = od_ec_dec_uint(&dec->ec, OD_MAX_CODED_REFS, "flags") + 1;
+  if (*frame_type != OD_I_FRAME) {
+    mbctx->num_refs = od_ec_dec_uint(&dec->ec, OD_MAX_CODED_REFS, "flags") + 1;
   } else {
-    mbctx.num_refs = 0;
-  }
-  mbctx.use_activity_masking = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
-  mbctx.qm = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
-  /*TODO: Cache the previous qm value to avoid calling this every packet.*/
-  od_init_qm(dec->state.qm, dec->state.qm_inv,
-   mbctx.qm == OD_HVS_QM ? OD_QM8_Q4_HVS : OD_QM8_Q4_FLAT);
-  mbctx.use_haar_wavelet = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
-  mbctx.is_golden_frame = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
-  if (mbctx.is_keyframe) {
+    mbctx->num_refs = 0;
+  }
+  mbctx->use_activity_masking = od_ec_decode_bool_q15(&dec->ec, 16384,
+   "flags");
+  mbctx->qm = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
+  mbctx->use_haar_wavelet = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
+  mbctx->is_golden_frame = od_ec_decode_bool_q15(&dec->ec, 16384, "flags");
+  if (mbctx->is_keyframe) {
     int nplanes;
     int pli;
     nplanes = dec->state.info.nplanes;
@@ -1216,34 +2384,54 @@ int daala_decode_packet_in(daala_dec_ctx *dec, const daala_packet *op) {
       }
     }
   }
-  /*Update the reference buffer state.*/
+  return OD_SUCCESS;
+}
+
+/*Updates the reference frame indices before decoding a frame.*/
+static void od_dec_refs_begin(int *ref_imgi, int frame_type) {
   if (frame_type == OD_P_FRAME) {
-    dec->state.ref_imgi[OD_FRAME_PREV] = dec->state.ref_imgi[OD_FRAME_NEXT];
+    ref_imgi[OD_FRAME_PREV] = ref_imgi[OD_FRAME_NEXT];
   }
 #if OD_CLOSED_GOP
   if (frame_type == OD_I_FRAME) {
     int imgi;
     /*Mark all of the reference frames are not available.*/
-    for (imgi = 0; imgi < 4; imgi++) dec->state.ref_imgi[imgi] = -1;
+    for (imgi = 0; imgi < 4; imgi++) ref_imgi[imgi] = -1;
   }
 #endif
-  if (!mbctx.is_keyframe) {
-    /*If there have been no reference frames, and we need one,
-       initialize one.*/
-    if (dec->state.ref_imgi[OD_FRAME_GOLD] < 0 ||
-     dec->state.ref_imgi[OD_FRAME_PREV] < 0 ) {
-      od_dec_init_dummy_frame(dec);
+}
+
+/*Updates the reference frame indices after decoding a frame.*/
+static void od_dec_refs_end(int *ref_imgi, int frame_type,
+ int is_golden_frame) {
+  if (is_golden_frame) {
+    ref_imgi[OD_FRAME_GOLD] = ref_imgi[OD_FRAME_SELF];
+  }
+  /*B frames cannot be a reference frame.*/
+  if (frame_type != OD_B_FRAME) {
+    /*1st P frame in closed GOP or 1st P in the sequence with open GOP?*/
+    if (ref_imgi[OD_FRAME_PREV] < 0 && ref_imgi[OD_FRAME_NEXT] < 0) {
+      /*Only previous reference frame (i.e. I frame) is available.*/
+      ref_imgi[OD_FRAME_PREV] = ref_imgi[OD_FRAME_SELF];
+      ref_imgi[OD_FRAME_NEXT] = ref_imgi[OD_FRAME_SELF];
+    }
+    else {
+      /*Update two reference frames.*/
+      ref_imgi[OD_FRAME_PREV] = ref_imgi[OD_FRAME_NEXT];
+      ref_imgi[OD_FRAME_NEXT] = ref_imgi[OD_FRAME_SELF];
     }
   }
-  /*Select a free buffer to use for this reference frame.*/
-  for (refi = 0; refi == dec->state.ref_imgi[OD_FRAME_GOLD]
-   || refi == dec->state.ref_imgi[OD_FRAME_PREV]
-   || refi == dec->state.ref_imgi[OD_FRAME_NEXT]; refi++);
-  dec->state.ref_imgi[OD_FRAME_SELF] = refi;
-  od_adapt_ctx_reset(&dec->state.adapt, mbctx.is_keyframe);
-  if (!mbctx.is_keyframe) {
+}
+
+/*Decodes the rest of a frame packet into the SELF reference image.*/
+static void od_dec_decode_frame(od_dec_ctx *dec, od_mb_dec_ctx *mbctx) {
+  /*TODO: Cache the previous qm value to avoid calling this every packet.*/
+  od_init_qm(dec->state.qm, dec->state.qm_inv,
+   mbctx->qm == OD_HVS_QM ? OD_QM8_Q4_HVS : OD_QM8_Q4_FLAT);
+  od_adapt_ctx_reset(&dec->state.adapt, mbctx->is_keyframe);
+  if (!mbctx->is_keyframe) {
     int num_refs;
-    num_refs = mbctx.num_refs;
+    num_refs = mbctx->num_refs;
     od_dec_mv_unpack(dec, num_refs);
     od_state_mc_predict(&dec->state,
      dec->state.ref_imgs + dec->state.ref_imgi[OD_FRAME_SELF]);
@@ -1252,7 +2440,7 @@ int daala_decode_packet_in(daala_dec_ctx *dec, const daala_packet *op) {
        dec->state.ref_imgs + dec->state.ref_imgi[OD_FRAME_SELF]);
     }
   }
-  od_decode_coefficients(dec, &mbctx);
+  od_decode_coefficients(dec, mbctx);
   if (dec->user_bsize != NULL) {
     int j;
     int nhsb;
@@ -1264,37 +2452,252 @@ int daala_decode_packet_in(daala_dec_ctx *dec, const daala_packet *op) {
        &dec->state.bsize[dec->state.bstride*j], nhsb*OD_BSIZE_GRID);
     }
   }
-  ref_img = dec->state.ref_imgs + dec->state.ref_imgi[OD_FRAME_SELF];
-  od_img_copy(dec->output_img + dec->curr_dec_frame, ref_img);
-  OD_ASSERT(ref_img);
-  od_img_edge_ext(ref_img);
-  if (mbctx.is_golden_frame) {
-    dec->state.ref_imgi[OD_FRAME_GOLD] =
-     dec->state.ref_imgi[OD_FRAME_SELF];
+}
+
+/*Makes sure that dec has a tile worker for each column of tiles of the
+   frame whose header was just read into hdec, if it is streaming.*/
+static int od_dec_stream_tiles_reserve(od_dec_ctx *dec, od_dec_ctx *hdec) {
+  if (!dec->streaming || hdec->tile_w <= 0) return OD_SUCCESS;
+  return od_dec_tile_workers_reserve(dec,
+   (dec->state.nhsb + hdec->tile_w - 1)/hdec->tile_w);
+}
+
+/*Decodes a queued frame on a frame thread.*/
+static void od_dec_frame_job(void *ctx, int jobi) {
+  od_dec_frame *frame;
+  od_dec_ctx *dec;
+  od_mb_dec_ctx mbctx;
+  int frame_type;
+  int refi;
+  (void)jobi;
+  frame = (od_dec_frame *)ctx;
+  dec = frame->dec;
+  od_dec_ec_init(dec, &dec->ec, frame->packet, frame->nbytes);
+  /*The owner already read this header successfully.*/
+  OD_ALWAYS_TRUE(od_dec_read_frame_header(dec, &mbctx, &frame_type) == 0);
+  OD_ASSERT(frame_type == frame->frame_type);
+  dec->state.frame_type = frame_type;
+  for (refi = 0; refi <= OD_FRAME_MAX; refi++) {
+    if (frame->refs[refi] < 0) {
+      dec->state.ref_imgi[refi] = -1;
+      continue;
+    }
+    dec->state.ref_imgs[refi] = frame->owner->frame_imgs[frame->refs[refi]];
+    dec->state.ref_imgi[refi] = refi;
+    if (refi != OD_FRAME_SELF) {
+      od_progress_wait(frame->owner->frame_img_done + frame->refs[refi], 1);
+    }
   }
-  /*B frames cannot be a reference frame.*/
-  if (frame_type != OD_B_FRAME) {
-    /*1st P frame in closed GOP or 1st P in the sequence with open GOP?*/
-    if (dec->state.ref_imgi[OD_FRAME_PREV] < 0 &&
-     dec->state.ref_imgi[OD_FRAME_NEXT] < 0) {
-      /*Only previous reference frame (i.e. I frame) is available.*/
-      dec->state.ref_imgi[OD_FRAME_PREV] =
-       dec->state.ref_imgi[OD_FRAME_SELF];
-      dec->state.ref_imgi[OD_FRAME_NEXT] =
-       dec->state.ref_imgi[OD_FRAME_SELF];
+  od_dec_decode_frame(dec, &mbctx);
+  od_progress_set(frame->owner->frame_img_done + frame->refs[OD_FRAME_SELF],
+   1);
+}
+
+/*Returns the index of a pooled image that neither the current references
+   nor any queued frame uses.*/
+static int od_dec_find_free_img(od_dec_ctx *dec) {
+  int nimgs;
+  int imgi;
+  nimgs = dec->nframe_threads*(OD_FRAME_MAX + 1);
+  for (imgi = 0; imgi < nimgs; imgi++) {
+    int used;
+    int fi;
+    int refi;
+    used = imgi == dec->state.ref_imgi[OD_FRAME_GOLD]
+     || imgi == dec->state.ref_imgi[OD_FRAME_PREV]
+     || imgi == dec->state.ref_imgi[OD_FRAME_NEXT];
+    for (fi = 0; !used && fi < dec->nframes_queued; fi++) {
+      od_dec_frame *frame;
+      frame = dec->frames
+       + (dec->frame_head + fi) % dec->nframe_threads;
+      for (refi = 0; refi <= OD_FRAME_MAX; refi++) {
+        used |= imgi == frame->refs[refi];
+      }
     }
-    else {
-      /*Update two reference frames.*/
-      dec->state.ref_imgi[OD_FRAME_PREV] =
-       dec->state.ref_imgi[OD_FRAME_NEXT];
-      dec->state.ref_imgi[OD_FRAME_NEXT] =
-       dec->state.ref_imgi[OD_FRAME_SELF];
+    if (!used) return imgi;
+  }
+  /*See od_dec_frame_threads_init() for why this cannot happen.*/
+  OD_ASSERT(0);
+  return -1;
+}
+
+/*Waits for the oldest queued frame and moves it to the output buffer, as
+   daala_decode_packet_in() does after decoding a frame without frame
+   threads.*/
+static void od_dec_retire_frame(od_dec_ctx *dec) {
+  od_dec_frame *frame;
+  OD_ASSERT(dec->nframes_queued > 0 && !dec->frame_retired);
+  frame = dec->frames + dec->frame_head;
+  od_task_wait(&frame->task);
+  dec->curr_dec_output = -1;
+  dec->dec_order_count = frame->order;
+  if (frame->e_o_s) dec->last_frame_decoded = 1;
+  dec->curr_dec_frame = od_state_push_output_buff_tail(&dec->state);
+  dec->out_imgs_id[dec->curr_dec_frame] = dec->dec_order_count;
+  dec->state.frame_type = frame->frame_type;
+  od_img_copy(dec->output_img + dec->curr_dec_frame,
+   dec->frame_imgs + frame->refs[OD_FRAME_SELF]);
+  dec->frame_head = (dec->frame_head + 1) % dec->nframe_threads;
+  dec->nframes_queued--;
+  dec->frame_retired = 1;
+}
+
+/*Queues a packet for decoding on a frame thread.
+  All of the bookkeeping that later frames depend on (the frame header and
+   the reference indices) is done here, in order, so the frame threads only
+   need to wait for the pixels of their references.*/
+static int od_dec_submit_frame(od_dec_ctx *dec, const daala_packet *op) {
+  od_dec_frame *frame;
+  od_mb_dec_ctx mbctx;
+  int frame_type;
+  int refi;
+  int ret;
+  /*Making room for this frame moves the oldest one to the output buffer,
+     which needs the previous one to have been returned.*/
+  OD_RETURN_CHECK(dec->nframes_queued < dec->nframe_threads
+   || !dec->frame_retired, OD_EINVAL);
+  if (op->e_o_s) dec->packet_state = OD_PACKET_DONE;
+  ++dec->frames_submitted;
+  od_dec_ec_init(dec, &dec->ec, op->packet, op->bytes);
+  ret = od_dec_read_frame_header(dec, &mbctx, &frame_type);
+  if (ret < 0) return ret;
+  if (dec->nframes_queued == dec->nframe_threads) od_dec_retire_frame(dec);
+  frame = dec->frames
+   + (dec->frame_head + dec->nframes_queued) % dec->nframe_threads;
+  ret = od_dec_stream_tiles_reserve(frame->dec, dec);
+  if (ret < 0) return ret;
+  if ((size_t)op->bytes > frame->packet_sz) {
+    unsigned char *packet;
+    packet = (unsigned char *)realloc(frame->packet, op->bytes);
+    if (OD_UNLIKELY(packet == NULL)) return OD_EFAULT;
+    frame->packet = packet;
+    frame->packet_sz = op->bytes;
+  }
+  memcpy(frame->packet, op->packet, op->bytes);
+  frame->nbytes = op->bytes;
+  frame->order = dec->frames_submitted;
+  frame->frame_type = frame_type;
+  frame->e_o_s = op->e_o_s;
+  od_dec_refs_begin(dec->state.ref_imgi, frame_type);
+  if (!mbctx.is_keyframe) {
+    /*If there have been no reference frames, and we need one,
+       initialize one.*/
+    if (dec->state.ref_imgi[OD_FRAME_GOLD] < 0 ||
+     dec->state.ref_imgi[OD_FRAME_PREV] < 0) {
+      refi = od_dec_find_free_img(dec);
+      od_dec_blank_img(dec->frame_imgs + refi);
+      od_progress_set(dec->frame_img_done + refi, 1);
+      dec->state.ref_imgi[OD_FRAME_GOLD] = refi;
+      dec->state.ref_imgi[OD_FRAME_PREV] = refi;
     }
   }
+  refi = od_dec_find_free_img(dec);
+  od_progress_reset(dec->frame_img_done + refi);
+  dec->state.ref_imgi[OD_FRAME_SELF] = refi;
+  OD_COPY(frame->refs, dec->state.ref_imgi, OD_FRAME_MAX + 1);
+  /*Key frames carry the quantization matrices used by the frames after
+     them.*/
+  OD_COPY(&frame->dec->state.pvq_qm_q4[0][0], &dec->state.pvq_qm_q4[0][0],
+   OD_NPLANES_MAX*OD_QM_SIZE);
+  od_task_start(&frame->task, od_dec_frame_job, frame, 0);
+  dec->nframes_queued++;
+  od_dec_refs_end(dec->state.ref_imgi, frame_type, mbctx.is_golden_frame);
   return 0;
 }
 
-int daala_decode_img_out(daala_dec_ctx *dec, od_img *img) {
+static int od_dec_packet_in(daala_dec_ctx *dec, const daala_packet *op) {
+  int refi;
+  od_mb_dec_ctx mbctx;
+  od_img *ref_img;
+  const unsigned char *pending;
+  int frame_type;
+  int ret;
+  dec->curr_dec_output = -1;
+  if (dec == NULL || op == NULL) return OD_EFAULT;
+  if (dec->packet_state != OD_PACKET_DATA) return OD_EINVAL;
+  if (dec->nframe_threads > 1) return od_dec_submit_frame(dec, op);
+  if (op->e_o_s) {
+    dec->packet_state = OD_PACKET_DONE;
+    dec->last_frame_decoded = 1;
+  }
+  ++dec->dec_order_count;
+  od_dec_ec_init(dec, &dec->ec, op->packet, op->bytes);
+#if OD_ACCOUNTING
+  if (dec->acct_enabled) {
+    od_accounting_reset(&dec->acct);
+    dec->ec.acct = &dec->acct;
+  }
+  else dec->ec.acct = NULL;
+#endif
+  ret = od_dec_read_frame_header(dec, &mbctx, &frame_type);
+  if (ret < 0) return ret;
+  ret = od_dec_stream_tiles_reserve(dec, dec);
+  if (ret < 0) return ret;
+  dec->curr_dec_frame = od_state_push_output_buff_tail(&dec->state);
+  dec->out_imgs_id[dec->curr_dec_frame] = dec->dec_order_count;
+  dec->state.frame_type = frame_type;
+  /*Update the reference buffer state.*/
+  od_dec_refs_begin(dec->state.ref_imgi, frame_type);
+  if (!mbctx.is_keyframe) {
+    /*If there have been no reference frames, and we need one,
+       initialize one.*/
+    if (dec->state.ref_imgi[OD_FRAME_GOLD] < 0 ||
+     dec->state.ref_imgi[OD_FRAME_PREV] < 0 ) {
+      od_dec_init_dummy_frame(dec);
+    }
+  }
+  /*When the output images are the reference images, the frame still waiting
+     to be output must not be overwritten either.
+    It is always PREV or NEXT, unless an I frame dropped all of the
+     references, so a buffer is always free.*/
+  pending = NULL;
+  if (dec->output_refs && dec->state.frames_in_out_buff == 2) {
+    pending = dec->output_img[dec->curr_dec_frame ^ 1].planes[0].data;
+  }
+  /*Select a free buffer to use for this reference frame.*/
+  for (refi = 0; refi == dec->state.ref_imgi[OD_FRAME_GOLD]
+   || refi == dec->state.ref_imgi[OD_FRAME_PREV]
+   || refi == dec->state.ref_imgi[OD_FRAME_NEXT]
+   || dec->state.ref_imgs[refi].planes[0].data == pending; refi++);
+  OD_ASSERT(refi <= OD_FRAME_MAX);
+  dec->state.ref_imgi[OD_FRAME_SELF] = refi;
+  if (dec->frame_pool) {
+    ret = od_dec_frame_pool_begin(dec);
+    if (OD_UNLIKELY(ret < 0)) {
+      /*Drop the frame, much as if the packet had been lost.*/
+      od_state_pop_output_buff_tail(&dec->state);
+      return ret;
+    }
+  }
+  else if (dec->output_refs) {
+    od_img *out;
+    out = dec->output_img + dec->curr_dec_frame;
+    *out = dec->state.ref_imgs[refi];
+    out->width = dec->state.info.pic_width;
+    out->height = dec->state.info.pic_height;
+  }
+  od_dec_decode_frame(dec, &mbctx);
+  ref_img = dec->state.ref_imgs + dec->state.ref_imgi[OD_FRAME_SELF];
+  /*The row callback already copied each row as it was reported, and frames
+     decoded into the pool or output from the references are output as they
+     are.*/
+  if (dec->row_cb.func == NULL && !dec->frame_pool_refs
+   && !dec->output_refs) {
+    od_img_copy(dec->output_img + dec->curr_dec_frame, ref_img);
+  }
+  OD_ASSERT(ref_img);
+  od_dec_refs_end(dec->state.ref_imgi, frame_type, mbctx.is_golden_frame);
+  return 0;
+}
+
+int daala_decode_packet_in(daala_dec_ctx *dec, const daala_packet *op) {
+  int ret;
+  ret = od_dec_packet_in(dec, op);
+  if (dec != NULL) od_dec_update_peak_bytes(dec);
+  return ret;
+}
+
+static int od_dec_img_out(daala_dec_ctx *dec, od_img *img) {
   int frame_ready;
   int frame_type;
   if (dec == NULL || img == NULL) return OD_EFAULT;
@@ -1324,3 +2727,24 @@ int daala_decode_img_out(daala_dec_ctx *dec, od_img *img) {
   }
   return frame_ready;
 }
+
+int daala_decode_img_out(daala_dec_ctx *dec, od_img *img) {
+  if (dec == NULL || img == NULL) return OD_EFAULT;
+  if (dec->nframe_threads > 1) {
+    /*Replay the calls that would have been made without frame threads: one
+       after each retired frame, and then as many as needed once the last
+       frame has been retired.*/
+    for (;;) {
+      if (dec->frame_retired) {
+        dec->frame_retired = 0;
+        if (od_dec_img_out(dec, img)) return 1;
+      }
+      if (dec->nframes_queued == 0) break;
+      /*Until the end of the stream, frames are only retired to make room for
+         new ones.*/
+      if (dec->packet_state != OD_PACKET_DONE) return 0;
+      od_dec_retire_frame(dec);
+    }
+  }
+  return od_dec_img_out(dec, img);
+}
@@ -30,12 +30,18 @@ typedef struct od_params_ctx od_params_ctx;
 typedef struct od_mv_est_ctx od_mv_est_ctx;
 typedef struct od_enc_opt_vtbl od_enc_opt_vtbl;
 typedef struct od_rollback_buffer od_rollback_buffer;
+typedef struct od_enc_worker od_enc_worker;
+typedef struct od_enc_frame_plan od_enc_frame_plan;
 
 # include "../include/daala/daaladec.h"
 # include "../include/daala/daalaenc.h"
 # include "state.h"
 # include "entenc.h"
 # include "block_size_enc.h"
+# include "thread.h"
+# include "ratecontrol.h"
+# include "lookahead.h"
+# include "srcanalysis.h"
 
 /*Constants for the packet state machine specific to the encoder.*/
 /*No packet currently ready to output.*/
@@ -58,6 +64,14 @@ typedef struct od_rollback_buffer od_rollback_buffer;
    refinement.*/
 # define OD_MC_SQUARE_SUBPEL_REFINEMENT_COMPLEXITY (10)
 
+/*The number of input frames the encoder can buffer: the frame being coded,
+   the B frames before it and the lookahead.*/
+# define OD_MAX_INPUT_FRAMES (1 + OD_MAX_B_FRAMES + OD_MAX_LOOKAHEAD)
+
+/*Adds pulses to y until it has k of them (see od_pvq_search_pulses_c()).*/
+typedef void (*od_pvq_search_pulses_func)(od_coeff *y, int32_t *xy,
+ int32_t *yy, const int16_t *x, int n, int i, int k);
+
 struct od_enc_opt_vtbl {
   int32_t (*mc_compute_sad_4x4)(const unsigned char *src,
    int systride, const unsigned char *ref, int dystride);
@@ -79,6 +93,7 @@ struct od_enc_opt_vtbl {
    int systride, const unsigned char *ref, int dystride);
   int32_t (*mc_compute_satd_64x64)(const unsigned char *src,
    int systride, const unsigned char *ref, int dystride);
+  od_pvq_search_pulses_func pvq_search_pulses;
 };
 
 /*Unsanitized user parameters*/
@@ -89,11 +104,28 @@ struct od_params_ctx {
   int mv_level_max;
 };
 
+/*The decisions about the next frame that do not depend on its quality, made
+   once by an encoder and shared with the encoders of its ladder.*/
+struct od_enc_frame_plan {
+  int frame_type;
+  int is_golden_frame;
+  /*The number of frames until the next keyframe, for the rate control.*/
+  int frames_to_key;
+  int duration;
+  /*The reference buffers of the frame, and the one it is coded into.*/
+  int ref_imgi[OD_FRAME_MAX + 1];
+  /*The analysis of the source of the frame, or NULL when the encoder has no
+     ladder.*/
+  const od_src_analysis *src;
+};
+
 struct daala_enc_ctx{
   od_state state;
   od_enc_opt_vtbl opt_vtbl;
   oggbyte_buffer obb;
   od_ec_enc ec;
+  /** The log of changes to state.adapt, used to roll back RDO decisions. */
+  od_ec_log adapt_log;
   int packet_state;
   int quality[OD_NPLANES_MAX];
   int complexity;
@@ -105,6 +137,7 @@ struct daala_enc_ctx{
   int b_frames;
   od_mv_est_ctx *mvest;
   od_params_ctx params;
+  od_rc_state rc;
 #if defined(OD_ENCODER_CHECK)
   struct daala_dec_ctx *dec;
 #endif
@@ -125,8 +158,35 @@ struct daala_enc_ctx{
   od_coeff block_mc_orig[OD_BSIZE_MAX*OD_BSIZE_MAX];
   od_coeff block_c_noskip[OD_BSIZE_MAX*OD_BSIZE_MAX];
   /* Buffer for the input frame, scaled to reference resolution. */
-  od_img input_img[1 + OD_MAX_B_FRAMES];
+  od_img input_img[OD_MAX_INPUT_FRAMES];
   unsigned char *input_img_data;
+  /** The number of frames buffered for the lookahead beyond the B frames,
+      set with OD_SET_LOOKAHEAD. */
+  int lookahead;
+  /** The frame type decisions, if the lookahead is enabled. */
+  od_lookahead *la;
+  /** The input frames buffered for the lookahead. */
+  unsigned char *lookahead_img_data;
+  /** The function that gives input images used in place back to the
+      application, set with OD_SET_INPUT_RELEASE. */
+  daala_img_release input_release;
+  /** The encoders that code the same input at their own quality, set with
+      OD_SET_LADDER, and the thread that codes each of their frames. */
+  od_enc_ctx **ladder;
+  od_task *ladder_tasks;
+  int nladder;
+  /** The encoder this one is a rung of the ladder of, if any. */
+  od_enc_ctx *ladder_leader;
+  /** The analysis of the source shared with the ladder. */
+  od_src_analysis *src;
+  /** The decisions about the frame being coded. */
+  od_enc_frame_plan plan;
+  /** For each input buffer, whether it holds an image of the application,
+      the image as it was submitted, and the encoder's own image that it
+      replaces until it is released. */
+  int input_lent[OD_MAX_INPUT_FRAMES];
+  od_img input_lent_img[OD_MAX_INPUT_FRAMES];
+  od_img input_own_img[OD_MAX_INPUT_FRAMES];
   /** Frame delay. */
   int frame_delay;
   /** Frame counter in encoding order. */
@@ -144,9 +204,30 @@ struct daala_enc_ctx{
   /** # of frames left in buffer to encode. */
   int frames_in_buff;
   /** Keep the display order of frames in input image buffer. */
-  int in_imgs_id[1 + OD_MAX_B_FRAMES];
+  int in_imgs_id[OD_MAX_INPUT_FRAMES];
   /** Number of I or P frames encoded so far, starting from zero. */
   unsigned int ip_frame_count;
+  /** Worker threads, set with OD_SET_THREADS. */
+  od_thread_pool pool;
+  /** The size of the tiles in superblocks, or 0 to code each frame as a
+      single tile. Set with OD_SET_TILES. */
+  int tile_w;
+  int tile_h;
+  /** The entropy coder of each tile. */
+  od_ec_enc *tile_ecs;
+  /** The coded data of each tile of the current frame. */
+  unsigned char **tile_data;
+  uint32_t *tile_nbytes;
+  /** Buffer for assembling the packet of a tiled frame. */
+  unsigned char *tile_packet;
+  size_t tile_packet_sz;
+  /** The private state of each thread of the pool. */
+  od_enc_worker *workers;
+  int nworkers;
+  /** The macroblock context and mode of the frame being coded, for the tile
+      jobs. */
+  struct od_mb_enc_ctx *jobs_mbctx;
+  int jobs_rdo_only;
 #if defined(OD_DUMP_IMAGES) || defined(OD_DUMP_RECONS)
   unsigned char *output_img_data;
   /** Output images buffer, used as circular queue. */
@@ -174,19 +255,50 @@ struct daala_enc_ctx{
 #endif
 };
 
+/*The private state of one thread of the encoder's pool.
+  enc is a shallow copy of the encoder made by od_enc_worker_begin() at the
+   start of each batch of jobs.
+  The frame buffers and the MV grid are shared, since each job only writes
+   to its own part of them, but the entropy coder, the adaptation state and
+   the scratch buffers are private.*/
+struct od_enc_worker {
+  od_enc_ctx enc;
+  /*A copy of the motion estimation context, with its own hit cache.*/
+  od_mv_est_ctx *mvest;
+  od_coeff *lbuf[OD_NPLANES_MAX];
+  unsigned char *mc_buf_data;
+  od_ec_log adapt_log;
+};
+
 /** Holds important encoder information so we can roll back decisions */
 struct od_rollback_buffer {
   od_ec_enc ec;
-  od_adapt_ctx adapt;
+  /*The length of the adaptation log at the checkpoint.*/
+  int log_pos;
+  /*The redo entries to apply after undoing back to log_pos.*/
+  int redo_start;
+  int redo_end;
 };
 
 void od_encode_checkpoint(const daala_enc_ctx *enc, od_rollback_buffer *rbuf);
 void od_encode_rollback(daala_enc_ctx *enc, const od_rollback_buffer *rbuf);
+void od_encode_rollback_redo(daala_enc_ctx *enc,
+ const od_rollback_buffer *rbuf, od_rollback_buffer *redo);
+int od_enc_pool_njobs(const od_enc_ctx *enc, int nitems);
+od_enc_ctx *od_enc_worker_begin(od_enc_ctx *enc, int workeri);
 
 od_mv_est_ctx *od_mv_est_alloc(od_enc_ctx *enc);
 void od_mv_est_free(od_mv_est_ctx *est);
 void od_mv_est(od_mv_est_ctx *est, int lambda);
 
+/*The shifts that reduce (xy + x[j]) to 15 bits and yy + 2*y[j] + 1 to 16
+   bits in the greedy PVQ search, after i pulses have been placed.*/
+# define OD_PVQ_SEARCH_NUM_SHIFT(i) (OD_MAXI(0, OD_ILOG((i) + 1) - 1))
+# define OD_PVQ_SEARCH_DEN_SHIFT(i) (OD_MAXI(0, 2*OD_ILOG((i) + 1) - 16))
+
+void od_pvq_search_pulses_c(od_coeff *y, int32_t *xy, int32_t *yy,
+ const int16_t *x, int n, int i, int k);
+
 int32_t od_mc_compute_sad8_4x4_c(const unsigned char *src, int systride,
  const unsigned char *ref, int dystride);
 int32_t od_mc_compute_sad8_8x8_c(const unsigned char *src, int systride,
@@ -59,6 +59,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #define OD_GOLDEN_FRAME_INTERVAL 10
 
+/*The finest motion vector level searched in the first pass of a two-pass
+   encode.*/
+#define OD_FIRST_PASS_MV_LEVEL_MAX (2)
+
+/*The padding of the input images that is filled in.
+  Only od_split_superblock() looks outside of the frame, by 2*OD_MAX_OVERLAP
+   pixels, but the visualization and the logging read all of the padding.*/
+#if defined(OD_DUMP_IMAGES) || defined(OD_LOGGING_ENABLED)
+# define OD_INPUT_EDGE_EXT (OD_BUFFER_PADDING)
+#else
+# define OD_INPUT_EDGE_EXT (OD_INPUT_PADDING)
+#endif
+
 static const unsigned char OD_LUMA_QM_Q4[2][OD_QM_SIZE] = {
 /* Flat quantization for PSNR. The DC component isn't 16 because the DC
    magnitude compensation is done here for inter (Haar DC doesn't need it).
@@ -189,6 +202,7 @@ void od_enc_opt_vtbl_init_c(od_enc_ctx *enc) {
     enc->opt_vtbl.mc_compute_satd_64x64 =
       od_mc_compute_satd8_64x64_c;
   }
+  enc->opt_vtbl.pvq_search_pulses = od_pvq_search_pulses_c;
 }
 
 static void od_enc_opt_vtbl_init(od_enc_ctx *enc) {
@@ -199,6 +213,136 @@ static void od_enc_opt_vtbl_init(od_enc_ctx *enc) {
 #endif
 }
 
+static void od_enc_worker_clear(od_enc_worker *worker) {
+  int pli;
+  for (pli = 0; pli < OD_NPLANES_MAX; pli++) free(worker->lbuf[pli]);
+  od_aligned_free(worker->mc_buf_data);
+  free(worker->mvest);
+  od_ec_log_clear(&worker->adapt_log);
+}
+
+static void od_enc_workers_clear(od_enc_ctx *enc) {
+  int i;
+  for (i = 0; i < enc->nworkers; i++) od_enc_worker_clear(enc->workers + i);
+  free(enc->workers);
+  enc->workers = NULL;
+  enc->nworkers = 0;
+}
+
+/*Makes sure there are at least nworkers workers.
+  On failure, the existing ones are kept, so encoding can continue with
+   fewer threads.*/
+static int od_enc_workers_reserve(od_enc_ctx *enc, int nworkers) {
+  od_enc_worker *workers;
+  int reference_bytes;
+  if (nworkers <= enc->nworkers) return OD_SUCCESS;
+  workers = (od_enc_worker *)realloc(enc->workers,
+   nworkers*sizeof(*workers));
+  if (OD_UNLIKELY(workers == NULL)) return OD_EFAULT;
+  enc->workers = workers;
+  reference_bytes = enc->state.full_precision_references ? 2 : 1;
+  while (enc->nworkers < nworkers) {
+    od_enc_worker *worker;
+    int pli;
+    int fail;
+    worker = workers + enc->nworkers;
+    OD_CLEAR(worker->lbuf, OD_NPLANES_MAX);
+    od_ec_log_init(&worker->adapt_log);
+    fail = 0;
+    for (pli = 1; pli < enc->state.info.nplanes; pli++) {
+      worker->lbuf[pli] = (od_coeff *)malloc(OD_BSIZE_MAX*OD_BSIZE_MAX*
+       sizeof(*worker->lbuf[pli]));
+      fail |= worker->lbuf[pli] == NULL;
+    }
+    worker->mc_buf_data = (unsigned char *)od_aligned_malloc(
+     OD_MC_BUFS_SIZE(reference_bytes), 32);
+    worker->mvest = (od_mv_est_ctx *)malloc(sizeof(*worker->mvest));
+    if (OD_UNLIKELY(fail || worker->mc_buf_data == NULL
+     || worker->mvest == NULL)) {
+      od_enc_worker_clear(worker);
+      return OD_EFAULT;
+    }
+    enc->nworkers++;
+  }
+  return OD_SUCCESS;
+}
+
+/*Returns the number of jobs to split nitems independent items between.*/
+int od_enc_pool_njobs(const od_enc_ctx *enc, int nitems) {
+  return OD_MINI(OD_MINI(enc->pool.nthreads, enc->nworkers), nitems);
+}
+
+/*Makes worker workeri a copy of the encoder that can run concurrently with
+   the other workers, and returns it.*/
+od_enc_ctx *od_enc_worker_begin(od_enc_ctx *enc, int workeri) {
+  od_enc_worker *worker;
+  od_enc_ctx *wenc;
+  int reference_bytes;
+  int pli;
+  worker = enc->workers + workeri;
+  wenc = &worker->enc;
+  *wenc = *enc;
+  for (pli = 0; pli < OD_NPLANES_MAX; pli++) {
+    wenc->state.lbuf[pli] = worker->lbuf[pli];
+  }
+  reference_bytes = enc->state.full_precision_references ? 2 : 1;
+  od_state_set_mc_bufs(&wenc->state, worker->mc_buf_data, reference_bytes);
+  wenc->ec.log = &worker->adapt_log;
+  return wenc;
+}
+
+static void od_enc_tiles_clear(od_enc_ctx *enc) {
+  int ntiles;
+  int tilei;
+  ntiles = od_state_ntiles(&enc->state, enc->tile_w, enc->tile_h);
+  if (enc->tile_ecs != NULL) {
+    for (tilei = 0; tilei < ntiles; tilei++) {
+      od_ec_enc_clear(enc->tile_ecs + tilei);
+    }
+  }
+  free(enc->tile_ecs);
+  free(enc->tile_data);
+  free(enc->tile_nbytes);
+  enc->tile_ecs = NULL;
+  enc->tile_data = NULL;
+  enc->tile_nbytes = NULL;
+  enc->tile_w = enc->tile_h = 0;
+}
+
+/*Splits the following frames into tiles of tile_w by tile_h superblocks.*/
+static int od_enc_tiles_init(od_enc_ctx *enc, int tile_w, int tile_h) {
+  int ntiles;
+  int tilei;
+  od_enc_tiles_clear(enc);
+  ntiles = od_state_ntiles(&enc->state, tile_w, tile_h);
+  if (ntiles <= 1) return OD_SUCCESS;
+  enc->tile_ecs = (od_ec_enc *)malloc(ntiles*sizeof(*enc->tile_ecs));
+  enc->tile_data = (unsigned char **)malloc(ntiles*sizeof(*enc->tile_data));
+  enc->tile_nbytes = (uint32_t *)malloc(ntiles*sizeof(*enc->tile_nbytes));
+  if (OD_UNLIKELY(enc->tile_ecs == NULL || enc->tile_data == NULL
+   || enc->tile_nbytes == NULL)) {
+    free(enc->tile_ecs);
+    enc->tile_ecs = NULL;
+    od_enc_tiles_clear(enc);
+    return OD_EFAULT;
+  }
+  for (tilei = 0; tilei < ntiles; tilei++) {
+    od_ec_enc_init(enc->tile_ecs + tilei, 4096);
+    if (OD_UNLIKELY(enc->tile_ecs[tilei].error)) {
+      do od_ec_enc_clear(enc->tile_ecs + tilei);
+      while (tilei-- > 0);
+      free(enc->tile_ecs);
+      enc->tile_ecs = NULL;
+      od_enc_tiles_clear(enc);
+      return OD_EFAULT;
+    }
+    enc->tile_ecs[tilei].cdf_adapt = enc->state.opt_vtbl.cdf_adapt;
+  }
+  enc->tile_w = tile_w;
+  enc->tile_h = tile_h;
+  return OD_SUCCESS;
+}
+
 static int od_enc_init(od_enc_ctx *enc, const daala_info *info) {
   int i;
   int pli;
@@ -224,12 +368,15 @@ static int od_enc_init(od_enc_ctx *enc, const daala_info *info) {
   char dist_fname[1024];
   const char *suf;
 #endif
-  ret = od_state_init(&enc->state, info);
+  ret = od_state_init(&enc->state, info, OD_BUFFER_PADDING);
   if (ret < 0) return ret;
   enc->use_satd = 0;
   od_enc_opt_vtbl_init(enc);
   oggbyte_writeinit(&enc->obb);
   od_ec_enc_init(&enc->ec, 65025);
+  enc->ec.cdf_adapt = enc->state.opt_vtbl.cdf_adapt;
+  od_ec_log_init(&enc->adapt_log);
+  enc->ec.log = &enc->adapt_log;
   enc->packet_state = OD_PACKET_INFO_HDR;
   for (i = 0; i < OD_NPLANES_MAX; i++){
     enc->quality[i] = 10;
@@ -248,6 +395,21 @@ static int od_enc_init(od_enc_ctx *enc, const daala_info *info) {
   enc->params.mv_level_max = 4;
   enc->bs = (od_block_size_comp *)malloc(sizeof(*enc->bs));
   enc->b_frames = 0;
+  od_rc_init(&enc->rc, info);
+  enc->tile_w = enc->tile_h = 0;
+  enc->tile_ecs = NULL;
+  enc->tile_data = NULL;
+  enc->tile_nbytes = NULL;
+  enc->tile_packet = NULL;
+  enc->tile_packet_sz = 0;
+  enc->workers = NULL;
+  enc->nworkers = 0;
+  enc->jobs_mbctx = NULL;
+  ret = od_thread_pool_init(&enc->pool, 1);
+  if (OD_UNLIKELY(ret < 0)) return ret;
+  if (OD_UNLIKELY(od_enc_workers_reserve(enc, 1) < 0)) {
+    return OD_EFAULT;
+  }
   data_sz = 0;
   reference_bytes = enc->state.full_precision_references ? 2 : 1;
   reference_bits =
@@ -388,9 +550,21 @@ static int od_enc_init(od_enc_ctx *enc, const daala_info *info) {
   enc->enc_order_count = 0;
   enc->display_order_count = 0;
   enc->ip_frame_count = 0;
-  for (i = 0; i < 1 + OD_MAX_B_FRAMES; i++) {
+  for (i = 0; i < OD_MAX_INPUT_FRAMES; i++) {
     enc->in_imgs_id[i] = -1;
-  }
+    enc->input_lent[i] = 0;
+  }
+  enc->input_release.func = NULL;
+  enc->input_release.ctx = NULL;
+  enc->ladder = NULL;
+  enc->ladder_tasks = NULL;
+  enc->nladder = 0;
+  enc->ladder_leader = NULL;
+  enc->src = NULL;
+  OD_ASSERT(2*OD_MAX_OVERLAP <= OD_INPUT_PADDING);
+  enc->lookahead = 0;
+  enc->la = NULL;
+  enc->lookahead_img_data = NULL;
 #if defined(OD_ENCODER_CHECK)
   enc->dec = daala_decode_create(info, NULL);
 #endif
@@ -414,11 +588,162 @@ static int od_enc_init(od_enc_ctx *enc, const daala_info *info) {
   return 0;
 }
 
+/*Gives an input image used in place back to the application, and puts the
+   encoder's own image back in its buffer.*/
+static void od_enc_release_input(od_enc_ctx *enc, int imgi) {
+  if (!enc->input_lent[imgi]) return;
+  enc->input_img[imgi] = enc->input_own_img[imgi];
+  enc->input_lent[imgi] = 0;
+  (*enc->input_release.func)(enc->input_release.ctx,
+   enc->input_lent_img + imgi);
+}
+
+/*Returns whether two encoders take images of the same size and format.*/
+static int od_enc_same_input(const od_enc_ctx *enc, const od_enc_ctx *other) {
+  int pli;
+  if (enc->state.info.pic_width != other->state.info.pic_width
+   || enc->state.info.pic_height != other->state.info.pic_height
+   || enc->state.info.nplanes != other->state.info.nplanes) {
+    return 0;
+  }
+  for (pli = 0; pli < enc->state.info.nplanes; pli++) {
+    const od_img_plane *iplane;
+    const od_img_plane *oplane;
+    iplane = enc->input_img[0].planes + pli;
+    oplane = other->input_img[0].planes + pli;
+    if (iplane->xdec != oplane->xdec || iplane->ydec != oplane->ydec
+     || iplane->xstride != oplane->xstride
+     || iplane->bitdepth != oplane->bitdepth) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void od_enc_ladder_clear(od_enc_ctx *enc) {
+  int i;
+  for (i = 0; i < enc->nladder; i++) enc->ladder[i]->ladder_leader = NULL;
+  if (enc->ladder_tasks != NULL) {
+    for (i = 0; i < enc->nladder; i++) od_task_clear(enc->ladder_tasks + i);
+    free(enc->ladder_tasks);
+    enc->ladder_tasks = NULL;
+  }
+  free(enc->ladder);
+  enc->ladder = NULL;
+  enc->nladder = 0;
+}
+
+/*Takes a rung that is being freed out of the ladder.*/
+static void od_enc_ladder_remove(od_enc_ctx *enc, od_enc_ctx *rung) {
+  int i;
+  for (i = 0; enc->ladder[i] != rung; i++);
+  for (; i < enc->nladder - 1; i++) enc->ladder[i] = enc->ladder[i + 1];
+  enc->nladder--;
+  if (enc->ladder_tasks != NULL) {
+    od_task_clear(enc->ladder_tasks + enc->nladder);
+  }
+}
+
+static int od_enc_set_ladder(od_enc_ctx *enc, od_enc_ctx *const *ladder,
+ int nladder) {
+  od_enc_ctx **rungs;
+  int i;
+  int j;
+  if (enc->display_order_count != 0 || enc->ladder_leader != NULL) {
+    return OD_EINVAL;
+  }
+  for (i = 0; i < nladder; i++) {
+    od_enc_ctx *rung;
+    rung = ladder[i];
+    if (rung == NULL) return OD_EFAULT;
+    if (rung == enc || rung->nladder > 0 || rung->display_order_count != 0
+     || (rung->ladder_leader != NULL && rung->ladder_leader != enc)
+     || !od_enc_same_input(enc, rung)) {
+      return OD_EINVAL;
+    }
+    for (j = 0; j < i; j++) if (ladder[j] == rung) return OD_EINVAL;
+  }
+  rungs = NULL;
+  if (nladder > 0) {
+    rungs = (od_enc_ctx **)malloc(nladder*sizeof(*rungs));
+    if (OD_UNLIKELY(rungs == NULL)) return OD_EFAULT;
+  }
+  od_enc_ladder_clear(enc);
+  for (i = 0; i < nladder; i++) {
+    rungs[i] = ladder[i];
+    rungs[i]->ladder_leader = enc;
+  }
+  enc->ladder = rungs;
+  enc->nladder = nladder;
+  return OD_SUCCESS;
+}
+
+/*Starts a thread for each rung of the ladder, if the encoder may use more
+   than one.
+  On failure, the rungs are coded in turn by the calling thread.*/
+static void od_enc_ladder_tasks_init(od_enc_ctx *enc) {
+  od_task *tasks;
+  int i;
+  if (enc->pool.nthreads <= 1) return;
+  tasks = (od_task *)malloc(enc->nladder*sizeof(*tasks));
+  if (OD_UNLIKELY(tasks == NULL)) return;
+  for (i = 0; i < enc->nladder; i++) {
+    if (OD_UNLIKELY(od_task_init(tasks + i) < 0)) {
+      while (i-- > 0) od_task_clear(tasks + i);
+      free(tasks);
+      return;
+    }
+  }
+  enc->ladder_tasks = tasks;
+}
+
+/*Sets up the analysis of the source shared with the ladder.*/
+static int od_enc_src_analysis_init(od_enc_ctx *enc) {
+  int use_psy;
+  int i;
+  /*Only the open-loop block size decision uses the psy model statistics.*/
+  use_psy = enc->complexity < 2;
+  for (i = 0; i < enc->nladder; i++) {
+    use_psy |= enc->ladder[i]->complexity < 2;
+  }
+  enc->src = (od_src_analysis *)malloc(sizeof(*enc->src));
+  if (OD_UNLIKELY(enc->src == NULL)) return OD_EFAULT;
+  if (OD_UNLIKELY(od_src_analysis_init(enc->src, &enc->state, use_psy) < 0)) {
+    free(enc->src);
+    enc->src = NULL;
+    return OD_EFAULT;
+  }
+  return OD_SUCCESS;
+}
+
 static void od_enc_clear(od_enc_ctx *enc) {
+  int imgi;
+  if (enc->ladder_leader != NULL) {
+    od_enc_ladder_remove(enc->ladder_leader, enc);
+  }
+  od_enc_ladder_clear(enc);
+  for (imgi = 0; imgi < OD_MAX_INPUT_FRAMES; imgi++) {
+    od_enc_release_input(enc, imgi);
+  }
+  od_rc_clear(&enc->rc);
+  od_enc_tiles_clear(enc);
+  od_enc_workers_clear(enc);
+  od_thread_pool_clear(&enc->pool);
+  free(enc->tile_packet);
   od_mv_est_free(enc->mvest);
   od_ec_enc_clear(&enc->ec);
+  od_ec_log_clear(&enc->adapt_log);
   oggbyte_writeclear(&enc->obb);
   od_aligned_free(enc->input_img_data);
+  if (enc->la != NULL) {
+    od_lookahead_clear(enc->la);
+    free(enc->la);
+  }
+  od_aligned_free(enc->lookahead_img_data);
+  if (enc->src != NULL) {
+    od_src_analysis_clear(enc->src);
+    free(enc->src);
+  }
 #if defined(OD_DUMP_IMAGES) || defined(OD_DUMP_RECONS)
   od_aligned_free(enc->output_img_data);
 #endif
@@ -593,18 +918,168 @@ int daala_encode_ctl(daala_enc_ctx *enc, int req, void *buf, size_t buf_sz) {
       enc->b_frames = b_frames;
       return OD_SUCCESS;
     }
+    case OD_SET_TILES: {
+      const int *tiles;
+      int tile_w;
+      int tile_h;
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == 2*sizeof(*tiles), OD_EINVAL);
+      /*The packet of the last frame has not been assembled yet.*/
+      OD_RETURN_CHECK(enc->packet_state != OD_PACKET_READY, OD_EINVAL);
+      tiles = (const int *)buf;
+      OD_RETURN_CHECK(tiles[0] >= 1 && tiles[0] <= enc->state.nhsb,
+       OD_EINVAL);
+      OD_RETURN_CHECK(tiles[1] >= 1 && tiles[1] <= enc->state.nvsb,
+       OD_EINVAL);
+      tile_w = (enc->state.nhsb + tiles[0] - 1)/tiles[0];
+      tile_h = (enc->state.nvsb + tiles[1] - 1)/tiles[1];
+      return od_enc_tiles_init(enc, tile_w, tile_h);
+    }
+    case OD_SET_THREADS: {
+      int nthreads;
+      int ret;
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(nthreads), OD_EINVAL);
+      nthreads = *(const int *)buf;
+      OD_RETURN_CHECK(nthreads >= 1 && nthreads <= OD_THREADS_MAX, OD_EINVAL);
+      ret = od_enc_workers_reserve(enc, nthreads);
+      if (ret < 0) return ret;
+      if (nthreads != enc->pool.nthreads) {
+        od_thread_pool_clear(&enc->pool);
+        ret = od_thread_pool_init(&enc->pool, nthreads);
+        if (ret < 0) {
+          /*Fall back to encoding serially, which cannot fail.*/
+          od_thread_pool_init(&enc->pool, 1);
+          return ret;
+        }
+      }
+      return OD_SUCCESS;
+    }
+    case OD_SET_BITRATE: {
+      int bitrate;
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(bitrate), OD_EINVAL);
+      bitrate = *(const int *)buf;
+      if (bitrate < 0) return OD_EINVAL;
+      enc->rc.target_bitrate = bitrate;
+      od_rc_reset(&enc->rc);
+      return OD_SUCCESS;
+    }
+    case OD_SET_RATE_BUFFER: {
+      int buffer_size;
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(buffer_size), OD_EINVAL);
+      buffer_size = *(const int *)buf;
+      if (buffer_size < 0) return OD_EINVAL;
+      enc->rc.buffer_size = buffer_size;
+      od_rc_reset(&enc->rc);
+      return OD_SUCCESS;
+    }
+    case OD_SET_MAX_BITRATE: {
+      int max_bitrate;
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(max_bitrate), OD_EINVAL);
+      max_bitrate = *(const int *)buf;
+      if (max_bitrate < 0) return OD_EINVAL;
+      enc->rc.max_bitrate = max_bitrate;
+      return OD_SUCCESS;
+    }
+    case OD_GET_RATE_BUFFER_FULLNESS: {
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(int), OD_EINVAL);
+      *(int *)buf = (int)enc->rc.buffer_fullness;
+      return OD_SUCCESS;
+    }
+    case OD_SET_LOOKAHEAD: {
+      int lookahead;
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(lookahead), OD_EINVAL);
+      lookahead = *(const int *)buf;
+      if (lookahead < 0 || lookahead > OD_MAX_LOOKAHEAD) return OD_EINVAL;
+      /*The lookahead buffers are allocated with the first frame.*/
+      if (enc->la != NULL || enc->frames_in_buff != 0) return OD_EINVAL;
+      enc->lookahead = lookahead;
+      return OD_SUCCESS;
+    }
+    case OD_SET_INPUT_RELEASE: {
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(daala_img_release), OD_EINVAL);
+      if (enc->display_order_count != 0) return OD_EINVAL;
+      enc->input_release = *(const daala_img_release *)buf;
+      return OD_SUCCESS;
+    }
+    case OD_2PASS_OUT: {
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz == sizeof(unsigned char *), OD_EINVAL);
+      if (enc->rc.twopass == 0) {
+        /*The first pass must start with the first frame.*/
+        if (enc->rc.target_bitrate <= 0 || enc->enc_order_count != 0
+         || enc->frames_in_buff != 0) {
+          return OD_EINVAL;
+        }
+        enc->rc.twopass = 1;
+      }
+      if (enc->rc.twopass != 1) return OD_EINVAL;
+      return od_rc_2pass_out(&enc->rc, (unsigned char **)buf);
+    }
+    case OD_2PASS_IN: {
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf, OD_EFAULT);
+      if (enc->rc.target_bitrate <= 0 || enc->rc.twopass == 1
+       || (enc->rc.twopass == 0 && (enc->enc_order_count != 0
+       || enc->frames_in_buff != 0))) {
+        return OD_EINVAL;
+      }
+      enc->rc.twopass = 2;
+      return od_rc_2pass_in(&enc->rc, (const unsigned char *)buf, buf_sz);
+    }
+    case OD_SET_LADDER: {
+      OD_RETURN_CHECK(enc, OD_EFAULT);
+      OD_RETURN_CHECK(buf != NULL || buf_sz == 0, OD_EFAULT);
+      OD_RETURN_CHECK(buf_sz % sizeof(od_enc_ctx *) == 0, OD_EINVAL);
+      return od_enc_set_ladder(enc, (od_enc_ctx *const *)buf,
+       (int)(buf_sz/sizeof(od_enc_ctx *)));
+    }
     default: return OD_EIMPL;
   }
 }
 
+/*Saves a checkpoint of the entropy coder and the adaptation state.
+  Only the position in the adaptation log is saved, so this is only valid
+   while coding the current superblock (see od_encode_sb()).*/
 void od_encode_checkpoint(const daala_enc_ctx *enc, od_rollback_buffer *rbuf) {
   od_ec_enc_checkpoint(&rbuf->ec, &enc->ec);
-  OD_COPY(&rbuf->adapt, &enc->state.adapt, 1);
+  rbuf->log_pos = enc->ec.log->nentries;
+  rbuf->redo_start = rbuf->redo_end = 0;
 }
 
+/*Restores a checkpoint, undoing only the adaptation changes made since.*/
 void od_encode_rollback(daala_enc_ctx *enc, const od_rollback_buffer *rbuf) {
   od_ec_enc_rollback(&enc->ec, &rbuf->ec);
-  OD_COPY(&enc->state.adapt, &rbuf->adapt, 1);
+  od_ec_log_undo(enc->ec.log, rbuf->log_pos);
+  od_ec_enc_redo(&enc->ec, rbuf->redo_start, rbuf->redo_end);
+}
+
+/*Rolls back to the checkpoint in rbuf, after saving the current state in
+   redo.
+  Unlike a checkpoint from od_encode_checkpoint(), redo can still be restored
+   after rolling back past it, as long as nothing before rbuf is undone.*/
+void od_encode_rollback_redo(daala_enc_ctx *enc,
+ const od_rollback_buffer *rbuf, od_rollback_buffer *redo) {
+  od_ec_enc_checkpoint(&redo->ec, &enc->ec);
+  redo->log_pos = rbuf->log_pos;
+  od_ec_enc_save_redo(&enc->ec, rbuf->log_pos,
+   &redo->redo_start, &redo->redo_end);
+  od_encode_rollback(enc, rbuf);
 }
 
 static void od_img_plane_copy_pad(od_img *dst,
@@ -629,8 +1104,9 @@ static void od_img_plane_copy_pad(od_img *dst,
     }
   }
   else {
-    /*Otherwise, Step 1: Copy the data we do have.*/
-    od_img_plane_copy(dst, src, pli);
+    /*Otherwise, Step 1: Copy the data we do have, unless it is already in
+       place.*/
+    if (src != dst) od_img_plane_copy(dst, src, pli);
     /*Step 2: Perform a low-pass extension into the padding region.*/
     /*Right side.*/
     for (x = pic_width; x < plane_width; x++) {
@@ -732,8 +1208,10 @@ static void od_encode_compute_pred(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
     if (pli == 0 || OD_DISABLE_CFL || ctx->use_haar_wavelet) {
       OD_CLEAR(pred, n*n);
       if (pli == 0 && !ctx->use_haar_wavelet) {
-        od_hv_intra_pred(pred, d, w, bx, by, enc->state.bsize,
-         enc->state.bstride, bs);
+        od_hv_intra_pred(pred, d, w, bx, by,
+         enc->state.tile_sbx0 << (OD_LOG_BSIZE_MAX - OD_LOG_BSIZE0),
+         enc->state.tile_sby0 << (OD_LOG_BSIZE_MAX - OD_LOG_BSIZE0),
+         enc->state.bsize, enc->state.bstride, bs);
       }
     }
     else {
@@ -1317,7 +1795,8 @@ static void od_compute_dcts(daala_enc_ctx *enc, od_mb_enc_ctx *ctx, int pli,
     bo = (by << (OD_LOG_BSIZE0 + bs))*w + (bx << (OD_LOG_BSIZE0 + bs));
     hfilter = (bx + 1) << (OD_LOG_BSIZE0 + bs) <= enc->state.info.pic_width;
     vfilter = (by + 1) << (OD_LOG_BSIZE0 + bs) <= enc->state.info.pic_height;
-    od_prefilter_split(ctx->c + bo, w, bs, f, hfilter, vfilter);
+    od_prefilter_split(&enc->state, ctx->c + bo, w, bs, f, hfilter,
+     vfilter);
     bsi--;
     bx <<= 1;
     by <<= 1;
@@ -1378,6 +1857,8 @@ static void od_quantize_haar_dc_sb(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
   od_coeff sb_dc_pred;
   od_coeff sb_dc_curr;
   od_coeff *sb_dc_mem;
+  int has_up;
+  int has_left;
   (void)ydec;
   d = ctx->d[pli];
   w = enc->state.frame_width >> xdec;
@@ -1391,7 +1872,10 @@ static void od_quantize_haar_dc_sb(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
   nhsb = enc->state.nhsb;
   sb_dc_mem = enc->state.sb_dc_mem[pli];
   ln = OD_LOG_BSIZE_MAX - xdec;
-  if (by > 0 && bx > 0) {
+  /*Superblocks in other tiles are not available for prediction.*/
+  has_up = by > enc->state.tile_sby0;
+  has_left = bx > enc->state.tile_sbx0;
+  if (has_up && has_left) {
     /* These coeffs were LS-optimized on subset 1. */
     if (has_ur) {
       sb_dc_pred = (22*sb_dc_mem[by*nhsb + bx - 1]
@@ -1405,8 +1889,8 @@ static void od_quantize_haar_dc_sb(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
        + 19*sb_dc_mem[(by - 1)*nhsb + bx] + 16) >> 5;
     }
   }
-  else if (by > 0) sb_dc_pred = sb_dc_mem[(by - 1)*nhsb + bx];
-  else if (bx > 0) sb_dc_pred = sb_dc_mem[by*nhsb + bx - 1];
+  else if (has_up) sb_dc_pred = sb_dc_mem[(by - 1)*nhsb + bx];
+  else if (has_left) sb_dc_pred = sb_dc_mem[by*nhsb + bx - 1];
   else sb_dc_pred = 0;
   dc0 = d[(by << ln)*w + (bx << ln)] - sb_dc_pred;
   quant = OD_DIV_R0(dc0, dc_quant);
@@ -1416,8 +1900,8 @@ static void od_quantize_haar_dc_sb(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
   sb_dc_curr = quant*dc_quant + sb_dc_pred;
   d[(by << ln)*w + (bx << ln)] = sb_dc_curr;
   sb_dc_mem[by*nhsb + bx] = sb_dc_curr;
-  if (by > 0) *ovgrad = sb_dc_mem[(by - 1)*nhsb + bx] - sb_dc_curr;
-  if (bx > 0) *ohgrad = sb_dc_mem[by*nhsb + bx - 1]- sb_dc_curr;
+  if (has_up) *ovgrad = sb_dc_mem[(by - 1)*nhsb + bx] - sb_dc_curr;
+  if (has_left) *ohgrad = sb_dc_mem[by*nhsb + bx - 1]- sb_dc_curr;
 }
 #endif
 
@@ -1571,8 +2055,7 @@ static int od_encode_recursive(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
       od_encode_checkpoint(enc, &pre_encode_buf);
       skip_nosplit = od_block_encode(enc, ctx, bs, pli, bx, by, rdo_only);
       rate_nosplit = od_ec_enc_tell_frac(&enc->ec) - tell;
-      od_encode_checkpoint(enc, &post_nosplit_buf);
-      od_encode_rollback(enc, &pre_encode_buf);
+      od_encode_rollback_redo(enc, &pre_encode_buf, &post_nosplit_buf);
       for (i = 0; i < n; i++) {
         for (j = 0; j < n; j++) nosplit[n*i + j] = ctx->c[bo + i*w + j];
       }
@@ -1588,9 +2071,11 @@ static int od_encode_recursive(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
     f = OD_FILT_SIZE(bs - 1, xdec);
     hfilter = (bx + 1) << (OD_LOG_BSIZE0 + bs) <= enc->state.info.pic_width;
     vfilter = (by + 1) << (OD_LOG_BSIZE0 + bs) <= enc->state.info.pic_height;
-    od_prefilter_split(ctx->c + bo, w, bs, f, hfilter, vfilter);
+    od_prefilter_split(&enc->state, ctx->c + bo, w, bs, f, hfilter,
+     vfilter);
     if (!ctx->is_keyframe) {
-      od_prefilter_split(ctx->mc + bo, w, bs, f, hfilter, vfilter);
+      od_prefilter_split(&enc->state, ctx->mc + bo, w, bs, f, hfilter,
+       vfilter);
     }
     skip_split = 1;
     if (pli == 0) {
@@ -1617,7 +2102,8 @@ static int od_encode_recursive(daala_enc_ctx *enc, od_mb_enc_ctx *ctx,
     skip_split &= od_encode_recursive(enc, ctx, pli, 2*bx + 1, 2*by + 1,
      bsi - 1, xdec, ydec, rdo_only, hgrad, vgrad);
     skip_block = skip_split;
-    od_postfilter_split(ctx->c + bo, w, bs, f, enc->state.coded_quantizer[pli],
+    od_postfilter_split(&enc->state, ctx->c + bo, w, bs, f,
+     enc->state.coded_quantizer[pli],
      &enc->state.bskip[pli][(by << bs)*enc->state.skip_stride + (bx << bs)],
      enc->state.skip_stride, hfilter, vfilter);
     if (rdo_only && bsi <= OD_LIMIT_BSIZE_MAX) {
@@ -1724,15 +2210,50 @@ static void od_encode_mv(daala_enc_ctx *enc, int num_refs, od_mv_grid_pt *mvg,
   if (abs(oy)) od_ec_enc_bits(&enc->ec, oy < 0, 1);
 }
 
+/*Returns whether an input image can be used in place, rather than copied
+   to the encoder's own buffer.*/
+static int od_enc_input_in_place(daala_enc_ctx *enc, const od_img *img) {
+#if defined(OD_DUMP_IMAGES) || defined(OD_LOGGING_ENABLED)
+  (void)enc;
+  (void)img;
+  return 0;
+#else
+  int pli;
+  if (enc->input_release.func == NULL) return 0;
+  for (pli = 0; pli < img->nplanes; pli++) {
+    if (img->planes[pli].xstride != enc->input_img[0].planes[pli].xstride
+     || img->planes[pli].bitdepth != enc->input_img[0].planes[pli].bitdepth) {
+      return 0;
+    }
+  }
+  return 1;
+#endif
+}
+
 /* Note : Only used for input frames. */
 static void od_img_copy_pad(daala_enc_ctx *enc, od_img *img) {
   od_state *state;
+  od_img *dst;
   int pli;
   int nplanes;
   state = &enc->state;
   OD_ASSERT(enc->in_buff_ptr >= 0 &&
-   enc->in_buff_ptr < 1 + enc->b_frames);
+   enc->in_buff_ptr < enc->frame_delay);
   nplanes = img->nplanes;
+  dst = enc->input_img + enc->in_buff_ptr;
+  OD_ASSERT(!enc->input_lent[enc->in_buff_ptr]);
+  if (od_enc_input_in_place(enc, img)) {
+    /*Point the buffer at the image of the application, which only needs
+       padding.*/
+    enc->input_lent[enc->in_buff_ptr] = 1;
+    enc->input_lent_img[enc->in_buff_ptr] = *img;
+    enc->input_own_img[enc->in_buff_ptr] = *dst;
+    for (pli = 0; pli < nplanes; pli++) {
+      dst->planes[pli].data = img->planes[pli].data;
+      dst->planes[pli].ystride = img->planes[pli].ystride;
+    }
+    img = dst;
+  }
   /* Copy and pad the image. */
   for (pli = 0; pli < nplanes; pli++) {
     int plane_width;
@@ -1743,11 +2264,11 @@ static void od_img_copy_pad(daala_enc_ctx *enc, od_img *img) {
     ydec = img->planes[pli].ydec;
     plane_width = ((state->info.pic_width + (1 << xdec) - 1) >> xdec);
     plane_height = ((state->info.pic_height + (1 << ydec) - 1) >> ydec);
-    od_img_plane_copy_pad(&enc->input_img[enc->in_buff_ptr],
+    od_img_plane_copy_pad(dst,
      state->frame_width >> xdec, state->frame_height >> ydec,
      img, plane_width, plane_height, pli);
   }
-  od_img_edge_ext(enc->input_img + enc->in_buff_ptr);
+  od_img_edge_ext_pad(dst, OD_INPUT_EDGE_EXT);
 }
 
 #if defined(OD_DUMP_IMAGES)
@@ -2227,7 +2748,8 @@ static void od_predict_frame(daala_enc_ctx *enc) {
 #endif
 }
 
-static void od_split_superblocks(daala_enc_ctx *enc, int is_keyframe) {
+static void od_split_superblocks(daala_enc_ctx *enc, int is_keyframe,
+ const od_superblock_stats *psy_stats) {
   int nhsb;
   int nvsb;
   int i;
@@ -2268,7 +2790,8 @@ static void od_split_superblocks(daala_enc_ctx *enc, int is_keyframe) {
       state_bsize =
        &state->bsize[i*OD_BSIZE_GRID*state->bstride + j*OD_BSIZE_GRID];
       od_split_superblock(enc->bs, bimg + j*OD_BSIZE_MAX, istride,
-       is_keyframe ? NULL : rimg + j*OD_BSIZE_MAX, rstride, bsize,
+       is_keyframe ? NULL : rimg + j*OD_BSIZE_MAX, rstride,
+       psy_stats == NULL ? NULL : psy_stats + i*nhsb + j, bsize,
        state->quantizer[0]);
       /* Grab the 4x4 information returned from `od_split_superblock` in bsize
          and store it in the od_state bsize. */
@@ -2386,6 +2909,146 @@ static int od_compute_superblock_q_scaling(daala_enc_ctx *enc, od_coeff *x,
 
 #define OD_ENCODE_REAL (0)
 #define OD_ENCODE_RDO (1)
+
+/*Codes every plane of one superblock.*/
+static void od_encode_sb(daala_enc_ctx *enc, od_mb_enc_ctx *mbctx,
+ int sbx, int sby, int rdo_only) {
+  od_state *state;
+  int nplanes;
+  int pli;
+  state = &enc->state;
+  nplanes = rdo_only ? 1 : state->info.nplanes;
+  /*No checkpoint outlives a superblock, so the adaptation log only has to
+     track the changes made while coding one.*/
+  od_ec_log_reset(enc->ec.log, &state->adapt, sizeof(state->adapt));
+  for (pli = 0; pli < nplanes; pli++) {
+    od_coeff *c_orig;
+    int i;
+    int j;
+    int width;
+    int xdec;
+    int ydec;
+    od_rollback_buffer buf;
+    od_coeff hgrad;
+    od_coeff vgrad;
+    width = enc->state.frame_width;
+    hgrad = vgrad = 0;
+    c_orig = enc->c_orig[0];
+    mbctx->c = state->ctmp[pli];
+    mbctx->d = state->dtmp;
+    mbctx->mc = state->mctmp[pli];
+    mbctx->md = state->mdtmp[pli];
+    mbctx->l = state->lbuf[pli];
+    xdec = enc->input_img[enc->curr_frame].planes[pli].xdec;
+    ydec = enc->input_img[enc->curr_frame].planes[pli].ydec;
+    if (pli == 0 || (rdo_only && mbctx->is_keyframe)) {
+      for (i = 0; i < OD_BSIZE_MAX; i++) {
+        for (j = 0; j < OD_BSIZE_MAX; j++) {
+          c_orig[i*OD_BSIZE_MAX + j] =
+           mbctx->c[(OD_BSIZE_MAX*sby + i)*width + OD_BSIZE_MAX*sbx + j];
+        }
+      }
+    }
+    if (mbctx->is_keyframe) {
+      if (rdo_only) {
+        od_encode_checkpoint(enc, &buf);
+      }
+      od_compute_dcts(enc, mbctx, pli, sbx, sby, OD_NBSIZES - 1, xdec,
+       ydec, mbctx->use_haar_wavelet && !rdo_only);
+      od_quantize_haar_dc_sb(enc, mbctx, pli, sbx, sby, xdec, ydec,
+       sby > state->tile_sby0 && sbx < state->tile_sbx1 - 1, &hgrad, &vgrad);
+      if (rdo_only) {
+        od_encode_rollback(enc, &buf);
+        for (i = 0; i < OD_BSIZE_MAX; i++) {
+          for (j = 0; j < OD_BSIZE_MAX; j++) {
+            mbctx->c[(OD_BSIZE_MAX*sby + i)*width + OD_BSIZE_MAX*sbx + j] =
+             c_orig[i*OD_BSIZE_MAX + j];
+          }
+        }
+      }
+    }
+    if (pli == 0 && state->quantizer[pli] != 0) {
+      mbctx->q_scaling =
+       od_compute_superblock_q_scaling(enc, c_orig, OD_BSIZE_MAX);
+    }
+    od_encode_recursive(enc, mbctx, pli, sbx, sby, OD_NBSIZES - 1, xdec,
+     ydec, rdo_only, hgrad, vgrad);
+  }
+  od_ec_log_reset(enc->ec.log, NULL, 0);
+}
+
+/*Codes the superblocks of the current tile (the whole frame, if it is not
+   split into tiles).*/
+static void od_encode_tile(daala_enc_ctx *enc, od_mb_enc_ctx *mbctx,
+ int rdo_only) {
+  int sby;
+  int sbx;
+  for (sby = enc->state.tile_sby0; sby < enc->state.tile_sby1; sby++) {
+    for (sbx = enc->state.tile_sbx0; sbx < enc->state.tile_sbx1; sbx++) {
+      od_encode_sb(enc, mbctx, sbx, sby, rdo_only);
+    }
+  }
+}
+
+/*Returns the number of jobs used to code the tiles of the current frame.*/
+static int od_enc_tile_njobs(daala_enc_ctx *enc) {
+  return od_enc_pool_njobs(enc,
+   od_state_ntiles(&enc->state, enc->tile_w, enc->tile_h));
+}
+
+/*Job j codes tiles j, j + njobs, j + 2*njobs, ..., with worker j.
+  Each tile starts from a fresh adaptation state and only predicts from
+   itself, so the result does not depend on which job codes it.*/
+static void od_enc_tile_job(void *ctx, int jobi) {
+  daala_enc_ctx *enc;
+  daala_enc_ctx *tenc;
+  int ntiles;
+  int njobs;
+  int tilei;
+  enc = (daala_enc_ctx *)ctx;
+  tenc = od_enc_worker_begin(enc, jobi);
+#if defined(OD_DUMP_BSIZE_DIST)
+  OD_CLEAR(tenc->bsize_dist, OD_NPLANES_MAX);
+#endif
+  ntiles = od_state_ntiles(&enc->state, enc->tile_w, enc->tile_h);
+  njobs = od_enc_tile_njobs(enc);
+  for (tilei = jobi; tilei < ntiles; tilei += njobs) {
+    od_mb_enc_ctx mbctx;
+    mbctx = *enc->jobs_mbctx;
+    tenc->ec = enc->tile_ecs[tilei];
+    tenc->ec.log = &enc->workers[jobi].adapt_log;
+    od_ec_enc_reset(&tenc->ec);
+    od_adapt_ctx_reset(&tenc->state.adapt, mbctx.is_keyframe);
+    od_state_set_tile(&tenc->state, enc->tile_w, enc->tile_h, tilei);
+    od_encode_tile(tenc, &mbctx, enc->jobs_rdo_only);
+    enc->tile_ecs[tilei] = tenc->ec;
+  }
+}
+
+/*Finishes the entropy coder of each tile, and codes the size of every tile
+   but the last one in the main entropy coder.
+  The tiles themselves are appended to the packet by
+   daala_encode_packet_out().*/
+static void od_enc_finish_tiles(daala_enc_ctx *enc) {
+  uint32_t total;
+  uint32_t offs;
+  int ntiles;
+  int tilei;
+  ntiles = od_state_ntiles(&enc->state, enc->tile_w, enc->tile_h);
+  total = 0;
+  for (tilei = 0; tilei < ntiles; tilei++) {
+    enc->tile_data[tilei] = od_ec_enc_done(enc->tile_ecs + tilei,
+     enc->tile_nbytes + tilei);
+    total += enc->tile_nbytes[tilei];
+  }
+  offs = 0;
+  for (tilei = 0; tilei < ntiles - 1; tilei++) {
+    if (offs < total) {
+      od_ec_enc_uint(&enc->ec, enc->tile_nbytes[tilei], total - offs + 1);
+    }
+    offs += enc->tile_nbytes[tilei];
+  }
+}
 static void od_encode_coefficients(daala_enc_ctx *enc, od_mb_enc_ctx *mbctx,
  int rdo_only) {
   int xdec;
@@ -2425,15 +3088,15 @@ static void od_encode_coefficients(daala_enc_ctx *enc, od_mb_enc_ctx *mbctx,
     od_ref_plane_to_coeff(state, state->ctmp[pli],
      OD_LOSSLESS(enc, pli), &enc->input_img[enc->curr_frame], pli);
     if (!mbctx->use_haar_wavelet) {
-      od_apply_prefilter_frame_sbs(state->ctmp[pli],
+      od_apply_prefilter_frame_sbs(state, state->ctmp[pli],
        w, nhsb, nvsb, xdec, ydec);
     }
     if (!mbctx->is_keyframe) {
       od_ref_plane_to_coeff(state,
        state->mctmp[pli], OD_LOSSLESS(enc, pli), rec, pli);
       if (!mbctx->use_haar_wavelet) {
-        od_apply_prefilter_frame_sbs(state->mctmp[pli], w, nhsb, nvsb, xdec,
-         ydec);
+        od_apply_prefilter_frame_sbs(state, state->mctmp[pli], w, nhsb, nvsb,
+         xdec, ydec);
       }
     }
     pic_width = enc->state.info.pic_width >> xdec;
@@ -2457,61 +3120,25 @@ static void od_encode_coefficients(daala_enc_ctx *enc, od_mb_enc_ctx *mbctx,
       }
     }
   }
-  for (sby = 0; sby < nvsb; sby++) {
-    for (sbx = 0; sbx < nhsb; sbx++) {
-      for (pli = 0; pli < nplanes; pli++) {
-        od_coeff *c_orig;
-        int i;
-        int j;
-        int width;
-        od_rollback_buffer buf;
-        od_coeff hgrad;
-        od_coeff vgrad;
-        width = enc->state.frame_width;
-        hgrad = vgrad = 0;
-        c_orig = enc->c_orig[0];
-        mbctx->c = state->ctmp[pli];
-        mbctx->d = state->dtmp;
-        mbctx->mc = state->mctmp[pli];
-        mbctx->md = state->mdtmp[pli];
-        mbctx->l = state->lbuf[pli];
-        xdec = enc->input_img[enc->curr_frame].planes[pli].xdec;
-        ydec = enc->input_img[enc->curr_frame].planes[pli].ydec;
-        if (pli == 0 || (rdo_only && mbctx->is_keyframe)) {
-          for (i = 0; i < OD_BSIZE_MAX; i++) {
-            for (j = 0; j < OD_BSIZE_MAX; j++) {
-              c_orig[i*OD_BSIZE_MAX + j] =
-               mbctx->c[(OD_BSIZE_MAX*sby + i)*width + OD_BSIZE_MAX*sbx + j];
-            }
-          }
-        }
-        if (mbctx->is_keyframe) {
-          if (rdo_only) {
-            od_encode_checkpoint(enc, &buf);
-          }
-          od_compute_dcts(enc, mbctx, pli, sbx, sby, OD_NBSIZES - 1, xdec,
-           ydec, mbctx->use_haar_wavelet && !rdo_only);
-          od_quantize_haar_dc_sb(enc, mbctx, pli, sbx, sby, xdec, ydec,
-           sby > 0 && sbx < nhsb - 1, &hgrad, &vgrad);
-          if (rdo_only) {
-            od_encode_rollback(enc, &buf);
-            for (i = 0; i < OD_BSIZE_MAX; i++) {
-              for (j = 0; j < OD_BSIZE_MAX; j++) {
-                mbctx->c[(OD_BSIZE_MAX*sby + i)*width + OD_BSIZE_MAX*sbx + j] =
-                 c_orig[i*OD_BSIZE_MAX + j];
-              }
-            }
-          }
-        }
-        if (pli == 0 && state->quantizer[pli] != 0) {
-          mbctx->q_scaling =
-           od_compute_superblock_q_scaling(enc, c_orig, OD_BSIZE_MAX);
+  if (enc->tile_w > 0) {
+    enc->jobs_mbctx = mbctx;
+    enc->jobs_rdo_only = rdo_only;
+    od_thread_pool_run(&enc->pool, od_enc_tile_job, enc,
+     od_enc_tile_njobs(enc));
+    enc->jobs_mbctx = NULL;
+#if defined(OD_DUMP_BSIZE_DIST)
+    {
+      int jobi;
+      for (jobi = od_enc_tile_njobs(enc); jobi-- > 0;) {
+        for (pli = 0; pli < nplanes; pli++) {
+          enc->bsize_dist[pli] += enc->workers[jobi].enc.bsize_dist[pli];
         }
-        od_encode_recursive(enc, mbctx, pli, sbx, sby, OD_NBSIZES - 1, xdec,
-         ydec, rdo_only, hgrad, vgrad);
       }
     }
+#endif
+    if (!rdo_only) od_enc_finish_tiles(enc);
   }
+  else od_encode_tile(enc, mbctx, rdo_only);
 #if defined(OD_DUMP_IMAGES)
   if (!rdo_only) {
     /*Dump the lapped frame (before the postfilter has been applied)*/
@@ -2527,8 +3154,8 @@ static void od_encode_coefficients(daala_enc_ctx *enc, od_mb_enc_ctx *mbctx,
     ydec = enc->input_img[enc->curr_frame].planes[pli].ydec;
     w = frame_width >> xdec;
     if (!mbctx->use_haar_wavelet) {
-      od_apply_postfilter_frame_sbs(state->ctmp[pli], w, nhsb, nvsb, xdec,
-       ydec, state->coded_quantizer[pli], &enc->state.bskip[pli][0],
+      od_apply_postfilter_frame_sbs(state, state->ctmp[pli], w, nhsb, nvsb,
+       xdec, ydec, state->coded_quantizer[pli], &enc->state.bskip[pli][0],
        enc->state.skip_stride);
     }
   }
@@ -2799,10 +3426,15 @@ static void od_interp_qm(unsigned char *out, int q, const od_qm_entry *entry1,
 
 static void od_split_superblocks_rdo(daala_enc_ctx *enc,
  od_mb_enc_ctx *mbctx) {
-  od_rollback_buffer rbuf;
-  od_encode_checkpoint(enc, &rbuf);
+  od_ec_enc ec;
+  od_adapt_ctx adapt;
+  /*This spans every superblock of the frame, which the adaptation log does
+     not, so save a full copy of the adaptation state.*/
+  od_ec_enc_checkpoint(&ec, &enc->ec);
+  OD_COPY(&adapt, &enc->state.adapt, 1);
   od_encode_coefficients(enc, mbctx, OD_ENCODE_RDO);
-  od_encode_rollback(enc, &rbuf);
+  od_ec_enc_rollback(&enc->ec, &ec);
+  OD_COPY(&enc->state.adapt, &adapt, 1);
 }
 
 static int od_enc_pop_input_buff_head(daala_enc_ctx *enc) {
@@ -2829,7 +3461,14 @@ static int od_enc_pop_input_buff_tail(daala_enc_ctx *enc) {
 static void od_enc_push_input_buff_tail(daala_enc_ctx *enc, od_img *img) {
   enc->frames_in_buff += 1;
   OD_ASSERT(enc->frames_in_buff <= enc->frame_delay);
-  enc->in_buff_ptr = (enc->in_buff_ptr + 1) % enc->frame_delay;
+  if (enc->la != NULL) {
+    int imgi;
+    /*Frames leave the lookahead in coding order, so take any free
+       buffer.*/
+    for (imgi = 0; enc->in_imgs_id[imgi] >= 0; imgi++);
+    enc->in_buff_ptr = imgi;
+  }
+  else enc->in_buff_ptr = (enc->in_buff_ptr + 1) % enc->frame_delay;
   OD_ASSERT(enc->in_buff_ptr >= 0 &&
    enc->in_buff_ptr < enc->frame_delay);
   enc->in_imgs_id[enc->in_buff_ptr] = enc->display_order_count;
@@ -2838,6 +3477,60 @@ static void od_enc_push_input_buff_tail(daala_enc_ctx *enc, od_img *img) {
     enc->in_buff_head = enc->in_buff_ptr;
   }
   od_img_copy_pad(enc, img);
+  if (!enc->input_lent[enc->in_buff_ptr] && enc->input_release.func != NULL) {
+    (*enc->input_release.func)(enc->input_release.ctx, img);
+  }
+  if (enc->la != NULL) {
+    od_lookahead_push(enc->la, enc->input_img + enc->in_buff_ptr,
+     enc->in_buff_ptr);
+  }
+}
+
+/*Allocates the lookahead and the extra input buffers it needs.*/
+static int od_enc_lookahead_init(daala_enc_ctx *enc) {
+  unsigned char *data;
+  size_t img_sz;
+  int frame_buf_height;
+  int nplanes;
+  int imgi;
+  int pli;
+  nplanes = enc->state.info.nplanes;
+  frame_buf_height = enc->state.frame_height + (OD_BUFFER_PADDING << 1);
+  img_sz = 0;
+  for (pli = 0; pli < nplanes; pli++) {
+    img_sz += (size_t)(frame_buf_height >> enc->input_img[0].planes[pli].ydec)
+     *enc->input_img[0].planes[pli].ystride;
+  }
+  enc->lookahead_img_data = data =
+   (unsigned char *)od_aligned_malloc(img_sz*enc->lookahead, 32);
+  enc->la = (od_lookahead *)malloc(sizeof(*enc->la));
+  if (OD_UNLIKELY(data == NULL || enc->la == NULL)) {
+    free(enc->la);
+    enc->la = NULL;
+    return OD_EFAULT;
+  }
+  /*The extra buffers have the same layout as the others.*/
+  for (imgi = 1 + OD_MAX_B_FRAMES;
+   imgi < 1 + OD_MAX_B_FRAMES + enc->lookahead; imgi++) {
+    od_img *img;
+    img = enc->input_img + imgi;
+    *img = enc->input_img[0];
+    for (pli = 0; pli < nplanes; pli++) {
+      od_img_plane *iplane;
+      iplane = img->planes + pli;
+      iplane->data = data
+       + iplane->xstride*(OD_BUFFER_PADDING >> iplane->xdec)
+       + iplane->ystride*(OD_BUFFER_PADDING >> iplane->ydec);
+      data += (size_t)(frame_buf_height >> iplane->ydec)*iplane->ystride;
+    }
+  }
+  if (OD_UNLIKELY(od_lookahead_init(enc->la, &enc->state.info,
+   1 + OD_MAX_B_FRAMES + enc->lookahead, enc->pool.nthreads > 1) < 0)) {
+    free(enc->la);
+    enc->la = NULL;
+    return OD_EFAULT;
+  }
+  return OD_SUCCESS;
 }
 
 /*As an example, if # of B frames = 2,
@@ -2870,119 +3563,119 @@ static int od_enc_determine_frame_type(daala_enc_ctx *enc) {
     /*1st frame.*/
     frame_type = OD_I_FRAME;
   }
+  /*Without B frames, the second pass of a two-pass encode moves keyframes
+     to scene cuts.*/
+  if (enc->b_frames == 0) {
+    int keyframe;
+    keyframe = od_rc_2pass_keyframe(&enc->rc);
+    if (keyframe >= 0) frame_type = keyframe ? OD_I_FRAME : OD_P_FRAME;
+  }
   return frame_type;
 }
 
-int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
- int end_of_input, int *input_frames_left_encoder_buffer) {
+static int32_t od_enc_plane_pixel(const od_img_plane *plane, int x, int y) {
+  const unsigned char *p;
+  p = plane->data + y*plane->ystride + x*plane->xstride;
+  return plane->xstride == 1 ? *p : *(const uint16_t *)p;
+}
+
+/*Computes the mean absolute difference per pixel, in Q8, between the luma
+   plane of the current input frame and either its motion-compensated
+   prediction in pred, or, if pred is NULL, the mean of each 8x8 block.
+  These are the first-pass inter and intra costs of the frame.*/
+static uint32_t od_enc_frame_cost(daala_enc_ctx *enc, const od_img *pred) {
+  const od_img_plane *iplane;
+  const od_img_plane *pplane;
+  int64_t cost;
+  int shift;
+  int w;
+  int h;
+  int bx;
+  int by;
+  iplane = enc->input_img[enc->curr_frame].planes;
+  pplane = pred != NULL ? pred->planes : NULL;
+  shift = iplane->bitdepth - 8;
+  w = enc->state.info.pic_width;
+  h = enc->state.info.pic_height;
+  cost = 0;
+  for (by = 0; by < h; by += 8) {
+    for (bx = 0; bx < w; bx += 8) {
+      int bw;
+      int bh;
+      int x;
+      int y;
+      int32_t mean;
+      bw = OD_MINI(8, w - bx);
+      bh = OD_MINI(8, h - by);
+      mean = 0;
+      if (pplane == NULL) {
+        for (y = by; y < by + bh; y++) {
+          for (x = bx; x < bx + bw; x++) {
+            mean += od_enc_plane_pixel(iplane, x, y);
+          }
+        }
+        mean = (mean + (bw*bh >> 1))/(bw*bh);
+      }
+      for (y = by; y < by + bh; y++) {
+        for (x = bx; x < bx + bw; x++) {
+          int32_t p;
+          p = pplane != NULL ? od_enc_plane_pixel(pplane, x, y) : mean;
+          cost += abs(od_enc_plane_pixel(iplane, x, y) - p);
+        }
+      }
+    }
+  }
+  return (uint32_t)(((cost << 8) + ((int64_t)w*h << shift >> 1))
+   /((int64_t)w*h << shift));
+}
+
+/*Picks the reference buffers of the next frame and the buffer it is coded
+   into, which may also change its type.*/
+static void od_enc_plan_refs(daala_enc_ctx *enc, od_enc_frame_plan *plan) {
+  int *ref_imgi;
   int refi;
+  ref_imgi = plan->ref_imgi;
+  OD_COPY(ref_imgi, enc->state.ref_imgi, OD_FRAME_MAX + 1);
+  if (ref_imgi[OD_FRAME_GOLD] < 0) plan->is_golden_frame = 1;
+  /*Update the reference buffer state.*/
+  if (enc->b_frames != 0 && plan->frame_type == OD_P_FRAME) {
+    ref_imgi[OD_FRAME_PREV] = ref_imgi[OD_FRAME_NEXT];
+  }
+#if OD_CLOSED_GOP
+  if (plan->frame_type == OD_I_FRAME) {
+    int imgi;
+    /*Mark all of the reference frames are not available.*/
+    for (imgi = 0; imgi < 4; imgi++) ref_imgi[imgi] = -1;
+  }
+#endif
+  /*Select a free buffer to use for this reference frame.*/
+  for (refi = 0; refi == ref_imgi[OD_FRAME_GOLD]
+   || refi == ref_imgi[OD_FRAME_PREV]
+   || refi == ref_imgi[OD_FRAME_NEXT]; refi++);
+  ref_imgi[OD_FRAME_SELF] = refi;
+  /*We must be a keyframe if we don't have a reference.*/
+  if (ref_imgi[OD_FRAME_PREV] < 0) plan->frame_type = OD_I_FRAME;
+}
+
+/*Codes the current input frame as planned.*/
+static void od_encode_frame(daala_enc_ctx *enc,
+ const od_enc_frame_plan *plan) {
   int nplanes;
   int pli;
-  int frame_width;
-  int frame_height;
-  int pic_width;
-  int pic_height;
   int use_masking;
+  int first_pass;
   od_mb_enc_ctx mbctx;
   od_img *ref_img;
   int frame_type;
-  if (enc == NULL || img == NULL || input_frames_left_encoder_buffer == NULL) {
-    return OD_EFAULT;
-  }
-  if (enc->packet_state == OD_PACKET_DONE) return OD_EINVAL;
-  /*Check the input image dimensions to make sure they're compatible with the
-     declared video size.*/
   nplanes = enc->state.info.nplanes;
-  if (img->nplanes != nplanes) return OD_EINVAL;
-  for (pli = 0; pli < nplanes; pli++) {
-    if (img->planes[pli].xdec != enc->state.info.plane_info[pli].xdec
-     || img->planes[pli].ydec != enc->state.info.plane_info[pli].ydec) {
-      return OD_EINVAL;
-    }
-  }
-  enc->frame_delay = enc->b_frames + 1;
-#if defined(OD_DUMP_IMAGES) || defined(OD_DUMP_RECONS)
-  enc->curr_dec_output = -1;
-#endif
-  /*Buffer the input frames up to frame delay.*/
-  if (!end_of_input && (enc->b_frames == 0 ||
-   enc->frames_in_buff < enc->frame_delay)) {
-    od_enc_push_input_buff_tail(enc, img);
-#if defined(OD_DUMP_IMAGES)
-  if (od_logging_active(OD_LOG_GENERIC, OD_LOG_DEBUG)) {
-    od_img_dump_padded(enc);
-  }
-#endif
-  }
-  /*If buffer is not filled as required, don't proceed to encoding.*/
-  if (!end_of_input && enc->frames_in_buff < enc->frame_delay) {
-    return OD_SUCCESS;
-  }
-  if (end_of_input && enc->frames_in_buff <= 0) {
-    *input_frames_left_encoder_buffer = 0;
-    return OD_SUCCESS;
-  }
   use_masking = enc->use_activity_masking;
-  frame_width = enc->state.frame_width;
-  frame_height = enc->state.frame_height;
-  pic_width = enc->state.info.pic_width;
-  pic_height = enc->state.info.pic_height;
-  if (img->width != frame_width || img->height != frame_height) {
-    /*The buffer does not match the frame size.
-      Check to see if it matches the picture size.*/
-    if (img->width != pic_width || img->height != pic_height) {
-      /*It doesn't; we don't know how to handle it yet.*/
-      return OD_EINVAL;
-    }
-  }
-  /*Determine a frame type.*/
-  frame_type = od_enc_determine_frame_type(enc);
-  /*If P frame or I with open GOP, the input frame is at the tail of
-    input frame buffer, otherwise input frame is at the head.*/
-  if (enc->b_frames > 0) {
-    if (frame_type == OD_P_FRAME ||
-     (!OD_CLOSED_GOP && frame_type == OD_I_FRAME &&
-     enc->enc_order_count != 0)) {
-      enc->curr_frame = od_enc_pop_input_buff_tail(enc);
-    }
-    else enc->curr_frame = od_enc_pop_input_buff_head(enc);
-  }
-  else {
-    enc->curr_frame = 0;
-    enc->frames_in_buff -= 1;
-  }
   enc->curr_display_order = enc->in_imgs_id[enc->curr_frame];
+  frame_type = plan->frame_type;
   /* Check if the frame should be a keyframe. */
   mbctx.is_keyframe = (frame_type == OD_I_FRAME) ? 1 : 0;
-  /* B-frame cannot be a Golden frame.*/
-  mbctx.is_golden_frame = (enc->ip_frame_count %
-   (OD_GOLDEN_FRAME_INTERVAL/(enc->b_frames + 1)) == 0)
-   && (frame_type != OD_B_FRAME) ? 1 : 0;
-  if (enc->state.ref_imgi[OD_FRAME_GOLD] < 0) {
-    mbctx.is_golden_frame = 1;
-  }
-  /*Update the reference buffer state.*/
-  if (enc->b_frames != 0 && frame_type == OD_P_FRAME) {
-    enc->state.ref_imgi[OD_FRAME_PREV] =
-     enc->state.ref_imgi[OD_FRAME_NEXT];
-  }
-#if OD_CLOSED_GOP
-  if (frame_type == OD_I_FRAME) {
-    int imgi;
-    /*Mark all of the reference frames are not available.*/
-    for (imgi = 0; imgi < 4; imgi++) enc->state.ref_imgi[imgi] = -1;
-  }
-#endif
-  /*Select a free buffer to use for this reference frame.*/
-  for (refi = 0; refi == enc->state.ref_imgi[OD_FRAME_GOLD]
-   || refi == enc->state.ref_imgi[OD_FRAME_PREV]
-   || refi == enc->state.ref_imgi[OD_FRAME_NEXT]; refi++);
-  enc->state.ref_imgi[OD_FRAME_SELF] = refi;
-  /*We must be a keyframe if we don't have a reference.*/
-  if (enc->state.ref_imgi[OD_FRAME_PREV] < 0) {
-    mbctx.is_keyframe = 1;
-    frame_type = OD_I_FRAME;
-  }
+  mbctx.is_golden_frame = plan->is_golden_frame;
+  OD_COPY(enc->state.ref_imgi, plan->ref_imgi, OD_FRAME_MAX + 1);
+  enc->mvest->src = plan->src;
 #if defined(OD_DUMP_IMAGES) || defined(OD_DUMP_RECONS)
   enc->curr_dec_frame = od_state_push_output_buff_tail(&enc->state);
   /*Let output buffer know which input frame in display order it was.*/
@@ -2999,11 +3692,22 @@ int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
   /* Use Haar for lossless since 1) it's more efficient than the DCT and 2)
      PVQ isn't lossless. We only look at luma quality based on the assumption
      that it's silly to have just some planes be lossless. */
-  mbctx.use_haar_wavelet = enc->use_haar_wavelet || enc->quality[0] == 0;
+  mbctx.use_haar_wavelet = enc->use_haar_wavelet
+   || (enc->quality[0] == 0 && enc->rc.target_bitrate == 0);
   /*Initialize the entropy coder.*/
   od_ec_enc_reset(&enc->ec);
   /*Write a bit to mark this as a data packet.*/
   od_ec_encode_bool_q15(&enc->ec, 0, 16384);
+  /*Code whether the frame is split into tiles, and their size.*/
+  od_ec_encode_bool_q15(&enc->ec, enc->tile_w > 0, 16384);
+  if (enc->tile_w > 0) {
+    if (enc->state.nhsb > 1) {
+      od_ec_enc_uint(&enc->ec, enc->tile_w - 1, enc->state.nhsb);
+    }
+    if (enc->state.nvsb > 1) {
+      od_ec_enc_uint(&enc->ec, enc->tile_h - 1, enc->state.nvsb);
+    }
+  }
   /*Code the keyframe bit.*/
   od_ec_encode_bool_q15(&enc->ec, mbctx.is_keyframe, 16384);
   /*If not I frame, code the bit to tell whether it is P or B frame.*/
@@ -3021,10 +3725,27 @@ int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
   od_ec_encode_bool_q15(&enc->ec, mbctx.qm, 16384);
   od_ec_encode_bool_q15(&enc->ec, mbctx.use_haar_wavelet, 16384);
   od_ec_encode_bool_q15(&enc->ec, mbctx.is_golden_frame, 16384);
+  if (enc->rc.target_bitrate > 0) {
+    int frame_duration;
+    int coded_quantizer;
+    frame_duration = enc->state.info.frame_duration > 0 ?
+     (int)enc->state.info.frame_duration : plan->duration;
+    coded_quantizer = od_rc_select_quantizer(&enc->rc, frame_type,
+     mbctx.is_golden_frame, frame_duration, plan->frames_to_key,
+     enc->b_frames,
+     OD_GOLDEN_FRAME_INTERVAL/(enc->b_frames + 1));
+    for (pli = 0; pli < nplanes; pli++) {
+      enc->state.coded_quantizer[pli] = coded_quantizer;
+    }
+  }
+  else {
+    for (pli = 0; pli < nplanes; pli++) {
+      enc->state.coded_quantizer[pli] =
+       od_quantizer_to_codedquantizer(
+        od_quantizer_from_quality(enc->quality[pli]));
+    }
+  }
   for (pli = 0; pli < nplanes; pli++) {
-    enc->state.coded_quantizer[pli] =
-     od_quantizer_to_codedquantizer(
-      od_quantizer_from_quality(enc->quality[pli]));
     enc->state.quantizer[pli] =
      od_codedquantizer_to_quantizer(enc->state.coded_quantizer[pli]);
   }
@@ -3081,10 +3802,27 @@ int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
   OD_LOG((OD_LOG_ENCODER, OD_LOG_INFO, "is_keyframe=%d", mbctx.is_keyframe));
   /*TODO: Increment frame count.*/
   od_adapt_ctx_reset(&enc->state.adapt, mbctx.is_keyframe);
+  first_pass = enc->rc.twopass == 1 && enc->rc.target_bitrate > 0;
+  if (first_pass) {
+    enc->rc.intra_cost = od_enc_frame_cost(enc, NULL);
+    enc->rc.inter_cost = 0;
+  }
   if (!mbctx.is_keyframe) {
     int num_refs;
+    int mv_level_max;
     num_refs = mbctx.num_refs;
+    /*The first pass only needs a rough motion field.*/
+    mv_level_max = enc->params.mv_level_max;
+    if (first_pass) {
+      enc->params.mv_level_max =
+       OD_MINI(mv_level_max, OD_FIRST_PASS_MV_LEVEL_MAX);
+    }
     od_predict_frame(enc);
+    enc->params.mv_level_max = mv_level_max;
+    if (first_pass) {
+      enc->rc.inter_cost = od_enc_frame_cost(enc,
+       enc->state.ref_imgs + enc->state.ref_imgi[OD_FRAME_SELF]);
+    }
     od_encode_mvs(enc, num_refs);
   }
   if (mbctx.use_haar_wavelet) {
@@ -3094,8 +3832,14 @@ int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
     /* Enable block size RDO for all but complexity 0 and 1. We might want to
        revise that choice if we get a better open-loop block size algorithm. */
     od_state_init_superblock_split(&enc->state, OD_LIMIT_BSIZE_MIN);
-    if (enc->complexity >= 2) od_split_superblocks_rdo(enc, &mbctx);
-    else od_split_superblocks(enc, mbctx.is_keyframe);
+    if (enc->complexity >= 2 && !(first_pass
+     && enc->input_img[enc->curr_frame].planes[0].xstride == 1)) {
+      od_split_superblocks_rdo(enc, &mbctx);
+    }
+    else {
+      od_split_superblocks(enc, mbctx.is_keyframe,
+       plan->src == NULL ? NULL : plan->src->psy_stats);
+    }
   }
   od_encode_coefficients(enc, &mbctx, OD_ENCODE_REAL);
   enc->packet_state = OD_PACKET_READY;
@@ -3178,8 +3922,9 @@ int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
   /*od_state_dump_img(&enc->state,
    enc->state.ref_img + enc->state.ref_imigi[OD_FRAME_SELF], "ref");*/
 #endif
-  *input_frames_left_encoder_buffer = enc->frames_in_buff;
-  if (enc->state.info.frame_duration == 0) enc->state.cur_time += duration;
+  if (enc->state.info.frame_duration == 0) {
+    enc->state.cur_time += plan->duration;
+  }
   else enc->state.cur_time += enc->state.info.frame_duration;
 #if defined(OD_DUMP_BSIZE_DIST)
   for (pli = 0; pli < nplanes; pli++){
@@ -3192,11 +3937,193 @@ int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
   fprintf(enc->bsize_dist_file, "\n");
 #endif
   OD_ASSERT(mbctx.is_keyframe == (frame_type == OD_I_FRAME));
-  enc->in_imgs_id[enc->curr_frame] = -1;
   ++enc->enc_order_count;
   if (frame_type == OD_I_FRAME || frame_type == OD_P_FRAME) {
     ++enc->ip_frame_count;
   }
+}
+
+/*Checks that the rungs of the ladder can still code the frames of this
+   encoder.*/
+static int od_enc_ladder_check(od_enc_ctx *enc) {
+  int i;
+  for (i = 0; i < enc->nladder; i++) {
+    if (enc->ladder[i]->packet_state == OD_PACKET_DONE
+     || enc->ladder[i]->b_frames != enc->b_frames) {
+      return OD_EINVAL;
+    }
+  }
+  return OD_SUCCESS;
+}
+
+static void od_enc_ladder_job(void *ctx, int jobi) {
+  od_enc_ctx *enc;
+  enc = (od_enc_ctx *)ctx;
+  od_encode_frame(enc->ladder[jobi], &enc->plan);
+}
+
+/*Hands the current input frame to the rungs of the ladder, and starts
+   coding it in their threads.*/
+static void od_enc_ladder_start(od_enc_ctx *enc) {
+  int i;
+  for (i = 0; i < enc->nladder; i++) {
+    od_enc_ctx *rung;
+    rung = enc->ladder[i];
+    rung->curr_frame = enc->curr_frame;
+    rung->input_img[enc->curr_frame] = enc->input_img[enc->curr_frame];
+    rung->in_imgs_id[enc->curr_frame] = enc->in_imgs_id[enc->curr_frame];
+    rung->frames_in_buff = enc->frames_in_buff;
+    if (enc->ladder_tasks != NULL) {
+      od_task_start(enc->ladder_tasks + i, od_enc_ladder_job, enc, i);
+    }
+  }
+}
+
+/*Waits for the rungs of the ladder to finish the current frame, or codes it
+   for them without threads.*/
+static void od_enc_ladder_finish(od_enc_ctx *enc) {
+  int i;
+  for (i = 0; i < enc->nladder; i++) {
+    if (enc->ladder_tasks != NULL) od_task_wait(enc->ladder_tasks + i);
+    else od_enc_ladder_job(enc, i);
+  }
+}
+
+int daala_encode_img_in(daala_enc_ctx *enc, od_img *img, int duration,
+ int end_of_input, int *input_frames_left_encoder_buffer) {
+  int nplanes;
+  int pli;
+  int frame_width;
+  int frame_height;
+  int pic_width;
+  int pic_height;
+  int lookahead_golden;
+  int frame_type;
+  int ret;
+  if (enc == NULL || img == NULL || input_frames_left_encoder_buffer == NULL) {
+    return OD_EFAULT;
+  }
+  if (enc->packet_state == OD_PACKET_DONE) return OD_EINVAL;
+  /*The rungs of a ladder get their frames from its first encoder.*/
+  if (enc->ladder_leader != NULL) return OD_EINVAL;
+  ret = od_enc_ladder_check(enc);
+  if (OD_UNLIKELY(ret < 0)) return ret;
+  /*Check the input image dimensions to make sure they're compatible with the
+     declared video size.*/
+  nplanes = enc->state.info.nplanes;
+  if (img->nplanes != nplanes) return OD_EINVAL;
+  for (pli = 0; pli < nplanes; pli++) {
+    if (img->planes[pli].xdec != enc->state.info.plane_info[pli].xdec
+     || img->planes[pli].ydec != enc->state.info.plane_info[pli].ydec) {
+      return OD_EINVAL;
+    }
+  }
+  enc->frame_delay = enc->b_frames + 1;
+  if (enc->lookahead > 0) {
+    enc->frame_delay += enc->lookahead;
+    if (enc->la == NULL) {
+      ret = od_enc_lookahead_init(enc);
+      if (OD_UNLIKELY(ret < 0)) return ret;
+    }
+  }
+  if (enc->nladder > 0 && enc->display_order_count == 0) {
+    if (enc->src == NULL) {
+      ret = od_enc_src_analysis_init(enc);
+      if (OD_UNLIKELY(ret < 0)) return ret;
+    }
+    if (enc->ladder_tasks == NULL) od_enc_ladder_tasks_init(enc);
+  }
+#if defined(OD_DUMP_IMAGES) || defined(OD_DUMP_RECONS)
+  enc->curr_dec_output = -1;
+#endif
+  /*Buffer the input frames up to frame delay.*/
+  if (!end_of_input && (enc->b_frames == 0 ||
+   enc->frames_in_buff < enc->frame_delay)) {
+    od_enc_push_input_buff_tail(enc, img);
+#if defined(OD_DUMP_IMAGES)
+  if (od_logging_active(OD_LOG_GENERIC, OD_LOG_DEBUG)) {
+    od_img_dump_padded(enc);
+  }
+#endif
+  }
+  /*If buffer is not filled as required, don't proceed to encoding.*/
+  if (!end_of_input && enc->frames_in_buff < enc->frame_delay) {
+    return OD_SUCCESS;
+  }
+  if (end_of_input && enc->frames_in_buff <= 0) {
+    *input_frames_left_encoder_buffer = 0;
+    return OD_SUCCESS;
+  }
+  frame_width = enc->state.frame_width;
+  frame_height = enc->state.frame_height;
+  pic_width = enc->state.info.pic_width;
+  pic_height = enc->state.info.pic_height;
+  if (img->width != frame_width || img->height != frame_height) {
+    /*The buffer does not match the frame size.
+      Check to see if it matches the picture size.*/
+    if (img->width != pic_width || img->height != pic_height) {
+      /*It doesn't; we don't know how to handle it yet.*/
+      return OD_EINVAL;
+    }
+  }
+  lookahead_golden = 0;
+  if (enc->la != NULL) {
+    /*The lookahead picks both the next frame to code and its type.*/
+    enc->curr_frame = od_lookahead_next(enc->la, &frame_type,
+     &lookahead_golden, enc->b_frames, enc->state.info.keyframe_rate,
+     OD_GOLDEN_FRAME_INTERVAL/(enc->b_frames + 1), end_of_input);
+    OD_ASSERT(enc->curr_frame >= 0);
+    enc->frames_in_buff -= 1;
+  }
+  else {
+    /*Determine a frame type.*/
+    frame_type = od_enc_determine_frame_type(enc);
+    /*If P frame or I with open GOP, the input frame is at the tail of
+      input frame buffer, otherwise input frame is at the head.*/
+    if (enc->b_frames > 0) {
+      if (frame_type == OD_P_FRAME ||
+       (!OD_CLOSED_GOP && frame_type == OD_I_FRAME &&
+       enc->enc_order_count != 0)) {
+        enc->curr_frame = od_enc_pop_input_buff_tail(enc);
+      }
+      else enc->curr_frame = od_enc_pop_input_buff_head(enc);
+    }
+    else {
+      enc->curr_frame = 0;
+      enc->frames_in_buff -= 1;
+    }
+  }
+  /* B-frame cannot be a Golden frame.*/
+  if (enc->la != NULL) enc->plan.is_golden_frame = lookahead_golden;
+  else {
+    enc->plan.is_golden_frame = (enc->ip_frame_count %
+     (OD_GOLDEN_FRAME_INTERVAL/(enc->b_frames + 1)) == 0)
+     && (frame_type != OD_B_FRAME) ? 1 : 0;
+  }
+  if (enc->la != NULL) enc->plan.frames_to_key = enc->la->frames_to_key;
+  else {
+    enc->plan.frames_to_key = enc->state.info.keyframe_rate
+     - (int)(enc->enc_order_count % enc->state.info.keyframe_rate);
+  }
+  enc->plan.frame_type = frame_type;
+  enc->plan.duration = duration;
+  od_enc_plan_refs(enc, &enc->plan);
+  enc->plan.src = NULL;
+  if (enc->src != NULL) {
+    od_src_analysis_run(enc->src, enc->input_img + enc->curr_frame,
+     enc->plan.frame_type, enc->plan.ref_imgi);
+    enc->plan.src = enc->src;
+  }
+  od_enc_ladder_start(enc);
+  od_encode_frame(enc, &enc->plan);
+  od_enc_ladder_finish(enc);
+  /*B frames cannot be a reference frame.*/
+  if (enc->src != NULL && enc->plan.frame_type != OD_B_FRAME) {
+    od_src_analysis_store(enc->src, enc->plan.ref_imgi[OD_FRAME_SELF]);
+  }
+  *input_frames_left_encoder_buffer = enc->frames_in_buff;
+  enc->in_imgs_id[enc->curr_frame] = -1;
+  od_enc_release_input(enc, enc->curr_frame);
   return 0;
 }
 
@@ -3243,6 +4170,42 @@ static void daala_encoder_check(daala_enc_ctx *ctx, od_img *img,
 }
 #endif
 
+/*Appends the tiles of a tiled frame to the rest of its packet, followed by
+   the size of the rest, as a 32-bit little-endian value.*/
+static int od_enc_append_tiles(daala_enc_ctx *enc, unsigned char **packet,
+ uint32_t *nbytes) {
+  unsigned char *buf;
+  size_t sz;
+  uint32_t nhead;
+  uint32_t offs;
+  int ntiles;
+  int tilei;
+  ntiles = od_state_ntiles(&enc->state, enc->tile_w, enc->tile_h);
+  nhead = *nbytes;
+  sz = nhead + 4;
+  for (tilei = 0; tilei < ntiles; tilei++) sz += enc->tile_nbytes[tilei];
+  if (sz > enc->tile_packet_sz) {
+    buf = (unsigned char *)realloc(enc->tile_packet, sz);
+    if (OD_UNLIKELY(buf == NULL)) return OD_EFAULT;
+    enc->tile_packet = buf;
+    enc->tile_packet_sz = sz;
+  }
+  buf = enc->tile_packet;
+  memcpy(buf, *packet, nhead);
+  offs = nhead;
+  for (tilei = 0; tilei < ntiles; tilei++) {
+    memcpy(buf + offs, enc->tile_data[tilei], enc->tile_nbytes[tilei]);
+    offs += enc->tile_nbytes[tilei];
+  }
+  buf[offs++] = (unsigned char)(nhead & 0xFF);
+  buf[offs++] = (unsigned char)(nhead >> 8 & 0xFF);
+  buf[offs++] = (unsigned char)(nhead >> 16 & 0xFF);
+  buf[offs++] = (unsigned char)(nhead >> 24);
+  *packet = buf;
+  *nbytes = offs;
+  return OD_SUCCESS;
+}
+
 int daala_encode_packet_out(daala_enc_ctx *enc, int last, daala_packet *op) {
   uint32_t nbytes;
   if (enc == NULL || op == NULL) return OD_EFAULT;
@@ -3250,7 +4213,15 @@ int daala_encode_packet_out(daala_enc_ctx *enc, int last, daala_packet *op) {
     return 0;
   }
   op->packet = od_ec_enc_done(&enc->ec, &nbytes);
+  if (enc->tile_w > 0) {
+    int ret;
+    ret = od_enc_append_tiles(enc, &op->packet, &nbytes);
+    if (OD_UNLIKELY(ret < 0)) return ret;
+  }
   op->bytes = nbytes;
+  if (enc->rc.target_bitrate > 0) {
+    od_rc_update_state(&enc->rc, (int32_t)(nbytes*8));
+  }
   OD_LOG((OD_LOG_ENCODER, OD_LOG_INFO, "Output Bytes: %ld (%ld Kbits)",
    op->bytes, op->bytes*8/1024));
   op->b_o_s = 0;
@@ -89,3 +89,35 @@ uint32_t od_ec_tell_frac(uint32_t nbits_total, uint32_t rng) {
   }
   return nbits - l;
 }
+
+/*Finds the symbol whose CDF interval contains q.
+  cdf: The CDF, which must be non-decreasing.
+  nsyms: The number of entries in cdf.
+  q: The value to look up.
+     This must be less than cdf[nsyms - 1].
+  Return: The index of the first entry of cdf greater than q.*/
+int od_ec_cdf_search_c(const uint16_t *cdf, int nsyms, unsigned q) {
+  int ret;
+  (void)nsyms;
+  OD_ASSERT(q < cdf[nsyms - 1]);
+  for (ret = 0; cdf[ret] <= q; ret++);
+  return ret;
+}
+
+/*Adapts a CDF after coding a symbol with it.
+  cdf: The CDF to adapt.
+  val: The symbol that was coded.
+  n: The number of entries in cdf.
+  increment: The amount to add to the probability of val (Q15).
+             If cdf[n - 1] would exceed 32767, the whole CDF is first halved,
+              keeping every symbol's probability non-zero.*/
+void od_ec_cdf_adapt_c(uint16_t *cdf, int val, int n, int increment) {
+  int i;
+  if (cdf[n - 1] + increment > 32767) {
+    for (i = 0; i < n; i++) {
+      /* Second term ensures that the pdf is non-null */
+      cdf[i] = (cdf[i] >> 1) + i + 1;
+    }
+  }
+  for (i = val; i < n; i++) cdf[i] += increment;
+}
@@ -84,8 +84,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 # define OD_EC_REDUCED_OVERHEAD (1)
 
 /*OPT: od_ec_window must be at least 32 bits, but if you have fast arithmetic
-   on a larger type, you can speed up the decoder by using it here.*/
+   on a larger type, you can speed up the decoder by using it here.
+  Configuring with --enable-ec-window64 selects a 64-bit window, which lets the
+   decoder refill up to 8 bytes at a time.
+  The bitstream does not depend on the window size.*/
+# if defined(OD_EC_WINDOW64)
+typedef uint64_t od_ec_window;
+# else
 typedef uint32_t od_ec_window;
+# endif
 
 # define OD_EC_WINDOW_SIZE ((int)sizeof(od_ec_window)*CHAR_BIT)
 
@@ -111,9 +118,21 @@ extern const uint16_t OD_UNIFORM_CDFS_Q15[135];
 # define OD_UNIFORM_CDF_Q15(n) \
    (OD_UNIFORM_CDFS_Q15 + ((n)*((n) - 1) >> 1) - 1)
 
+/*Returns the index of the first entry of cdf greater than q.
+  cdf[nsyms - 1] must be greater than q.*/
+typedef int (*od_ec_cdf_search_func)(const uint16_t *cdf, int nsyms,
+ unsigned q);
+/*Adapts an n-entry CDF after coding the value val, halving it first if
+   adding increment would overflow 15 bits.*/
+typedef void (*od_ec_cdf_adapt_func)(uint16_t *cdf, int val, int n,
+ int increment);
+
 /*See entcode.c for further documentation.*/
 
 OD_WARN_UNUSED_RESULT uint32_t od_ec_tell_frac(uint32_t nbits_total,
  uint32_t rng);
 
+int od_ec_cdf_search_c(const uint16_t *cdf, int nsyms, unsigned q);
+void od_ec_cdf_adapt_c(uint16_t *cdf, int val, int n, int increment);
+
 #endif
@@ -106,6 +106,16 @@ static void od_process_accounting(od_ec_dec *dec, char *str) {
   Even relatively modest values like 100 would work fine.*/
 #define OD_EC_LOTS_OF_BITS (0x4000)
 
+/*Reads a whole window's worth of bytes from the stream in big-endian order.
+  Compilers turn this into a single (byte-swapped) load.*/
+static od_ec_window od_ec_dec_load_window(const unsigned char *bptr) {
+  od_ec_window w;
+  int i;
+  w = 0;
+  for (i = 0; i < (int)sizeof(w); i++) w = w << 8 | bptr[i];
+  return w;
+}
+
 static void od_ec_dec_refill(od_ec_dec *dec) {
   int s;
   od_ec_window dif;
@@ -117,6 +127,19 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   bptr = dec->bptr;
   end = dec->end;
   s = OD_EC_WINDOW_SIZE - 9 - (cnt + 15);
+  /*Away from the end of the stream, read all the bytes that fit in dif with a
+     single load instead of one at a time.
+    This takes s/8 + 1 bytes, the same number as the loop below.*/
+  if (s >= 0 && end - bptr >= (int)sizeof(od_ec_window)) {
+    int n;
+    OD_ASSERT(s <= OD_EC_WINDOW_SIZE - 8);
+    n = (s >> 3) + 1;
+    dif |= od_ec_dec_load_window(bptr) >> (OD_EC_WINDOW_SIZE - 8*n)
+     << (s & 7);
+    bptr += n;
+    cnt += 8*n;
+    s -= 8*n;
+  }
   for (; s >= 0 && bptr < end; s -= 8, bptr++) {
     OD_ASSERT(s <= OD_EC_WINDOW_SIZE - 8);
     dif |= (od_ec_window)bptr[0] << s;
@@ -161,13 +184,17 @@ void od_ec_dec_init(od_ec_dec *dec,
   dec->eptr = buf + storage;
   dec->end_window = 0;
   dec->nend_bits = 0;
-  dec->tell_offs = 10 - (OD_EC_WINDOW_SIZE - 8);
+  /*Refills add every bit they read to cnt, which starts at -15, so this makes
+     od_ec_dec_tell() start at 1 bit, like the encoder, for any window size.*/
+  dec->tell_offs = 1 - 15;
   dec->end = buf + storage;
   dec->bptr = buf;
   dec->dif = 0;
   dec->rng = 0x8000;
   dec->cnt = -15;
   dec->error = 0;
+  dec->cdf_search = od_ec_cdf_search_c;
+  dec->cdf_adapt = od_ec_cdf_adapt_c;
   od_ec_dec_refill(dec);
 #if OD_ACCOUNTING
   dec->acct = NULL;
@@ -300,9 +327,9 @@ int od_ec_decode_cdf_(od_ec_dec *dec, const uint16_t *cdf, int nsyms OD_ACC_STR)
 #endif
   q >>= s;
   OD_ASSERT(q < ft >> s);
-  fl = 0;
-  ret = 0;
-  for (fh = cdf[ret]; fh <= q; fh = cdf[++ret]) fl = fh;
+  ret = (*dec->cdf_search)(cdf, nsyms, q);
+  fl = ret > 0 ? cdf[ret - 1] : 0;
+  fh = cdf[ret];
   OD_ASSERT(fh <= ft >> s);
   fl <<= s;
   fh <<= s;
@@ -340,7 +367,6 @@ int od_ec_decode_cdf_q15_(od_ec_dec *dec, const uint16_t *cdf, int nsyms OD_ACC_
   unsigned fl;
   unsigned fh;
   int ret;
-  (void)nsyms;
   dif = dec->dif;
   r = dec->rng;
   OD_ASSERT(dif >> (OD_EC_WINDOW_SIZE - 16) < r);
@@ -357,9 +383,9 @@ int od_ec_decode_cdf_q15_(od_ec_dec *dec, const uint16_t *cdf, int nsyms OD_ACC_
   q = OD_MAXI((int)q, (int)((2*(int32_t)c + 1 - (int32_t)e)/3));
 #endif
   OD_ASSERT(q < 32768U);
-  fl = 0;
-  ret = 0;
-  for (fh = cdf[ret]; fh <= q; fh = cdf[++ret]) fl = fh;
+  ret = (*dec->cdf_search)(cdf, nsyms, q);
+  fl = ret > 0 ? cdf[ret - 1] : 0;
+  fh = cdf[ret];
   OD_ASSERT(fh <= 32768U);
 #if OD_EC_REDUCED_OVERHEAD
   u = fl + OD_MINI(fl, e) + OD_MINI(OD_SUBSATU(fl, e) >> 1, d);
@@ -423,9 +449,9 @@ int od_ec_decode_cdf_unscaled_(od_ec_dec *dec,
 #endif
   q >>= s;
   OD_ASSERT(q < ft >> s);
-  fl = 0;
-  ret = 0;
-  for (fh = cdf[ret]; fh <= q; fh = cdf[++ret]) fl = fh;
+  ret = (*dec->cdf_search)(cdf, nsyms, q);
+  fl = ret > 0 ? cdf[ret - 1] : 0;
+  fh = cdf[ret];
   OD_ASSERT(fh <= ft >> s);
   fl <<= s;
   fh <<= s;
@@ -467,7 +493,6 @@ int od_ec_decode_cdf_unscaled_dyadic_(od_ec_dec *dec,
   unsigned fl;
   unsigned fh;
   int ret;
-  (void)nsyms;
   dif = dec->dif;
   r = dec->rng;
   OD_ASSERT(dif >> (OD_EC_WINDOW_SIZE - 16) < r);
@@ -486,9 +511,9 @@ int od_ec_decode_cdf_unscaled_dyadic_(od_ec_dec *dec,
 #endif
   q >>= s;
   OD_ASSERT(q < 1U << ftb);
-  fl = 0;
-  ret = 0;
-  for (fh = cdf[ret]; fh <= q; fh = cdf[++ret]) fl = fh;
+  ret = (*dec->cdf_search)(cdf, nsyms, q);
+  fl = ret > 0 ? cdf[ret - 1] : 0;
+  fh = cdf[ret];
   OD_ASSERT(fh <= 1U << ftb);
   fl <<= s;
   fh <<= s;
@@ -80,6 +80,11 @@ struct od_ec_dec {
   int16_t cnt;
   /*Nonzero if an error occurred.*/
   int error;
+  /*The CDF search and adaptation functions.
+    These are set to the C versions by od_ec_dec_init(), and can be replaced
+     by the caller afterwards.*/
+  od_ec_cdf_search_func cdf_search;
+  od_ec_cdf_adapt_func cdf_adapt;
 #if OD_ACCOUNTING
   od_accounting_internal *acct;
 #endif
@@ -117,6 +117,8 @@ static void od_ec_enc_normalize(od_ec_enc *enc,
   size: The initial size of the buffer, in bytes.*/
 void od_ec_enc_init(od_ec_enc *enc, uint32_t size) {
   od_ec_enc_reset(enc);
+  enc->log = NULL;
+  enc->cdf_adapt = od_ec_cdf_adapt_c;
   enc->buf = (unsigned char *)malloc(sizeof(*enc->buf)*size);
   enc->storage = size;
   if (size > 0 && enc->buf == NULL) {
@@ -686,21 +688,146 @@ void od_ec_enc_checkpoint(od_ec_enc *dst, const od_ec_enc *src) {
    state's history: you can not switch backwards and forwards or otherwise
    switch to a state which isn't a casual ancestor of the current state.
   Restore is also incompatible with patching the initial bits, as the
-   changes will remain in the restored version.*/
+   changes will remain in the restored version.
+  Errors are not rolled back, since the log of adaptation changes may have
+   become incomplete.*/
 void od_ec_enc_rollback(od_ec_enc *dst, const od_ec_enc *src) {
   unsigned char *buf;
   uint32_t storage;
   uint16_t *precarry_buf;
   uint32_t precarry_storage;
+  od_ec_log *log;
+  int error;
   OD_ASSERT(dst->storage >= src->storage);
   OD_ASSERT(dst->precarry_storage >= src->precarry_storage);
   buf = dst->buf;
   storage = dst->storage;
   precarry_buf = dst->precarry_buf;
   precarry_storage = dst->precarry_storage;
+  log = dst->log;
+  error = dst->error;
   OD_COPY(dst, src, 1);
   dst->buf = buf;
   dst->storage = storage;
   dst->precarry_buf = precarry_buf;
   dst->precarry_storage = precarry_storage;
+  dst->log = log;
+  dst->error |= error;
+}
+
+/*Initializes an empty adaptation log.*/
+void od_ec_log_init(od_ec_log *log) {
+  OD_CLEAR(log, 1);
+}
+
+/*Frees the buffers used by the log.*/
+void od_ec_log_clear(od_ec_log *log) {
+  free(log->entries);
+  free(log->redo);
+}
+
+/*Empties the log and starts tracking the size bytes at base.
+  Every checkpoint taken before this becomes invalid.*/
+void od_ec_log_reset(od_ec_log *log, void *base, size_t size) {
+  log->base = (unsigned char *)base;
+  log->size = size;
+  log->nentries = 0;
+  log->nredo = 0;
+}
+
+/*Makes room for one more entry in *entries.
+  Return: The new entry, or NULL on allocation failure.*/
+static od_ec_log_entry *od_ec_log_entry_push(od_ec_log_entry **entries,
+ int *nentries, int *centries) {
+  if (*nentries >= *centries) {
+    od_ec_log_entry *grown;
+    int cgrown;
+    cgrown = OD_MAXI(2*(*centries), 256);
+    grown = (od_ec_log_entry *)realloc(*entries, cgrown*sizeof(*grown));
+    if (OD_UNLIKELY(grown == NULL)) return NULL;
+    *entries = grown;
+    *centries = cgrown;
+  }
+  return *entries + (*nentries)++;
+}
+
+/*Saves the size bytes at ptr in the encoder's adaptation log before the
+   caller changes them.
+  This does nothing if there is no log, or if ptr lies outside the context it
+   tracks (e.g., a temporary copy of a model).
+  On allocation failure, the encoder is put in an error state, since a later
+   rollback would leave the models out of sync with the decoder.*/
+void od_ec_enc_log(od_ec_enc *enc, void *ptr, size_t size) {
+  od_ec_log *log;
+  unsigned char *p;
+  log = enc->log;
+  p = (unsigned char *)ptr;
+  if (log == NULL || p < log->base || p >= log->base + log->size) return;
+  OD_ASSERT(p + size <= log->base + log->size);
+  while (size > 0) {
+    od_ec_log_entry *e;
+    size_t n;
+    e = od_ec_log_entry_push(&log->entries, &log->nentries, &log->centries);
+    if (OD_UNLIKELY(e == NULL)) {
+      enc->error = -1;
+      return;
+    }
+    n = OD_MINI(size, OD_EC_LOG_ENTRY_MAX);
+    e->offs = (uint32_t)(p - log->base);
+    e->size = (uint32_t)n;
+    OD_COPY(e->data, p, n);
+    p += n;
+    size -= n;
+  }
+}
+
+/*Restores the tracked context to what it was when the log held pos entries,
+   and drops the newer entries.*/
+void od_ec_log_undo(od_ec_log *log, int pos) {
+  int i;
+  OD_ASSERT(pos <= log->nentries);
+  for (i = log->nentries; i-- > pos;) {
+    od_ec_log_entry *e;
+    e = log->entries + i;
+    OD_COPY(log->base + e->offs, e->data, e->size);
+  }
+  log->nentries = pos;
+}
+
+/*Saves the current contents of everything changed since the log held pos
+   entries, so that after undoing back to pos, od_ec_enc_redo() can bring the
+   context forward to its current state again.
+  The saved entries are [*redo_start, *redo_end) of the redo stack.*/
+void od_ec_enc_save_redo(od_ec_enc *enc, int pos,
+ int *redo_start, int *redo_end) {
+  od_ec_log *log;
+  int i;
+  log = enc->log;
+  *redo_start = log->nredo;
+  for (i = pos; i < log->nentries; i++) {
+    od_ec_log_entry *e;
+    e = od_ec_log_entry_push(&log->redo, &log->nredo, &log->credo);
+    if (OD_UNLIKELY(e == NULL)) {
+      enc->error = -1;
+      break;
+    }
+    e->offs = log->entries[i].offs;
+    e->size = log->entries[i].size;
+    OD_COPY(e->data, log->base + e->offs, e->size);
+  }
+  *redo_end = log->nredo;
+}
+
+/*Reapplies the redo entries [redo_start, redo_end).
+  The changes are logged like any other, so they can be undone again.*/
+void od_ec_enc_redo(od_ec_enc *enc, int redo_start, int redo_end) {
+  od_ec_log *log;
+  int i;
+  log = enc->log;
+  for (i = redo_start; i < redo_end; i++) {
+    od_ec_log_entry *e;
+    e = log->redo + i;
+    od_ec_enc_log(enc, log->base + e->offs, e->size);
+    OD_COPY(log->base + e->offs, e->data, e->size);
+  }
 }
@@ -27,9 +27,44 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 # include <stddef.h>
 # include "entcode.h"
 typedef struct od_ec_enc od_ec_enc;
+typedef struct od_ec_log_entry od_ec_log_entry;
+typedef struct od_ec_log od_ec_log;
 
 #define OD_MEASURE_EC_OVERHEAD (0)
 
+/*The largest number of bytes saved by a single log entry.
+  This is enough for a whole 16-symbol CDF.*/
+# define OD_EC_LOG_ENTRY_MAX (32)
+
+/*A copy of some bytes of the context tracked by an od_ec_log.*/
+struct od_ec_log_entry {
+  /*The offset of the first byte from the start of the context.*/
+  uint32_t offs;
+  /*The number of bytes saved.*/
+  uint32_t size;
+  unsigned char data[OD_EC_LOG_ENTRY_MAX];
+};
+
+/*An undo log of the changes made to the adaptive models while encoding.
+  Each time a model is adapted, the bytes about to change are saved first, so
+   rolling back to a checkpoint only has to restore what was actually coded
+   since then, rather than copying the whole adaptation context.*/
+struct od_ec_log {
+  /*The context being tracked.
+    Changes to memory outside of it are not logged.*/
+  unsigned char *base;
+  size_t size;
+  /*The undo entries, oldest first.*/
+  od_ec_log_entry *entries;
+  int nentries;
+  int centries;
+  /*The saved contents of the context used to roll forward again (see
+     od_ec_log_save_redo()).*/
+  od_ec_log_entry *redo;
+  int nredo;
+  int credo;
+};
+
 /*The entropy encoder context.*/
 struct od_ec_enc {
   /*Buffered output.
@@ -58,6 +93,12 @@ struct od_ec_enc {
   int16_t cnt;
   /*Nonzero if an error occurred.*/
   int error;
+  /*The log of adaptation changes, or NULL if they are not being tracked.*/
+  od_ec_log *log;
+  /*The CDF adaptation function.
+    This is set to the C version by od_ec_enc_init(), and can be replaced by
+     the caller afterwards.*/
+  od_ec_cdf_adapt_func cdf_adapt;
 #if OD_MEASURE_EC_OVERHEAD
   double entropy;
   int nb_symbols;
@@ -102,4 +143,16 @@ OD_WARN_UNUSED_RESULT uint32_t od_ec_enc_tell_frac(od_ec_enc *enc)
 void od_ec_enc_checkpoint(od_ec_enc *dst, const od_ec_enc *src);
 void od_ec_enc_rollback(od_ec_enc *dst, const od_ec_enc *src);
 
+void od_ec_log_init(od_ec_log *log) OD_ARG_NONNULL(1);
+void od_ec_log_clear(od_ec_log *log) OD_ARG_NONNULL(1);
+void od_ec_log_reset(od_ec_log *log, void *base, size_t size)
+ OD_ARG_NONNULL(1);
+void od_ec_enc_log(od_ec_enc *enc, void *ptr, size_t size)
+ OD_ARG_NONNULL(1) OD_ARG_NONNULL(2);
+void od_ec_log_undo(od_ec_log *log, int pos) OD_ARG_NONNULL(1);
+void od_ec_enc_save_redo(od_ec_enc *enc, int pos,
+ int *redo_start, int *redo_end) OD_ARG_NONNULL(1);
+void od_ec_enc_redo(od_ec_enc *enc, int redo_start, int redo_end)
+ OD_ARG_NONNULL(1);
+
 #endif
@@ -126,6 +126,20 @@ const od_filter_func OD_POST_FILTER[OD_NBSIZES] = {
   od_post_filter32
 };
 
+const od_filter_cols_func OD_PRE_FILTER_COLS_C[OD_NBSIZES] = {
+  od_pre_filter_cols4_c,
+  od_pre_filter_cols8_c,
+  od_pre_filter_cols16_c,
+  od_pre_filter_cols32_c
+};
+
+const od_filter_cols_func OD_POST_FILTER_COLS_C[OD_NBSIZES] = {
+  od_post_filter_cols4_c,
+  od_post_filter_cols8_c,
+  od_post_filter_cols16_c,
+  od_post_filter_cols32_c
+};
+
 const od_filter_dering_direction_func
  OD_DERING_DIRECTION_C[OD_DERINGSIZES] = {
   od_filter_dering_direction_4x4_c,
@@ -1372,6 +1386,52 @@ void od_post_filter32(od_coeff _x[32], const od_coeff _y[32]) {
 #endif
 }
 
+/*Filters n adjacent columns one at a time by gathering each of them into a
+   contiguous buffer.*/
+static void od_filter_cols_c(od_coeff *c, int stride, int n,
+ od_filter_func filter, int f) {
+  int j;
+  int k;
+  od_coeff t[4 << OD_NBSIZES];
+  for (j = 0; j < n; j++) {
+    for (k = 0; k < 4 << f; k++) t[k] = c[stride*k + j];
+    (*filter)(t, t);
+    for (k = 0; k < 4 << f; k++) c[stride*k + j] = t[k];
+  }
+}
+
+void od_pre_filter_cols4_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_pre_filter4, 0);
+}
+
+void od_post_filter_cols4_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_post_filter4, 0);
+}
+
+void od_pre_filter_cols8_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_pre_filter8, 1);
+}
+
+void od_post_filter_cols8_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_post_filter8, 1);
+}
+
+void od_pre_filter_cols16_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_pre_filter16, 2);
+}
+
+void od_post_filter_cols16_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_post_filter16, 2);
+}
+
+void od_pre_filter_cols32_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_pre_filter32, 3);
+}
+
+void od_post_filter_cols32_c(od_coeff *c, int stride, int n) {
+  od_filter_cols_c(c, stride, n, od_post_filter32, 3);
+}
+
 #if OD_DEBLOCKING
 
 /* This is a slightly modified implementation of the Thor deblocking filter
@@ -1483,22 +1543,16 @@ void od_thor_deblock_row8(od_coeff *c0, int stride, int q) {
 #define OD_BLOCK_SIZE4x4_DEC(bsize, bstride, bx, by, dec) \
  OD_MAXI(OD_BLOCK_SIZE4x4(bsize, bstride, bx, by), dec)
 
-void od_prefilter_split(od_coeff *c0, int stride, int bs, int f, int hfilter,
- int vfilter) {
+void od_prefilter_split(od_state *state, od_coeff *c0, int stride, int bs,
+ int f, int hfilter, int vfilter) {
 #if OD_DEBLOCKING
+  (void)state;
 #else
   int i;
-  int j;
   od_coeff *c;
   if (hfilter) {
     c = c0 + ((2 << bs) - (2 << f))*stride;
-    for (j = 0; j < 4 << bs; j++) {
-      int k;
-      od_coeff t[4 << OD_NBSIZES];
-      for (k = 0; k < 4 << f; k++) t[k] = c[stride*k + j];
-      (*OD_PRE_FILTER[f])(t, t);
-      for (k = 0; k < 4 << f; k++) c[stride*k + j] = t[k];
-    }
+    (*state->opt_vtbl.pre_filter_cols[f])(c, stride, 4 << bs);
   }
   if (vfilter) {
     c = c0 + (2 << bs) - (2 << f);
@@ -1509,11 +1563,13 @@ void od_prefilter_split(od_coeff *c0, int stride, int bs, int f, int hfilter,
 #endif
 }
 
-void od_postfilter_split(od_coeff *c0, int stride, int bs, int f, int q,
- unsigned char *skip, int skip_stride, int hfilter, int vfilter) {
+void od_postfilter_split(od_state *state, od_coeff *c0, int stride, int bs,
+ int f, int q, unsigned char *skip, int skip_stride, int hfilter,
+ int vfilter) {
   int i;
   od_coeff *c;
 #if OD_DEBLOCKING
+  (void)state;
   if (bs==0) return;
   c = c0 + (2 << bs);
   for (i = 0; i < 4 << bs; i += 8) {
@@ -1530,7 +1586,6 @@ void od_postfilter_split(od_coeff *c0, int stride, int bs, int f, int q,
     }
   }
 #else
-  int j;
   (void)q;
   (void)skip;
   (void)skip_stride;
@@ -1542,42 +1597,50 @@ void od_postfilter_split(od_coeff *c0, int stride, int bs, int f, int q,
   }
   if (hfilter) {
     c = c0 + ((2 << bs) - (2 << f))*stride;
-    for (j = 0; j < 4 << bs; j++) {
-      int k;
-      od_coeff t[4 << OD_NBSIZES];
-      for (k = 0; k < 4 << f; k++) t[k] = c[stride*k + j];
-      (*OD_POST_FILTER[f])(t, t);
-      for (k = 0; k < 4 << f; k++) c[stride*k + j] = t[k];
-    }
+    (*state->opt_vtbl.post_filter_cols[f])(c, stride, 4 << bs);
   }
 #endif
 }
 
-void od_apply_prefilter_frame_sbs(od_coeff *c0, int stride, int nhsb, int nvsb,
- int xdec, int ydec) {
+/*Applies the superblock prefilter to one row of superblocks: the horizontal
+   edge between rows sby and sby + 1, followed by the vertical edges between
+   the superblocks in row sby.
+  Row sby + 1 must already hold its unfiltered input, and the top of it is
+   modified, so row sby is final once this returns, but row sby + 1 is not.
+  Calling this for every row in order is equivalent to filtering all the
+   horizontal edges in the frame before all the vertical edges, because the
+   vertical edges of a row are filtered after both of its horizontal
+   edges.*/
+void od_apply_prefilter_sb_row(od_state *state, od_coeff *c0, int stride,
+ int nhsb, int nvsb, int sby, int xdec, int ydec) {
 #if OD_DEBLOCKING
+  (void)state;
+  (void)c0;
+  (void)stride;
+  (void)nhsb;
+  (void)nvsb;
+  (void)sby;
+  (void)xdec;
+  (void)ydec;
 #else
   int sbx;
-  int sby;
   int i;
-  int j;
   int f;
   od_coeff *c;
   f = OD_FILT_SIZE(OD_NBSIZES - 1, xdec);
-  c = c0 + ((OD_BSIZE_MAX >> ydec) - (2 << f))*stride;
-  for (sby = 1; sby < nvsb; sby++) {
-    for (j = 0; j < nhsb << OD_LOG_BSIZE_MAX >> xdec; j++) {
-      int k;
-      od_coeff t[4 << OD_NBSIZES];
-      for (k = 0; k < 4 << f; k++) t[k] = c[stride*k + j];
-      (*OD_PRE_FILTER[f])(t, t);
-      for (k = 0; k < 4 << f; k++) c[stride*k + j] = t[k];
+  if (sby + 1 < nvsb) {
+    c = c0 + (((sby + 1)*OD_BSIZE_MAX >> ydec) - (2 << f))*stride;
+    /*Filter one superblock's worth of columns at a time, so that the
+       accelerated versions only ever see a bounded number of columns.*/
+    for (sbx = 0; sbx < nhsb; sbx++) {
+      (*state->opt_vtbl.pre_filter_cols[f])(c + (sbx*OD_BSIZE_MAX >> xdec),
+       stride, OD_BSIZE_MAX >> xdec);
     }
-    c += OD_BSIZE_MAX*stride >> ydec;
   }
-  c = c0 + (OD_BSIZE_MAX >> ydec) - (2 << f);
+  c = c0 + (OD_BSIZE_MAX >> xdec) - (2 << f)
+   + (sby*OD_BSIZE_MAX*stride >> ydec);
   for (sbx = 1; sbx < nhsb; sbx++) {
-    for (i = 0; i < nvsb << OD_LOG_BSIZE_MAX >> ydec; i++) {
+    for (i = 0; i < OD_BSIZE_MAX >> ydec; i++) {
       (*OD_PRE_FILTER[f])(c + i*stride, c + i*stride);
     }
     c += OD_BSIZE_MAX >> xdec;
@@ -1585,66 +1648,116 @@ void od_apply_prefilter_frame_sbs(od_coeff *c0, int stride, int nhsb, int nvsb,
 #endif
 }
 
-void od_apply_postfilter_frame_sbs(od_coeff *c0, int stride, int nhsb,
- int nvsb, int xdec, int ydec, int q, unsigned char *skip, int skip_stride) {
+void od_apply_prefilter_frame_sbs(od_state *state, od_coeff *c0, int stride,
+ int nhsb, int nvsb, int xdec, int ydec) {
+  int sby;
+  for (sby = 0; sby < nvsb; sby++) {
+    od_apply_prefilter_sb_row(state, c0, stride, nhsb, nvsb, sby, xdec, ydec);
+  }
+}
+
+/*Applies the superblock postfilter to one row of superblocks: the vertical
+   edges between the superblocks in row sby, followed by the horizontal edge
+   between rows sby - 1 and sby.
+  The horizontal edge filter modifies the bottom of row sby - 1, so that row
+   is only final once this has been called for row sby.
+  Calling this for every row in order is equivalent to filtering all the
+   vertical edges in the frame before all the horizontal edges, because the
+   horizontal edges only read pixels whose vertical edges are already done.*/
+void od_apply_postfilter_sb_row(od_state *state, od_coeff *c0, int stride,
+ int nhsb, int sby, int xdec, int ydec, int q, unsigned char *skip,
+ int skip_stride) {
 #if OD_DEBLOCKING
   od_coeff *c;
   int sbx;
-  int sby;
-  c = c0 + (OD_BSIZE_MAX >> ydec);
+  int i;
+  int j;
+  (void)state;
+  c = c0 + (OD_BSIZE_MAX >> ydec) + (sby*OD_BSIZE_MAX*stride >> ydec);
   for (sbx = 1; sbx < nhsb; sbx++) {
-    int i;
-    for (i = 0; i < nvsb << OD_LOG_BSIZE_MAX >> ydec; i+=8) {
+    for (i = sby*OD_BSIZE_MAX >> ydec; i < (sby + 1)*OD_BSIZE_MAX >> ydec;
+     i += 8) {
       if (!skip[(i >> 2)*skip_stride + (sbx << 3 >> xdec) - 1]
        || !skip[(i >> 2)*skip_stride + (sbx << 3 >> xdec)]) {
-        od_thor_deblock_col8(c + i*stride, stride, q);
+        od_thor_deblock_col8(c + (i - (sby*OD_BSIZE_MAX >> ydec))*stride,
+         stride, q);
       }
     }
     c += OD_BSIZE_MAX >> xdec;
   }
-  c = c0 + (OD_BSIZE_MAX >> ydec)*stride;
-  for (sby = 1; sby < nvsb; sby++) {
-    int j;
-    for (j = 0; j < nhsb << OD_LOG_BSIZE_MAX >> xdec; j+=8) {
+  if (sby > 0) {
+    c = c0 + (sby*OD_BSIZE_MAX*stride >> ydec);
+    for (j = 0; j < nhsb << OD_LOG_BSIZE_MAX >> xdec; j += 8) {
       if (!skip[((sby << 3 >> xdec) - 1)*skip_stride + (j >> 2)]
        || !skip[(sby << 3 >> xdec)*skip_stride + (j >> 2)]) {
         od_thor_deblock_row8(c + j, stride, q);
       }
     }
-    c += OD_BSIZE_MAX*stride >> ydec;
   }
 #else
   int sbx;
-  int sby;
   int i;
-  int j;
   int f;
   od_coeff *c;
   (void)q;
   (void)skip;
   (void)skip_stride;
   f = OD_FILT_SIZE(OD_NBSIZES - 1, xdec);
-  c = c0 + (OD_BSIZE_MAX >> ydec) - (2 << f);
+  c = c0 + (OD_BSIZE_MAX >> ydec) - (2 << f)
+   + (sby*OD_BSIZE_MAX*stride >> ydec);
   for (sbx = 1; sbx < nhsb; sbx++) {
-    for (i = 0; i < nvsb << OD_LOG_BSIZE_MAX >> ydec; i++) {
+    for (i = 0; i < OD_BSIZE_MAX >> ydec; i++) {
       (*OD_POST_FILTER[f])(c + i*stride, c + i*stride);
     }
     c += OD_BSIZE_MAX >> xdec;
   }
-  c = c0 + ((OD_BSIZE_MAX >> ydec) - (2 << f))*stride;
-  for (sby = 1; sby < nvsb; sby++) {
-    for (j = 0; j < nhsb << OD_LOG_BSIZE_MAX >> xdec; j++) {
-      int k;
-      od_coeff t[4 << OD_NBSIZES];
-      for (k = 0; k < 4 << f; k++) t[k] = c[stride*k + j];
-      (*OD_POST_FILTER[f])(t, t);
-      for (k = 0; k < 4 << f; k++) c[stride*k + j] = t[k];
+  if (sby > 0) {
+    c = c0 + ((sby*OD_BSIZE_MAX >> ydec) - (2 << f))*stride;
+    for (sbx = 0; sbx < nhsb; sbx++) {
+      (*state->opt_vtbl.post_filter_cols[f])(c + (sbx*OD_BSIZE_MAX >> xdec),
+       stride, OD_BSIZE_MAX >> xdec);
     }
-    c += OD_BSIZE_MAX*stride >> ydec;
   }
 #endif
 }
 
+void od_apply_postfilter_frame_sbs(od_state *state, od_coeff *c0,
+ int stride, int nhsb, int nvsb, int xdec, int ydec, int q,
+ unsigned char *skip, int skip_stride) {
+  int sby;
+  for (sby = 0; sby < nvsb; sby++) {
+    od_apply_postfilter_sb_row(state, c0, stride, nhsb, sby, xdec, ydec, q,
+     skip, skip_stride);
+  }
+}
+
+/*Reciprocals ceil(2^31/d) of the line lengths d used to normalize the squared
+   partial sums of od_dir_find8_c(), for SIMD versions that keep 8 partial
+   sums per vector.
+  For 0 <= x <= 2^28, (x*ceil(2^31/d)) >> 31 == x/d for all d <= 8, since the
+   error is below 1/8 and the fractional part of x/d is at most (d - 1)/d.
+  Row 0 is for the partial sums 7 down to 0 of direction 4 and row 1 for its
+   partial sums 14 down to 8, starting at lane 1.
+  Rows 2 and 3 are for the 11 partial sums of the odd directions in order.*/
+const uint32_t OD_DIR_DIVU31[4][8] = {
+  {
+    268435456U, 306783379U, 357913942U, 429496730U,
+    536870912U, 715827883U, 1073741824U, 2147483648U
+  },
+  {
+    0, 2147483648U, 1073741824U, 715827883U,
+    536870912U, 429496730U, 357913942U, 306783379U
+  },
+  {
+    1073741824U, 536870912U, 357913942U, 268435456U,
+    268435456U, 268435456U, 268435456U, 268435456U
+  },
+  {
+    357913942U, 536870912U, 1073741824U, 0,
+    0, 0, 0, 0
+  }
+};
+
 /* Detect direction. 0 means 45-degree up-right, 2 is horizontal, and so on.
    The search minimizes the weighted variance along all the lines in a
    particular direction, i.e. the squared error between the input and a
@@ -1652,7 +1765,7 @@ void od_apply_postfilter_frame_sbs(od_coeff *c0, int stride, int nhsb,
    in a particular direction. Since each direction have the same sum(x^2) term,
    that term is never computed. See Section 2, step 2, of:
    http://jmvalin.ca/notes/intra_paint.pdf */
-static int od_dir_find8(const int16_t *img, int stride, int32_t *var) {
+int od_dir_find8_c(const int16_t *img, int stride, int32_t *var) {
   int i;
   int cost[8] = {0};
   int partial[8][15] = {{0}};
@@ -1877,8 +1990,8 @@ void od_dering(od_state *state, int16_t *y, int ystride, int16_t *x, int
   if (pli == 0) {
     for (by = 0; by < nvb; by++) {
       for (bx = 0; bx < nhb; bx++) {
-        dir[by][bx] = od_dir_find8(&x[8*by*xstride + 8*bx], xstride,
-         &var[by][bx]);
+        dir[by][bx] = (*state->opt_vtbl.dir_find8)(&x[8*by*xstride + 8*bx],
+         xstride, &var[by][bx]);
         varsum += var[by][bx];
       }
     }
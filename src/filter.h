@@ -43,6 +43,13 @@ typedef int32_t od_coeff;
 # define OD_DCT_RSHIFT(_a, _b) OD_UNBIASED_RSHIFT32(_a, _b)
 
 typedef void (*od_filter_func)(od_coeff _out[], const od_coeff _in[]);
+/*Applies a pre/post filter in place to n adjacent columns starting at c.
+  Each column holds the 4 << f coefficients of one filter.*/
+typedef void (*od_filter_cols_func)(od_coeff *c, int stride, int n);
+/*Finds the dominant direction of an 8x8 block and the directional variance
+   for deringing.*/
+typedef int (*od_dir_find8_func)(const int16_t *img, int stride,
+ int32_t *var);
 typedef void (*od_filter_dering_direction_func)(int16_t *y, int ystride,
  int16_t *in, int threshold, int dir);
 typedef void (*od_filter_dering_orthogonal_func)(int16_t *y, int ystride,
@@ -50,6 +57,8 @@ typedef void (*od_filter_dering_orthogonal_func)(int16_t *y, int ystride,
 
 extern const od_filter_func OD_PRE_FILTER[OD_NBSIZES];
 extern const od_filter_func OD_POST_FILTER[OD_NBSIZES];
+extern const od_filter_cols_func OD_PRE_FILTER_COLS_C[OD_NBSIZES];
+extern const od_filter_cols_func OD_POST_FILTER_COLS_C[OD_NBSIZES];
 extern const od_filter_dering_direction_func
  OD_DERING_DIRECTION_C[OD_DERINGSIZES];
 extern const od_filter_dering_orthogonal_func
@@ -83,6 +92,15 @@ void od_post_filter16(od_coeff _x[16], const od_coeff _y[16]);
 void od_pre_filter32(od_coeff _y[32], const od_coeff _x[32]);
 void od_post_filter32(od_coeff _x[32], const od_coeff _y[32]);
 
+void od_pre_filter_cols4_c(od_coeff *c, int stride, int n);
+void od_post_filter_cols4_c(od_coeff *c, int stride, int n);
+void od_pre_filter_cols8_c(od_coeff *c, int stride, int n);
+void od_post_filter_cols8_c(od_coeff *c, int stride, int n);
+void od_pre_filter_cols16_c(od_coeff *c, int stride, int n);
+void od_post_filter_cols16_c(od_coeff *c, int stride, int n);
+void od_pre_filter_cols32_c(od_coeff *c, int stride, int n);
+void od_post_filter_cols32_c(od_coeff *c, int stride, int n);
+
 void od_apply_prefilter_frame(od_coeff *c, int w, int nhsb, int nvsb,
  const unsigned char *bsize, int bstride, int dec);
 void od_apply_postfilter_frame(od_coeff *c, int w, int nhsb, int nvsb,
@@ -103,11 +121,13 @@ void od_apply_postfilter_frame(od_coeff *c, int w, int nhsb, int nvsb,
 #define OD_FILT_BSTRIDE (OD_BSIZE_MAX + 2*OD_FILT_BORDER)
 
 extern const int direction_offsets_table[8][3];
+extern const uint32_t OD_DIR_DIVU31[4][8];
 extern const int OD_FILT_SIZE[OD_NBSIZES];
 void od_dering(struct od_state *state, int16_t *y, int ystride, int16_t *x,
  int xstride, int ln, int sbx, int sby, int nhsb, int nvsb, int q, int xdec,
  int dir[OD_DERING_NBLOCKS][OD_DERING_NBLOCKS], int pli, unsigned char *bskip,
  int skip_stride);
+int od_dir_find8_c(const int16_t *img, int stride, int32_t *var);
 void od_filter_dering_direction_c(int16_t *y, int ystride, int16_t *in,
  int ln, int threshold, int dir);
 void od_filter_dering_orthogonal_c(int16_t *y, int ystride, int16_t *in,
@@ -118,14 +138,21 @@ void od_bilinear_smooth(od_coeff *x, int ln, int stride, int q, int pli);
 void od_smooth_recursive(od_coeff *c, unsigned char *bsize, int bstride,
  int bx, int by, int bsi, int w, int xdec, int ydec, int min_bs,
   int quantizer, int pli);
-void od_prefilter_split(od_coeff *c0, int stride, int bs, int f, int hfilter,
+void od_prefilter_split(struct od_state *state, od_coeff *c0, int stride,
+ int bs, int f, int hfilter, int vfilter);
+void od_postfilter_split(struct od_state *state, od_coeff *c0, int stride,
+ int bs, int f, int q, unsigned char *skip, int skip_stride, int hfilter,
  int vfilter);
-void od_postfilter_split(od_coeff *c0, int stride, int bs, int f, int q,
- unsigned char *skip, int skip_stride, int hfilter, int vfilter);
-void od_apply_prefilter_frame_sbs(od_coeff *c, int stride, int nhsb, int nvsb,
- int xdec, int ydec);
-void od_apply_postfilter_frame_sbs(od_coeff *c, int stride, int nhsb, int nvsb,
- int xdec, int ydec, int q, unsigned char *skip, int skip_stride);
+void od_apply_prefilter_frame_sbs(struct od_state *state, od_coeff *c,
+ int stride, int nhsb, int nvsb, int xdec, int ydec);
+void od_apply_prefilter_sb_row(struct od_state *state, od_coeff *c,
+ int stride, int nhsb, int nvsb, int sby, int xdec, int ydec);
+void od_apply_postfilter_frame_sbs(struct od_state *state, od_coeff *c,
+ int stride, int nhsb, int nvsb, int xdec, int ydec, int q,
+ unsigned char *skip, int skip_stride);
+void od_apply_postfilter_sb_row(struct od_state *state, od_coeff *c,
+ int stride, int nhsb, int sby, int xdec, int ydec, int q,
+ unsigned char *skip, int skip_stride);
 void od_apply_filter_sb_rows(od_coeff *c, int stride, int nhsb, int nvsb,
  int xdec, int ydec, int inv, int bs);
 void od_apply_filter_sb_cols(od_coeff *c, int stride, int nhsb, int nvsb,
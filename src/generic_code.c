@@ -86,24 +86,13 @@ int log_ex(int ex_q16) {
  * @param [in]     id    id of the icdf to adapt
  * @param [in]     integration integration period of ExQ16 (leaky average over
  * 1<<integration samples)
+ * @param [in]     cdf_adapt function used to adapt the icdf (renormalizing
+ * it if we cannot add the increment)
  */
 void generic_model_update(generic_encoder *model, int *ex_q16, int x, int xs,
- int id, int integration) {
-  int i;
-  int xenc;
-  uint16_t *cdf;
-  cdf = model->cdf[id];
-  /* Renormalize if we cannot add increment */
-  if (cdf[15] + model->increment > 32767) {
-    for (i = 0; i < 16; i++) {
-      /* Second term ensures that the pdf is non-null */
-      cdf[i] = (cdf[i] >> 1) + i + 1;
-    }
-  }
+ int id, int integration, od_ec_cdf_adapt_func cdf_adapt) {
   /* Update freq count */
-  xenc = OD_MINI(15, xs);
-  /* This can be easily vectorized */
-  for (i = xenc; i < 16; i++) cdf[i] += model->increment;
+  (*cdf_adapt)(model->cdf[id], OD_MINI(15, xs), 16, model->increment);
   /* We could have saturated ExQ16 directly, but this is safe and simpler */
   x = OD_MINI(x, 32767);
   OD_IIR_DIADIC(*ex_q16, x << 16, integration);
@@ -82,6 +82,6 @@ int generic_decode_(od_ec_dec *dec, generic_encoder *model, int max,
 int log_ex(int ex_q16);
 
 void generic_model_update(generic_encoder *model, int *ex_q16, int x, int xs,
- int id, int integration);
+ int id, int integration, od_ec_cdf_adapt_func cdf_adapt);
 
 #endif
@@ -46,16 +46,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
  */
 int od_decode_cdf_adapt_(od_ec_dec *ec, uint16_t *cdf, int n,
  int increment OD_ACC_STR) {
-  int i;
   int val;
   val = od_ec_decode_cdf_unscaled(ec, cdf, n, acc_str);
-  if (cdf[n-1] + increment > 32767) {
-    for (i = 0; i < n; i++) {
-      /* Second term ensures that the pdf is non-null */
-      cdf[i] = (cdf[i] >> 1) + i + 1;
-    }
-  }
-  for (i = val; i < n; i++) cdf[i] += increment;
+  (*ec->cdf_adapt)(cdf, val, n, increment);
   return val;
 }
 
@@ -116,7 +109,8 @@ int generic_decode_(od_ec_dec *dec, generic_encoder *model, int max,
     lsb -= !special << (shift - 1);
   }
   x = (xs << shift) + lsb;
-  generic_model_update(model, ex_q16, x, xs, id, integration);
+  generic_model_update(model, ex_q16, x, xs, id, integration,
+   dec->cdf_adapt);
   OD_LOG((OD_LOG_ENTROPY_CODER, OD_LOG_DEBUG,
    "dec: %d %d %d %d %d %x", *ex_q16, x, shift, id, xs, dec->rng));
   return x;
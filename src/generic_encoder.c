@@ -46,15 +46,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
  */
 void od_encode_cdf_adapt(od_ec_enc *ec, int val, uint16_t *cdf, int n,
  int increment) {
-  int i;
   od_ec_encode_cdf_unscaled(ec, val, cdf, n);
-  if (cdf[n-1] + increment > 32767) {
-    for (i = 0; i < n; i++) {
-      /* Second term ensures that the pdf is non-null */
-      cdf[i] = (cdf[i] >> 1) + i + 1;
-    }
-  }
-  for (i = val; i < n; i++) cdf[i] += increment;
+  od_ec_enc_log(ec, cdf, n*sizeof(*cdf));
+  (*ec->cdf_adapt)(cdf, val, n, increment);
 }
 
 /** Encodes a random variable using a "generic" model, assuming that the
@@ -118,7 +112,10 @@ void generic_encode(od_ec_enc *enc, generic_encoder *model, int x, int max,
        shift - special);
     }
   }
-  generic_model_update(model, ex_q16, x, xs, id, integration);
+  od_ec_enc_log(enc, cdf, sizeof(model->cdf[id]));
+  od_ec_enc_log(enc, ex_q16, sizeof(*ex_q16));
+  generic_model_update(model, ex_q16, x, xs, id, integration,
+   enc->cdf_adapt);
   OD_LOG((OD_LOG_ENTROPY_CODER, OD_LOG_DEBUG,
    "enc: %d %d %d %d %d %x", *ex_q16, x, shift, id, xs, enc->rng));
 }
@@ -34,8 +34,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "tf.h"
 #include "state.h"
 
+/*Predicts the low frequencies of a block from the blocks above and to its
+   left, if they have the same size.
+  bx0, by0: The first 4x4 column and row that may be used for prediction
+   (the edge of the current tile).*/
 void od_hv_intra_pred(od_coeff *pred, const od_coeff *d, int w, int bx, int by,
- unsigned char *bsize, int bstride, int bs) {
+ int bx0, int by0, unsigned char *bsize, int bstride, int bs) {
   int i;
   const od_coeff *t;
   double g1;
@@ -44,8 +48,8 @@ void od_hv_intra_pred(od_coeff *pred, const od_coeff *d, int w, int bx, int by,
   int left;
   int n;
   n = 1 << (bs + OD_LOG_BSIZE0);
-  top = by > 0 && OD_BLOCK_SIZE4x4(bsize, bstride, bx, by - 1) == bs;
-  left = bx > 0 && OD_BLOCK_SIZE4x4(bsize, bstride, bx - 1, by) == bs;
+  top = by > by0 && OD_BLOCK_SIZE4x4(bsize, bstride, bx, by - 1) == bs;
+  left = bx > bx0 && OD_BLOCK_SIZE4x4(bsize, bstride, bx - 1, by) == bs;
   t = &d[((by << OD_LOG_BSIZE0))*w + (bx << OD_LOG_BSIZE0)];
   g1 = g2 = 0;
   if (top) for (i = 1; i < 4; i++) g1 += t[-n*w + i]*(double)t[-n*w + i];
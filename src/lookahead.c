@@ -0,0 +1,364 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "lookahead.h"
+#include "state.h"
+
+/*The log of the downscaling factor of the low-resolution planes.*/
+#define OD_LA_LOG_SCALE (2)
+/*The range of the low-resolution motion search, in each direction.*/
+#define OD_LA_SEARCH_RANGE (4)
+/*The minimum distance between a keyframe and a scene cut for the scene cut
+   to be coded as a keyframe.*/
+#define OD_LA_MIN_KEY_DIST (8)
+/*The growth in prediction error, in Q8, that is always tolerated when
+   moving a reference frame further away to make room for B frames.*/
+#define OD_LA_B_SLACK (2 << 8)
+
+/*Downscales a luma plane by box filtering.*/
+static void od_la_downscale(unsigned char *dst, int w, int h,
+ const od_img_plane *iplane) {
+  int shift;
+  int x;
+  int y;
+  shift = iplane->bitdepth - 8 + 2*OD_LA_LOG_SCALE;
+  for (y = 0; y < h; y++) {
+    for (x = 0; x < w; x++) {
+      const unsigned char *src;
+      int32_t sum;
+      int i;
+      int j;
+      src = iplane->data + (y << OD_LA_LOG_SCALE)*iplane->ystride
+       + (x << OD_LA_LOG_SCALE)*iplane->xstride;
+      sum = 0;
+      for (i = 0; i < 1 << OD_LA_LOG_SCALE; i++) {
+        for (j = 0; j < 1 << OD_LA_LOG_SCALE; j++) {
+          const unsigned char *p;
+          p = src + i*iplane->ystride + j*iplane->xstride;
+          sum += iplane->xstride == 1 ? *p : *(const uint16_t *)p;
+        }
+      }
+      dst[y*w + x] = (unsigned char)OD_CLAMP255(
+       (sum + (1 << shift >> 1)) >> shift);
+    }
+  }
+}
+
+/*Returns a total cost as a mean absolute difference per pixel in Q8.*/
+static uint32_t od_la_mean_cost(int64_t cost, int w, int h) {
+  return (uint32_t)(((cost << 8) + (w*h >> 1))/(w*h));
+}
+
+static int32_t od_la_sad(const unsigned char *a, const unsigned char *b,
+ int stride, int bw, int bh) {
+  int32_t sad;
+  int x;
+  int y;
+  sad = 0;
+  for (y = 0; y < bh; y++) {
+    for (x = 0; x < bw; x++) sad += abs(a[y*stride + x] - b[y*stride + x]);
+  }
+  return sad;
+}
+
+/*Computes the cost of coding each 8x8 block of a low-resolution plane
+   without prediction, as its mean absolute difference from its mean.*/
+static uint32_t od_la_intra_cost(const unsigned char *cur, int w, int h) {
+  int64_t cost;
+  int bx;
+  int by;
+  cost = 0;
+  for (by = 0; by < h; by += 8) {
+    for (bx = 0; bx < w; bx += 8) {
+      const unsigned char *blk;
+      int32_t mean;
+      int bw;
+      int bh;
+      int x;
+      int y;
+      bw = OD_MINI(8, w - bx);
+      bh = OD_MINI(8, h - by);
+      blk = cur + by*w + bx;
+      mean = 0;
+      for (y = 0; y < bh; y++) {
+        for (x = 0; x < bw; x++) mean += blk[y*w + x];
+      }
+      mean = (mean + (bw*bh >> 1))/(bw*bh);
+      for (y = 0; y < bh; y++) {
+        for (x = 0; x < bw; x++) cost += abs(blk[y*w + x] - mean);
+      }
+    }
+  }
+  return od_la_mean_cost(cost, w, h);
+}
+
+/*Computes the cost of predicting a low-resolution plane from another with
+   a full search over 8x8 blocks.*/
+static uint32_t od_la_inter_cost(const unsigned char *ref,
+ const unsigned char *cur, int w, int h) {
+  int64_t cost;
+  int bx;
+  int by;
+  cost = 0;
+  for (by = 0; by < h; by += 8) {
+    for (bx = 0; bx < w; bx += 8) {
+      const unsigned char *blk;
+      int32_t best;
+      int bw;
+      int bh;
+      int dx;
+      int dy;
+      bw = OD_MINI(8, w - bx);
+      bh = OD_MINI(8, h - by);
+      blk = cur + by*w + bx;
+      best = od_la_sad(blk, ref + by*w + bx, w, bw, bh);
+      for (dy = OD_MAXI(-OD_LA_SEARCH_RANGE, -by);
+       dy <= OD_MINI(OD_LA_SEARCH_RANGE, h - bh - by); dy++) {
+        for (dx = OD_MAXI(-OD_LA_SEARCH_RANGE, -bx);
+         dx <= OD_MINI(OD_LA_SEARCH_RANGE, w - bw - bx); dx++) {
+          int32_t sad;
+          sad = od_la_sad(blk, ref + (by + dy)*w + bx + dx, w, bw, bh);
+          best = OD_MINI(best, sad);
+        }
+      }
+      cost += best;
+    }
+  }
+  return od_la_mean_cost(cost, w, h);
+}
+
+/*Downscales a new frame and measures its costs.
+  This is the job run on the background thread.*/
+static void od_la_analyze(void *ctx, int framei) {
+  od_lookahead *la;
+  od_lookahead_frame *frame;
+  la = (od_lookahead *)ctx;
+  frame = la->frames + framei;
+  od_la_downscale(frame->lowres, la->w, la->h, frame->img->planes);
+  frame->intra_cost = od_la_intra_cost(frame->lowres, la->w, la->h);
+  frame->inter_cost = frame->prev == NULL ? 0 :
+   od_la_inter_cost(frame->prev, frame->lowres, la->w, la->h);
+}
+
+/*Initializes the lookahead.
+  cframes: The most frames that will be queued at once (at least 2).
+  async: Whether to analyze new frames on a background thread, if the
+   library was built with thread support.*/
+int od_lookahead_init(od_lookahead *la, const daala_info *info, int cframes,
+ int async) {
+  size_t plane_sz;
+  int framei;
+  OD_ASSERT(cframes >= 2);
+  la->w = (info->pic_width + (1 << OD_LA_LOG_SCALE) - 1) >> OD_LA_LOG_SCALE;
+  la->h = (info->pic_height + (1 << OD_LA_LOG_SCALE) - 1) >> OD_LA_LOG_SCALE;
+  plane_sz = (size_t)la->w*la->h;
+  la->frames = (od_lookahead_frame *)calloc(cframes, sizeof(*la->frames));
+  la->data = (unsigned char *)malloc(plane_sz*(cframes + 2));
+  if (OD_UNLIKELY(la->frames == NULL || la->data == NULL)) {
+    free(la->frames);
+    free(la->data);
+    return OD_EFAULT;
+  }
+  for (framei = 0; framei < cframes; framei++) {
+    la->frames[framei].lowres = la->data + plane_sz*framei;
+  }
+  la->anchor = la->data + plane_sz*cframes;
+  la->golden = la->anchor + plane_sz;
+  la->cframes = cframes;
+  la->head = 0;
+  la->nframes = 0;
+  la->have_anchor = 0;
+  la->have_golden = 0;
+  la->head_order = 0;
+  la->key_order = 0;
+  la->ip_since_golden = 0;
+  la->frames_to_key = 1;
+  la->npushed = 0;
+  la->plan_n = 0;
+  la->plan_pos = 0;
+  la->async = async && od_task_init(&la->task) == OD_SUCCESS;
+  return OD_SUCCESS;
+}
+
+void od_lookahead_clear(od_lookahead *la) {
+  if (la->async) od_task_clear(&la->task);
+  free(la->frames);
+  free(la->data);
+}
+
+/*Adds a frame to the queue and starts analyzing it.
+  img must stay unchanged until the frame is returned by
+   od_lookahead_next().*/
+void od_lookahead_push(od_lookahead *la, const od_img *img, int slot) {
+  od_lookahead_frame *frame;
+  int framei;
+  if (la->async) od_task_wait(&la->task);
+  OD_ASSERT(la->nframes < la->cframes);
+  framei = (la->head + la->nframes) % la->cframes;
+  frame = la->frames + framei;
+  frame->img = img;
+  frame->slot = slot;
+  frame->prev = la->npushed > 0 ?
+   la->frames[(framei + la->cframes - 1) % la->cframes].lowres : NULL;
+  la->nframes++;
+  la->npushed++;
+  if (la->async) od_task_start(&la->task, od_la_analyze, la, framei);
+  else od_la_analyze(la, framei);
+}
+
+static int od_la_is_scene_cut(const od_lookahead_frame *frame) {
+  return frame->prev != NULL && frame->inter_cost > frame->intra_cost;
+}
+
+/*Plans the next mini-GOP.
+  Unless flushing at the end of the input, the most recent frame is left out,
+   since it may still be being analyzed.*/
+static void od_la_plan(od_lookahead *la, int b_frames, int keyframe_rate,
+ int golden_interval, int flush) {
+  od_lookahead_frame *anchor;
+  uint32_t next_cost;
+  uint32_t anchor_cost;
+  int navail;
+  int nanchor;
+  int anchor_type;
+  int golden;
+  int framei;
+  int k;
+  la->plan_n = la->plan_pos = 0;
+  if (flush && la->async) od_task_wait(&la->task);
+  navail = flush ? la->nframes : la->nframes - 1;
+  if (navail <= 0) return;
+  /*Find the reference frame: the last frame before a keyframe, or the
+     furthest one that can still be predicted well from the last reference
+     frame.*/
+  nanchor = OD_MINI(b_frames + 1, navail);
+  anchor_type = OD_P_FRAME;
+  next_cost = anchor_cost = 0;
+  for (k = 1; k <= nanchor; k++) {
+    od_lookahead_frame *frame;
+    int64_t since_key;
+    frame = la->frames + (la->head + k - 1) % la->cframes;
+    since_key = la->head_order + k - 1 - la->key_order;
+    if (!la->have_anchor || since_key >= keyframe_rate
+     || (since_key >= OD_LA_MIN_KEY_DIST && od_la_is_scene_cut(frame))) {
+      if (k == 1) anchor_type = OD_I_FRAME;
+      nanchor = OD_MAXI(k - 1, 1);
+      break;
+    }
+    if (k == 1) next_cost = anchor_cost = frame->inter_cost;
+    else {
+      uint32_t cost;
+      /*The frame right after the last reference frame was predicted from
+         it during the analysis; stop once the prediction error over the
+         longer distance grows faster than the distance itself, as B frames
+         in between would then not be predicted much better.*/
+      cost = od_la_inter_cost(la->anchor, frame->lowres, la->w, la->h);
+      if (cost > (int64_t)(k + 1)*next_cost + OD_LA_B_SLACK) {
+        nanchor = k - 1;
+        break;
+      }
+      anchor_cost = cost;
+    }
+  }
+  framei = (la->head + nanchor - 1) % la->cframes;
+  anchor = la->frames + framei;
+  /*Decide whether to refresh the golden frame: always on keyframes, and
+     otherwise every golden_interval reference frames, unless the golden
+     frame is still about as good a predictor as the last reference frame
+     (then up to twice as long) or a scene cut is coming anyway.*/
+  if (anchor_type == OD_I_FRAME || !la->have_golden) golden = 1;
+  else if (la->ip_since_golden + 1 >= 2*golden_interval) golden = 1;
+  else if (la->ip_since_golden + 1 >= golden_interval) {
+    uint32_t golden_cost;
+    golden_cost = od_la_inter_cost(la->golden, anchor->lowres, la->w, la->h);
+    golden = 4*(int64_t)golden_cost > 5*(int64_t)anchor_cost;
+    for (k = nanchor; golden && k < navail; k++) {
+      od_lookahead_frame *frame;
+      frame = la->frames + (la->head + k) % la->cframes;
+      if (la->head_order + k - la->key_order >= OD_LA_MIN_KEY_DIST
+       && od_la_is_scene_cut(frame)) {
+        golden = 0;
+      }
+    }
+  }
+  else golden = 0;
+  /*Code the reference frame first, then the B frames before it.*/
+  la->plan_slot[0] = anchor->slot;
+  la->plan_type[0] = anchor_type;
+  la->plan_golden = golden;
+  for (k = 1; k < nanchor; k++) {
+    la->plan_slot[k] = la->frames[(la->head + k - 1) % la->cframes].slot;
+    la->plan_type[k] = OD_B_FRAME;
+  }
+  la->plan_n = nanchor;
+  memcpy(la->anchor, anchor->lowres, (size_t)la->w*la->h);
+  la->have_anchor = 1;
+  if (golden) {
+    memcpy(la->golden, anchor->lowres, (size_t)la->w*la->h);
+    la->have_golden = 1;
+    la->ip_since_golden = 0;
+  }
+  else la->ip_since_golden++;
+  if (anchor_type == OD_I_FRAME) {
+    la->key_order = la->head_order + nanchor - 1;
+  }
+  la->head = (la->head + nanchor) % la->cframes;
+  la->head_order += nanchor;
+  la->nframes -= nanchor;
+  navail -= nanchor;
+  /*Look for the next keyframe, for rate control.*/
+  la->frames_to_key = (int)OD_MAXI(1,
+   keyframe_rate - (la->head_order - la->key_order));
+  for (k = 0; k < navail && k < la->frames_to_key; k++) {
+    od_lookahead_frame *frame;
+    frame = la->frames + (la->head + k) % la->cframes;
+    if (la->head_order + k - la->key_order >= OD_LA_MIN_KEY_DIST
+     && od_la_is_scene_cut(frame)) {
+      la->frames_to_key = OD_MAXI(k, 1);
+    }
+  }
+}
+
+/*Returns the input buffer index of the next frame to code, along with its
+   frame type and whether it is a golden frame, or -1 if no frame is ready.
+  flush: Whether the end of the input has been reached.*/
+int od_lookahead_next(od_lookahead *la, int *frame_type, int *golden,
+ int b_frames, int keyframe_rate, int golden_interval, int flush) {
+  int i;
+  if (la->plan_pos >= la->plan_n) {
+    od_la_plan(la, b_frames, keyframe_rate, golden_interval, flush);
+    if (la->plan_n <= 0) return -1;
+  }
+  i = la->plan_pos++;
+  *frame_type = la->plan_type[i];
+  *golden = i == 0 && la->plan_golden;
+  return la->plan_slot[i];
+}
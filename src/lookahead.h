@@ -0,0 +1,110 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#if !defined(_lookahead_H)
+# define _lookahead_H (1)
+
+# include "internal.h"
+# include "thread.h"
+
+/*The longest lookahead that can be set with OD_SET_LOOKAHEAD, in frames.*/
+# define OD_MAX_LOOKAHEAD (16)
+
+typedef struct od_lookahead_frame od_lookahead_frame;
+typedef struct od_lookahead       od_lookahead;
+
+/*A frame waiting in the lookahead queue.*/
+struct od_lookahead_frame {
+  /*The input image of the frame, and its index in the encoder's input
+     buffer.*/
+  const od_img *img;
+  int slot;
+  /*The luma plane, downscaled by 4 in each direction.*/
+  unsigned char *lowres;
+  /*The low-resolution luma of the frame before this one, or NULL for the
+     first frame.*/
+  const unsigned char *prev;
+  /*The intra cost (about the mean of each 8x8 low-resolution block) and the
+     cost of predicting the frame from the one before it with motion
+     compensation, as mean absolute differences per low-resolution pixel in
+     Q8.*/
+  uint32_t intra_cost;
+  uint32_t inter_cost;
+};
+
+/*Frame type decisions made ahead of the main encode.
+  Each frame is downscaled and compared against the previous one with a
+   cheap motion search as soon as it is submitted, possibly on a background
+   thread.
+  Frames are then coded in mini-GOPs of one reference (I or P) frame,
+   followed by the B frames before it: the lookahead places keyframes at
+   scene cuts, shortens mini-GOPs when the motion is too complex for B frames
+   to help, and decides when to refresh the golden frame.*/
+struct od_lookahead {
+  /*The size of the low-resolution luma planes.*/
+  int w;
+  int h;
+  /*The queue of frames that have not been planned yet, in display order.*/
+  od_lookahead_frame *frames;
+  int cframes;
+  int head;
+  int nframes;
+  /*The low-resolution luma of the last reference frame and of the golden
+     frame.*/
+  unsigned char *anchor;
+  unsigned char *golden;
+  int have_anchor;
+  int have_golden;
+  /*The display order of the next frame to plan and of the last keyframe.*/
+  int64_t head_order;
+  int64_t key_order;
+  /*The number of I or P frames since the last golden frame.*/
+  int ip_since_golden;
+  /*The number of frames from the next one to plan to the next expected
+     keyframe, for rate control.*/
+  int frames_to_key;
+  /*The number of frames submitted so far.*/
+  int64_t npushed;
+  /*The planned mini-GOP, in coding order: the input buffer index and frame
+     type of each frame, and whether the first one is a golden frame.*/
+  int plan_slot[1 + OD_MAX_B_FRAMES];
+  int plan_type[1 + OD_MAX_B_FRAMES];
+  int plan_golden;
+  int plan_n;
+  int plan_pos;
+  /*The background thread that analyzes new frames, if any.*/
+  od_task task;
+  int async;
+  unsigned char *data;
+};
+
+int od_lookahead_init(od_lookahead *la, const daala_info *info, int cframes,
+ int async);
+void od_lookahead_clear(od_lookahead *la);
+void od_lookahead_push(od_lookahead *la, const od_img *img, int slot);
+int od_lookahead_next(od_lookahead *la, int *frame_type, int *golden,
+ int b_frames, int keyframe_rate, int golden_interval, int flush);
+
+#endif
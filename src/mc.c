@@ -1053,7 +1053,7 @@ static void od_mc_blend_multi(od_state *state, unsigned char *dst,
    log_xblk_sz, log_yblk_sz);
 }
 
-static void od_mc_setup_s_split(int s0[4], int dsdi[4], int dsdj[4],
+void od_mc_setup_s_split(int s0[4], int dsdi[4], int dsdj[4],
  int ddsdidj[4], int oc, int s, int log_xblk_sz, int log_yblk_sz) {
   int log_blk_sz2;
   int k;
@@ -1209,7 +1209,7 @@ void od_mc_blend_full_split(od_state *state, unsigned char *dst,
 
 /*Sets up a second set of image pointers based on the given split state to
    properly shift weight from one image to another.*/
-static void od_mc_setup_split_ptrs(const unsigned char *drc[4],
+void od_mc_setup_split_ptrs(const unsigned char *drc[4],
  const unsigned char *src[4], int oc, int s) {
   int j;
   int k;
@@ -105,6 +105,10 @@ void od_mc_predict_singleref(od_state *state, unsigned char *dst, int dystride,
 void od_mc_predict(od_state *state, unsigned char *dst, int dystride,
  const unsigned char *src[4], int systride, const int32_t mvx[4],
  const int32_t mvy[4], int oc, int s, int log_xblk_sz, int log_yblk_sz);
+void od_mc_setup_s_split(int s0[4], int dsdi[4], int dsdj[4],
+ int ddsdidj[4], int oc, int s, int log_xblk_sz, int log_yblk_sz);
+void od_mc_setup_split_ptrs(const unsigned char *drc[4],
+ const unsigned char *src[4], int oc, int s);
 void od_state_mvs_clear(od_state *state);
 int od_mc_get_ref_predictor(od_state *state, int vx, int vy, int level);
 int od_state_get_predictor(od_state *state, int pred[2],
@@ -1754,6 +1754,7 @@ static int32_t od_enc_satd(od_enc_ctx *enc, const unsigned char *p,
 static int od_mv_est_init_impl(od_mv_est_ctx *est, od_enc_ctx *enc) {
   int nhmvbs;
   int nvmvbs;
+  int nrows;
   int log_mvb_sz;
   int vx;
   int vy;
@@ -1807,6 +1808,18 @@ static int od_mv_est_init_impl(od_mv_est_ctx *est, od_enc_ctx *enc) {
   if (OD_UNLIKELY(!est->dec_heap)) {
     return OD_EFAULT;
   }
+  nrows = (nvmvbs + OD_MVB_DELTA0 - 1) >> OD_LOG_MVB_DELTA0;
+  est->row_progress = (od_progress *)malloc(
+   sizeof(*est->row_progress)*nrows);
+  if (OD_UNLIKELY(!est->row_progress)) {
+    return OD_EFAULT;
+  }
+  for (; est->nrow_progress < nrows; est->nrow_progress++) {
+    if (OD_UNLIKELY(od_progress_init(est->row_progress
+     + est->nrow_progress) < 0)) {
+      return OD_EFAULT;
+    }
+  }
   /*Set to UCHAR_MAX so that od_mv_est_clear_hit_cache initializes hit_cache.*/
   est->hit_bit = UCHAR_MAX;
   est->mv_res_min = 0;
@@ -1816,6 +1829,10 @@ static int od_mv_est_init_impl(od_mv_est_ctx *est, od_enc_ctx *enc) {
 
 static void od_mv_est_clear(od_mv_est_ctx *est) {
   int log_mvb_sz;
+  while (est->nrow_progress-- > 0) {
+    od_progress_clear(est->row_progress + est->nrow_progress);
+  }
+  free(est->row_progress);
   free(est->dec_heap);
   free(est->col_counts);
   free(est->row_counts);
@@ -2705,6 +2722,32 @@ static void od_mv_est_init_mv(od_mv_est_ctx *est, int ref, int vx, int vy,
   od_mv_est_set_hit(est, candx, candy);
   best_vec[0] = candx;
   best_vec[1] = candy;
+  /*The vector found by the motion search on the source frames.*/
+  if (est->src != NULL && est->src->mvs[ref] != NULL) {
+    const int *seed;
+    seed = est->src->mvs[ref][(vy >> 1)*est->src->nhmvs + (vx >> 1)];
+    candx = OD_CLAMPI(mvxmin, seed[0], mvxmax);
+    candy = OD_CLAMPI(mvymin, seed[1], mvymax);
+    if (!od_mv_est_is_hit(est, candx, candy)) {
+      int32_t sad;
+      int32_t cost;
+      int rate;
+      od_mv_est_set_hit(est, candx, candy);
+      sad = od_mv_est_bma_sad(est, ref, bx, by, candx, candy, log_mvb_sz);
+      rate = od_mv_est_cand_bits(est, equal_mvs,
+       candx, candy, pred[0], pred[1], ref, ref_pred);
+      cost = (sad << OD_ERROR_SCALE) + rate*est->lambda;
+      OD_LOG((OD_LOG_MOTION_ESTIMATION, OD_LOG_DEBUG,
+       "Source predictor: (%i, %i)   Cost: %i", candx, candy, cost));
+      if (cost < best_cost) {
+        best_sad = sad;
+        best_rate = rate;
+        best_cost = cost;
+        best_vec[0] = candx;
+        best_vec[1] = candy;
+      }
+    }
+  }
   OD_LOG((OD_LOG_MOTION_ESTIMATION, OD_LOG_DEBUG,
    "Threshold: %i", est->thresh1[log_mvb_sz]));
   /*TODO: adjust the BMA thresholds if B-frame is used, i.e. P frame's MV
@@ -3033,12 +3076,121 @@ static void od_mv_est_init_mv(od_mv_est_ctx *est, int ref, int vx, int vy,
   }
 }
 
+/*Returns the number of jobs to split nitems rows of the MV grid between.*/
+static int od_mv_est_njobs(od_mv_est_ctx *est, int nitems) {
+#if defined(OD_DUMP_IMAGES) && defined(OD_ANIMATE)
+  /*Every search is drawn into the same visualization image.*/
+  (void)est;
+  (void)nitems;
+  return 1;
+#else
+  return od_enc_pool_njobs(est->enc, nitems);
+#endif
+}
+
+/*Makes a copy of the estimator that job jobi can use concurrently with the
+   other jobs.
+  Only the scratch state is private: the MV grid is shared.*/
+static od_mv_est_ctx *od_mv_est_worker_begin(od_mv_est_ctx *est, int jobi) {
+  od_mv_est_ctx *west;
+  west = est->enc->workers[jobi].mvest;
+  *west = *est;
+  west->enc = od_enc_worker_begin(est->enc, jobi);
+  return west;
+}
+
+/*Initializes the MVs of one row of MVBs, along with the vertices on its
+   bottom edge.*/
+static void od_mv_est_init_mvb_row(od_mv_est_ctx *est, int ref,
+ int must_update, int vy) {
+  od_state *state;
+  od_progress *above;
+  od_progress *row;
+  int nhmvbs;
+  int ncols;
+  int vx;
+  state = &est->enc->state;
+  nhmvbs = state->nhmvbs;
+  ncols = (nhmvbs + OD_MVB_DELTA0 - 1) >> OD_LOG_MVB_DELTA0;
+  row = est->row_progress + (vy >> OD_LOG_MVB_DELTA0);
+  above = vy > 0 ? row - 1 : NULL;
+  /*The level 0 vertices use the ones above and to the right as predictors,
+     so each MVB waits for the row above to be one MVB ahead.
+    No vertex is predicted from the row below, so this reproduces the serial
+     order exactly.*/
+  if (above != NULL) od_progress_wait(above, OD_MINI(2, ncols));
+  od_mv_est_init_mv(est, ref, 0, vy + OD_MVB_DELTA0, must_update);
+  for (vx = 0; vx < nhmvbs; vx += OD_MVB_DELTA0) {
+    int log_mvb_sz;
+    int level;
+    if (above != NULL) {
+      od_progress_wait(above, OD_MINI((vx >> OD_LOG_MVB_DELTA0) + 2, ncols));
+    }
+    /*Level 0 vertex.*/
+    od_mv_est_init_mv(est, ref, vx + OD_MVB_DELTA0, vy + OD_MVB_DELTA0,
+     must_update);
+    /*All other levels.*/
+    for(log_mvb_sz = OD_LOG_MVB_DELTA0, level = 1;
+     log_mvb_sz-- > 0 && est->level_max >= level; level++) {
+      int cx;
+      int cy;
+      int mvb_sz;
+      mvb_sz = 1 << log_mvb_sz;
+      /*Odd level vertices.*/
+      for (cy = vy + mvb_sz; cy < vy + OD_MVB_DELTA0; cy += 2*mvb_sz) {
+        for( cx = vx + mvb_sz; cx < vx + OD_MVB_DELTA0; cx += 2*mvb_sz) {
+          od_mv_est_init_mv(est, ref, cx, cy, must_update);
+        }
+      }
+      level++;
+      if (est->level_max < level) break;
+      /*Even level vertices.*/
+      /*Add even-level vertices on the top/left edges of the frame as extra
+         vertices in the first row/column of MVBs.
+        Unlike other vertices on the edges of an MVB, they can use parents to
+         the right/below them as predictors (or otherwise they would have no
+         predictors).*/
+      /*Skip the cy == vy row unless we're at the top of the frame.*/
+      for (cy = vy + mvb_sz*!!vy; cy <= vy + OD_MVB_DELTA0; cy += mvb_sz) {
+        /*Even level vertices appear in a quincunx pattern.
+          We want to start every other row at an mvb_sz offset, and also to
+           skip the first column on the rows flush with the edge of the block
+           unless we're on the left edge of the whole frame.*/
+        for( cx = vx + (cy & mvb_sz ? 2*mvb_sz*!!vx : mvb_sz);
+         cx <= vx + OD_MVB_DELTA0; cx += 2*mvb_sz) {
+          od_mv_est_init_mv(est, ref, cx, cy, must_update);
+        }
+      }
+    }
+    od_progress_set(row, (vx >> OD_LOG_MVB_DELTA0) + 1);
+  }
+}
+
+/*Job j initializes MVB rows j, j + njobs, j + 2*njobs, ...*/
+static void od_mv_est_init_mvs_job(void *ctx, int jobi) {
+  od_mv_est_ctx *est;
+  od_mv_est_ctx *west;
+  int nvmvbs;
+  int njobs;
+  int vy;
+  est = (od_mv_est_ctx *)ctx;
+  nvmvbs = est->enc->state.nvmvbs;
+  njobs = od_mv_est_njobs(est, est->nrow_progress);
+  west = od_mv_est_worker_begin(est, jobi);
+  for (vy = jobi << OD_LOG_MVB_DELTA0; vy < nvmvbs;
+   vy += njobs << OD_LOG_MVB_DELTA0) {
+    od_mv_est_init_mvb_row(west, est->jobs_ref, est->jobs_must_update, vy);
+  }
+}
+
 static void od_mv_est_init_mvs(od_mv_est_ctx *est, int ref, int must_update) {
   od_state *state;
   int nhmvbs;
   int nvmvbs;
+  int njobs;
   int vx;
   int vy;
+  int i;
   state = &est->enc->state;
   nhmvbs = state->nhmvbs;
   nvmvbs = state->nvmvbs;
@@ -3067,47 +3219,18 @@ static void od_mv_est_init_mvs(od_mv_est_ctx *est, int ref, int must_update) {
   for (vx = 0; vx <= nhmvbs; vx += OD_MVB_DELTA0) {
     od_mv_est_init_mv(est, ref, vx, 0, must_update);
   }
-  for (vy = 0; vy < nvmvbs; vy += OD_MVB_DELTA0) {
-    od_mv_est_init_mv(est, ref, 0, vy + OD_MVB_DELTA0, must_update);
-    for (vx = 0; vx < nhmvbs; vx += OD_MVB_DELTA0) {
-      int log_mvb_sz;
-      int level;
-      /*Level 0 vertex.*/
-      od_mv_est_init_mv(est, ref, vx + OD_MVB_DELTA0, vy + OD_MVB_DELTA0,
-       must_update);
-      /*All other levels.*/
-      for(log_mvb_sz = OD_LOG_MVB_DELTA0, level = 1;
-       log_mvb_sz-- > 0 && est->level_max >= level; level++) {
-        int cx;
-        int cy;
-        int mvb_sz;
-        mvb_sz = 1 << log_mvb_sz;
-        /*Odd level vertices.*/
-        for (cy = vy + mvb_sz; cy < vy + OD_MVB_DELTA0; cy += 2*mvb_sz) {
-          for( cx = vx + mvb_sz; cx < vx + OD_MVB_DELTA0; cx += 2*mvb_sz) {
-            od_mv_est_init_mv(est, ref, cx, cy, must_update);
-          }
-        }
-        level++;
-        if (est->level_max < level) break;
-        /*Even level vertices.*/
-        /*Add even-level vertices on the top/left edges of the frame as extra
-           vertices in the first row/column of MVBs.
-          Unlike other vertices on the edges of an MVB, they can use parents to
-           the right/below them as predictors (or otherwise they would have no
-           predictors).*/
-        /*Skip the cy == vy row unless we're at the top of the frame.*/
-        for (cy = vy + mvb_sz*!!vy; cy <= vy + OD_MVB_DELTA0; cy += mvb_sz) {
-          /*Even level vertices appear in a quincunx pattern.
-            We want to start every other row at an mvb_sz offset, and also to
-             skip the first column on the rows flush with the edge of the block
-             unless we're on the left edge of the whole frame.*/
-          for( cx = vx + (cy & mvb_sz ? 2*mvb_sz*!!vx : mvb_sz);
-           cx <= vx + OD_MVB_DELTA0; cx += 2*mvb_sz) {
-            od_mv_est_init_mv(est, ref, cx, cy, must_update);
-          }
-        }
-      }
+  for (i = 0; i < est->nrow_progress; i++) {
+    od_progress_reset(est->row_progress + i);
+  }
+  njobs = od_mv_est_njobs(est, est->nrow_progress);
+  if (njobs > 1) {
+    est->jobs_ref = ref;
+    est->jobs_must_update = must_update;
+    od_thread_pool_run(&est->enc->pool, od_mv_est_init_mvs_job, est, njobs);
+  }
+  else {
+    for (vy = 0; vy < nvmvbs; vy += OD_MVB_DELTA0) {
+      od_mv_est_init_mvb_row(est, ref, must_update, vy);
     }
   }
 }
@@ -3755,6 +3878,57 @@ static void od_mv_est_init_nodes(od_mv_est_ctx *est) {
   }
 }
 
+/*Computes the SADs of one row of blocks of size 1 << log_mvb_sz.*/
+static void od_mv_est_calc_sads_row(od_mv_est_ctx *est, int log_mvb_sz,
+ int vy) {
+  od_sad4 *sad_cache_row;
+  od_mv_node *mv_row;
+  int nhmvbs;
+  int level_max;
+  int smax;
+  int vx;
+  int oc;
+  int s;
+  nhmvbs = est->enc->state.nhmvbs >> log_mvb_sz;
+  level_max = est->level_max;
+  smax = level_max >= OD_MC_LEVEL_MAX - 2*log_mvb_sz ? 4 : 1;
+  sad_cache_row = est->sad_cache[log_mvb_sz][vy];
+  mv_row = est->mvs[vy << log_mvb_sz];
+  for (vx = 0; vx < nhmvbs; vx++) {
+    oc = (vx & 1) ^ ((vy & 1) << 1 | (vy & 1));
+    for (s = 0; s < smax; s++) {
+      sad_cache_row[vx][s] = od_mv_est_sad(est,
+       vx << log_mvb_sz, vy << log_mvb_sz, oc, s, log_mvb_sz);
+    }
+    /*While we're here, fill in the block's setup state.*/
+    if (level_max <= OD_MC_LEVEL_MAX - 2*log_mvb_sz) {
+      mv_row[vx << log_mvb_sz].oc = oc;
+      mv_row[vx << log_mvb_sz].log_mvb_sz = log_mvb_sz;
+      mv_row[vx << log_mvb_sz].s = smax - 1;
+      mv_row[vx << log_mvb_sz].sad = sad_cache_row[vx][smax - 1];
+    }
+  }
+}
+
+/*Job j computes the SADs of rows j, j + njobs, j + 2*njobs, ...
+  The rows of one block size are independent.*/
+static void od_mv_est_calc_sads_job(void *ctx, int jobi) {
+  od_mv_est_ctx *est;
+  od_mv_est_ctx *west;
+  int log_mvb_sz;
+  int nvmvbs;
+  int njobs;
+  int vy;
+  est = (od_mv_est_ctx *)ctx;
+  log_mvb_sz = est->jobs_log_mvb_sz;
+  nvmvbs = est->enc->state.nvmvbs >> log_mvb_sz;
+  njobs = od_mv_est_njobs(est, nvmvbs);
+  west = od_mv_est_worker_begin(est, jobi);
+  for (vy = jobi; vy < nvmvbs; vy += njobs) {
+    od_mv_est_calc_sads_row(west, log_mvb_sz, vy);
+  }
+}
+
 /*Computes the SAD of all blocks at all scales with all possible edge
    splittings, using OBMC.
   These are what will drive the error of the adaptive subdivision process.*/
@@ -3767,8 +3941,6 @@ static void od_mv_est_calc_sads(od_mv_est_ctx *est) {
   int log_mvb_sz;
   int vx;
   int vy;
-  int oc;
-  int s;
   state = &est->enc->state;
   /*TODO: Interleaved evaluation would probably provide better cache
      coherency.*/
@@ -3779,28 +3951,16 @@ static void od_mv_est_calc_sads(od_mv_est_ctx *est) {
   for (log_mvb_sz = 0; log_mvb_sz < OD_LOG_MVB_DELTA0; log_mvb_sz++) {
     if (level_max >= OD_MC_LEVEL_MAX - 1 - 2*log_mvb_sz
      && level_min <= OD_MC_LEVEL_MAX - 2*log_mvb_sz) {
-      od_sad4 **sad_cache;
-      int smax;
-      sad_cache = est->sad_cache[log_mvb_sz];
-      smax = level_max >= OD_MC_LEVEL_MAX - 2*log_mvb_sz ? 4 : 1;
-      for (vy = 0; vy < nvmvbs; vy++) {
-        od_sad4 *sad_cache_row;
-        od_mv_node *mv_row;
-        sad_cache_row = sad_cache[vy];
-        mv_row = est->mvs[vy << log_mvb_sz];
-        for (vx = 0; vx < nhmvbs; vx++) {
-          oc = (vx & 1) ^ ((vy & 1) << 1 | (vy & 1));
-          for (s = 0; s < smax; s++) {
-            sad_cache_row[vx][s] = od_mv_est_sad(est,
-             vx << log_mvb_sz, vy << log_mvb_sz, oc, s, log_mvb_sz);
-          }
-          /*While we're here, fill in the block's setup state.*/
-          if (level_max <= OD_MC_LEVEL_MAX - 2*log_mvb_sz) {
-            mv_row[vx << log_mvb_sz].oc = oc;
-            mv_row[vx << log_mvb_sz].log_mvb_sz = log_mvb_sz;
-            mv_row[vx << log_mvb_sz].s = smax - 1;
-            mv_row[vx << log_mvb_sz].sad = sad_cache_row[vx][smax - 1];
-          }
+      int njobs;
+      njobs = od_mv_est_njobs(est, nvmvbs);
+      if (njobs > 1) {
+        est->jobs_log_mvb_sz = log_mvb_sz;
+        od_thread_pool_run(&est->enc->pool, od_mv_est_calc_sads_job, est,
+         njobs);
+      }
+      else {
+        for (vy = 0; vy < nvmvbs; vy++) {
+          od_mv_est_calc_sads_row(est, log_mvb_sz, vy);
         }
       }
     }
@@ -6350,7 +6510,7 @@ void od_mv_subpel_refine(od_mv_est_ctx *est, int cost_thresh) {
   do {
     dcost = od_mv_est_refine(est, 2, 2, pattern_nsites, pattern);
   }
-  while (dcost < cost_thresh);
+  while (dcost < cost_thresh && est->src == NULL);
   for (best_mv_res = mv_res = 2; mv_res-- > est->mv_res_min;) {
     subpel_cost = od_mv_est_update_mv_rates(est, mv_res)*est->lambda;
     /*If the rate penalty for refining is small, bump the termination threshold
@@ -6366,7 +6526,7 @@ void od_mv_subpel_refine(od_mv_est_ctx *est, int cost_thresh) {
        pattern_nsites, pattern);
       subpel_cost += dcost;
     }
-    while (dcost < cost_thresh);
+    while (dcost < cost_thresh && est->src == NULL);
     if (subpel_cost >= 0) {
       OD_LOG((OD_LOG_MOTION_ESTIMATION, OD_LOG_INFO,
        "1/%i refinement FAILED:    dopt %7i", 1 << (3 - mv_res), subpel_cost));
@@ -6512,18 +6672,22 @@ void od_mv_est(od_mv_est_ctx *est, int lambda) {
     pattern_nsites = OD_DIAMOND_NSITES;
     pattern = OD_DIAMOND_SITES;
   }
+  /*Vectors that started from a search of the source frames are already
+     close to their best, so they get a single pass of each refinement, and
+     no logarithmic search.*/
   do {
     dcost = 0;
     /*Logarithmic (telescoping) search.
       This is 3x more expensive than basic refinement, but can help escape
        local minima.*/
-    if (complexity >= OD_MC_LOGARITHMIC_REFINEMENT_COMPLEXITY) {
+    if (complexity >= OD_MC_LOGARITHMIC_REFINEMENT_COMPLEXITY
+     && est->src == NULL) {
       dcost += od_mv_est_refine(est, 5, 2, pattern_nsites, pattern);
       dcost += od_mv_est_refine(est, 4, 2, pattern_nsites, pattern);
     }
     dcost += od_mv_est_refine(est, 3, 2, pattern_nsites, pattern);
   }
-  while (dcost < cost_thresh);
+  while (dcost < cost_thresh && est->src == NULL);
   if (use_satd) {
     /* The two #defines below apply to sub-pel ME only. */
 # define OD_ME_SATD_THRESH_SCALE (0.7) /* 1.0 means the same as SAD. */
@@ -156,6 +156,10 @@ struct od_mv_dp_node {
 
 struct od_mv_est_ctx {
   od_enc_ctx *enc;
+  /*The analysis of the source shared by the encoders of a ladder, whose
+     motion field gives an extra candidate to the initial search and
+     shortens the refinement, or NULL.*/
+  const od_src_analysis *src;
   /*A cache of the SAD values used during decimation.
     Indexed by [log_mvb_sz][vy >> log_mvb_sz][vx >> log_mvb_sz][s], where s is
      the edge split state.
@@ -211,6 +215,14 @@ struct od_mv_est_ctx {
      and SATD functions are called for stage 4 (i.e. sub-pel refine).*/
   int32_t (*compute_distortion)(od_enc_ctx *enc, const unsigned char *p,
    int pystride, int pxstride, int pli, int x, int y, int log_blk_sz);
+  /*The number of MVB columns done in each MVB row during the initial search,
+     used to run the rows as a wavefront on the encoder's thread pool.*/
+  od_progress *row_progress;
+  int nrow_progress;
+  /*The arguments of the jobs currently running on the thread pool.*/
+  int jobs_ref;
+  int jobs_must_update;
+  int jobs_log_mvb_sz;
 };
 
 #endif
@@ -64,6 +64,7 @@ static void od_encode_pvq_codeword(od_ec_enc *ec, od_pvq_codeword_ctx *adapt,
     pvq_adapt = adapt->pvq_adapt + 4*(2*bs + noref);
     laplace_encode_vector(ec, in, n - !noref, k, adapt_curr,
      pvq_adapt);
+    od_ec_enc_log(ec, pvq_adapt, OD_NSB_ADAPT_CTXS*sizeof(*pvq_adapt));
     if (adapt_curr[OD_ADAPT_K_Q8] > 0) {
       pvq_adapt[OD_ADAPT_K_Q8] += (256*adapt_curr[OD_ADAPT_K_Q8]
        - pvq_adapt[OD_ADAPT_K_Q8]) >> speed;
@@ -79,74 +80,129 @@ static void od_encode_pvq_codeword(od_ec_enc *ec, od_pvq_codeword_ctx *adapt,
   }
 }
 
-/* Computes 1/sqrt(i) using a table for small values. */
-static double od_rsqrt_table(int i) {
-  static double table[16] = {
-    1.000000, 0.707107, 0.577350, 0.500000,
-    0.447214, 0.408248, 0.377964, 0.353553,
-    0.333333, 0.316228, 0.301511, 0.288675,
-    0.277350, 0.267261, 0.258199, 0.250000};
-  if (i <= 16) return table[i-1];
-  else return 1./sqrt(i);
-}
+/*The magnitude the largest coefficient is scaled to for the fixed-point PVQ
+   search.*/
+#define OD_PVQ_SEARCH_SCALE (16384)
 
-/*Computes 1/sqrt(start+2*i+1) using a lookup table containing the results
-   where 0 <= i < table_size.*/
-static double od_custom_rsqrt_dynamic_table(const double* table,
- const int table_size, const double start, const int i) {
-  if (i < table_size) return table[i];
-  else return od_rsqrt_table(start + 2*i + 1);
+/** Adds pulses one at a time to the position that maximizes the cosine
+ * between x and y, i.e., (xy + x[j])^2/(yy + 2*y[j] + 1).
+ *
+ * The ratios are compared in 32-bit fixed point: the numerator is reduced to
+ * 15 bits and the denominator to 16 bits, with shifts that only depend on the
+ * number of pulses placed so far, so that their products cannot overflow.
+ * Ties go to the lowest position.
+ *
+ * @param [in,out]  y       pulses placed so far (all non-negative)
+ * @param [in,out]  xy      sum of x[j]*y[j]
+ * @param [in,out]  yy      sum of y[j]*y[j]
+ * @param [in]      x       magnitudes of the vector to quantize, no larger
+ *                          than OD_PVQ_SEARCH_SCALE
+ * @param [in]      n       number of dimensions
+ * @param [in]      i       number of pulses in y
+ * @param [in]      k       number of pulses y should have on return
+ */
+void od_pvq_search_pulses_c(od_coeff *y, int32_t *xy, int32_t *yy,
+ const int16_t *x, int n, int i, int k) {
+  int32_t cxy;
+  int32_t cyy;
+  int j;
+  cxy = *xy;
+  cyy = *yy;
+  for (; i < k; i++) {
+    int32_t best_num;
+    int32_t best_den;
+    int pos;
+    int s;
+    int t;
+    s = OD_PVQ_SEARCH_NUM_SHIFT(i);
+    t = OD_PVQ_SEARCH_DEN_SHIFT(i);
+    best_num = -1;
+    best_den = 1;
+    pos = 0;
+    for (j = 0; j < n; j++) {
+      int32_t num;
+      int32_t den;
+      num = (cxy + x[j]) >> s;
+      num = num*num >> 15;
+      den = (cyy + 2*y[j] + 1) >> t;
+      if (num*best_den > best_num*den) {
+        best_num = num;
+        best_den = den;
+        pos = j;
+      }
+    }
+    cxy += x[pos];
+    cyy += 2*y[pos] + 1;
+    y[pos]++;
+  }
+  *xy = cxy;
+  *yy = cyy;
 }
 
-/*Fills tables used in od_custom_rsqrt_dynamic_table for a given start.*/
-static void od_fill_dynamic_rqrt_table(double *table, const int table_size,
- const double start) {
-  int i;
-  for (i = 0; i < table_size; i++)
-    table[i] = od_rsqrt_table(start + 2*i + 1);
+/*Computes 65536/sqrt(v), rounded down, for v >= 1.*/
+static int32_t od_pvq_rsqrt_q16(int32_t v) {
+  uint64_t w;
+  uint64_t r;
+  uint64_t b;
+  OD_ASSERT(v >= 1);
+  w = ((uint64_t)1 << 32)/(uint32_t)v;
+  /*Digit-by-digit integer square root.*/
+  r = 0;
+  for (b = (uint64_t)1 << 32; b > 0; b >>= 2) {
+    if (w >= r + b) {
+      w -= r + b;
+      r = (r >> 1) + b;
+    }
+    else r >>= 1;
+  }
+  return (int32_t)r;
 }
 
 /** Find the codepoint on the given PSphere closest to the desired
- * vector. Double-precision PVQ search just to make sure our tests
- * aren't limited by numerical accuracy.
+ * vector, using a fixed-point search.
  *
+ * @param [in]      search  greedy pulse search function to use
  * @param [in]      xcoeff  input vector to quantize (x in the math doc)
- * @param [in]      n       number of dimensions
+ * @param [in]      n       number of dimensions (at most OD_MAX_PVQ_SIZE)
  * @param [in]      k       number of pulses
  * @param [out]     ypulse  optimal codevector found (y in the math doc)
  * @param [out]     g2      multiplier for the distortion (typically squared
  *                          gain units)
  * @return                  cosine distance between x and y (between 0 and 1)
  */
-static double pvq_search_rdo_double(const double *xcoeff, int n, int k,
- od_coeff *ypulse, double g2) {
-  int i, j;
-  double xy;
-  double yy;
-  /* TODO - This blows our 8kB stack space budget and should be fixed when
-   converting PVQ to fixed point. */
-  double x[MAXN];
-  double xx;
-  double lambda;
-  double norm_1;
+static double pvq_search_rdo(od_pvq_search_pulses_func search,
+ const double *xcoeff, int n, int k, od_coeff *ypulse, double g2) {
+  int16_t x[OD_MAX_PVQ_SIZE];
+  double xmax;
+  double scale;
+  int64_t xx;
+  int32_t xy;
+  int32_t yy;
+  int64_t penalty;
   int rdo_pulses;
-  double delta_rate;
-  xx = xy = yy = 0;
+  int i;
+  int j;
+  OD_ASSERT(n <= OD_MAX_PVQ_SIZE);
+  /*The squared norm of y must fit in 32 bits.*/
+  OD_ASSERT(k < 46341);
+  xmax = 0;
+  for (j = 0; j < n; j++) xmax = OD_MAXF(xmax, fabs(xcoeff[j]));
+  /*Only the direction of x matters, so scale it to a fixed magnitude.*/
+  scale = xmax > 0 ? OD_PVQ_SEARCH_SCALE/xmax : 0;
+  xx = 0;
   for (j = 0; j < n; j++) {
-    x[j] = fabs(xcoeff[j]);
-    xx += x[j]*x[j];
+    x[j] = (int16_t)OD_MINI(OD_PVQ_SEARCH_SCALE,
+     (int)floor(.5 + fabs(xcoeff[j])*scale));
+    xx += x[j]*(int64_t)x[j];
   }
-  norm_1 = 1./sqrt(1e-30 + xx);
-  lambda = OD_PVQ_LAMBDA/(1e-30 + g2);
+  xy = yy = 0;
   i = 0;
   if (k > 2) {
-    double l1_norm;
-    double l1_inv;
+    int32_t l1_norm;
     l1_norm = 0;
     for (j = 0; j < n; j++) l1_norm += x[j];
-    l1_inv = 1./OD_MAXF(l1_norm, 1e-100);
     for (j = 0; j < n; j++) {
-      ypulse[j] = OD_MAXI(0, (int)floor(k*x[j]*l1_inv));
+      ypulse[j] = l1_norm > 0 ? k*x[j]/l1_norm : 0;
       xy += x[j]*ypulse[j];
       yy += ypulse[j]*ypulse[j];
       i += ypulse[j];
@@ -159,69 +215,47 @@ static double pvq_search_rdo_double(const double *xcoeff, int n, int k,
      RDO on all pulses actually makes the results worse for reasons I don't
      fully understand. */
   rdo_pulses = 1 + k/4;
-  /* Rough assumption for now, the last position costs about 3 bits more than
-     the first. */
-  delta_rate = 3./n;
-  /* Search one pulse at a time */
-  for (; i < k - rdo_pulses; i++) {
-    int pos;
-    double best_xy;
-    double best_yy;
-    pos = 0;
-    best_xy = -10;
-    best_yy = 1;
-    for (j = 0; j < n; j++) {
-      double tmp_xy;
-      double tmp_yy;
-      tmp_xy = xy + x[j];
-      tmp_yy = yy + 2*ypulse[j] + 1;
-      tmp_xy *= tmp_xy;
-      if (j == 0 || tmp_xy*best_yy > best_xy*tmp_yy) {
-        best_xy = tmp_xy;
-        best_yy = tmp_yy;
-        pos = j;
-      }
-    }
-    xy = xy + x[pos];
-    yy = yy + 2*ypulse[pos] + 1;
-    ypulse[pos]++;
+  if (i < k - rdo_pulses) {
+    (*search)(ypulse, &xy, &yy, x, n, i, k - rdo_pulses);
+    i = k - rdo_pulses;
   }
   /* Search last pulses with RDO. Distortion is D = (x-y)^2 = x^2 - x*y + y^2
      and since x^2 and y^2 are constant, we just maximize x*y, plus a
      lambda*rate term. Note that since x and y aren't normalized here,
-     we need to divide by sqrt(x^2)*sqrt(y^2). */
+     we need to divide by sqrt(x^2)*sqrt(y^2).
+     Scaling the whole cost by 65536*sqrt(x^2) leaves
+      2*(xy + x[j])*rsqrt_q16(yy + 2*y[j] + 1) - penalty*j,
+     where the penalty is the rate term, with the rough assumption that the
+     last position costs about 3 bits more than the first. */
+  penalty = (int64_t)floor(.5 + OD_MINF(OD_PVQ_LAMBDA/(1e-30 + g2)*3./n
+   *sqrt((double)xx)*65536, (double)((int64_t)1 << 48)));
   for (; i < k; i++) {
-    double rsqrt_table[4];
-    int rsqrt_table_size = 4;
+    /*1/sqrt(yy + 2*y[j] + 1) for the most common small y[j].*/
+    int32_t rsqrt_table[4];
+    int64_t best_cost;
     int pos;
-    double best_cost;
+    for (j = 0; j < 4; j++) rsqrt_table[j] = od_pvq_rsqrt_q16(yy + 2*j + 1);
+    best_cost = 0;
     pos = 0;
-    best_cost = -1e5;
-    /*Fill the small rsqrt lookup table with inputs relative to yy.
-      Specifically, the table of n values is filled with
-       rsqrt(yy + 1), rsqrt(yy + 2 + 1) .. rsqrt(yy + 2*(n-1) + 1).*/
-    od_fill_dynamic_rqrt_table(rsqrt_table, rsqrt_table_size, yy);
     for (j = 0; j < n; j++) {
-      double tmp_xy;
-      double tmp_yy;
-      tmp_xy = xy + x[j];
-      /*Calculate rsqrt(yy + 2*ypulse[j] + 1) using an optimized method.*/
-      tmp_yy = od_custom_rsqrt_dynamic_table(rsqrt_table, rsqrt_table_size,
-       yy, ypulse[j]);
-      tmp_xy = 2*tmp_xy*norm_1*tmp_yy - lambda*j*delta_rate;
-      if (j == 0 || tmp_xy > best_cost) {
-        best_cost = tmp_xy;
+      int64_t cost;
+      int32_t rsqrt;
+      rsqrt = ypulse[j] < 4 ? rsqrt_table[ypulse[j]]
+       : od_pvq_rsqrt_q16(yy + 2*ypulse[j] + 1);
+      cost = 2*(int64_t)(xy + x[j])*rsqrt - penalty*j;
+      if (j == 0 || cost > best_cost) {
+        best_cost = cost;
         pos = j;
       }
     }
-    xy = xy + x[pos];
-    yy = yy + 2*ypulse[pos] + 1;
+    xy += x[pos];
+    yy += 2*ypulse[pos] + 1;
     ypulse[pos]++;
   }
-  for (i = 0; i < n; i++) {
-    if (xcoeff[i] < 0) ypulse[i] = -ypulse[i];
+  for (j = 0; j < n; j++) {
+    if (xcoeff[j] < 0) ypulse[j] = -ypulse[j];
   }
-  return xy/(1e-100 + sqrt(xx*yy));
+  return xy/(1e-100 + sqrt((double)xx*yy));
 }
 
 /** Encodes the gain so that the return value increases with the
@@ -287,6 +321,7 @@ static double od_pvq_rate(int qg, int icgr, int theta, int ts,
  * possible gains and angles. See draft-valin-videocodec-pvq and
  * http://jmvalin.ca/slides/pvq.pdf for more details.
  *
+ * @param [in]     enc       daala encoder context
  * @param [out]    out       coefficients after quantization
  * @param [in]     x0        coefficients before quantization
  * @param [in]     r0        reference, aka predicted coefficients
@@ -308,8 +343,8 @@ static double od_pvq_rate(int qg, int icgr, int theta, int ts,
  * @param [in]     qm_inv    Inverse of QM with magnitude compensation
  * @return         gain      index of the quatized gain
 */
-static int pvq_theta(od_coeff *out, od_coeff *x0, od_coeff *r0, int n, int q0,
- od_coeff *y, int *itheta, int *max_theta, int *vk,
+static int pvq_theta(daala_enc_ctx *enc, od_coeff *out, od_coeff *x0,
+ od_coeff *r0, int n, int q0, od_coeff *y, int *itheta, int *max_theta, int *vk,
  double beta, double *skip_diff, int robust, int is_keyframe, int pli,
  const od_adapt_ctx *adapt, int bs, const int16_t *qm,
  const int16_t *qm_inv) {
@@ -423,8 +458,8 @@ static int pvq_theta(od_coeff *out, od_coeff *x0, od_coeff *r0, int n, int q0,
         /* PVQ search, using a gain of qcg*cg*sin(theta)*sin(qtheta) since
            that's the factor by which cos_dist is multiplied to get the
            distortion metric. */
-        cos_dist = pvq_search_rdo_double(x, n - 1, k, y_tmp,
-         qcg*cg*sin(theta)*sin(qtheta));
+        cos_dist = pvq_search_rdo(enc->opt_vtbl.pvq_search_pulses, x, n - 1,
+         k, y_tmp, qcg*cg*sin(theta)*sin(qtheta));
         /* See Jmspeex' Journal of Dubious Theoretical Results. */
         dist_theta = 2 - 2*cos(theta - qtheta)
          + sin(theta)*sin(qtheta)*(2 - 2*cos_dist);
@@ -460,7 +495,8 @@ static int pvq_theta(od_coeff *out, od_coeff *x0, od_coeff *r0, int n, int q0,
       double qcg;
       qcg = i;
       k = od_pvq_compute_k(qcg, -1, -1, 1, n, beta, robust || is_keyframe);
-      cos_dist = pvq_search_rdo_double(x1, n, k, y_tmp, qcg*cg);
+      cos_dist = pvq_search_rdo(enc->opt_vtbl.pvq_search_pulses, x1, n, k,
+       y_tmp, qcg*cg);
       /* See Jmspeex' Journal of Dubious Theoretical Results. */
       dist = gain_weight*(qcg - cg)*(qcg - cg) + qcg*cg*(2 - 2*cos_dist);
       /* Do approximate RDO. */
@@ -568,6 +604,7 @@ static void pvq_encode_partition(od_ec_enc *ec,
     int tmp;
     tmp = *exg;
     generic_encode(ec, &model[!noref], qg - 1, -1, &tmp, 2);
+    od_ec_enc_log(ec, exg, sizeof(*exg));
     OD_IIR_DIADIC(*exg, qg << 16, 2);
   }
   if (theta > 1 && (nodesync || max_theta > 3)) {
@@ -575,6 +612,7 @@ static void pvq_encode_partition(od_ec_enc *ec,
     tmp = *ext;
     generic_encode(ec, &model[2], theta - 2, nodesync ? -1 : max_theta - 3,
      &tmp, 2);
+    od_ec_enc_log(ec, ext, sizeof(*ext));
     OD_IIR_DIADIC(*ext, theta << 16, 2);
   }
   od_encode_pvq_codeword(ec, &adapt->pvq.pvq_codeword_ctx, in, n, k, theta == -1, bs);
@@ -612,10 +650,10 @@ void od_encode_quantizer_scaling(daala_enc_ctx *enc, int q_scaling,
     int above;
     int left;
     /* use value from neighbour if possible, otherwise use 0 */
-    above = sby > 0 ? enc->state.sb_q_scaling[(sby - 1)*enc->state.nhsb + sbx]
-     : 0;
-    left = sbx > 0 ? enc->state.sb_q_scaling[sby*enc->state.nhsb + (sbx - 1)]
-     : 0;
+    above = sby > enc->state.tile_sby0 ?
+     enc->state.sb_q_scaling[(sby - 1)*enc->state.nhsb + sbx] : 0;
+    left = sbx > enc->state.tile_sbx0 ?
+     enc->state.sb_q_scaling[sby*enc->state.nhsb + (sbx - 1)] : 0;
     od_encode_cdf_adapt(&enc->ec, q_scaling,
      enc->state.adapt.q_cdf[above + left*4], 4,
      enc->state.adapt.q_increment);
@@ -710,7 +748,7 @@ int od_pvq_encode(daala_enc_ctx *enc,
   for (i = 0; i < nb_bands; i++) {
     int q;
     q = OD_MAXI(1, q0*pvq_qm[od_qm_get_index(bs, i + 1)] >> 4);
-    qg[i] = pvq_theta(out + off[i], in + off[i], ref + off[i], size[i],
+    qg[i] = pvq_theta(enc, out + off[i], in + off[i], ref + off[i], size[i],
      q, y + off[i], &theta[i], &max_theta[i],
      &k[i], beta[i], &skip_diff, robust, is_keyframe, pli, &enc->state.adapt,
      bs, qm + off[i], qm_inv + off[i]);
@@ -0,0 +1,426 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "internal.h"
+#include "quantizer.h"
+#include "ratecontrol.h"
+#include "state.h"
+
+/*The initial number of bits per pixel of each frame type at a quantizer of
+   1 (in units of 1 << OD_COEFF_SHIFT), and the exponent of the quantizer.
+  These only matter until the first frame of each type has been coded.*/
+static const double OD_RC_INIT_BPP[OD_RC_NFRAME_TYPES] = { 30, 20, 15, 30 };
+static const double OD_RC_EXP[OD_RC_NFRAME_TYPES] = { .9, 1.1, 1.2, 1.1 };
+
+/*The weight given to a new measurement of the scale of each frame type once
+   a few frames of that type have been coded.*/
+static const double OD_RC_SCALE_ALPHA[OD_RC_NFRAME_TYPES] = {
+  .5, .25, .25, .5
+};
+
+/*The fraction of the decoder buffer a single frame may empty.*/
+#define OD_RC_BUFFER_MAX_DRAIN (.875)
+
+/*The version of the two-pass statistics stream.*/
+#define OD_RC_2PASS_VERSION (1)
+
+/*The minimum distance between a keyframe and a scene cut for the second pass
+   to code the scene cut as a keyframe.*/
+#define OD_RC_MIN_KEY_DIST (8)
+
+void od_rc_init(od_rc_state *rc, const daala_info *info) {
+  double log_npixels;
+  int fti;
+  OD_CLEAR(rc, 1);
+  rc->tick_duration = info->timebase_numerator > 0 ?
+   (double)info->timebase_denominator/info->timebase_numerator : 1;
+  rc->keyframe_rate = OD_MAXI(1, info->keyframe_rate);
+  log_npixels = log((double)info->pic_width*info->pic_height + 1);
+  for (fti = 0; fti < OD_RC_NFRAME_TYPES; fti++) {
+    rc->exp[fti] = OD_RC_EXP[fti];
+    rc->log_scale[fti] = log(OD_RC_INIT_BPP[fti]) + log_npixels
+     + rc->exp[fti]*log(1 << OD_COEFF_SHIFT);
+  }
+}
+
+void od_rc_clear(od_rc_state *rc) {
+  free(rc->twopass_buf);
+  free(rc->stats);
+}
+
+static double od_rc_buffer_size(const od_rc_state *rc) {
+  /*Default to one second worth of data.*/
+  return rc->buffer_size > 0 ? rc->buffer_size : rc->target_bitrate;
+}
+
+static double od_rc_max_bitrate(const od_rc_state *rc) {
+  return rc->max_bitrate > 0 ? rc->max_bitrate : rc->target_bitrate;
+}
+
+/*Restarts the reservoir and the decoder buffer model after a change to the
+   rate control parameters.
+  The rate model itself is kept.*/
+void od_rc_reset(od_rc_state *rc) {
+  rc->reservoir = 0;
+  rc->buffer_fullness = od_rc_buffer_size(rc);
+}
+
+/*Estimates the number of bits used by a set of frames at a quantizer of
+   exp(log_q), given the sum of the scales of the frames of each type.*/
+static double od_rc_estimate_bits(const od_rc_state *rc,
+ const double scale[OD_RC_NFRAME_TYPES], double log_q) {
+  double bits;
+  int fti;
+  bits = 0;
+  for (fti = 0; fti < OD_RC_NFRAME_TYPES; fti++) {
+    if (scale[fti] > 0) bits += scale[fti]*exp(-rc->exp[fti]*log_q);
+  }
+  return bits;
+}
+
+/*Picks the coded quantizer for the next frame, before any adjustment for its
+   frame type.
+  frame_type: The type of the next frame.
+  golden: Whether the next frame is a golden frame.
+  duration: The duration of the next frame, in timebase ticks.
+  frames_to_key: The (approximate) number of frames until the next keyframe.
+  b_frames: The number of B frames between reference frames.
+  golden_interval: The number of reference frames between golden frames.
+  Return: The coded quantizer to use.*/
+int od_rc_select_quantizer(od_rc_state *rc, int frame_type, int golden,
+ int duration, int frames_to_key, int b_frames, int golden_interval) {
+  double scale[OD_RC_NFRAME_TYPES];
+  double log_frame_scale;
+  double rate_total;
+  double log_qmin;
+  double log_qmax;
+  double lo;
+  double hi;
+  double log_q;
+  int cq;
+  int fti;
+  int i;
+  OD_ASSERT(frame_type >= 0 && frame_type <= OD_B_FRAME);
+  rc->golden = golden;
+  rc->duration = OD_MAXI(duration, 1);
+  if (rc->twopass == 1 && !rc->twopass_header) {
+    rc->twopass_place_keys = b_frames == 0;
+  }
+  if (golden && frame_type == OD_P_FRAME) frame_type = OD_RC_GOLDEN_P;
+  rc->frame_type = frame_type;
+  rc->frame_duration = rc->duration*rc->tick_duration;
+  if (rc->twopass == 2 && rc->stats_pos < rc->nstats) {
+    /*Spread what is left of the budget over the rest of the file, using the
+       first-pass statistics of each frame.*/
+    rate_total = rc->target_bitrate*rc->stats_duration + rc->reservoir;
+    for (fti = 0; fti < OD_RC_NFRAME_TYPES; fti++) {
+      scale[fti] = rc->stats_scale[fti]*exp(rc->log_corr[fti]);
+    }
+    log_frame_scale = rc->stats[rc->stats_pos].log_scale
+     + rc->log_corr[frame_type];
+  }
+  else {
+    double frame_bits;
+    int window;
+    int nkey;
+    int nrest;
+    int nref;
+    frame_bits = rc->target_bitrate*rc->frame_duration;
+    /*Plan over as many frames as fit in the buffer at the target rate, and
+       aim to bring the reservoir back to its target by the end of them.*/
+    window = (int)OD_CLAMPF(1, od_rc_buffer_size(rc)/frame_bits,
+     rc->keyframe_rate);
+    rate_total = window*frame_bits + rc->reservoir;
+    /*Count the frames of each type in the window, assuming a regular GOP
+       structure.*/
+    OD_CLEAR(scale, OD_RC_NFRAME_TYPES);
+    scale[frame_type] = 1;
+    nkey = 0;
+    if (window > 1 && frames_to_key < window) {
+      nkey = 1 + (window - 1 - OD_MAXI(frames_to_key, 1))/rc->keyframe_rate;
+    }
+    nrest = window - 1 - nkey;
+    nref = nrest - nrest*b_frames/(b_frames + 1);
+    scale[OD_I_FRAME] += nkey;
+    scale[OD_B_FRAME] += nrest - nref;
+    scale[OD_RC_GOLDEN_P] += nref/OD_MAXI(golden_interval, 1);
+    scale[OD_P_FRAME] += nref - nref/OD_MAXI(golden_interval, 1);
+    for (fti = 0; fti < OD_RC_NFRAME_TYPES; fti++) {
+      scale[fti] *= exp(rc->log_scale[fti]);
+    }
+    log_frame_scale = rc->log_scale[frame_type];
+  }
+  log_qmin = log(od_codedquantizer_to_quantizer(1));
+  log_qmax = log(od_codedquantizer_to_quantizer(OD_N_CODED_QUANTIZERS - 1));
+  /*The estimate decreases monotonically with the quantizer, so bisect.*/
+  if (rate_total <= 0) log_q = log_qmax;
+  else {
+    lo = log_qmin;
+    hi = log_qmax;
+    for (i = 0; i < 24; i++) {
+      log_q = .5*(lo + hi);
+      if (od_rc_estimate_bits(rc, scale, log_q) > rate_total) lo = log_q;
+      else hi = log_q;
+    }
+    log_q = hi;
+  }
+  /*Make sure the frame does not empty the decoder buffer.*/
+  if (rc->buffer_fullness > 0) {
+    double max_bits;
+    max_bits = OD_RC_BUFFER_MAX_DRAIN*rc->buffer_fullness;
+    log_q = OD_MAXF(log_q,
+     (log_frame_scale - log(max_bits))/rc->exp[frame_type]);
+  }
+  else log_q = log_qmax;
+  log_q = OD_CLAMPF(log_qmin, log_q, log_qmax);
+  /*Round to the nearest coded quantizer in the log domain.*/
+  cq = od_quantizer_to_codedquantizer((int)exp(log_q));
+  if (cq + 1 < OD_N_CODED_QUANTIZERS
+   && log(od_codedquantizer_to_quantizer(cq + 1)) - log_q
+   < log_q - log(od_codedquantizer_to_quantizer(cq))) {
+    cq++;
+  }
+  rc->coded_quantizer = cq;
+  rc->log_q = log(od_codedquantizer_to_quantizer(cq));
+  return cq;
+}
+
+static void od_rc_write_uint32(unsigned char *buf, uint32_t v) {
+  buf[0] = (unsigned char)(v & 0xFF);
+  buf[1] = (unsigned char)(v >> 8 & 0xFF);
+  buf[2] = (unsigned char)(v >> 16 & 0xFF);
+  buf[3] = (unsigned char)(v >> 24);
+}
+
+static uint32_t od_rc_read_uint32(const unsigned char *buf) {
+  return buf[0] | (uint32_t)buf[1] << 8 | (uint32_t)buf[2] << 16
+   | (uint32_t)buf[3] << 24;
+}
+
+/*Writes the first-pass statistics of the current frame (preceded by the
+   stream header for the first frame).
+  The header is "OD2P", followed by a version byte, and a byte which is
+   non-zero if the first pass used B frames.
+  Each frame is then coded as 20 bytes: the frame type, whether it is a
+   golden frame, the coded quantizer chosen by rate control, a zero byte,
+   then the duration in timebase ticks, the size in bits, and the intra and
+   inter costs (see od_rc_state), as 32-bit little-endian values.*/
+static void od_rc_2pass_write_frame(od_rc_state *rc, int32_t bits) {
+  unsigned char *buf;
+  int nbuf;
+  nbuf = rc->twopass_nbuf + OD_RC_2PASS_FRAME_SZ
+   + (rc->twopass_header ? 0 : OD_RC_2PASS_HEADER_SZ);
+  if (nbuf > rc->twopass_cbuf) {
+    int cbuf;
+    cbuf = OD_MAXI(rc->twopass_cbuf << 1,
+     OD_RC_2PASS_HEADER_SZ + OD_RC_2PASS_FRAME_SZ);
+    cbuf = OD_MAXI(cbuf, nbuf);
+    buf = (unsigned char *)realloc(rc->twopass_buf, cbuf);
+    if (OD_UNLIKELY(buf == NULL)) {
+      rc->twopass_lost = 1;
+      return;
+    }
+    rc->twopass_buf = buf;
+    rc->twopass_cbuf = cbuf;
+  }
+  buf = rc->twopass_buf + rc->twopass_nbuf;
+  if (!rc->twopass_header) {
+    buf[0] = 'O';
+    buf[1] = 'D';
+    buf[2] = '2';
+    buf[3] = 'P';
+    buf[4] = OD_RC_2PASS_VERSION;
+    buf[5] = !rc->twopass_place_keys;
+    buf[6] = buf[7] = 0;
+    buf += OD_RC_2PASS_HEADER_SZ;
+    rc->twopass_nbuf += OD_RC_2PASS_HEADER_SZ;
+    rc->twopass_header = 1;
+  }
+  buf[0] = (unsigned char)(rc->frame_type == OD_RC_GOLDEN_P ?
+   OD_P_FRAME : rc->frame_type);
+  buf[1] = (unsigned char)rc->golden;
+  buf[2] = (unsigned char)rc->coded_quantizer;
+  buf[3] = 0;
+  od_rc_write_uint32(buf + 4, rc->duration);
+  od_rc_write_uint32(buf + 8, bits);
+  od_rc_write_uint32(buf + 12, rc->intra_cost);
+  od_rc_write_uint32(buf + 16, rc->inter_cost);
+  rc->twopass_nbuf += OD_RC_2PASS_FRAME_SZ;
+}
+
+/*Updates the rate model, the reservoir and the decoder buffer model with the
+   size of the frame last passed to od_rc_select_quantizer().*/
+void od_rc_update_state(od_rc_state *rc, int32_t bits) {
+  double buffer_size;
+  double log_scale;
+  double alpha;
+  int fti;
+  fti = rc->frame_type;
+  log_scale = log(OD_MAXI(bits, 1)) + rc->exp[fti]*rc->log_q;
+  alpha = OD_MAXF(OD_RC_SCALE_ALPHA[fti], 1./(rc->nframes[fti] + 1));
+  rc->log_scale[fti] += alpha*(log_scale - rc->log_scale[fti]);
+  rc->nframes[fti]++;
+  buffer_size = od_rc_buffer_size(rc);
+  rc->reservoir += rc->target_bitrate*rc->frame_duration - bits;
+  if (rc->twopass == 1) od_rc_2pass_write_frame(rc, bits);
+  else if (rc->twopass == 2 && rc->stats_pos < rc->nstats) {
+    const od_rc_frame_stats *fs;
+    fs = rc->stats + rc->stats_pos;
+    rc->log_corr[fti] += OD_RC_SCALE_ALPHA[fti]
+     *(log_scale - fs->log_scale - rc->log_corr[fti]);
+    rc->stats_scale[fs->frame_type] = OD_MAXF(0,
+     rc->stats_scale[fs->frame_type] - exp(fs->log_scale));
+    rc->stats_duration = OD_MAXF(0,
+     rc->stats_duration - fs->duration*rc->tick_duration);
+    rc->stats_pos++;
+  }
+  /*Only the second pass knows how many bits are left for the whole file, so
+     keep the reservoir within the buffer otherwise.*/
+  if (rc->twopass != 2 || rc->stats_pos >= rc->nstats) {
+    rc->reservoir = OD_CLAMPF(-buffer_size, rc->reservoir, buffer_size);
+  }
+  /*The decoder buffer cannot hold more than its size: any more data would
+     simply not be sent.*/
+  rc->buffer_fullness = OD_MINF(buffer_size, OD_MAXF(0,
+   rc->buffer_fullness - bits) + od_rc_max_bitrate(rc)*rc->frame_duration);
+}
+
+/*Returns the first-pass statistics produced since the last call.
+  Return: The number of bytes stored in *buf, or OD_EFAULT if the statistics
+   of a frame were lost to an allocation failure.*/
+int od_rc_2pass_out(od_rc_state *rc, unsigned char **buf) {
+  int nbuf;
+  if (OD_UNLIKELY(rc->twopass_lost)) return OD_EFAULT;
+  *buf = rc->twopass_buf;
+  nbuf = rc->twopass_nbuf;
+  rc->twopass_nbuf = 0;
+  return nbuf;
+}
+
+/*Adds the first-pass statistics of one frame, deciding which type the second
+   pass will code it as.*/
+static int od_rc_2pass_add_frame(od_rc_state *rc, const unsigned char *buf) {
+  od_rc_frame_stats *fs;
+  uint32_t intra_cost;
+  uint32_t inter_cost;
+  int frame_type;
+  int golden;
+  int cq;
+  int since_key;
+  frame_type = buf[0];
+  golden = buf[1];
+  cq = buf[2];
+  if (frame_type > OD_B_FRAME || cq < 1 || cq >= OD_N_CODED_QUANTIZERS) {
+    return OD_EINVAL;
+  }
+  if (rc->nstats >= rc->cstats) {
+    od_rc_frame_stats *stats;
+    int cstats;
+    cstats = OD_MAXI(rc->cstats << 1, 256);
+    stats = (od_rc_frame_stats *)realloc(rc->stats,
+     cstats*sizeof(*stats));
+    if (OD_UNLIKELY(stats == NULL)) return OD_EFAULT;
+    rc->stats = stats;
+    rc->cstats = cstats;
+  }
+  intra_cost = od_rc_read_uint32(buf + 12);
+  inter_cost = od_rc_read_uint32(buf + 16);
+  if (rc->twopass_place_keys) {
+    /*Follow the same rules as the encoder: a keyframe every keyframe_rate
+       frames, counting from the last one, and at each scene cut.
+      A scene cut is a frame that is cheaper to code without motion
+       compensation.*/
+    since_key = rc->nstats > 0 ? rc->stats_since_key + 1 : 0;
+    if (since_key == 0 || since_key >= rc->keyframe_rate
+     || (frame_type != OD_I_FRAME && since_key >= OD_RC_MIN_KEY_DIST
+     && inter_cost > intra_cost)) {
+      frame_type = OD_I_FRAME;
+      since_key = 0;
+    }
+    else if (frame_type == OD_I_FRAME) frame_type = OD_P_FRAME;
+    rc->stats_since_key = since_key;
+  }
+  if (golden && frame_type == OD_P_FRAME) frame_type = OD_RC_GOLDEN_P;
+  fs = rc->stats + rc->nstats++;
+  fs->frame_type = frame_type;
+  fs->duration = OD_MAXI(od_rc_read_uint32(buf + 4), 1);
+  fs->log_scale = log(OD_MAXI(od_rc_read_uint32(buf + 8), 1))
+   + rc->exp[frame_type]*log(od_codedquantizer_to_quantizer(cq));
+  rc->stats_scale[frame_type] += exp(fs->log_scale);
+  rc->stats_duration += fs->duration*rc->tick_duration;
+  return OD_SUCCESS;
+}
+
+/*Reads first-pass statistics for the second pass.
+  They may be split into pieces of any size.
+  Return: The number of bytes consumed, or a negative value on error.*/
+int od_rc_2pass_in(od_rc_state *rc, const unsigned char *buf, size_t nbytes) {
+  size_t consumed;
+  consumed = 0;
+  while (consumed < nbytes) {
+    int need;
+    int n;
+    need = rc->twopass_header ? OD_RC_2PASS_FRAME_SZ : OD_RC_2PASS_HEADER_SZ;
+    n = (int)OD_MINI((size_t)(need - rc->twopass_npartial),
+     nbytes - consumed);
+    memcpy(rc->twopass_partial + rc->twopass_npartial, buf + consumed, n);
+    rc->twopass_npartial += n;
+    consumed += n;
+    if (rc->twopass_npartial < need) break;
+    rc->twopass_npartial = 0;
+    if (!rc->twopass_header) {
+      if (memcmp(rc->twopass_partial, "OD2P", 4) != 0
+       || rc->twopass_partial[4] != OD_RC_2PASS_VERSION) {
+        return OD_EINVAL;
+      }
+      rc->twopass_place_keys = rc->twopass_partial[5] == 0;
+      rc->twopass_header = 1;
+    }
+    else {
+      int ret;
+      ret = od_rc_2pass_add_frame(rc, rc->twopass_partial);
+      if (ret < 0) return ret;
+    }
+  }
+  return (int)consumed;
+}
+
+/*Returns whether the second pass wants the next frame to be a keyframe, or
+   -1 if it does not place keyframes (because the first pass used B frames or
+   its statistics have run out).*/
+int od_rc_2pass_keyframe(const od_rc_state *rc) {
+  if (rc->twopass != 2 || !rc->twopass_place_keys
+   || rc->stats_pos >= rc->nstats) {
+    return -1;
+  }
+  return rc->stats[rc->stats_pos].frame_type == OD_I_FRAME;
+}
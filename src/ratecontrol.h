@@ -0,0 +1,147 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#if !defined(_ratecontrol_H)
+# define _ratecontrol_H (1)
+
+# include "../include/daala/codec.h"
+
+/*The number of frame types with their own rate model: I, P and B frames,
+   plus golden P frames, which use a finer quantizer than other P frames.*/
+# define OD_RC_NFRAME_TYPES (4)
+/*The rate model index of golden P frames.*/
+# define OD_RC_GOLDEN_P (3)
+
+/*The size of the header of the two-pass statistics stream, in bytes.*/
+# define OD_RC_2PASS_HEADER_SZ (8)
+/*The size of the two-pass statistics of one frame, in bytes.*/
+# define OD_RC_2PASS_FRAME_SZ (20)
+
+typedef struct od_rc_frame_stats od_rc_frame_stats;
+typedef struct od_rc_state od_rc_state;
+
+/*The first-pass statistics of one frame, as used by the second pass.*/
+struct od_rc_frame_stats {
+  /*The rate model index the second pass expects to code the frame with.*/
+  int frame_type;
+  /*The duration of the frame, in timebase ticks.*/
+  int duration;
+  /*The log of the scale of the rate model of this frame alone.*/
+  double log_scale;
+};
+
+/*Average bitrate control with a VBV-style buffer constraint.
+  The number of bits used by a frame of a given type is modeled as
+   scale*q^-exp, where q is the (uncoded) quantizer.
+  The scale is tracked in the log domain for each frame type and updated
+   after each frame is coded, while the exponents are fixed.
+  In the second pass of a two-pass encode, each frame instead gets its own
+   scale from the first-pass statistics, and the scale of each frame type is
+   only used to correct those.*/
+struct od_rc_state {
+  /*The target bitrate in bits per second, or 0 if rate control is off.*/
+  int32_t target_bitrate;
+  /*The maximum rate at which the decoder buffer fills, in bits per second.*/
+  int32_t max_bitrate;
+  /*The size of the decoder buffer, in bits.*/
+  int32_t buffer_size;
+  /*The duration of one tick of the timebase, in seconds.*/
+  double tick_duration;
+  /*The distance between keyframes.*/
+  int keyframe_rate;
+  /*The number of bits saved (or overspent, if negative) relative to the
+     target so far.*/
+  double reservoir;
+  /*The number of bits in the decoder buffer before the next frame is
+     removed.*/
+  double buffer_fullness;
+  /*The log of the scale of the rate model of each frame type.*/
+  double log_scale[OD_RC_NFRAME_TYPES];
+  /*The exponent of the rate model of each frame type.*/
+  double exp[OD_RC_NFRAME_TYPES];
+  /*The number of frames of each type the model has been updated with.*/
+  int nframes[OD_RC_NFRAME_TYPES];
+  /*The rate model index of the frame currently being coded.*/
+  int frame_type;
+  /*The log of the quantizer the current frame was coded with.*/
+  double log_q;
+  /*The duration of the current frame, in seconds.*/
+  double frame_duration;
+  /*The duration of the current frame, in timebase ticks.*/
+  int duration;
+  /*Whether the current frame is a golden frame.*/
+  int golden;
+  /*The coded quantizer chosen for the current frame.*/
+  int coded_quantizer;
+  /*The intra and inter (motion compensated) costs of the current frame, as
+     mean absolute differences per luma pixel in Q8, for the first pass.*/
+  uint32_t intra_cost;
+  uint32_t inter_cost;
+  /*0: single pass, 1: first pass, 2: second pass.*/
+  int twopass;
+  /*First pass: statistics not yet returned by OD_2PASS_OUT, which grow by
+     one frame at a time until they are.*/
+  unsigned char *twopass_buf;
+  int twopass_nbuf;
+  int twopass_cbuf;
+  /*First pass: set when the statistics of a frame could not be stored.*/
+  int twopass_lost;
+  /*Second pass: a partially received header or frame.*/
+  unsigned char twopass_partial[OD_RC_2PASS_FRAME_SZ];
+  int twopass_npartial;
+  /*Second pass: whether the header has been received, and whether the first
+     pass ran without B frames, so that keyframes can be moved.*/
+  int twopass_header;
+  int twopass_place_keys;
+  /*Second pass: the statistics of each frame, in coding order.*/
+  od_rc_frame_stats *stats;
+  int nstats;
+  int cstats;
+  /*Second pass: the index of the current frame in stats.*/
+  int stats_pos;
+  /*Second pass: the number of frames since the last keyframe, at the end of
+     stats.*/
+  int stats_since_key;
+  /*Second pass: the sum of the scales of the frames of each type left in
+     stats, including the current one, and the total duration of those frames
+     in seconds.*/
+  double stats_scale[OD_RC_NFRAME_TYPES];
+  double stats_duration;
+  /*Second pass: the log of the correction to the first-pass scales of each
+     frame type.*/
+  double log_corr[OD_RC_NFRAME_TYPES];
+};
+
+void od_rc_init(od_rc_state *rc, const daala_info *info);
+void od_rc_clear(od_rc_state *rc);
+void od_rc_reset(od_rc_state *rc);
+int od_rc_select_quantizer(od_rc_state *rc, int frame_type, int golden,
+ int duration, int frames_to_key, int b_frames, int golden_interval);
+void od_rc_update_state(od_rc_state *rc, int32_t bits);
+int od_rc_2pass_out(od_rc_state *rc, unsigned char **buf);
+int od_rc_2pass_in(od_rc_state *rc, const unsigned char *buf, size_t nbytes);
+int od_rc_2pass_keyframe(const od_rc_state *rc);
+
+#endif
@@ -0,0 +1,283 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include "srcanalysis.h"
+
+/*The log of the size of the blocks of the motion search.*/
+#define OD_SA_LOG_BSIZE (4)
+/*The padding of the luma planes, which bounds how far a block may point
+   outside of the frame, as in motion compensation.*/
+#define OD_SA_PADDING (OD_UMV_CLAMP)
+/*The step of the first diamond of the motion search, in pixels.*/
+#define OD_SA_STEP_MAX (8)
+
+static const int OD_SA_DIAMOND[4][2] = { { 0, -1 }, { -1, 0 }, { 1, 0 },
+ { 0, 1 } };
+
+/*Copies a luma plane to 8 bits, and extends its edges into the padding.*/
+static void od_sa_copy_luma(const od_src_analysis *sa, unsigned char *dst,
+ const od_img_plane *iplane) {
+  unsigned char *row;
+  int shift;
+  int x;
+  int y;
+  shift = iplane->bitdepth - 8;
+  for (y = 0; y < sa->h; y++) {
+    const unsigned char *src;
+    row = dst + y*sa->stride;
+    src = iplane->data + y*iplane->ystride;
+    if (iplane->xstride == 1) memcpy(row, src, sa->w);
+    else {
+      for (x = 0; x < sa->w; x++) {
+        row[x] = (unsigned char)OD_CLAMP255(
+         (((const uint16_t *)src)[x] + (1 << shift >> 1)) >> shift);
+      }
+    }
+    memset(row - OD_SA_PADDING, row[0], OD_SA_PADDING);
+    memset(row + sa->w, row[sa->w - 1], OD_SA_PADDING);
+  }
+  row = dst - OD_SA_PADDING;
+  for (y = 1; y <= OD_SA_PADDING; y++) {
+    memcpy(row - y*sa->stride, row, sa->stride);
+    memcpy(row + (sa->h - 1 + y)*sa->stride, row + (sa->h - 1)*sa->stride,
+     sa->stride);
+  }
+}
+
+static int32_t od_sa_sad(const unsigned char *a, const unsigned char *b,
+ int stride) {
+  int32_t sad;
+  int x;
+  int y;
+  sad = 0;
+  for (y = 0; y < 1 << OD_SA_LOG_BSIZE; y++) {
+    for (x = 0; x < 1 << OD_SA_LOG_BSIZE; x++) {
+      sad += abs(a[y*stride + x] - b[y*stride + x]);
+    }
+  }
+  return sad;
+}
+
+/*Searches each block of the current frame in a reference frame.
+  The best of the zero vector, the vector of the block in the previous
+   field and those of its causal neighbors in this one is refined with a
+   diamond search of decreasing step.*/
+static void od_sa_search(od_src_analysis *sa, const unsigned char *ref,
+ int (*mvs)[2]) {
+  int bsize;
+  int stride;
+  int bx;
+  int by;
+  bsize = 1 << OD_SA_LOG_BSIZE;
+  stride = sa->stride;
+  for (by = 0; by < sa->nvmvs; by++) {
+    for (bx = 0; bx < sa->nhmvs; bx++) {
+      const unsigned char *cur;
+      const unsigned char *blk;
+      int cands[5][2];
+      int ncands;
+      int32_t best_sad;
+      int best[2];
+      int xmin;
+      int xmax;
+      int ymin;
+      int ymax;
+      int x0;
+      int y0;
+      int step;
+      int ci;
+      int k;
+      k = by*sa->nhmvs + bx;
+      /*The block is centered on its vertex of the MV grid.*/
+      x0 = (bx << OD_SA_LOG_BSIZE) - (bsize >> 1);
+      y0 = (by << OD_SA_LOG_BSIZE) - (bsize >> 1);
+      xmin = -OD_SA_PADDING - x0;
+      xmax = sa->w + OD_SA_PADDING - bsize - x0;
+      ymin = -OD_SA_PADDING - y0;
+      ymax = sa->h + OD_SA_PADDING - bsize - y0;
+      cur = sa->cur + y0*stride + x0;
+      blk = ref + y0*stride + x0;
+      ncands = 0;
+      cands[ncands][0] = mvs[k][0] >> 1;
+      cands[ncands++][1] = mvs[k][1] >> 1;
+      if (bx > 0) {
+        cands[ncands][0] = mvs[k - 1][0] >> 1;
+        cands[ncands++][1] = mvs[k - 1][1] >> 1;
+      }
+      if (by > 0) {
+        cands[ncands][0] = mvs[k - sa->nhmvs][0] >> 1;
+        cands[ncands++][1] = mvs[k - sa->nhmvs][1] >> 1;
+        if (bx + 1 < sa->nhmvs) {
+          cands[ncands][0] = mvs[k - sa->nhmvs + 1][0] >> 1;
+          cands[ncands++][1] = mvs[k - sa->nhmvs + 1][1] >> 1;
+        }
+      }
+      best[0] = best[1] = 0;
+      best_sad = od_sa_sad(cur, blk, stride);
+      for (ci = 0; ci < ncands; ci++) {
+        int32_t sad;
+        int dx;
+        int dy;
+        dx = OD_CLAMPI(xmin, cands[ci][0], xmax);
+        dy = OD_CLAMPI(ymin, cands[ci][1], ymax);
+        if (dx == best[0] && dy == best[1]) continue;
+        sad = od_sa_sad(cur, blk + dy*stride + dx, stride);
+        if (sad < best_sad) {
+          best_sad = sad;
+          best[0] = dx;
+          best[1] = dy;
+        }
+      }
+      for (step = OD_SA_STEP_MAX; step > 0; step >>= 1) {
+        int best_site;
+        do {
+          int center[2];
+          int site;
+          best_site = -1;
+          center[0] = best[0];
+          center[1] = best[1];
+          for (site = 0; site < 4; site++) {
+            int32_t sad;
+            int dx;
+            int dy;
+            dx = center[0] + step*OD_SA_DIAMOND[site][0];
+            dy = center[1] + step*OD_SA_DIAMOND[site][1];
+            if (dx < xmin || dx > xmax || dy < ymin || dy > ymax) continue;
+            sad = od_sa_sad(cur, blk + dy*stride + dx, stride);
+            if (sad < best_sad) {
+              best_sad = sad;
+              best[0] = dx;
+              best[1] = dy;
+              best_site = site;
+            }
+          }
+        }
+        while (best_site >= 0);
+      }
+      mvs[k][0] = best[0] << 1;
+      mvs[k][1] = best[1] << 1;
+    }
+  }
+}
+
+int od_src_analysis_init(od_src_analysis *sa, const od_state *state,
+ int use_psy) {
+  size_t plane_sz;
+  size_t field_sz;
+  int refi;
+  int ri;
+  sa->w = state->frame_width >> state->info.plane_info[0].xdec;
+  sa->h = state->frame_height >> state->info.plane_info[0].ydec;
+  sa->stride = sa->w + 2*OD_SA_PADDING;
+  plane_sz = (size_t)sa->stride*(sa->h + 2*OD_SA_PADDING);
+  sa->nhmvs = (sa->w >> OD_SA_LOG_BSIZE) + 1;
+  sa->nvmvs = (sa->h >> OD_SA_LOG_BSIZE) + 1;
+  field_sz = (size_t)sa->nhmvs*sa->nvmvs;
+  sa->nhsb = state->nhsb;
+  sa->nvsb = state->nvsb;
+  sa->data = (unsigned char *)malloc(plane_sz*(OD_FRAME_MAX + 2));
+  sa->fields[0] = (int (*)[2])calloc(field_sz*OD_SA_NREFS,
+   sizeof(*sa->fields[0]));
+  sa->psy_data = NULL;
+  if (use_psy) {
+    sa->psy_data = (od_superblock_stats *)malloc(
+     (size_t)sa->nhsb*sa->nvsb*sizeof(*sa->psy_data));
+  }
+  if (OD_UNLIKELY(sa->data == NULL || sa->fields[0] == NULL
+   || (use_psy && sa->psy_data == NULL))) {
+    free(sa->data);
+    free(sa->fields[0]);
+    free(sa->psy_data);
+    return OD_EFAULT;
+  }
+  sa->cur = sa->data + OD_SA_PADDING*sa->stride + OD_SA_PADDING;
+  for (refi = 0; refi <= OD_FRAME_MAX; refi++) {
+    sa->refs[refi] = sa->cur + plane_sz*(refi + 1);
+  }
+  for (ri = 0; ri < OD_SA_NREFS; ri++) {
+    sa->fields[ri] = sa->fields[0] + field_sz*ri;
+    sa->mvs[ri] = NULL;
+  }
+  sa->psy_stats = NULL;
+  return OD_SUCCESS;
+}
+
+void od_src_analysis_clear(od_src_analysis *sa) {
+  free(sa->data);
+  free(sa->fields[0]);
+  free(sa->psy_data);
+}
+
+/*Analyzes a new input frame of the given type, whose references are in the
+   buffers given by ref_imgi.*/
+void od_src_analysis_run(od_src_analysis *sa, const od_img *img,
+ int frame_type, const int ref_imgi[OD_FRAME_MAX + 1]) {
+  int ri;
+  od_sa_copy_luma(sa, sa->cur, img->planes + 0);
+  for (ri = 0; ri < OD_SA_NREFS; ri++) {
+    int rj;
+    sa->mvs[ri] = NULL;
+    if (frame_type == OD_I_FRAME || ref_imgi[ri] < 0) continue;
+    if (ri == OD_FRAME_GOLD && frame_type != OD_P_FRAME) continue;
+    if (ri == OD_FRAME_NEXT && frame_type != OD_B_FRAME) continue;
+    /*A buffer used by two reference types is only searched once.*/
+    for (rj = 0; rj < ri && (sa->mvs[rj] == NULL
+     || ref_imgi[rj] != ref_imgi[ri]); rj++);
+    if (rj < ri) sa->mvs[ri] = sa->mvs[rj];
+    else {
+      od_sa_search(sa, sa->refs[ref_imgi[ri]], sa->fields[ri]);
+      sa->mvs[ri] = sa->fields[ri];
+    }
+  }
+  sa->psy_stats = NULL;
+  if (sa->psy_data != NULL && img->planes[0].xstride == 1) {
+    const od_img_plane *iplane;
+    int sbx;
+    int sby;
+    iplane = img->planes + 0;
+    for (sby = 0; sby < sa->nvsb; sby++) {
+      for (sbx = 0; sbx < sa->nhsb; sbx++) {
+        od_compute_psy_stats(sa->psy_data + sby*sa->nhsb + sbx,
+         iplane->data + (sby*iplane->ystride + sbx)*OD_BSIZE_MAX,
+         iplane->ystride);
+      }
+    }
+    sa->psy_stats = sa->psy_data;
+  }
+}
+
+/*Keeps the luma of the frame that was just analyzed as the source of the
+   reference buffer it was coded into.*/
+void od_src_analysis_store(od_src_analysis *sa, int refi) {
+  unsigned char *tmp;
+  tmp = sa->refs[refi];
+  sa->refs[refi] = sa->cur;
+  sa->cur = tmp;
+}
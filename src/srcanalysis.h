@@ -0,0 +1,79 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#if !defined(_srcanalysis_H)
+# define _srcanalysis_H (1)
+
+# include "state.h"
+# include "block_size_enc.h"
+
+/*The number of reference types that are searched: OD_FRAME_GOLD,
+   OD_FRAME_PREV and OD_FRAME_NEXT.*/
+# define OD_SA_NREFS (OD_FRAME_NEXT + 1)
+
+typedef struct od_src_analysis od_src_analysis;
+
+/*The analysis of each input frame that only depends on the source, done once
+   by an encoder for all the encoders of its ladder.
+  A fullpel motion search of 16x16 luma blocks against the input frames that
+   were coded into each reference buffer gives every encoder the starting
+   candidates of its own motion search, and the statistics of the psy model
+   of each superblock are shared by the open-loop block size decisions.*/
+struct od_src_analysis {
+  /*The size of the luma plane.*/
+  int w;
+  int h;
+  /*The padded 8-bit luma of the current frame, and of the input frame that
+     was coded into each reference buffer, indexed like ref_imgi.*/
+  unsigned char *cur;
+  unsigned char *refs[OD_FRAME_MAX + 1];
+  int stride;
+  /*The number of vectors along each direction: one for every other vertex
+     of the MV grid, at the center of a 16x16 block.*/
+  int nhmvs;
+  int nvmvs;
+  /*The motion field of the current frame against each reference type, in
+     half-pel units, or NULL for reference types it does not use.
+    Each field keeps the vectors of the last frame that searched it, which
+     are temporal candidates for the next one.*/
+  int (*mvs[OD_SA_NREFS])[2];
+  int (*fields[OD_SA_NREFS])[2];
+  /*The psy model statistics of each superblock of the current frame, or
+     NULL if no encoder makes open-loop block size decisions.*/
+  od_superblock_stats *psy_stats;
+  od_superblock_stats *psy_data;
+  int nhsb;
+  int nvsb;
+  unsigned char *data;
+};
+
+int od_src_analysis_init(od_src_analysis *sa, const od_state *state,
+ int use_psy);
+void od_src_analysis_clear(od_src_analysis *sa);
+void od_src_analysis_run(od_src_analysis *sa, const od_img *img,
+ int frame_type, const int ref_imgi[OD_FRAME_MAX + 1]);
+void od_src_analysis_store(od_src_analysis *sa, int refi);
+
+#endif
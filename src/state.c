@@ -26,6 +26,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 # include "config.h"
 #endif
 
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -34,6 +35,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "util.h"
 #if defined(OD_X86ASM)
 # include "x86/x86int.h"
+#elif defined(OD_ARMASM)
+# include "arm/armint.h"
 #endif
 #include "block_size.h"
 
@@ -90,6 +93,12 @@ void od_aligned_free(void *_ptr) {
    and out of the codec, not for internal reference->reference copies.
   Does not touch any padding/border/unintersected area.*/
 void od_img_plane_copy(od_img* dst, od_img* src, int pli) {
+  od_img_plane_copy_rows(dst, src, pli, 0, INT_MAX);
+}
+
+/*Copies rows [y0, y1) of plane pli, like od_img_plane_copy().*/
+void od_img_plane_copy_rows(od_img* dst, od_img* src, int pli, int y0,
+ int y1) {
   od_img_plane *dst_plane;
   od_img_plane *src_plane;
   unsigned char *dst_data;
@@ -133,8 +142,10 @@ void od_img_plane_copy(od_img* dst, od_img* src, int pli) {
   src_plane_width = ((src->width + (1 << src_xdec) - 1) >> src_xdec);
   src_plane_height = ((src->height + (1 << src_ydec) - 1) >> src_ydec);
   w = OD_MINI(dst_plane_width, src_plane_width);
-  h = OD_MINI(dst_plane_height, src_plane_height);
-  for (y = 0; y < h; y++) {
+  h = OD_MINI(OD_MINI(dst_plane_height, src_plane_height), y1);
+  dst_data += y0*dst_ystride;
+  src_data += y0*src_ystride;
+  for (y = y0; y < h; y++) {
     unsigned char *src_ptr;
     unsigned char *dst_ptr;
     src_ptr = src_data;
@@ -227,10 +238,30 @@ void od_img_copy(od_img* dst, od_img* src) {
   }
 }
 
+/*Lays out the motion compensation and edge emulation buffers in data, which
+   holds OD_MC_BUFS_SIZE(reference_bytes) bytes, and returns the end of
+   them.*/
+unsigned char *od_state_set_mc_bufs(od_state *state, unsigned char *data,
+ int reference_bytes) {
+  int i;
+  for (i = 0; i < 5; i++) {
+    state->mc_buf[i] = data;
+    data += OD_MVBSIZE_MAX*OD_MVBSIZE_MAX*reference_bytes;
+  }
+  for (i = 0; i < 4; i++) {
+    state->mc_edge_buf[i] = data;
+    data += OD_MC_EDGE_STRIDE*(OD_MVBSIZE_MAX + 2*OD_RESAMPLE_PADDING)
+     *reference_bytes;
+  }
+  return data;
+}
+
 /*Initializes the buffers used for reference frames.
-  These buffers are padded with 16 extra pixels on each side, to allow
-   (relatively) unrestricted motion vectors without special casing reading
-   outside the image boundary.
+  These buffers are padded with state->ref_padding extra pixels on each
+   side.
+  With OD_BUFFER_PADDING, that allows (relatively) unrestricted motion
+   vectors without special casing reading outside the image boundary, as
+   long as the images are edge extended.
   If chroma is decimated in either direction, the padding is reduced by an
    appropriate factor on the appropriate sides.*/
 static int od_state_ref_imgs_init(od_state *state, int nrefs) {
@@ -255,10 +286,10 @@ static int od_state_ref_imgs_init(od_state *state, int nrefs) {
   reference_bytes = state->full_precision_references ? 2 : 1;
   reference_bits = state->full_precision_references ? 8 + OD_COEFF_SHIFT : 8;
   /*TODO: Check for overflow before allocating.*/
-  frame_buf_width = state->frame_width + (OD_BUFFER_PADDING << 1);
-  frame_buf_height = state->frame_height + (OD_BUFFER_PADDING << 1);
+  frame_buf_width = state->frame_width + (state->ref_padding << 1);
+  frame_buf_height = state->frame_height + (state->ref_padding << 1);
   /*Reserve space for the motion comp buffers.*/
-  data_sz += OD_MVBSIZE_MAX*OD_MVBSIZE_MAX*reference_bytes*5;
+  data_sz += OD_MC_BUFS_SIZE(reference_bytes);
   for (pli = 0; pli < info->nplanes; pli++) {
     /*Reserve space for this plane in nrefs reference images.*/
     plane_buf_width = frame_buf_width >> info->plane_info[pli].xdec;
@@ -270,11 +301,9 @@ static int od_state_ref_imgs_init(od_state *state, int nrefs) {
   if (OD_UNLIKELY(!ref_img_data)) {
     return OD_EFAULT;
   }
+  state->nbytes += data_sz;
   /*Fill in the motion comp buffers.*/
-  for (imgi = 0; imgi < 5; imgi++) {
-    state->mc_buf[imgi] = ref_img_data;
-    ref_img_data += OD_MVBSIZE_MAX*OD_MVBSIZE_MAX*reference_bytes;
-  }
+  ref_img_data = od_state_set_mc_bufs(state, ref_img_data, reference_bytes);
   /*Fill in the reference image structures.*/
   for (imgi = 0; imgi < nrefs; imgi++) {
     img = state->ref_imgs + imgi;
@@ -291,8 +320,8 @@ static int od_state_ref_imgs_init(od_state *state, int nrefs) {
       iplane->xstride = reference_bytes;
       iplane->ystride = plane_buf_width*reference_bytes;
       iplane->data = ref_img_data
-       + (OD_BUFFER_PADDING >> iplane->xdec)*iplane->xstride
-       + (OD_BUFFER_PADDING >> iplane->ydec)*iplane->ystride;
+       + (state->ref_padding >> iplane->xdec)*iplane->xstride
+       + (state->ref_padding >> iplane->ydec)*iplane->ystride;
       ref_img_data += plane_buf_height*iplane->ystride;
     }
   }
@@ -307,6 +336,8 @@ static int od_state_mvs_init(od_state *state) {
   if (OD_UNLIKELY(!state->mv_grid)) {
     return OD_EFAULT;
   }
+  state->nbytes += (state->nvmvbs + 1)
+   *((state->nhmvbs + 1)*sizeof(**state->mv_grid) + sizeof(*state->mv_grid));
   return OD_SUCCESS;
 }
 
@@ -335,6 +366,10 @@ void od_state_opt_vtbl_init_c(od_state *state) {
     OD_COPY(state->opt_vtbl.od_copy_nxn,
      OD_COPY_NXN_8_C, OD_LOG_COPYBSIZE_MAX + 1);
   }
+  OD_COPY(state->opt_vtbl.pre_filter_cols, OD_PRE_FILTER_COLS_C, OD_NBSIZES);
+  OD_COPY(state->opt_vtbl.post_filter_cols, OD_POST_FILTER_COLS_C,
+   OD_NBSIZES);
+  state->opt_vtbl.dir_find8 = od_dir_find8_c;
   OD_COPY(state->opt_vtbl.filter_dering_direction, OD_DERING_DIRECTION_C,
    OD_DERINGSIZES);
   OD_COPY(state->opt_vtbl.filter_dering_orthogonal, OD_DERING_ORTHOGONAL_C,
@@ -342,17 +377,28 @@ void od_state_opt_vtbl_init_c(od_state *state) {
   state->opt_vtbl.restore_fpu = od_restore_fpu_c;
   OD_COPY(state->opt_vtbl.fdct_2d, OD_FDCT_2D_C, OD_NBSIZES + 1);
   OD_COPY(state->opt_vtbl.idct_2d, OD_IDCT_2D_C, OD_NBSIZES + 1);
+  state->opt_vtbl.cdf_search = od_ec_cdf_search_c;
+  state->opt_vtbl.cdf_adapt = od_ec_cdf_adapt_c;
 }
 
 static void od_state_opt_vtbl_init(od_state *state) {
 #if defined(OD_X86ASM)
   od_state_opt_vtbl_init_x86(state);
+#elif defined(OD_ARMASM)
+  od_state_opt_vtbl_init_arm(state);
 #else
   od_state_opt_vtbl_init_c(state);
 #endif
 }
 
-static int od_state_init_impl(od_state *state, const daala_info *info) {
+/*Allocates a buffer of the state, counting it in state->nbytes.*/
+static void *od_state_malloc(od_state *state, size_t size) {
+  state->nbytes += size;
+  return malloc(size);
+}
+
+static int od_state_init_impl(od_state *state, const daala_info *info,
+ int ref_padding) {
   int nplanes;
   int pli;
   /*First validate the parameters.*/
@@ -383,6 +429,7 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
      and lossless frames.
     FIXME: Switch on when FPR SIMD lands.*/
   state->full_precision_references = 0;
+  state->ref_padding = ref_padding;
   od_state_opt_vtbl_init(state);
   if (OD_UNLIKELY(od_state_ref_imgs_init(state, OD_FRAME_MAX + 1))) {
     return OD_EFAULT;
@@ -392,12 +439,13 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
   }
   state->nhsb = state->frame_width >> OD_LOG_BSIZE_MAX;
   state->nvsb = state->frame_height >> OD_LOG_BSIZE_MAX;
+  od_state_set_tile(state, 0, 0, 0);
   for (pli = 0; pli < nplanes; pli++) {
     int xdec;
     int ydec;
     int w;
     int h;
-    state->sb_dc_mem[pli] = (od_coeff*)malloc(
+    state->sb_dc_mem[pli] = (od_coeff*)od_state_malloc(state,
      sizeof(state->sb_dc_mem[pli][0])*state->nhsb*state->nvsb);
     if (OD_UNLIKELY(!state->sb_dc_mem[pli])) {
       return OD_EFAULT;
@@ -406,23 +454,28 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
     ydec = info->plane_info[pli].ydec;
     w = state->frame_width >> xdec;
     h = state->frame_height >> ydec;
-    state->ctmp[pli] = (od_coeff *)malloc(w*h*sizeof(*state->ctmp[pli]));
+    state->ctmp[pli] = (od_coeff *)od_state_malloc(state,
+     w*h*sizeof(*state->ctmp[pli]));
     if (OD_UNLIKELY(!state->ctmp[pli])) {
       return OD_EFAULT;
     }
-    state->dtmp[pli] = (od_coeff *)malloc(w*h*sizeof(*state->dtmp[pli]));
+    state->dtmp[pli] = (od_coeff *)od_state_malloc(state,
+     w*h*sizeof(*state->dtmp[pli]));
     if (OD_UNLIKELY(!state->dtmp[pli])) {
       return OD_EFAULT;
     }
-    state->etmp[pli] = (int16_t *)malloc(w*h*sizeof(*state->etmp[pli]));
+    state->etmp[pli] = (int16_t *)od_state_malloc(state,
+     w*h*sizeof(*state->etmp[pli]));
     if (OD_UNLIKELY(!state->etmp[pli])) {
       return OD_EFAULT;
     }
-    state->mctmp[pli] = (od_coeff *)malloc(w*h*sizeof(*state->mctmp[pli]));
+    state->mctmp[pli] = (od_coeff *)od_state_malloc(state,
+     w*h*sizeof(*state->mctmp[pli]));
     if (OD_UNLIKELY(!state->mctmp[pli])) {
       return OD_EFAULT;
     }
-    state->mdtmp[pli] = (od_coeff *)malloc(w*h*sizeof(*state->mdtmp[pli]));
+    state->mdtmp[pli] = (od_coeff *)od_state_malloc(state,
+     w*h*sizeof(*state->mdtmp[pli]));
     if (OD_UNLIKELY(!state->mdtmp[pli])) {
       return OD_EFAULT;
     }
@@ -439,21 +492,23 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
         }
       }
       if (plj >= pli) {
-        state->lbuf[pli] = state->ltmp[pli] = (od_coeff *)malloc(OD_BSIZE_MAX*
-         OD_BSIZE_MAX*sizeof(*state->ltmp[pli]));
+        state->lbuf[pli] = state->ltmp[pli] = (od_coeff *)od_state_malloc(
+         state, OD_BSIZE_MAX*OD_BSIZE_MAX*sizeof(*state->ltmp[pli]));
         if (OD_UNLIKELY(!state->lbuf[pli])) {
           return OD_EFAULT;
         }
       }
     }
     else state->lbuf[pli] = state->ltmp[pli] = NULL;
-    state->bskip[pli] = (unsigned char *)malloc(sizeof(*state->bskip)*
+    state->bskip[pli] = (unsigned char *)od_state_malloc(state,
+     sizeof(*state->bskip)*
      state->nhsb*state->nvsb<<(2*(OD_NBSIZES-1) - xdec - ydec));
     if (OD_UNLIKELY(!state->bskip[pli])) {
       return OD_EFAULT;
     }
   }
-  state->bsize = (unsigned char *)malloc(sizeof(*state->bsize)*
+  state->bsize = (unsigned char *)od_state_malloc(state,
+   sizeof(*state->bsize)*
    (state->nhsb + 2)*OD_BSIZE_GRID*(state->nvsb + 2)*OD_BSIZE_GRID);
   if (OD_UNLIKELY(!state->bsize)) {
     return OD_EFAULT;
@@ -470,12 +525,13 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
     int nvdr;
     nhdr = state->frame_width >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
     nvdr = state->frame_height >> (OD_LOG_DERING_GRID + OD_LOG_BSIZE0);
-    state->dering_flags = (unsigned char *)malloc(nhdr * nvdr);
+    state->dering_flags = (unsigned char *)od_state_malloc(state, nhdr * nvdr);
     if (OD_UNLIKELY(!state->dering_flags)) {
       return OD_EFAULT;
     }
   }
-  state->sb_q_scaling = (unsigned char *)malloc(state->nhsb * state->nvsb);
+  state->sb_q_scaling = (unsigned char *)od_state_malloc(state,
+   state->nhsb * state->nvsb);
   /*Init frame buffer related variables.*/
   state->out_buff_ptr = -1;
   state->out_buff_head = 0;
@@ -483,11 +539,12 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
   if (OD_UNLIKELY(!state->sb_q_scaling)) {
     return OD_EFAULT;
   }
-  state->qm = (int16_t *)malloc(OD_QM_BUFFER_SIZE*sizeof(state->qm[0]));
+  state->qm = (int16_t *)od_state_malloc(state,
+   OD_QM_BUFFER_SIZE*sizeof(state->qm[0]));
   if (OD_UNLIKELY(!state->qm)) {
     return OD_EFAULT;
   }
-  state->qm_inv = (int16_t *)malloc(OD_NBSIZES*2*OD_BSIZE_MAX*
+  state->qm_inv = (int16_t *)od_state_malloc(state, OD_NBSIZES*2*OD_BSIZE_MAX*
    OD_BSIZE_MAX*sizeof(state->qm_inv[0]));
   if (OD_UNLIKELY(!state->qm_inv)) {
     return OD_EFAULT;
@@ -495,9 +552,14 @@ static int od_state_init_impl(od_state *state, const daala_info *info) {
   return OD_SUCCESS;
 }
 
-int od_state_init(od_state *state, const daala_info *info) {
+/*Initializes the shared state.
+  ref_padding: The padding around each reference plane, in luma pixels.
+               Use OD_BUFFER_PADDING if the references are edge extended and
+                read directly outside the frame, or OD_EMU_BUFFER_PADDING if
+                they are only read through od_state_pred_block().*/
+int od_state_init(od_state *state, const daala_info *info, int ref_padding) {
   int ret;
-  ret = od_state_init_impl(state, info);
+  ret = od_state_init_impl(state, info, ref_padding);
   if (OD_UNLIKELY(ret < 0)) {
     od_state_clear(state);
   }
@@ -686,9 +748,37 @@ const int *const OD_VERT_SETUP_DY[4][4] = {
   }
 };
 
+/*Copies the w x h samples of a reference plane starting at (x0, y0) into an
+   edge emulation buffer, replicating the edge samples of the plane for the
+   parts that lie outside of it, just as od_img_edge_ext() would have.*/
+static void od_mc_edge_emu(unsigned char *dst, const od_img_plane *iplane,
+ int plane_width, int plane_height, int x0, int y0, int w, int h) {
+  ptrdiff_t xstride;
+  int il;
+  int ir;
+  int i;
+  int j;
+  xstride = iplane->xstride;
+  /*The columns [il, ir) of each row come from inside the plane.*/
+  il = OD_CLAMPI(0, -x0, w);
+  ir = OD_CLAMPI(il, plane_width - x0, w);
+  for (j = 0; j < h; j++) {
+    const unsigned char *row;
+    row = iplane->data
+     + OD_CLAMPI(0, y0 + j, plane_height - 1)*iplane->ystride;
+    for (i = 0; i < il; i++) memcpy(dst + i*xstride, row, xstride);
+    memcpy(dst + il*xstride, row + (x0 + il)*xstride, (ir - il)*xstride);
+    for (i = ir; i < w; i++) {
+      memcpy(dst + i*xstride, row + (plane_width - 1)*xstride, xstride);
+    }
+    dst += OD_MC_EDGE_STRIDE*xstride;
+  }
+}
+
 void od_state_pred_block_from_setup(od_state *state,
  unsigned char *buf, int ystride, int pli,
  int vx, int vy, int oc, int s, int log_mvb_sz) {
+  od_img_plane *iplanes[4];
   od_img_plane *iplane;
   od_mv_grid_pt *grid[4];
   int32_t mvx[4];
@@ -701,11 +791,19 @@ void od_state_pred_block_from_setup(od_state *state,
   int k;
   int xdec;
   int ydec;
+  int log_xblk_sz;
+  int log_yblk_sz;
+  int emu;
   /* Assumes that xdec and ydec are the same on all references. */
   xdec = state->ref_imgs[state->ref_imgi[OD_FRAME_PREV]].planes[pli].xdec;
   ydec = state->ref_imgs[state->ref_imgi[OD_FRAME_PREV]].planes[pli].ydec;
   dxp = OD_VERT_SETUP_DX[oc][s];
   dyp = OD_VERT_SETUP_DY[oc][s];
+  log_xblk_sz = log_mvb_sz + OD_LOG_MVBSIZE_MIN - xdec;
+  log_yblk_sz = log_mvb_sz + OD_LOG_MVBSIZE_MIN - ydec;
+  x = vx << (OD_LOG_MVBSIZE_MIN - xdec);
+  y = vy << (OD_LOG_MVBSIZE_MIN - ydec);
+  emu = 0;
   for (k = 0; k < 4; k++) {
     int mvx_;
     int mvy_;
@@ -721,15 +819,60 @@ void od_state_pred_block_from_setup(od_state *state,
     }
     mvx[k] = (int32_t)OD_DIV_POW2_RE(mvx_, xdec);
     mvy[k] = (int32_t)OD_DIV_POW2_RE(mvy_, ydec);
-    iplane = state->ref_imgs[state->ref_imgi[grid[k]->ref]].planes+pli;
-    x = vx << (OD_LOG_MVBSIZE_MIN - iplane->xdec);
-    y = vy << (OD_LOG_MVBSIZE_MIN - iplane->ydec);
+    iplanes[k] = iplane =
+     state->ref_imgs[state->ref_imgi[grid[k]->ref]].planes + pli;
     src[k] = iplane->data + y*iplane->ystride + x*iplane->xstride;
+    /*References without room for every motion vector in their padding were
+       not edge extended, so check whether the filter support of this
+       corner's prediction leaves the frame.*/
+    if (state->ref_padding < OD_BUFFER_PADDING) {
+      int x0;
+      int y0;
+      x0 = x + (mvx[k] >> 3) - OD_RESAMPLE_PADDING;
+      y0 = y + (mvy[k] >> 3) - OD_RESAMPLE_PADDING;
+      emu |= x0 < 0 || y0 < 0
+       || x0 + (1 << log_xblk_sz) + 2*OD_RESAMPLE_PADDING
+       > state->frame_width >> xdec
+       || y0 + (1 << log_yblk_sz) + 2*OD_RESAMPLE_PADDING
+       > state->frame_height >> ydec;
+    }
+  }
+  if (emu) {
+    /*All four predictions must share a stride, so they all get copied, but
+       corners with the same reference and whole-pel offset share a copy.*/
+    for (k = 0; k < 4; k++) {
+      int j;
+      for (j = 0; j < k; j++) {
+        if (iplanes[j] == iplanes[k]
+         && mvx[j] >> 3 == mvx[k] >> 3 && mvy[j] >> 3 == mvy[k] >> 3) {
+          break;
+        }
+      }
+      if (j < k) src[k] = src[j];
+      else {
+        od_mc_edge_emu(state->mc_edge_buf[k], iplanes[k],
+         state->frame_width >> xdec, state->frame_height >> ydec,
+         x + (mvx[k] >> 3) - OD_RESAMPLE_PADDING,
+         y + (mvy[k] >> 3) - OD_RESAMPLE_PADDING,
+         (1 << log_xblk_sz) + 2*OD_RESAMPLE_PADDING,
+         (1 << log_yblk_sz) + 2*OD_RESAMPLE_PADDING);
+        src[k] = state->mc_edge_buf[k]
+         + OD_RESAMPLE_PADDING*(OD_MC_EDGE_STRIDE + 1)*iplanes[k]->xstride;
+      }
+    }
+    /*Only the fractional part of each motion vector is left to apply.*/
+    for (k = 0; k < 4; k++) {
+      mvx[k] &= 7;
+      mvy[k] &= 7;
+    }
+    od_mc_predict(state, buf, ystride, src,
+     OD_MC_EDGE_STRIDE*iplane->xstride, mvx, mvy, oc, s,
+     log_xblk_sz, log_yblk_sz);
+  }
+  else {
+    od_mc_predict(state, buf, ystride, src,
+     iplane->ystride, mvx, mvy, oc, s, log_xblk_sz, log_yblk_sz);
   }
-  od_mc_predict(state, buf, ystride, src,
-   iplane->ystride, mvx, mvy, oc, s,
-   log_mvb_sz + OD_LOG_MVBSIZE_MIN - iplane->xdec,
-   log_mvb_sz + OD_LOG_MVBSIZE_MIN - iplane->ydec);
 }
 
 void od_state_pred_block(od_state *state,
@@ -1034,6 +1177,32 @@ void od_state_init_superblock_split(od_state *state, unsigned char bsize) {
   }
 }
 
+/*Returns the number of tiles in a frame split into tiles of tile_w by tile_h
+   superblocks (those in the last column and row may be smaller), or 1 if
+   tile_w is 0.*/
+int od_state_ntiles(const od_state *state, int tile_w, int tile_h) {
+  if (tile_w <= 0) return 1;
+  return ((state->nhsb + tile_w - 1)/tile_w)
+   *((state->nvsb + tile_h - 1)/tile_h);
+}
+
+/*Restricts prediction and the entropy coding contexts to the superblocks of
+   tile tilei, in raster order, or to the whole frame if tile_w is 0.*/
+void od_state_set_tile(od_state *state, int tile_w, int tile_h, int tilei) {
+  int ntcols;
+  if (tile_w <= 0) {
+    state->tile_sbx0 = state->tile_sby0 = 0;
+    state->tile_sbx1 = state->nhsb;
+    state->tile_sby1 = state->nvsb;
+    return;
+  }
+  ntcols = (state->nhsb + tile_w - 1)/tile_w;
+  state->tile_sbx0 = tilei%ntcols*tile_w;
+  state->tile_sby0 = tilei/ntcols*tile_h;
+  state->tile_sbx1 = OD_MINI(state->tile_sbx0 + tile_w, state->nhsb);
+  state->tile_sby1 = OD_MINI(state->tile_sby0 + tile_h, state->nvsb);
+}
+
 /*To avoiding having to special-case superblocks on the edges of the image,
    one superblock of padding is maintained on each side of the image.
   These "dummy" superblocks are notionally not subdivided.
@@ -1159,6 +1328,12 @@ static void od_img_plane_edge_ext(od_img_plane *dst_p,
 }
 
 void od_img_edge_ext(od_img* src) {
+  od_img_edge_ext_pad(src, OD_BUFFER_PADDING);
+}
+
+/*Extends the edges of the image into only the first padding pixels of the
+   padding, scaled down for decimated planes.*/
+void od_img_edge_ext_pad(od_img* src, int padding) {
   int pli;
   for (pli = 0; pli < src->nplanes; pli++) {
     int xdec;
@@ -1167,7 +1342,7 @@ void od_img_edge_ext(od_img* src) {
     ydec = (src->planes + pli)->ydec;
     od_img_plane_edge_ext(&src->planes[pli],
      src->width >> xdec, src->height >> ydec,
-     OD_BUFFER_PADDING >> xdec, OD_BUFFER_PADDING >> ydec);
+     padding >> xdec, padding >> ydec);
   }
 }
 
@@ -101,6 +101,21 @@ extern const int *const OD_VERT_SETUP_DY[4][4];
 # define OD_BUFFER_PADDING \
  ((OD_UMV_CLAMP + OD_RESAMPLE_PADDING + OD_PADDING_ALIGN - 1) \
  /OD_PADDING_ALIGN*OD_PADDING_ALIGN)
+/*Padding of reference buffers that are never edge extended.
+  Motion compensation emulates the edges of blocks that read outside the
+   frame, so this only needs to absorb SIMD over-reads and keep rows
+   aligned.*/
+# define OD_EMU_BUFFER_PADDING (OD_PADDING_ALIGN)
+/*The row stride of each edge emulation buffer, in samples.
+  It covers the filter support of the largest block, plus room for SIMD
+   over-reads to the right.*/
+# define OD_MC_EDGE_STRIDE (OD_MVBSIZE_MAX + 2*OD_RESAMPLE_PADDING + 16)
+/*The number of bytes needed for all of the motion compensation buffers of a
+   state whose references have the given number of bytes per sample.*/
+# define OD_MC_BUFS_SIZE(reference_bytes) \
+ ((OD_MVBSIZE_MAX*OD_MVBSIZE_MAX*5 \
+ + OD_MC_EDGE_STRIDE*(OD_MVBSIZE_MAX + 2*OD_RESAMPLE_PADDING)*4) \
+ *(reference_bytes))
 
 /*The shared (encoder and decoder) functions that have accelerated variants.*/
 struct od_state_opt_vtbl{
@@ -117,12 +132,17 @@ struct od_state_opt_vtbl{
   void (*mc_blend_multi_split)(unsigned char *_dst, int _dystride,
    const unsigned char *_src[4], int _c, int _s,
    int _log_xblk_sz, int _log_yblk_sz);
+  od_filter_cols_func pre_filter_cols[OD_NBSIZES];
+  od_filter_cols_func post_filter_cols[OD_NBSIZES];
+  od_dir_find8_func dir_find8;
   od_filter_dering_direction_func filter_dering_direction[OD_DERINGSIZES];
   od_filter_dering_orthogonal_func filter_dering_orthogonal[OD_DERINGSIZES];
   void (*restore_fpu)(void);
   od_dct_func_2d fdct_2d[OD_NBSIZES + 1];
   od_dct_func_2d idct_2d[OD_NBSIZES + 1];
   od_copy_nxn_func od_copy_nxn[OD_LOG_COPYBSIZE_MAX + 1];
+  od_ec_cdf_search_func cdf_search;
+  od_ec_cdf_adapt_func cdf_adapt;
 };
 
 # if defined(OD_DUMP_IMAGES) || defined(OD_DUMP_RECONS)
@@ -173,11 +193,18 @@ struct od_state{
   od_adapt_ctx        adapt;
   daala_info          info;
   unsigned char  *mc_buf[5];
+  /** Edge emulation buffers for each corner of a block whose prediction
+      reads outside the reference frame. */
+  unsigned char  *mc_edge_buf[4];
   od_state_opt_vtbl   opt_vtbl;
   uint32_t        cpu_flags;
   int32_t         frame_width;
   int32_t         frame_height;
   int             full_precision_references;
+  /** Padding around each reference plane, in luma pixels. */
+  int             ref_padding;
+  /** The number of bytes in the buffers allocated by od_state_init(). */
+  size_t          nbytes;
   /** Buffer for the reference images. */
   int                 ref_imgi[OD_FRAME_MAX+1];
   /** Pointers to the ref images so one can move them around without coping
@@ -204,6 +231,15 @@ struct od_state{
   int                 nvmvbs;
   int                 nhsb;
   int                 nvsb;
+  /** The superblocks of the tile being coded, [tile_sbx0, tile_sbx1) by
+      [tile_sby0, tile_sby1).
+      Intra prediction and the entropy coding contexts never look at
+      superblocks outside of it.
+      When a frame is not split into tiles, this is the whole frame. */
+  int                 tile_sbx0;
+  int                 tile_sby0;
+  int                 tile_sbx1;
+  int                 tile_sby1;
   /** Each 8x8 block of pixels in the image (+ one superblock of
       padding on each side) has a corresponding byte in this array, and
       every 32x32 superblock is represented by 16 (4 by 4) entries
@@ -254,13 +290,18 @@ struct od_state{
 
 void *od_aligned_malloc(size_t _sz,size_t _align);
 void od_aligned_free(void *_ptr);
-int od_state_init(od_state *_state, const daala_info *_info);
+int od_state_init(od_state *_state, const daala_info *_info,
+ int _ref_padding);
 void od_state_clear(od_state *_state);
 
 void od_img_plane_copy(od_img *dest, od_img *src, int pli);
+void od_img_plane_copy_rows(od_img *dest, od_img *src, int pli, int y0,
+ int y1);
 void od_img_copy(od_img *dest, od_img *src);
 void od_adapt_ctx_reset(od_adapt_ctx *state, int is_keyframe);
 void od_state_set_mv_res(od_state *state, int mv_res);
+unsigned char *od_state_set_mc_bufs(od_state *state, unsigned char *data,
+ int reference_bytes);
 void od_state_pred_block_from_setup(od_state *state, unsigned char *buf,
  int ystride, int pli, int vx, int vy, int c, int s, int log_mvb_sz);
 void od_state_pred_block(od_state *state, unsigned char *buf,
@@ -268,8 +309,11 @@ void od_state_pred_block(od_state *state, unsigned char *buf,
 void od_state_mc_predict(od_state *state, od_img *dst);
 void od_state_init_border(od_state *state);
 void od_state_init_superblock_split(od_state *state, unsigned char bsize);
+int od_state_ntiles(const od_state *state, int tile_w, int tile_h);
+void od_state_set_tile(od_state *state, int tile_w, int tile_h, int tilei);
 int od_state_dump_yuv(od_state *state, od_img *img, const char *tag);
 void od_img_edge_ext(od_img* src);
+void od_img_edge_ext_pad(od_img* src, int padding);
 int od_state_push_output_buff_tail(od_state *state);
 int od_state_pop_output_buff_head(od_state *state);
 int od_state_pop_output_buff_tail(od_state *state);
@@ -30,6 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include <check.h>
 
 Suite *headerencode_suite();
+Suite *simd_suite();
+Suite *decode_modes_suite();
 
 int main(int _argc,char **_argv) {
   int number_failed;
@@ -38,6 +40,8 @@ int main(int _argc,char **_argv) {
   (void)_argc;
   (void)_argv;
   sr = srunner_create(headerencode_suite());
+  srunner_add_suite(sr, simd_suite());
+  srunner_add_suite(sr, decode_modes_suite());
   srunner_set_fork_status(sr, CK_NOFORK);
   srunner_run_all(sr, CK_VERBOSE);
   number_failed = srunner_ntests_failed(sr);
@@ -0,0 +1,352 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "daala/daalaenc.h"
+#include "daala/daaladec.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+/*Encodes a short clip once, then checks that every decoder mode that is
+   supposed to leave the decoded images unchanged does.
+  The frame size is odd and not a multiple of the superblock size, and the
+   clip uses B frames and tiles, to cover the edge cases of the streaming
+   buffers.*/
+
+#define WIDTH (73)
+#define HEIGHT (41)
+#define NFRAMES (7)
+#define NPACKETS_MAX (16)
+
+typedef struct {
+  unsigned char *data;
+  long bytes;
+  int e_o_s;
+} test_packet;
+
+static test_packet packets[NPACKETS_MAX];
+static int npackets;
+/*The images decoded in the default mode, with the planes stored back to
+   back and no padding.*/
+static unsigned char *ref_frames[NFRAMES];
+static int nref_frames;
+
+static int plane_width(int pli) {
+  return (WIDTH + (pli > 0)) >> (pli > 0);
+}
+
+static int plane_height(int pli) {
+  return (HEIGHT + (pli > 0)) >> (pli > 0);
+}
+
+static size_t frame_size(void) {
+  size_t sz;
+  int pli;
+  sz = 0;
+  for (pli = 0; pli < 3; pli++) {
+    sz += (size_t)plane_width(pli)*plane_height(pli);
+  }
+  return sz;
+}
+
+/*Draws a pattern that moves a little from frame to frame, so that the
+   encoder codes motion vectors and residuals.*/
+static void fill_frame(od_img *img, int f) {
+  int pli;
+  int x;
+  int y;
+  for (pli = 0; pli < 3; pli++) {
+    od_img_plane *p;
+    p = img->planes + pli;
+    for (y = 0; y < plane_height(pli); y++) {
+      for (x = 0; x < plane_width(pli); x++) {
+        int xx;
+        int yy;
+        xx = x + f*(pli + 1);
+        yy = y + f/2;
+        p->data[y*p->ystride + x] = (unsigned char)(64
+         + ((xx*7 ^ yy*13) & 0x3F) + ((xx/8 + yy/8) & 1)*40);
+      }
+    }
+  }
+}
+
+static void save_packet(const daala_packet *dp) {
+  ck_assert(npackets < NPACKETS_MAX);
+  packets[npackets].data = (unsigned char *)malloc(dp->bytes);
+  ck_assert(packets[npackets].data != NULL);
+  memcpy(packets[npackets].data, dp->packet, dp->bytes);
+  packets[npackets].bytes = dp->bytes;
+  packets[npackets].e_o_s = dp->e_o_s;
+  npackets++;
+}
+
+static daala_dec_ctx *create_decoder(int *first_data_packet) {
+  daala_info di;
+  daala_comment dc;
+  daala_setup_info *ds;
+  daala_dec_ctx *dec;
+  int i;
+  daala_info_init(&di);
+  daala_comment_init(&dc);
+  ds = NULL;
+  for (i = 0; i < npackets; i++) {
+    daala_packet dp;
+    memset(&dp, 0, sizeof(dp));
+    dp.packet = packets[i].data;
+    dp.bytes = packets[i].bytes;
+    dp.b_o_s = i == 0;
+    dp.packetno = i;
+    /*This returns 0 once the last header has been processed.*/
+    if (daala_decode_header_in(&di, &dc, &ds, &dp) <= 0) break;
+  }
+  *first_data_packet = i + 1;
+  dec = daala_decode_create(&di, ds);
+  ck_assert(dec != NULL);
+  daala_setup_free(ds);
+  daala_comment_clear(&dc);
+  daala_info_clear(&di);
+  return dec;
+}
+
+/*Stores a decoded image as the reference, while the references are being
+   decoded, or else compares it with the reference.*/
+static void check_image(const od_img *img, int f) {
+  unsigned char *buf;
+  size_t off;
+  int pli;
+  int y;
+  ck_assert(f < NFRAMES);
+  ck_assert_int_eq(WIDTH, img->width);
+  ck_assert_int_eq(HEIGHT, img->height);
+  if (f == nref_frames) {
+    ref_frames[f] = (unsigned char *)malloc(frame_size());
+    ck_assert(ref_frames[f] != NULL);
+    nref_frames++;
+    buf = ref_frames[f];
+    off = 0;
+    for (pli = 0; pli < 3; pli++) {
+      const od_img_plane *p;
+      p = img->planes + pli;
+      for (y = 0; y < plane_height(pli); y++) {
+        memcpy(buf + off, p->data + y*p->ystride, plane_width(pli));
+        off += plane_width(pli);
+      }
+    }
+    return;
+  }
+  buf = ref_frames[f];
+  off = 0;
+  for (pli = 0; pli < 3; pli++) {
+    const od_img_plane *p;
+    p = img->planes + pli;
+    for (y = 0; y < plane_height(pli); y++) {
+      ck_assert_int_eq(0, memcmp(buf + off, p->data + y*p->ystride,
+       plane_width(pli)));
+      off += plane_width(pli);
+    }
+  }
+}
+
+/*Decodes the clip, checking each image as soon as it comes out, while it is
+   still valid in every mode.*/
+static void decode_clip(daala_dec_ctx *dec, int first_data_packet,
+ int release) {
+  int nframes;
+  int i;
+  nframes = 0;
+  for (i = first_data_packet; i < npackets; i++) {
+    daala_packet dp;
+    od_img img;
+    memset(&dp, 0, sizeof(dp));
+    dp.packet = packets[i].data;
+    dp.bytes = packets[i].bytes;
+    dp.e_o_s = packets[i].e_o_s;
+    dp.packetno = i;
+    ck_assert_int_eq(0, daala_decode_packet_in(dec, &dp));
+    /*Only the end of the stream can flush more than one image.*/
+    while (daala_decode_img_out(dec, &img) > 0) {
+      check_image(&img, nframes++);
+      if (release) {
+        ck_assert_int_eq(0, daala_decode_ctl(dec, OD_DECCTL_RELEASE_IMG,
+         &img, sizeof(img)));
+      }
+      if (!packets[i].e_o_s) break;
+    }
+  }
+  ck_assert_int_eq(NFRAMES, nframes);
+}
+
+static void setup(void) {
+  daala_info di;
+  daala_comment dc;
+  daala_enc_ctx *enc;
+  daala_dec_ctx *dec;
+  daala_packet dp;
+  od_img img;
+  int tiles[2];
+  int b_frames;
+  int complexity;
+  int quant;
+  int left;
+  int first;
+  int pli;
+  int f;
+  daala_info_init(&di);
+  di.pic_width = WIDTH;
+  di.pic_height = HEIGHT;
+  di.pixel_aspect_numerator = 1;
+  di.pixel_aspect_denominator = 1;
+  di.timebase_numerator = 30;
+  di.timebase_denominator = 1;
+  di.frame_duration = 1;
+  di.keyframe_rate = 256;
+  di.nplanes = 3;
+  img.nplanes = 3;
+  img.width = WIDTH;
+  img.height = HEIGHT;
+  for (pli = 0; pli < 3; pli++) {
+    di.plane_info[pli].xdec = di.plane_info[pli].ydec = pli > 0;
+    img.planes[pli].xdec = img.planes[pli].ydec = pli > 0;
+    img.planes[pli].xstride = 1;
+    img.planes[pli].ystride = plane_width(pli);
+    img.planes[pli].bitdepth = 8;
+    img.planes[pli].data = (unsigned char *)malloc(
+     plane_width(pli)*plane_height(pli));
+    ck_assert(img.planes[pli].data != NULL);
+  }
+  enc = daala_encode_create(&di);
+  ck_assert(enc != NULL);
+  quant = 30;
+  ck_assert_int_eq(0, daala_encode_ctl(enc, OD_SET_QUANT,
+   &quant, sizeof(quant)));
+  complexity = 3;
+  ck_assert_int_eq(0, daala_encode_ctl(enc, OD_SET_COMPLEXITY,
+   &complexity, sizeof(complexity)));
+  b_frames = 2;
+  ck_assert_int_eq(0, daala_encode_ctl(enc, OD_SET_B_FRAMES,
+   &b_frames, sizeof(b_frames)));
+  tiles[0] = 2;
+  tiles[1] = 2;
+  ck_assert_int_eq(0, daala_encode_ctl(enc, OD_SET_TILES,
+   tiles, sizeof(tiles)));
+  daala_comment_init(&dc);
+  npackets = 0;
+  while (daala_encode_flush_header(enc, &dc, &dp) > 0) save_packet(&dp);
+  for (f = 0; f < NFRAMES; f++) {
+    fill_frame(&img, f);
+    ck_assert_int_eq(0, daala_encode_img_in(enc, &img, 0, 0, &left));
+    while (daala_encode_packet_out(enc, 0, &dp) > 0) save_packet(&dp);
+  }
+  /*Code the frames held back for the B frames, and set e_o_s on the last
+     packet, so that the decoder flushes them out too.*/
+  do {
+    ck_assert_int_eq(0, daala_encode_img_in(enc, &img, 0, 1, &left));
+    while (daala_encode_packet_out(enc, !left, &dp) > 0) save_packet(&dp);
+  }
+  while (left);
+  ck_assert(packets[npackets - 1].e_o_s);
+  daala_encode_free(enc);
+  daala_comment_clear(&dc);
+  daala_info_clear(&di);
+  for (pli = 0; pli < 3; pli++) free(img.planes[pli].data);
+  /*Decode the reference images in the default mode.*/
+  nref_frames = 0;
+  dec = create_decoder(&first);
+  decode_clip(dec, first, 0);
+  daala_decode_free(dec);
+}
+
+static void teardown(void) {
+  int i;
+  for (i = 0; i < npackets; i++) free(packets[i].data);
+  for (i = 0; i < nref_frames; i++) free(ref_frames[i]);
+}
+
+START_TEST(decode_default) {
+  daala_dec_ctx *dec;
+  int first;
+  dec = create_decoder(&first);
+  decode_clip(dec, first, 0);
+  daala_decode_free(dec);
+}
+END_TEST
+
+START_TEST(decode_streaming) {
+  daala_dec_ctx *dec;
+  int streaming;
+  int first;
+  dec = create_decoder(&first);
+  streaming = 1;
+  ck_assert_int_eq(0, daala_decode_ctl(dec, OD_DECCTL_SET_STREAMING,
+   &streaming, sizeof(streaming)));
+  decode_clip(dec, first, 0);
+  daala_decode_free(dec);
+}
+END_TEST
+
+START_TEST(decode_low_memory) {
+  daala_dec_ctx *dec;
+  int low_memory;
+  int first;
+  dec = create_decoder(&first);
+  low_memory = 1;
+  ck_assert_int_eq(0, daala_decode_ctl(dec, OD_DECCTL_SET_LOW_MEMORY,
+   &low_memory, sizeof(low_memory)));
+  decode_clip(dec, first, 0);
+  daala_decode_free(dec);
+}
+END_TEST
+
+START_TEST(decode_frame_pool) {
+  daala_frame_allocator allocator;
+  daala_dec_ctx *dec;
+  int first;
+  dec = create_decoder(&first);
+  allocator.alloc = NULL;
+  allocator.free = NULL;
+  allocator.ctx = NULL;
+  ck_assert_int_eq(0, daala_decode_ctl(dec, OD_DECCTL_SET_FRAME_POOL,
+   &allocator, sizeof(allocator)));
+  decode_clip(dec, first, 1);
+  daala_decode_free(dec);
+}
+END_TEST
+
+Suite *decode_modes_suite() {
+  Suite *s = suite_create("DecodeModes");
+  TCase *tc = tcase_create("DecodeModes");
+  tcase_add_unchecked_fixture(tc, setup, teardown);
+  tcase_add_test(tc, decode_default);
+  tcase_add_test(tc, decode_streaming);
+  tcase_add_test(tc, decode_low_memory);
+  tcase_add_test(tc, decode_frame_pool);
+  suite_add_tcase(s, tc);
+  return s;
+}
@@ -0,0 +1,141 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "../internal.c"
+#include "../entcode.c"
+#include "../entdec.c"
+#include "../entenc.c"
+
+/*Measures entropy decoder throughput on a random mix of multi-symbol CDFs,
+   binary symbols and raw bits, similar to the streams exercised by ectest.
+  Build with -DOD_EC_WINDOW64 (as ecbench64 is) to compare window sizes.*/
+
+#define NCDFS (15)
+#define NREPS (5)
+
+int main(int _argc,char **_argv){
+  od_ec_enc      enc;
+  od_ec_dec      dec;
+  uint16_t       cdfs[NCDFS][16];
+  unsigned char *type;
+  unsigned char *sym;
+  uint16_t      *fz;
+  unsigned char *ptr;
+  uint32_t       ptr_sz;
+  unsigned       seed;
+  double         best;
+  long           nsyms;
+  long           i;
+  int            rep;
+  int            ret;
+  ret=EXIT_SUCCESS;
+  if(_argc>3){
+    fprintf(stderr,"Usage: %s [<nsymbols> [<seed>]]\n",_argv[0]);
+    return EXIT_FAILURE;
+  }
+  nsyms=_argc>1?atol(_argv[1]):4000000;
+  seed=_argc>2?(unsigned)atoi(_argv[2]):(unsigned)time(NULL);
+  srand(seed);
+  /*Skewed random CDFs with 2 to 16 symbols, every symbol at least 1/1024
+     likely.*/
+  for(i=0;i<NCDFS;i++){
+    unsigned w[16];
+    unsigned total;
+    unsigned acc;
+    int      n;
+    int      j;
+    n=(int)i+2;
+    total=0;
+    for(j=0;j<n;j++){
+      w[j]=1+(rand()%256>>(j&7));
+      total+=w[j];
+    }
+    acc=0;
+    for(j=0;j<n;j++){
+      acc+=w[j];
+      cdfs[i][j]=(uint16_t)((j+1)*32+(uint32_t)acc*(32768-n*32)/total);
+    }
+  }
+  type=(unsigned char *)malloc(nsyms);
+  sym=(unsigned char *)malloc(nsyms);
+  fz=(uint16_t *)malloc(nsyms*sizeof(*fz));
+  if(type==NULL||sym==NULL||fz==NULL){
+    fprintf(stderr,"Out of memory.\n");
+    return EXIT_FAILURE;
+  }
+  od_ec_enc_init(&enc,nsyms>>1);
+  for(i=0;i<nsyms;i++){
+    int r;
+    r=rand()&15;
+    if(r==0){
+      /*Raw bits.*/
+      type[i]=0;
+      fz[i]=(uint16_t)(1+rand()%8);
+      sym[i]=(unsigned char)(rand()&((1<<fz[i])-1));
+      od_ec_enc_bits(&enc,sym[i],fz[i]);
+    }
+    else if(r<8){
+      /*Binary symbol.*/
+      type[i]=1;
+      fz[i]=(uint16_t)(1+rand()%32767);
+      sym[i]=(unsigned char)((unsigned)rand()%32768>=fz[i]);
+      od_ec_encode_bool_q15(&enc,sym[i],fz[i]);
+    }
+    else{
+      const uint16_t *cdf;
+      int             n;
+      unsigned        u;
+      int             s;
+      type[i]=2;
+      fz[i]=(uint16_t)(rand()%NCDFS);
+      cdf=cdfs[fz[i]];
+      n=fz[i]+2;
+      u=(unsigned)rand()%32768;
+      for(s=0;cdf[s]<=u;s++);
+      OD_ASSERT(s<n);
+      sym[i]=(unsigned char)s;
+      od_ec_encode_cdf_q15(&enc,s,cdf,n);
+    }
+  }
+  ptr=od_ec_enc_done(&enc,&ptr_sz);
+  if(ptr==NULL){
+    fprintf(stderr,"Encoding failed.\n");
+    return EXIT_FAILURE;
+  }
+  best=-1;
+  for(rep=0;rep<NREPS;rep++){
+    clock_t start;
+    double  elapsed;
+    start=clock();
+    od_ec_dec_init(&dec,ptr,ptr_sz);
+    for(i=0;i<nsyms;i++){
+      int s;
+      switch(type[i]){
+        case 0:s=(int)od_ec_dec_bits(&dec,fz[i],"bench");break;
+        case 1:s=od_ec_decode_bool_q15(&dec,fz[i],"bench");break;
+        default:s=od_ec_decode_cdf_q15(&dec,cdfs[fz[i]],fz[i]+2,"bench");
+      }
+      if(s!=sym[i]){
+        fprintf(stderr,"Decoded %i instead of %i at symbol %li "
+         "(Random seed: %u).\n",s,sym[i],i,seed);
+        ret=EXIT_FAILURE;
+        break;
+      }
+    }
+    elapsed=(double)(clock()-start)/CLOCKS_PER_SEC;
+    if(best<0||elapsed<best)best=elapsed;
+  }
+  fprintf(stderr,"%i-bit window: %li symbols in %li bytes, "
+   "best of %i: %0.3f s (%0.2f Msymbols/s).\n",OD_EC_WINDOW_SIZE,nsyms,
+   (long)ptr_sz,NREPS,best,best>0?nsyms/best*1E-6:0);
+  od_ec_enc_clear(&enc);
+  free(fz);
+  free(sym);
+  free(type);
+  return ret;
+}
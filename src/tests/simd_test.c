@@ -0,0 +1,313 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "../encint.h"
+#if defined(OD_X86ASM)
+# include "../x86/cpu.h"
+# include "../x86/x86int.h"
+# include "../x86/x86enc.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <check.h>
+
+/*These tests compare vectorized kernels against their C versions directly.
+  Some kernels are not reachable through the codec yet (e.g., the 16-bit
+   blends, SADs and SATDs only run with full-precision references, which are
+   disabled), so this is the only place they get exercised.*/
+
+#define NTRIALS (4)
+
+#if defined(OD_X86ASM) && defined(OD_SSE2_INTRINSICS)
+
+typedef void (*blend_func)(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz);
+typedef void (*blend_split_func)(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz);
+
+static int16_t img16[4][OD_MVBSIZE_MAX*OD_MVBSIZE_MAX];
+static int16_t dst16[2][OD_MVBSIZE_MAX*2*OD_MVBSIZE_MAX];
+
+/*Fills a block of 16-bit pixels with random values of the given depth.*/
+static void fill16(int16_t *buf, int n, int depth) {
+  int i;
+  for (i = 0; i < n; i++) buf[i] = (int16_t)(rand() & ((1 << depth) - 1));
+}
+
+/*Runs a full blend on every block size, using a destination stride wider
+   than the block.*/
+static void check_blend_full16(blend_func blend) {
+  const unsigned char *src[4];
+  int log_xblk_sz;
+  int log_yblk_sz;
+  int trial;
+  int k;
+  for (k = 0; k < 4; k++) src[k] = (const unsigned char *)img16[k];
+  for (trial = 0; trial < NTRIALS; trial++) {
+    for (k = 0; k < 4; k++) {
+      fill16(img16[k], OD_MVBSIZE_MAX*OD_MVBSIZE_MAX, 8 + OD_COEFF_SHIFT);
+    }
+    for (log_yblk_sz = 1; log_yblk_sz <= OD_LOG_MVBSIZE_MAX; log_yblk_sz++) {
+      for (log_xblk_sz = 1; log_xblk_sz <= OD_LOG_MVBSIZE_MAX;
+       log_xblk_sz++) {
+        memset(dst16, 0, sizeof(dst16));
+        od_mc_blend_full16_c((unsigned char *)dst16[0], OD_MVBSIZE_MAX*4,
+         src, log_xblk_sz, log_yblk_sz);
+        (*blend)((unsigned char *)dst16[1], OD_MVBSIZE_MAX*4,
+         src, log_xblk_sz, log_yblk_sz);
+        ck_assert_int_eq(0, memcmp(dst16[0], dst16[1], sizeof(dst16[0])));
+      }
+    }
+  }
+}
+
+/*Runs a split blend on every block size, corner and split state.*/
+static void check_blend_full_split16(blend_split_func blend) {
+  const unsigned char *src[4];
+  int log_xblk_sz;
+  int log_yblk_sz;
+  int trial;
+  int oc;
+  int s;
+  int k;
+  for (k = 0; k < 4; k++) src[k] = (const unsigned char *)img16[k];
+  for (trial = 0; trial < NTRIALS; trial++) {
+    for (k = 0; k < 4; k++) {
+      fill16(img16[k], OD_MVBSIZE_MAX*OD_MVBSIZE_MAX, 8 + OD_COEFF_SHIFT);
+    }
+    for (log_yblk_sz = 1; log_yblk_sz <= OD_LOG_MVBSIZE_MAX; log_yblk_sz++) {
+      for (log_xblk_sz = 1; log_xblk_sz <= OD_LOG_MVBSIZE_MAX;
+       log_xblk_sz++) {
+        for (oc = 0; oc < 4; oc++) {
+          for (s = 0; s < 4; s++) {
+            memset(dst16, 0, sizeof(dst16));
+            od_mc_blend_full_split16_c((unsigned char *)dst16[0],
+             OD_MVBSIZE_MAX*4, src, oc, s, log_xblk_sz, log_yblk_sz);
+            (*blend)((unsigned char *)dst16[1], OD_MVBSIZE_MAX*4,
+             src, oc, s, log_xblk_sz, log_yblk_sz);
+            ck_assert_int_eq(0,
+             memcmp(dst16[0], dst16[1], sizeof(dst16[0])));
+          }
+        }
+      }
+    }
+  }
+}
+
+/*Fills a block of 8-bit pixels with random values.*/
+static void fill8(unsigned char *buf, int n) {
+  int i;
+  for (i = 0; i < n; i++) buf[i] = (unsigned char)(rand() & 0xFF);
+}
+
+static unsigned char img8[4][OD_MVBSIZE_MAX*OD_MVBSIZE_MAX];
+static unsigned char dst8[2][OD_MVBSIZE_MAX*2*OD_MVBSIZE_MAX];
+
+/*Runs the multiresolution blends on every square block size the C versions
+   support, with and without splits.*/
+static void check_blend_multi8(blend_func blend,
+ blend_split_func blend_split) {
+  const unsigned char *src[4];
+  int log_blk_sz;
+  int trial;
+  int oc;
+  int s;
+  int k;
+  for (k = 0; k < 4; k++) src[k] = img8[k];
+  for (trial = 0; trial < NTRIALS; trial++) {
+    for (k = 0; k < 4; k++) fill8(img8[k], OD_MVBSIZE_MAX*OD_MVBSIZE_MAX);
+    for (log_blk_sz = 2; log_blk_sz <= 4; log_blk_sz++) {
+      memset(dst8, 0, sizeof(dst8));
+      od_mc_blend_multi8_c(dst8[0], OD_MVBSIZE_MAX*2,
+       src, log_blk_sz, log_blk_sz);
+      (*blend)(dst8[1], OD_MVBSIZE_MAX*2, src, log_blk_sz, log_blk_sz);
+      ck_assert_int_eq(0, memcmp(dst8[0], dst8[1], sizeof(dst8[0])));
+      for (oc = 0; oc < 4; oc++) {
+        for (s = 0; s < 4; s++) {
+          memset(dst8, 0, sizeof(dst8));
+          od_mc_blend_multi_split8_c(dst8[0], OD_MVBSIZE_MAX*2,
+           src, oc, s, log_blk_sz, log_blk_sz);
+          (*blend_split)(dst8[1], OD_MVBSIZE_MAX*2,
+           src, oc, s, log_blk_sz, log_blk_sz);
+          ck_assert_int_eq(0, memcmp(dst8[0], dst8[1], sizeof(dst8[0])));
+        }
+      }
+    }
+  }
+}
+
+# if defined(OD_SSE41_INTRINSICS)
+typedef int32_t (*dist16_func)(const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride);
+
+/*Compares 16-bit distortion kernels against their C versions.
+  kernels[ln - 2] is the kernel for blocks of size 1 << ln, or NULL if there
+   is none.
+  The reference is offset by one pixel so that its rows are not aligned, and
+   the first trial uses only the extreme pixel values.*/
+static void check_dist16(const dist16_func ref_kernels[5],
+ const dist16_func kernels[5]) {
+  const unsigned char *src;
+  const unsigned char *ref;
+  int stride;
+  int trial;
+  int ln;
+  int i;
+  int k;
+  src = (const unsigned char *)dst16[0];
+  ref = (const unsigned char *)(dst16[1] + 1);
+  stride = OD_MVBSIZE_MAX*4;
+  for (trial = 0; trial < NTRIALS; trial++) {
+    for (k = 0; k < 2; k++) {
+      fill16(dst16[k], OD_MVBSIZE_MAX*2*OD_MVBSIZE_MAX, 8 + OD_COEFF_SHIFT);
+      if (trial == 0) {
+        for (i = 0; i < OD_MVBSIZE_MAX*2*OD_MVBSIZE_MAX; i++) {
+          dst16[k][i] = dst16[k][i] & 1 ? (1 << (8 + OD_COEFF_SHIFT)) - 1 : 0;
+        }
+      }
+    }
+    for (ln = 2; ln <= OD_LOG_MVBSIZE_MAX; ln++) {
+      if (kernels[ln - 2] == NULL) continue;
+      ck_assert_int_eq((*ref_kernels[ln - 2])(src, stride, ref, stride),
+       (*kernels[ln - 2])(src, stride, ref, stride));
+    }
+  }
+}
+
+static const dist16_func SAD16_C[5] = {
+  od_mc_compute_sad16_4x4_c,
+  od_mc_compute_sad16_8x8_c,
+  od_mc_compute_sad16_16x16_c,
+  od_mc_compute_sad16_32x32_c,
+  od_mc_compute_sad16_64x64_c
+};
+
+static const dist16_func SATD16_C[5] = {
+  od_mc_compute_satd16_4x4_c,
+  od_mc_compute_satd16_8x8_c,
+  od_mc_compute_satd16_16x16_c,
+  od_mc_compute_satd16_32x32_c,
+  od_mc_compute_satd16_64x64_c
+};
+# endif
+
+START_TEST(blend_full16_sse2) {
+  if (!(od_cpu_flags_get() & OD_CPU_X86_SSE2)) return;
+  check_blend_full16(od_mc_blend_full16_sse2);
+  check_blend_full_split16(od_mc_blend_full_split16_sse2);
+}
+END_TEST
+
+/*od_mc_blend() skips multiresolution blending (if (0 && ...)), so these are
+   not reachable through the codec either.*/
+START_TEST(blend_multi8_sse2) {
+  if (!(od_cpu_flags_get() & OD_CPU_X86_SSE2)) return;
+  check_blend_multi8(od_mc_blend_multi8_sse2, od_mc_blend_multi_split8_sse2);
+}
+END_TEST
+
+# if defined(OD_SSE41_INTRINSICS)
+/*The encoder only uses these with full-precision references.*/
+START_TEST(dist16_sse41) {
+  static const dist16_func SAD16_SSE41[5] = {
+    od_mc_compute_sad16_4x4_sse41,
+    od_mc_compute_sad16_8x8_sse41,
+    od_mc_compute_sad16_16x16_sse41,
+    od_mc_compute_sad16_32x32_sse41,
+    od_mc_compute_sad16_64x64_sse41
+  };
+  static const dist16_func SATD16_SSE41[5] = {
+    od_mc_compute_satd16_4x4_sse41,
+    od_mc_compute_satd16_8x8_sse41,
+    od_mc_compute_satd16_16x16_sse41,
+    od_mc_compute_satd16_32x32_sse41,
+    od_mc_compute_satd16_64x64_sse41
+  };
+  if (!(od_cpu_flags_get() & OD_CPU_X86_SSE4_1)) return;
+  check_dist16(SAD16_C, SAD16_SSE41);
+  check_dist16(SATD16_C, SATD16_SSE41);
+}
+END_TEST
+# endif
+
+# if defined(OD_AVX2_INTRINSICS)
+START_TEST(blend_full16_avx2) {
+  if (!(od_cpu_flags_get() & OD_CPU_X86_AVX2)) return;
+  check_blend_full16(od_mc_blend_full16_avx2);
+  check_blend_full_split16(od_mc_blend_full_split16_avx2);
+}
+END_TEST
+
+START_TEST(dist16_avx2) {
+  static const dist16_func SAD16_AVX2[5] = {
+    NULL,
+    NULL,
+    od_mc_compute_sad16_16x16_avx2,
+    od_mc_compute_sad16_32x32_avx2,
+    od_mc_compute_sad16_64x64_avx2
+  };
+  static const dist16_func SATD16_AVX2[5] = {
+    NULL,
+    od_mc_compute_satd16_8x8_avx2,
+    od_mc_compute_satd16_16x16_avx2,
+    od_mc_compute_satd16_32x32_avx2,
+    od_mc_compute_satd16_64x64_avx2
+  };
+  if (!(od_cpu_flags_get() & OD_CPU_X86_AVX2)) return;
+  check_dist16(SAD16_C, SAD16_AVX2);
+  check_dist16(SATD16_C, SATD16_AVX2);
+}
+END_TEST
+# endif
+
+#endif
+
+static void setup(void) {
+  srand(4657);
+}
+
+Suite *simd_suite() {
+  Suite *s = suite_create("SIMD");
+  TCase *tc = tcase_create("SIMD");
+  tcase_add_unchecked_fixture(tc, setup, NULL);
+#if defined(OD_X86ASM) && defined(OD_SSE2_INTRINSICS)
+  tcase_add_test(tc, blend_full16_sse2);
+  tcase_add_test(tc, blend_multi8_sse2);
+# if defined(OD_SSE41_INTRINSICS)
+  tcase_add_test(tc, dist16_sse41);
+# endif
+# if defined(OD_AVX2_INTRINSICS)
+  tcase_add_test(tc, blend_full16_avx2);
+  tcase_add_test(tc, dist16_avx2);
+# endif
+#endif
+  suite_add_tcase(s, tc);
+  return s;
+}
@@ -0,0 +1,335 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include "thread.h"
+
+/*Jobs are always handed out in increasing index order, and the caller of
+   od_thread_pool_run() takes jobs as well.
+  As long as a job only ever waits on progress published by jobs with a
+   smaller index, some thread is always running the lowest-numbered
+   unfinished job, so a batch cannot deadlock no matter how many threads the
+   pool has.*/
+
+#if defined(OD_THREADS)
+
+/*Claims and runs jobs from the current batch until there are none left.
+  The pool mutex must be held on entry, and is held again on return.*/
+static void od_thread_pool_work(od_thread_pool *pool) {
+  while (pool->next_job < pool->njobs) {
+    od_thread_job_func job;
+    void *ctx;
+    int jobi;
+    job = pool->job;
+    ctx = pool->ctx;
+    jobi = pool->next_job++;
+    pthread_mutex_unlock(&pool->mutex);
+    (*job)(ctx, jobi);
+    pthread_mutex_lock(&pool->mutex);
+    if (++pool->jobs_done == pool->njobs) {
+      pthread_cond_broadcast(&pool->done_cond);
+    }
+  }
+}
+
+static void *od_thread_pool_worker(void *arg) {
+  od_thread_pool *pool;
+  unsigned batch;
+  pool = (od_thread_pool *)arg;
+  pthread_mutex_lock(&pool->mutex);
+  batch = pool->batch;
+  for (;;) {
+    while (!pool->quit && pool->batch == batch) {
+      pthread_cond_wait(&pool->start_cond, &pool->mutex);
+    }
+    if (pool->quit) break;
+    batch = pool->batch;
+    od_thread_pool_work(pool);
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+int od_thread_pool_init(od_thread_pool *pool, int nthreads) {
+  int i;
+  if (nthreads < 1 || nthreads > OD_THREADS_MAX) return OD_EINVAL;
+  pool->nthreads = 1;
+  pool->workers = NULL;
+  pool->job = NULL;
+  pool->ctx = NULL;
+  pool->njobs = pool->next_job = pool->jobs_done = 0;
+  pool->batch = 0;
+  pool->quit = 0;
+  if (nthreads == 1) return OD_SUCCESS;
+  if (pthread_mutex_init(&pool->mutex, NULL)) return OD_EFAULT;
+  if (pthread_cond_init(&pool->start_cond, NULL)) {
+    pthread_mutex_destroy(&pool->mutex);
+    return OD_EFAULT;
+  }
+  if (pthread_cond_init(&pool->done_cond, NULL)) {
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    return OD_EFAULT;
+  }
+  pool->workers = (pthread_t *)malloc(sizeof(*pool->workers)*(nthreads - 1));
+  if (OD_UNLIKELY(!pool->workers)) {
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    return OD_EFAULT;
+  }
+  for (i = 0; i < nthreads - 1; i++) {
+    if (pthread_create(pool->workers + i, NULL, od_thread_pool_worker, pool)) {
+      od_thread_pool_clear(pool);
+      return OD_EFAULT;
+    }
+    /*Only count threads that were actually started, so that
+       od_thread_pool_clear() joins exactly those.*/
+    pool->nthreads++;
+  }
+  return OD_SUCCESS;
+}
+
+void od_thread_pool_clear(od_thread_pool *pool) {
+  int i;
+  if (pool->workers == NULL) {
+    pool->nthreads = 1;
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->quit = 1;
+  pthread_cond_broadcast(&pool->start_cond);
+  pthread_mutex_unlock(&pool->mutex);
+  for (i = 0; i < pool->nthreads - 1; i++) pthread_join(pool->workers[i], NULL);
+  free(pool->workers);
+  pool->workers = NULL;
+  pool->nthreads = 1;
+  pthread_cond_destroy(&pool->done_cond);
+  pthread_cond_destroy(&pool->start_cond);
+  pthread_mutex_destroy(&pool->mutex);
+}
+
+void od_thread_pool_run(od_thread_pool *pool, od_thread_job_func job,
+ void *ctx, int njobs) {
+  if (pool->workers == NULL || njobs <= 1) {
+    int jobi;
+    for (jobi = 0; jobi < njobs; jobi++) (*job)(ctx, jobi);
+    return;
+  }
+  pthread_mutex_lock(&pool->mutex);
+  pool->job = job;
+  pool->ctx = ctx;
+  pool->njobs = njobs;
+  pool->next_job = 0;
+  pool->jobs_done = 0;
+  pool->batch++;
+  pthread_cond_broadcast(&pool->start_cond);
+  od_thread_pool_work(pool);
+  while (pool->jobs_done < pool->njobs) {
+    pthread_cond_wait(&pool->done_cond, &pool->mutex);
+  }
+  pool->njobs = pool->next_job = pool->jobs_done = 0;
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+int od_progress_init(od_progress *progress) {
+  progress->value = 0;
+  if (pthread_mutex_init(&progress->mutex, NULL)) return OD_EFAULT;
+  if (pthread_cond_init(&progress->cond, NULL)) {
+    pthread_mutex_destroy(&progress->mutex);
+    return OD_EFAULT;
+  }
+  return OD_SUCCESS;
+}
+
+void od_progress_clear(od_progress *progress) {
+  pthread_cond_destroy(&progress->cond);
+  pthread_mutex_destroy(&progress->mutex);
+}
+
+void od_progress_reset(od_progress *progress) {
+  pthread_mutex_lock(&progress->mutex);
+  progress->value = 0;
+  pthread_mutex_unlock(&progress->mutex);
+}
+
+void od_progress_set(od_progress *progress, int value) {
+  pthread_mutex_lock(&progress->mutex);
+  OD_ASSERT(value >= progress->value);
+  progress->value = value;
+  pthread_cond_broadcast(&progress->cond);
+  pthread_mutex_unlock(&progress->mutex);
+}
+
+void od_progress_wait(od_progress *progress, int value) {
+  pthread_mutex_lock(&progress->mutex);
+  while (progress->value < value) {
+    pthread_cond_wait(&progress->cond, &progress->mutex);
+  }
+  pthread_mutex_unlock(&progress->mutex);
+}
+
+static void *od_task_worker(void *arg) {
+  od_task *task;
+  task = (od_task *)arg;
+  pthread_mutex_lock(&task->mutex);
+  for (;;) {
+    while (!task->quit && (!task->busy || task->job == NULL)) {
+      pthread_cond_wait(&task->cond, &task->mutex);
+    }
+    if (task->quit) break;
+    pthread_mutex_unlock(&task->mutex);
+    (*task->job)(task->ctx, task->jobi);
+    pthread_mutex_lock(&task->mutex);
+    task->job = NULL;
+    task->busy = 0;
+    pthread_cond_broadcast(&task->cond);
+  }
+  pthread_mutex_unlock(&task->mutex);
+  return NULL;
+}
+
+int od_task_init(od_task *task) {
+  task->job = NULL;
+  task->ctx = NULL;
+  task->jobi = 0;
+  task->busy = 0;
+  task->quit = 0;
+  if (pthread_mutex_init(&task->mutex, NULL)) return OD_EFAULT;
+  if (pthread_cond_init(&task->cond, NULL)) {
+    pthread_mutex_destroy(&task->mutex);
+    return OD_EFAULT;
+  }
+  if (pthread_create(&task->thread, NULL, od_task_worker, task)) {
+    pthread_cond_destroy(&task->cond);
+    pthread_mutex_destroy(&task->mutex);
+    return OD_EFAULT;
+  }
+  return OD_SUCCESS;
+}
+
+void od_task_clear(od_task *task) {
+  od_task_wait(task);
+  pthread_mutex_lock(&task->mutex);
+  task->quit = 1;
+  pthread_cond_broadcast(&task->cond);
+  pthread_mutex_unlock(&task->mutex);
+  pthread_join(task->thread, NULL);
+  pthread_cond_destroy(&task->cond);
+  pthread_mutex_destroy(&task->mutex);
+}
+
+void od_task_start(od_task *task, od_thread_job_func job, void *ctx,
+ int jobi) {
+  pthread_mutex_lock(&task->mutex);
+  OD_ASSERT(!task->busy);
+  task->job = job;
+  task->ctx = ctx;
+  task->jobi = jobi;
+  task->busy = 1;
+  pthread_cond_broadcast(&task->cond);
+  pthread_mutex_unlock(&task->mutex);
+}
+
+void od_task_wait(od_task *task) {
+  pthread_mutex_lock(&task->mutex);
+  while (task->busy) pthread_cond_wait(&task->cond, &task->mutex);
+  pthread_mutex_unlock(&task->mutex);
+}
+
+#else
+
+/*Without thread support, a pool always has exactly one thread, and every
+   batch runs serially in job order.
+  That order already satisfies every progress dependency, so waiting is only
+   a consistency check.*/
+
+int od_thread_pool_init(od_thread_pool *pool, int nthreads) {
+  if (nthreads < 1 || nthreads > OD_THREADS_MAX) return OD_EINVAL;
+  pool->nthreads = 1;
+  return nthreads == 1 ? OD_SUCCESS : OD_EIMPL;
+}
+
+void od_thread_pool_clear(od_thread_pool *pool) {
+  pool->nthreads = 1;
+}
+
+void od_thread_pool_run(od_thread_pool *pool, od_thread_job_func job,
+ void *ctx, int njobs) {
+  int jobi;
+  (void)pool;
+  for (jobi = 0; jobi < njobs; jobi++) (*job)(ctx, jobi);
+}
+
+int od_progress_init(od_progress *progress) {
+  progress->value = 0;
+  return OD_SUCCESS;
+}
+
+void od_progress_clear(od_progress *progress) {
+  (void)progress;
+}
+
+void od_progress_reset(od_progress *progress) {
+  progress->value = 0;
+}
+
+void od_progress_set(od_progress *progress, int value) {
+  OD_ASSERT(value >= progress->value);
+  progress->value = value;
+}
+
+void od_progress_wait(od_progress *progress, int value) {
+  OD_ALWAYS_TRUE(progress->value >= value);
+}
+
+/*Tasks exist so that work can overlap, which is impossible without threads.*/
+int od_task_init(od_task *task) {
+  task->job = NULL;
+  task->ctx = NULL;
+  task->jobi = 0;
+  task->busy = 0;
+  task->quit = 0;
+  return OD_EIMPL;
+}
+
+void od_task_clear(od_task *task) {
+  (void)task;
+}
+
+void od_task_start(od_task *task, od_thread_job_func job, void *ctx,
+ int jobi) {
+  (*job)(ctx, jobi);
+  task->busy = 0;
+}
+
+void od_task_wait(od_task *task) {
+  (void)task;
+}
+
+#endif
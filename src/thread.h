@@ -0,0 +1,117 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#if !defined(_thread_H)
+# define _thread_H (1)
+# include "internal.h"
+# if defined(OD_THREADS)
+#  include <pthread.h>
+# endif
+
+/*The largest number of threads a thread pool may be configured with.*/
+# define OD_THREADS_MAX (64)
+
+typedef struct od_thread_pool od_thread_pool;
+typedef struct od_progress    od_progress;
+typedef struct od_task        od_task;
+
+/*A job run by a thread pool.
+  ctx: The context pointer passed to od_thread_pool_run().
+  jobi: The index of this job, in the range [0, njobs).*/
+typedef void (*od_thread_job_func)(void *ctx, int jobi);
+
+/*A monotonically increasing counter that one job uses to publish how far it
+   has progressed (e.g., how many superblock rows are done) and that other
+   jobs can block on.*/
+struct od_progress {
+# if defined(OD_THREADS)
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+# endif
+  int value;
+};
+
+/*A fixed set of worker threads.
+  The thread that calls od_thread_pool_run() also executes jobs, so a pool
+   created with nthreads == 1 starts no threads at all and runs every job
+   serially, in order.*/
+struct od_thread_pool {
+  /*The number of threads that execute jobs, including the calling thread.*/
+  int nthreads;
+# if defined(OD_THREADS)
+  pthread_t *workers;
+  pthread_mutex_t mutex;
+  /*Signaled when a new batch of jobs is posted, or the pool shuts down.*/
+  pthread_cond_t start_cond;
+  /*Signaled when the last job of a batch finishes.*/
+  pthread_cond_t done_cond;
+  od_thread_job_func job;
+  void *ctx;
+  int njobs;
+  /*The index of the next job to hand out.*/
+  int next_job;
+  /*The number of jobs in the current batch that have completed.*/
+  int jobs_done;
+  /*Incremented for every batch, so that sleeping workers can tell a new
+     batch from a spurious wakeup.*/
+  unsigned batch;
+  int quit;
+# endif
+};
+
+/*A single thread that runs one job at a time in the background.
+  Unlike a pool batch, od_task_start() returns immediately, so the caller can
+   keep several tasks busy at once and collect them with od_task_wait().*/
+struct od_task {
+# if defined(OD_THREADS)
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+# endif
+  od_thread_job_func job;
+  void *ctx;
+  int jobi;
+  /*Set from od_task_start() until the job finishes.*/
+  int busy;
+  int quit;
+};
+
+int od_thread_pool_init(od_thread_pool *pool, int nthreads);
+void od_thread_pool_clear(od_thread_pool *pool);
+void od_thread_pool_run(od_thread_pool *pool, od_thread_job_func job,
+ void *ctx, int njobs);
+
+int od_progress_init(od_progress *progress);
+void od_progress_clear(od_progress *progress);
+void od_progress_reset(od_progress *progress);
+void od_progress_set(od_progress *progress, int value);
+void od_progress_wait(od_progress *progress, int value);
+
+int od_task_init(od_task *task);
+void od_task_clear(od_task *task);
+void od_task_start(od_task *task, od_thread_job_func job, void *ctx,
+ int jobi);
+void od_task_wait(od_task *task);
+
+#endif
@@ -86,7 +86,45 @@ OD_SIMD_INLINE od_m256i mul_epi32_256(od_m256i a, int b1) {
   return _mm256_mullo_epi32(a, _mm256_set1_epi32(b1));
 }
 
+typedef __m256d od_m256d;
+
+OD_SIMD_INLINE od_m256d od_mm256_set1_pd(double c) {
+  return _mm256_set1_pd(c);
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_add_pd(od_m256d a, od_m256d b) {
+  return _mm256_add_pd(a, b);
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_mul_pd(od_m256d a, od_m256d b) {
+  return _mm256_mul_pd(a, b);
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_floor_pd(od_m256d a) {
+  return _mm256_floor_pd(a);
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_cvtepi32lo_pd(od_m256i a) {
+  return _mm256_cvtepi32_pd(_mm256_castsi256_si128(a));
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_cvtepi32hi_pd(od_m256i a) {
+  return _mm256_cvtepi32_pd(_mm256_extracti128_si256(a, 1));
+}
+
+OD_SIMD_INLINE od_m256i od_mm256_cvttpd_epi32(od_m256d lo, od_m256d hi) {
+  return _mm256_inserti128_si256(
+   _mm256_castsi128_si256(_mm256_cvttpd_epi32(lo)),
+   _mm256_cvttpd_epi32(hi), 1);
+}
+
 #define od_bin_fdct8x8_x86 od_bin_fdct8x8_avx2
 #define od_bin_idct8x8_x86 od_bin_idct8x8_avx2
+#define od_bin_fdct16x16_x86 od_bin_fdct16x16_avx2
+#define od_bin_idct16x16_x86 od_bin_idct16x16_avx2
+#define od_bin_fdct32x32_x86 od_bin_fdct32x32_avx2
+#define od_bin_idct32x32_x86 od_bin_idct32x32_avx2
+#define od_bin_fdct64x64_x86 od_bin_fdct64x64_avx2
+#define od_bin_idct64x64_x86 od_bin_idct64x64_avx2
 
 #include "x86dct.h"
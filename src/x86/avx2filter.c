@@ -0,0 +1,393 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include "x86int.h"
+
+#if defined(OD_X86ASM)
+#include <immintrin.h>
+#include "../filter.h"
+
+#if defined(OD_AVX2_INTRINSICS)
+
+/*Loads 8 columns, or only the first 4 when half is set.*/
+OD_SIMD_INLINE __m256i od_filter_load_avx2(const od_coeff *c, int half) {
+  if (half) {
+    return _mm256_maskload_epi32((const int *)c,
+     _mm256_setr_epi32(-1, -1, -1, -1, 0, 0, 0, 0));
+  }
+  return _mm256_loadu_si256((const __m256i *)c);
+}
+
+OD_SIMD_INLINE void od_filter_store_avx2(od_coeff *c, __m256i x, int half) {
+  if (half) _mm_storeu_si128((__m128i *)c, _mm256_castsi256_si128(x));
+  else _mm256_storeu_si256((__m256i *)c, x);
+}
+
+/*Computes (a*p + 32) >> 6 in each lane.*/
+OD_SIMD_INLINE __m256i od_mul_round6_avx2(__m256i a, int p) {
+  return _mm256_srai_epi32(_mm256_add_epi32(
+   _mm256_mullo_epi32(a, _mm256_set1_epi32(p)), _mm256_set1_epi32(32)), 6);
+}
+
+/*Computes (t << 6)/p in each lane, rounding toward zero.
+  See od_div_scale6_sse41() for why double precision is exact enough.*/
+OD_SIMD_INLINE __m256i od_div_scale6_avx2(__m256i t, int p) {
+  __m256d d;
+  __m128i lo;
+  __m128i hi;
+  d = _mm256_set1_pd(p);
+  t = _mm256_slli_epi32(t, 6);
+  lo = _mm256_cvttpd_epi32(_mm256_div_pd(
+   _mm256_cvtepi32_pd(_mm256_castsi256_si128(t)), d));
+  hi = _mm256_cvttpd_epi32(_mm256_div_pd(
+   _mm256_cvtepi32_pd(_mm256_extracti128_si256(t, 1)), d));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+OD_SIMD_INLINE void od_filter_load_butterflies_avx2(__m256i *t,
+ const od_coeff *c, int stride, int n, int half) {
+  int i;
+  for (i = 0; i < n >> 1; i++) {
+    __m256i a;
+    __m256i b;
+    a = od_filter_load_avx2(c + i*stride, half);
+    b = od_filter_load_avx2(c + (n - 1 - i)*stride, half);
+    t[n - 1 - i] = _mm256_sub_epi32(a, b);
+    t[i] = _mm256_sub_epi32(a, _mm256_srai_epi32(t[n - 1 - i], 1));
+  }
+}
+
+OD_SIMD_INLINE void od_filter_store_butterflies_avx2(od_coeff *c,
+ int stride, __m256i *t, int n, int half) {
+  int i;
+  for (i = 0; i < n >> 1; i++) {
+    t[i] = _mm256_add_epi32(t[i], _mm256_srai_epi32(t[n - 1 - i], 1));
+    od_filter_store_avx2(c + i*stride, t[i], half);
+    od_filter_store_avx2(c + (n - 1 - i)*stride,
+     _mm256_sub_epi32(t[i], t[n - 1 - i]), half);
+  }
+}
+
+/*Applies the 4 << f point pre filter to 8 adjacent columns (4 if half is
+   set).
+  See od_pre_filter_cols_x4_sse41() for the layout of p.*/
+OD_SIMD_INLINE void od_pre_filter_cols_x8_avx2(od_coeff *c, int stride,
+ int f, const int *p, int half) {
+  __m256i t[4 << (OD_NBSIZES - 1)];
+  int n;
+  int h;
+  int i;
+  n = 4 << f;
+  h = n >> 1;
+  od_filter_load_butterflies_avx2(t, c, stride, n, half);
+  for (i = 0; i < h; i++) {
+    if (p[i] != 64) {
+      __m256i x;
+      x = _mm256_srai_epi32(
+       _mm256_mullo_epi32(t[h + i], _mm256_set1_epi32(p[i])), 6);
+      t[h + i] = _mm256_add_epi32(x,
+       _mm256_srli_epi32(_mm256_sub_epi32(_mm256_setzero_si256(), x), 31));
+    }
+  }
+  for (i = h - 2; i >= 0; i--) {
+    t[h + i + 1] = _mm256_add_epi32(t[h + i + 1],
+     od_mul_round6_avx2(t[h + i], p[h + i]));
+    t[h + i] = _mm256_add_epi32(t[h + i],
+     od_mul_round6_avx2(t[h + i + 1], p[2*h - 1 + i]));
+  }
+  od_filter_store_butterflies_avx2(c, stride, t, n, half);
+}
+
+OD_SIMD_INLINE void od_post_filter_cols_x8_avx2(od_coeff *c, int stride,
+ int f, const int *p, int half) {
+  __m256i t[4 << (OD_NBSIZES - 1)];
+  int n;
+  int h;
+  int i;
+  n = 4 << f;
+  h = n >> 1;
+  od_filter_load_butterflies_avx2(t, c, stride, n, half);
+  for (i = 0; i < h - 1; i++) {
+    t[h + i] = _mm256_sub_epi32(t[h + i],
+     od_mul_round6_avx2(t[h + i + 1], p[2*h - 1 + i]));
+    t[h + i + 1] = _mm256_sub_epi32(t[h + i + 1],
+     od_mul_round6_avx2(t[h + i], p[h + i]));
+  }
+  for (i = 0; i < h; i++) {
+    if (p[i] != 64) t[h + i] = od_div_scale6_avx2(t[h + i], p[i]);
+  }
+  od_filter_store_butterflies_avx2(c, stride, t, n, half);
+}
+
+OD_SIMD_INLINE void od_filter_cols_avx2(od_coeff *c, int stride, int n,
+ int f, const int *p, int inv) {
+  int j;
+#if defined(OD_CHECKASM)
+  od_coeff ref[(4 << (OD_NBSIZES - 1))*OD_BSIZE_MAX];
+  od_filter_cols_save(ref, c, stride, n, f);
+#endif
+  OD_ASSERT(!(n & 3));
+  for (j = 0; j < n; j += 8) {
+    if (inv) od_post_filter_cols_x8_avx2(c + j, stride, f, p, n - j < 8);
+    else od_pre_filter_cols_x8_avx2(c + j, stride, f, p, n - j < 8);
+  }
+#if defined(OD_CHECKASM)
+  od_filter_cols_check(c, stride, ref, n, f, inv);
+#endif
+}
+
+void od_pre_filter_cols4_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 0, OD_FILTER_PARAMS4, 0);
+}
+
+void od_post_filter_cols4_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 0, OD_FILTER_PARAMS4, 1);
+}
+
+void od_pre_filter_cols8_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 1, OD_FILTER_PARAMS8, 0);
+}
+
+void od_post_filter_cols8_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 1, OD_FILTER_PARAMS8, 1);
+}
+
+void od_pre_filter_cols16_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 2, OD_FILTER_PARAMS16, 0);
+}
+
+void od_post_filter_cols16_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 2, OD_FILTER_PARAMS16, 1);
+}
+
+void od_pre_filter_cols32_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 3, OD_FILTER_PARAMS32, 0);
+}
+
+void od_post_filter_cols32_avx2(od_coeff *c, int stride, int n) {
+  od_filter_cols_avx2(c, stride, n, 3, OD_FILTER_PARAMS32, 1);
+}
+
+/*Computes (x*m) >> 31 in each 32-bit lane, with the results of each pair of
+   lanes added into the even one.*/
+OD_SIMD_INLINE __m256i od_divu31_sum_avx2(__m256i x, __m256i m) {
+  __m256i even;
+  __m256i odd;
+  even = _mm256_srli_epi64(_mm256_mul_epu32(x, m), 31);
+  odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32),
+   _mm256_srli_epi64(m, 32)), 31);
+  return _mm256_add_epi64(even, odd);
+}
+
+/*Loads the same 4 reciprocals into both 128-bit lanes.*/
+OD_SIMD_INLINE __m256i od_dir_load_divu31_avx2(const uint32_t *m) {
+  __m128i m4;
+  m4 = _mm_loadu_si128((const __m128i *)m);
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(m4), m4, 1);
+}
+
+/*Squares the 8 partial sums in each 128-bit lane of p and divides each one
+   by its line length using the reciprocals in m.*/
+OD_SIMD_INLINE __m256i od_dir_cost8_avx2(__m256i p, const uint32_t *m) {
+  __m256i lo;
+  __m256i hi;
+  lo = _mm256_unpacklo_epi16(p, _mm256_setzero_si256());
+  hi = _mm256_unpackhi_epi16(p, _mm256_setzero_si256());
+  return _mm256_add_epi64(
+   od_divu31_sum_avx2(_mm256_madd_epi16(lo, lo),
+   od_dir_load_divu31_avx2(m)),
+   od_divu31_sum_avx2(_mm256_madd_epi16(hi, hi),
+   od_dir_load_divu31_avx2(m + 4)));
+}
+
+/*Computes the costs of directions 4 through 7 for the 8 rows in each 128-bit
+   lane of l.
+  This follows od_dir_costs4_sse41(), with the byte shifts applying to each
+   lane separately.*/
+OD_SIMD_INLINE __m256i od_dir_costs4_avx2(const __m256i *l) {
+  __m256i p4a;
+  __m256i p4b;
+  __m256i p5a;
+  __m256i p5b;
+  __m256i p6;
+  __m256i p7a;
+  __m256i p7b;
+  __m256i r;
+  __m256i c4;
+  __m256i c5;
+  __m256i c6;
+  __m256i c7;
+  __m256i lo;
+  __m256i hi;
+  p4a = l[0];
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[1], 2));
+  p4b = _mm256_slli_si256(l[1], 14);
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[2], 4));
+  p4b = _mm256_add_epi16(p4b, _mm256_slli_si256(l[2], 12));
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[3], 6));
+  p4b = _mm256_add_epi16(p4b, _mm256_slli_si256(l[3], 10));
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[4], 8));
+  p4b = _mm256_add_epi16(p4b, _mm256_slli_si256(l[4], 8));
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[5], 10));
+  p4b = _mm256_add_epi16(p4b, _mm256_slli_si256(l[5], 6));
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[6], 12));
+  p4b = _mm256_add_epi16(p4b, _mm256_slli_si256(l[6], 4));
+  p4a = _mm256_add_epi16(p4a, _mm256_srli_si256(l[7], 14));
+  p4b = _mm256_add_epi16(p4b, _mm256_slli_si256(l[7], 2));
+  r = _mm256_add_epi16(l[0], l[1]);
+  p5a = _mm256_slli_si256(r, 6);
+  p5b = _mm256_srli_si256(r, 10);
+  p6 = r;
+  p7a = r;
+  r = _mm256_add_epi16(l[2], l[3]);
+  p5a = _mm256_add_epi16(p5a, _mm256_slli_si256(r, 4));
+  p5b = _mm256_add_epi16(p5b, _mm256_srli_si256(r, 12));
+  p6 = _mm256_add_epi16(p6, r);
+  p7a = _mm256_add_epi16(p7a, _mm256_slli_si256(r, 2));
+  p7b = _mm256_srli_si256(r, 14);
+  r = _mm256_add_epi16(l[4], l[5]);
+  p5a = _mm256_add_epi16(p5a, _mm256_slli_si256(r, 2));
+  p5b = _mm256_add_epi16(p5b, _mm256_srli_si256(r, 14));
+  p6 = _mm256_add_epi16(p6, r);
+  p7a = _mm256_add_epi16(p7a, _mm256_slli_si256(r, 4));
+  p7b = _mm256_add_epi16(p7b, _mm256_srli_si256(r, 12));
+  r = _mm256_add_epi16(l[6], l[7]);
+  p5a = _mm256_add_epi16(p5a, r);
+  p6 = _mm256_add_epi16(p6, r);
+  p7a = _mm256_add_epi16(p7a, _mm256_slli_si256(r, 6));
+  p7b = _mm256_add_epi16(p7b, _mm256_srli_si256(r, 10));
+  c4 = _mm256_add_epi64(od_dir_cost8_avx2(p4a, OD_DIR_DIVU31[0]),
+   od_dir_cost8_avx2(p4b, OD_DIR_DIVU31[1]));
+  c5 = _mm256_add_epi64(od_dir_cost8_avx2(p5a, OD_DIR_DIVU31[2]),
+   od_dir_cost8_avx2(p5b, OD_DIR_DIVU31[3]));
+  c7 = _mm256_add_epi64(od_dir_cost8_avx2(p7a, OD_DIR_DIVU31[2]),
+   od_dir_cost8_avx2(p7b, OD_DIR_DIVU31[3]));
+  lo = _mm256_unpacklo_epi16(p6, _mm256_setzero_si256());
+  hi = _mm256_unpackhi_epi16(p6, _mm256_setzero_si256());
+  c6 = _mm256_add_epi32(_mm256_srli_epi32(_mm256_madd_epi16(lo, lo), 3),
+   _mm256_srli_epi32(_mm256_madd_epi16(hi, hi), 3));
+  return _mm256_hadd_epi32(_mm256_hadd_epi32(c4, c5),
+   _mm256_hadd_epi32(c6, c7));
+}
+
+/*Transposes the 8x8 block in the rows l, flipping it vertically first, so
+   that t[i][j] = l[7 - j][i].*/
+OD_SIMD_INLINE void od_dir_transpose_avx2(__m128i *t, const __m128i *l) {
+  __m128i a0;
+  __m128i a1;
+  __m128i a2;
+  __m128i a3;
+  __m128i a4;
+  __m128i a5;
+  __m128i a6;
+  __m128i a7;
+  __m128i b0;
+  __m128i b1;
+  __m128i b2;
+  __m128i b3;
+  __m128i b4;
+  __m128i b5;
+  __m128i b6;
+  __m128i b7;
+  a0 = _mm_unpacklo_epi16(l[7], l[6]);
+  a1 = _mm_unpacklo_epi16(l[5], l[4]);
+  a2 = _mm_unpacklo_epi16(l[3], l[2]);
+  a3 = _mm_unpacklo_epi16(l[1], l[0]);
+  a4 = _mm_unpackhi_epi16(l[7], l[6]);
+  a5 = _mm_unpackhi_epi16(l[5], l[4]);
+  a6 = _mm_unpackhi_epi16(l[3], l[2]);
+  a7 = _mm_unpackhi_epi16(l[1], l[0]);
+  b0 = _mm_unpacklo_epi32(a0, a1);
+  b1 = _mm_unpacklo_epi32(a2, a3);
+  b2 = _mm_unpackhi_epi32(a0, a1);
+  b3 = _mm_unpackhi_epi32(a2, a3);
+  b4 = _mm_unpacklo_epi32(a4, a5);
+  b5 = _mm_unpacklo_epi32(a6, a7);
+  b6 = _mm_unpackhi_epi32(a4, a5);
+  b7 = _mm_unpackhi_epi32(a6, a7);
+  t[0] = _mm_unpacklo_epi64(b0, b1);
+  t[1] = _mm_unpackhi_epi64(b0, b1);
+  t[2] = _mm_unpacklo_epi64(b2, b3);
+  t[3] = _mm_unpackhi_epi64(b2, b3);
+  t[4] = _mm_unpacklo_epi64(b4, b5);
+  t[5] = _mm_unpackhi_epi64(b4, b5);
+  t[6] = _mm_unpacklo_epi64(b6, b7);
+  t[7] = _mm_unpackhi_epi64(b6, b7);
+}
+
+/*Searches directions 0 through 3 in the low lane, using the flipped
+   transpose of the block, at the same time as directions 4 through 7 in the
+   high lane.*/
+int od_dir_find8_avx2(const int16_t *img, int stride, int32_t *var) {
+  __m128i l[8];
+  __m128i t[8];
+  __m256i lt[8];
+  int32_t cost[8];
+  int best_cost;
+  int best_dir;
+  int i;
+  for (i = 0; i < 8; i++) {
+    l[i] = _mm_srai_epi16(_mm_loadu_si128((const __m128i *)&img[i*stride]),
+     OD_COEFF_SHIFT);
+  }
+  od_dir_transpose_avx2(t, l);
+  for (i = 0; i < 8; i++) {
+    lt[i] = _mm256_inserti128_si256(_mm256_castsi128_si256(t[i]), l[i], 1);
+  }
+  _mm256_storeu_si256((__m256i *)cost, od_dir_costs4_avx2(lt));
+  best_cost = 0;
+  best_dir = 0;
+  for (i = 0; i < 8; i++) {
+    if (cost[i] > best_cost) {
+      best_cost = cost[i];
+      best_dir = i;
+    }
+  }
+  *var = best_cost - cost[(best_dir + 4) & 7];
+#if defined(OD_CHECKASM)
+  od_dir_find8_check(img, stride, *var, best_dir);
+#endif
+  return best_dir;
+}
+
+const od_filter_cols_func OD_PRE_FILTER_COLS_AVX2[OD_NBSIZES] = {
+  od_pre_filter_cols4_avx2,
+  od_pre_filter_cols8_avx2,
+  od_pre_filter_cols16_avx2,
+  od_pre_filter_cols32_avx2
+};
+
+const od_filter_cols_func OD_POST_FILTER_COLS_AVX2[OD_NBSIZES] = {
+  od_post_filter_cols4_avx2,
+  od_post_filter_cols8_avx2,
+  od_post_filter_cols16_avx2,
+  od_post_filter_cols32_avx2
+};
+
+#endif
+#endif
@@ -0,0 +1,193 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "x86int.h"
+#include "../mc.h"
+
+#if defined(OD_X86ASM)
+
+/*Computes 16 blended 16-bit pixels from 4 images.
+  This is the same computation as od_mc_blend16_8_sse2().
+  The unpacks and packs both work within 128-bit lanes, so the outputs come
+   back out in the same order as the inputs.*/
+OD_SIMD_INLINE __m256i od_mc_blend16_16_avx2(__m256i s0, __m256i s1,
+ __m256i s2, __m256i s3, __m256i w0, __m256i w1, __m256i w2, __m256i w3,
+ __m256i round, __m128i shift) {
+  __m256i lo;
+  __m256i hi;
+  lo = _mm256_add_epi32(
+   _mm256_madd_epi16(_mm256_unpacklo_epi16(s0, s1),
+   _mm256_unpacklo_epi16(w0, w1)),
+   _mm256_madd_epi16(_mm256_unpacklo_epi16(s2, s3),
+   _mm256_unpacklo_epi16(w2, w3)));
+  hi = _mm256_add_epi32(
+   _mm256_madd_epi16(_mm256_unpackhi_epi16(s0, s1),
+   _mm256_unpackhi_epi16(w0, w1)),
+   _mm256_madd_epi16(_mm256_unpackhi_epi16(s2, s3),
+   _mm256_unpackhi_epi16(w2, w3)));
+  lo = _mm256_sra_epi32(_mm256_add_epi32(lo, round), shift);
+  hi = _mm256_sra_epi32(_mm256_add_epi32(hi, round), shift);
+  return _mm256_packs_epi32(lo, hi);
+}
+
+/*Blends one row of a block of 16-bit pixels.
+  The weight of image k in column i is w[k] + i*dwdi[k].
+  Rows must be a multiple of 16 pixels wide.*/
+OD_SIMD_INLINE void od_mc_blend16_row_avx2(int16_t *dst,
+ const unsigned char *src[4], int off, int xblk_sz,
+ const int w[4], const int dwdi[4], __m256i round, __m128i shift) {
+  const int16_t *s0;
+  const int16_t *s1;
+  const int16_t *s2;
+  const int16_t *s3;
+  __m256i idx;
+  __m256i w0;
+  __m256i w1;
+  __m256i w2;
+  __m256i w3;
+  int i;
+  s0 = (const int16_t *)src[0] + off;
+  s1 = (const int16_t *)src[1] + off;
+  s2 = (const int16_t *)src[2] + off;
+  s3 = (const int16_t *)src[3] + off;
+  idx = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7,
+   8, 9, 10, 11, 12, 13, 14, 15);
+  w0 = _mm256_add_epi16(_mm256_set1_epi16(w[0]),
+   _mm256_mullo_epi16(idx, _mm256_set1_epi16(dwdi[0])));
+  w1 = _mm256_add_epi16(_mm256_set1_epi16(w[1]),
+   _mm256_mullo_epi16(idx, _mm256_set1_epi16(dwdi[1])));
+  w2 = _mm256_add_epi16(_mm256_set1_epi16(w[2]),
+   _mm256_mullo_epi16(idx, _mm256_set1_epi16(dwdi[2])));
+  w3 = _mm256_add_epi16(_mm256_set1_epi16(w[3]),
+   _mm256_mullo_epi16(idx, _mm256_set1_epi16(dwdi[3])));
+  for (i = 0; i < xblk_sz; i += 16) {
+    _mm256_storeu_si256((__m256i *)(dst + i), od_mc_blend16_16_avx2(
+     _mm256_loadu_si256((const __m256i *)(s0 + i)),
+     _mm256_loadu_si256((const __m256i *)(s1 + i)),
+     _mm256_loadu_si256((const __m256i *)(s2 + i)),
+     _mm256_loadu_si256((const __m256i *)(s3 + i)), w0, w1, w2, w3,
+     round, shift));
+    w0 = _mm256_add_epi16(w0, _mm256_set1_epi16(dwdi[0]*16));
+    w1 = _mm256_add_epi16(w1, _mm256_set1_epi16(dwdi[1]*16));
+    w2 = _mm256_add_epi16(w2, _mm256_set1_epi16(dwdi[2]*16));
+    w3 = _mm256_add_epi16(w3, _mm256_set1_epi16(dwdi[3]*16));
+  }
+}
+
+/*Perform normal bilinear blending on 16-bit pixels.*/
+void od_mc_blend_full16_avx2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz) {
+  int w[4];
+  int dwdi[4];
+  int xblk_sz;
+  int yblk_sz;
+  int log_blk_sz2;
+  __m256i round;
+  __m128i shift;
+  int j;
+  if (log_xblk_sz < 4) {
+    od_mc_blend_full16_sse2(dst, dystride, src, log_xblk_sz, log_yblk_sz);
+    return;
+  }
+  xblk_sz = 1 << log_xblk_sz;
+  yblk_sz = 1 << log_yblk_sz;
+  log_blk_sz2 = log_xblk_sz + log_yblk_sz;
+  round = _mm256_set1_epi32(1 << (log_blk_sz2 - 1));
+  shift = _mm_cvtsi32_si128(log_blk_sz2);
+  for (j = 0; j < yblk_sz; j++) {
+    w[0] = (yblk_sz - j) << log_xblk_sz;
+    dwdi[0] = j - yblk_sz;
+    w[1] = 0;
+    dwdi[1] = yblk_sz - j;
+    w[2] = 0;
+    dwdi[2] = j;
+    w[3] = j << log_xblk_sz;
+    dwdi[3] = -j;
+    od_mc_blend16_row_avx2((int16_t *)(dst + j*dystride), src, j*xblk_sz,
+     xblk_sz, w, dwdi, round, shift);
+  }
+#if defined(OD_CHECKASM)
+  od_mc_blend_full16_check(dst, dystride, src, log_xblk_sz, log_yblk_sz);
+#endif
+}
+
+/*Perform normal blending on 16-bit pixels with bilinear weights modified
+   for unsplit edges.*/
+void od_mc_blend_full_split16_avx2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz) {
+  int w[4];
+  int dwdi[4];
+  int s0[4];
+  int dsdi[4];
+  int dsdj[4];
+  int ddsdidj[4];
+  int xblk_sz;
+  int yblk_sz;
+  int log_blk_sz2p1;
+  __m256i round;
+  __m128i shift;
+  int j;
+  int k;
+  if (log_xblk_sz < 4 || log_xblk_sz != log_yblk_sz) {
+    od_mc_blend_full_split16_sse2(dst, dystride, src, oc, s,
+     log_xblk_sz, log_yblk_sz);
+    return;
+  }
+  xblk_sz = 1 << log_xblk_sz;
+  yblk_sz = 1 << log_yblk_sz;
+  log_blk_sz2p1 = log_xblk_sz + log_yblk_sz + 1;
+  round = _mm256_set1_epi32(1 << (log_blk_sz2p1 - 1));
+  shift = _mm_cvtsi32_si128(log_blk_sz2p1);
+  od_mc_setup_s_split(s0, dsdi, dsdj, ddsdidj,
+   oc, s, log_xblk_sz, log_yblk_sz);
+  for (j = 0; j < yblk_sz; j++) {
+    w[0] = 1 << log_blk_sz2p1;
+    dwdi[0] = 0;
+    for (k = 1; k < 4; k++) {
+      w[k] = s0[k];
+      dwdi[k] = dsdi[k];
+      w[0] -= w[k];
+      dwdi[0] -= dwdi[k];
+    }
+    od_mc_blend16_row_avx2((int16_t *)(dst + j*dystride), src, j*xblk_sz,
+     xblk_sz, w, dwdi, round, shift);
+    for (k = 0; k < 4; k++) {
+      s0[k] += dsdj[k];
+      dsdi[k] += ddsdidj[k];
+    }
+  }
+#if defined(OD_CHECKASM)
+  od_mc_blend_full_split16_check(dst, dystride, src, oc, s,
+   log_xblk_sz, log_yblk_sz);
+#endif
+}
+
+#endif
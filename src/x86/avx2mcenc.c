@@ -0,0 +1,378 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "x86enc.h"
+#include "x86int.h"
+
+#if defined(OD_X86ASM)
+#include <immintrin.h>
+
+#if defined(OD_AVX2_INTRINSICS)
+
+OD_SIMD_INLINE int32_t od_mc_compute_sad8_nxn_avx2(int ln,
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int dystride) {
+  __m256i sum;
+  __m128i s;
+  int32_t sad;
+  int n;
+  int i;
+  int j;
+  n = 1 << ln;
+  sum = _mm256_setzero_si256();
+  if (n == 16) {
+    /*Put two rows in each vector.*/
+    for (i = 0; i < 16; i += 2) {
+      sum = _mm256_add_epi64(sum, _mm256_sad_epu8(
+       _mm256_inserti128_si256(_mm256_castsi128_si256(
+       _mm_loadu_si128((const __m128i *)src)),
+       _mm_loadu_si128((const __m128i *)(src + systride)), 1),
+       _mm256_inserti128_si256(_mm256_castsi128_si256(
+       _mm_loadu_si128((const __m128i *)ref)),
+       _mm_loadu_si128((const __m128i *)(ref + dystride)), 1)));
+      src += 2*systride;
+      ref += 2*dystride;
+    }
+  }
+  else {
+    OD_ASSERT(n >= 32);
+    for (i = 0; i < n; i++) {
+      for (j = 0; j < n; j += 32) {
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(
+         _mm256_loadu_si256((const __m256i *)(src + j)),
+         _mm256_loadu_si256((const __m256i *)(ref + j))));
+      }
+      src += systride;
+      ref += dystride;
+    }
+  }
+  /*Each 64-bit lane holds a sum that fits in 32 bits.*/
+  s = _mm_add_epi32(_mm256_castsi256_si128(sum),
+   _mm256_extracti128_si256(sum, 1));
+  sad = _mm_cvtsi128_si32(_mm_add_epi32(s, _mm_unpackhi_epi64(s, s)));
+#if defined(OD_CHECKASM)
+  od_mc_compute_sad8_check(src - n*systride, systride, ref - n*dystride,
+   dystride, n, n, sad);
+#endif
+  return sad;
+}
+
+int32_t od_mc_compute_sad8_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad8_nxn_avx2(4, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad8_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad8_nxn_avx2(5, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad8_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad8_nxn_avx2(6, src, systride, ref, dystride);
+}
+
+/*Loads 16 8-bit pixels from src and ref and returns their difference as
+   16-bit values.*/
+OD_SIMD_INLINE __m256i od_mc_load_diff8_x16_avx2(const unsigned char *src,
+ const unsigned char *ref) {
+  return _mm256_sub_epi16(
+   _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)src)),
+   _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)ref)));
+}
+
+OD_SIMD_INLINE void od_mc_butterfly_epi16_avx2(__m256i *t0, __m256i *t1) {
+  __m256i a;
+  a = *t0;
+  *t0 = _mm256_add_epi16(a, *t1);
+  *t1 = _mm256_sub_epi16(a, *t1);
+}
+
+/*Computes the SATDs of two horizontally adjacent 8x8 blocks, one in each
+   128-bit lane.
+  The 8-bit differences transform to at most 255*64 in magnitude, so 16 bits
+   are enough, and the horizontal transform is done with three rounds of
+   in-lane horizontal adds and subtracts on pairs of rows.*/
+OD_SIMD_INLINE int32_t od_mc_compute_satd8_8x16_part_avx2(
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride) {
+  __m256i t[8];
+  __m256i sum;
+  __m256i a;
+  __m256i b;
+  __m128i s0;
+  __m128i s1;
+  int i;
+  int k;
+  for (i = 0; i < 8; i++) {
+    t[i] = od_mc_load_diff8_x16_avx2(src, ref);
+    src += systride;
+    ref += rystride;
+  }
+  /*Vertical transform.*/
+  for (i = 0; i < 8; i += 2) od_mc_butterfly_epi16_avx2(&t[i], &t[i + 1]);
+  for (i = 0; i < 8; i += 4) {
+    od_mc_butterfly_epi16_avx2(&t[i], &t[i + 2]);
+    od_mc_butterfly_epi16_avx2(&t[i + 1], &t[i + 3]);
+  }
+  for (i = 0; i < 4; i++) od_mc_butterfly_epi16_avx2(&t[i], &t[i + 4]);
+  /*Horizontal transform.*/
+  sum = _mm256_setzero_si256();
+  for (i = 0; i < 8; i += 2) {
+    a = t[i];
+    b = t[i + 1];
+    for (k = 0; k < 3; k++) {
+      __m256i c;
+      c = _mm256_hadd_epi16(a, b);
+      b = _mm256_hsub_epi16(a, b);
+      a = c;
+    }
+    /*|a| + |b| is at most 2*255*64, which still fits in a signed 16-bit
+       value.*/
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(
+     _mm256_add_epi16(_mm256_abs_epi16(a), _mm256_abs_epi16(b)),
+     _mm256_set1_epi16(1)));
+  }
+  /*Each 8x8 block is rounded separately to match the C version.*/
+  s0 = _mm256_castsi256_si128(sum);
+  s1 = _mm256_extracti128_si256(sum, 1);
+  s0 = _mm_hadd_epi32(s0, s1);
+  s0 = _mm_hadd_epi32(s0, s0);
+  s0 = _mm_srai_epi32(_mm_add_epi32(s0, _mm_set1_epi32(4)), 3);
+  return _mm_cvtsi128_si32(s0) + _mm_extract_epi32(s0, 1);
+}
+
+OD_SIMD_INLINE int32_t od_mc_compute_sum_8x8_satd8_avx2(int ln,
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride) {
+  int n;
+  int i;
+  int j;
+  int32_t satd;
+  n = 1 << ln;
+  OD_ASSERT(n >= 16);
+  satd = 0;
+  for (i = 0; i < n; i += 8) {
+    for (j = 0; j < n; j += 16) {
+      satd += od_mc_compute_satd8_8x16_part_avx2(src + i*systride + j,
+       systride, ref + i*rystride + j, rystride);
+    }
+  }
+#if defined(OD_CHECKASM)
+  od_mc_compute_satd8_check(src, systride, ref, rystride, ln, satd);
+#endif
+  return satd;
+}
+
+int32_t od_mc_compute_satd8_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd8_avx2(4, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd8_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd8_avx2(5, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd8_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd8_avx2(6, src, systride, ref, rystride);
+}
+
+/*Accumulates the absolute differences of 16 16-bit pixels into 8 32-bit
+   lanes.*/
+OD_SIMD_INLINE __m256i od_mc_sad16_accum_avx2(__m256i sum,
+ __m256i a, __m256i b) {
+  __m256i d;
+  d = _mm256_sub_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b));
+  sum = _mm256_add_epi32(sum,
+   _mm256_unpacklo_epi16(d, _mm256_setzero_si256()));
+  return _mm256_add_epi32(sum,
+   _mm256_unpackhi_epi16(d, _mm256_setzero_si256()));
+}
+
+OD_SIMD_INLINE int32_t od_mc_hsum_epi32_avx2(__m256i sum) {
+  __m128i s;
+  s = _mm_add_epi32(_mm256_castsi256_si128(sum),
+   _mm256_extracti128_si256(sum, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(s);
+}
+
+OD_SIMD_INLINE int32_t od_mc_compute_sad16_nxn_avx2(int ln,
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int dystride) {
+  __m256i sum;
+  int32_t sad;
+  int n;
+  int i;
+  int j;
+  n = 1 << ln;
+  OD_ASSERT(n >= 16);
+  sum = _mm256_setzero_si256();
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < n; j += 16) {
+      sum = od_mc_sad16_accum_avx2(sum,
+       _mm256_loadu_si256((const __m256i *)(src + 2*j)),
+       _mm256_loadu_si256((const __m256i *)(ref + 2*j)));
+    }
+    src += systride;
+    ref += dystride;
+  }
+  sad = (od_mc_hsum_epi32_avx2(sum) + (1 << OD_COEFF_SHIFT >> 1))
+   >> OD_COEFF_SHIFT;
+#if defined(OD_CHECKASM)
+  od_mc_compute_sad16_check(src - n*systride, systride, ref - n*dystride,
+   dystride, n, n, sad);
+#endif
+  return sad;
+}
+
+int32_t od_mc_compute_sad16_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_avx2(4, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad16_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_avx2(5, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad16_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_avx2(6, src, systride, ref, dystride);
+}
+
+/*Loads 8 16-bit pixels from src and ref and returns their difference as
+   32-bit values.*/
+OD_SIMD_INLINE __m256i od_mc_load_diff16_x8_avx2(const unsigned char *src,
+ const unsigned char *ref) {
+  return _mm256_sub_epi32(
+   _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)src)),
+   _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)ref)));
+}
+
+OD_SIMD_INLINE void od_mc_butterfly_epi32_avx2(__m256i *t0, __m256i *t1) {
+  __m256i a;
+  a = *t0;
+  *t0 = _mm256_add_epi32(a, *t1);
+  *t1 = _mm256_sub_epi32(a, *t1);
+}
+
+/*Performs the first stage of an 8-point Hadamard transform across the lanes
+   of t, combining lane i with lane i + 4.*/
+OD_SIMD_INLINE __m256i od_mc_butterfly_halves_avx2(__m256i t) {
+  __m256i s;
+  s = _mm256_permute2x128_si256(t, t, 0x01);
+  return _mm256_blend_epi32(_mm256_add_epi32(t, s), _mm256_sub_epi32(s, t),
+   0xF0);
+}
+
+/*Computes the SATD of one 8x8 block, with one row in each vector.
+  The horizontal transform is done in-lane, so no transpose is needed.*/
+OD_SIMD_INLINE int32_t od_mc_compute_satd16_8x8_part_avx2(
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride) {
+  __m256i t[8];
+  __m256i sum;
+  __m256i a;
+  __m256i b;
+  int i;
+  for (i = 0; i < 8; i++) {
+    t[i] = od_mc_load_diff16_x8_avx2(src, ref);
+    src += systride;
+    ref += rystride;
+  }
+  /*Vertical transform.*/
+  for (i = 0; i < 8; i += 2) od_mc_butterfly_epi32_avx2(&t[i], &t[i + 1]);
+  for (i = 0; i < 8; i += 4) {
+    od_mc_butterfly_epi32_avx2(&t[i], &t[i + 2]);
+    od_mc_butterfly_epi32_avx2(&t[i + 1], &t[i + 3]);
+  }
+  for (i = 0; i < 4; i++) od_mc_butterfly_epi32_avx2(&t[i], &t[i + 4]);
+  /*Horizontal transform.*/
+  sum = _mm256_setzero_si256();
+  for (i = 0; i < 8; i += 2) {
+    t[i] = od_mc_butterfly_halves_avx2(t[i]);
+    t[i + 1] = od_mc_butterfly_halves_avx2(t[i + 1]);
+    a = _mm256_hadd_epi32(t[i], t[i + 1]);
+    b = _mm256_hsub_epi32(t[i], t[i + 1]);
+    sum = _mm256_add_epi32(sum, _mm256_abs_epi32(_mm256_hadd_epi32(a, b)));
+    sum = _mm256_add_epi32(sum, _mm256_abs_epi32(_mm256_hsub_epi32(a, b)));
+  }
+  return (od_mc_hsum_epi32_avx2(sum) + (1 << (3 + OD_COEFF_SHIFT) >> 1))
+   >> (3 + OD_COEFF_SHIFT);
+}
+
+/*Perform SATD on 8x8 blocks within src and ref then sum the results of
+   each one.*/
+OD_SIMD_INLINE int32_t od_mc_compute_sum_8x8_satd16_avx2(int ln,
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride) {
+  int n;
+  int i;
+  int j;
+  int32_t satd;
+  n = 1 << ln;
+  OD_ASSERT(n >= 8);
+  satd = 0;
+  for (i = 0; i < n; i += 8) {
+    for (j = 0; j < n; j += 8) {
+      satd += od_mc_compute_satd16_8x8_part_avx2(src + i*systride + 2*j,
+       systride, ref + i*rystride + 2*j, rystride);
+    }
+  }
+#if defined(OD_CHECKASM)
+  od_mc_compute_satd16_check(src, systride, ref, rystride, ln, satd);
+#endif
+  return satd;
+}
+
+int32_t od_mc_compute_satd16_8x8_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_avx2(3, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd16_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_avx2(4, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd16_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_avx2(5, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd16_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_avx2(6, src, systride, ref, rystride);
+}
+
+#endif
+#endif
@@ -0,0 +1,139 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "x86enc.h"
+#include "x86int.h"
+
+#if defined(OD_X86ASM)
+#include <immintrin.h>
+
+#if defined(OD_AVX2_INTRINSICS)
+
+void od_pvq_search_pulses_avx2(od_coeff *y, int32_t *xy, int32_t *yy,
+ const int16_t *x, int n, int i, int k) {
+  int32_t cxy;
+  int32_t cyy;
+  int n8;
+#if defined(OD_CHECKASM)
+  od_coeff y0[OD_MAX_PVQ_SIZE];
+  int i0;
+  OD_ASSERT(n <= OD_MAX_PVQ_SIZE);
+  OD_COPY(y0, y, n);
+  i0 = i;
+#endif
+  cxy = *xy;
+  cyy = *yy;
+  n8 = n & ~7;
+  for (; i < k; i++) {
+    int32_t lane_num[8];
+    int32_t lane_den[8];
+    int32_t lane_pos[8];
+    __m256i best_num;
+    __m256i best_den;
+    __m256i best_pos;
+    __m256i pos;
+    __m256i xyv;
+    __m256i yyv;
+    __m128i s;
+    __m128i t;
+    int32_t num;
+    int32_t den;
+    int bestj;
+    int l;
+    int j;
+    s = _mm_cvtsi32_si128(OD_PVQ_SEARCH_NUM_SHIFT(i));
+    t = _mm_cvtsi32_si128(OD_PVQ_SEARCH_DEN_SHIFT(i));
+    xyv = _mm256_set1_epi32(cxy);
+    yyv = _mm256_set1_epi32(cyy + 1);
+    /*Each lane keeps the first best position among those congruent to it
+       mod 8.*/
+    best_num = _mm256_set1_epi32(-1);
+    best_den = _mm256_set1_epi32(1);
+    best_pos = _mm256_setzero_si256();
+    pos = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (j = 0; j < n8; j += 8) {
+      __m256i vnum;
+      __m256i vden;
+      __m256i gt;
+      vnum = _mm256_cvtepi16_epi32(
+       _mm_loadu_si128((const __m128i *)(x + j)));
+      vnum = _mm256_sra_epi32(_mm256_add_epi32(xyv, vnum), s);
+      vnum = _mm256_srli_epi32(_mm256_mullo_epi32(vnum, vnum), 15);
+      vden = _mm256_slli_epi32(
+       _mm256_loadu_si256((const __m256i *)(y + j)), 1);
+      vden = _mm256_sra_epi32(_mm256_add_epi32(yyv, vden), t);
+      gt = _mm256_cmpgt_epi32(_mm256_mullo_epi32(vnum, best_den),
+       _mm256_mullo_epi32(best_num, vden));
+      best_num = _mm256_blendv_epi8(best_num, vnum, gt);
+      best_den = _mm256_blendv_epi8(best_den, vden, gt);
+      best_pos = _mm256_blendv_epi8(best_pos, pos, gt);
+      pos = _mm256_add_epi32(pos, _mm256_set1_epi32(8));
+    }
+    _mm256_storeu_si256((__m256i *)lane_num, best_num);
+    _mm256_storeu_si256((__m256i *)lane_den, best_den);
+    _mm256_storeu_si256((__m256i *)lane_pos, best_pos);
+    num = lane_num[0];
+    den = lane_den[0];
+    bestj = lane_pos[0];
+    for (l = 1; l < 8; l++) {
+      int32_t a;
+      int32_t b;
+      a = lane_num[l]*den;
+      b = num*lane_den[l];
+      if (a > b || (a == b && lane_pos[l] < bestj)) {
+        num = lane_num[l];
+        den = lane_den[l];
+        bestj = lane_pos[l];
+      }
+    }
+    for (j = n8; j < n; j++) {
+      int32_t jnum;
+      int32_t jden;
+      jnum = (cxy + x[j]) >> OD_PVQ_SEARCH_NUM_SHIFT(i);
+      jnum = jnum*jnum >> 15;
+      jden = (cyy + 2*y[j] + 1) >> OD_PVQ_SEARCH_DEN_SHIFT(i);
+      if (jnum*den > num*jden) {
+        num = jnum;
+        den = jden;
+        bestj = j;
+      }
+    }
+    cxy += x[bestj];
+    cyy += 2*y[bestj] + 1;
+    y[bestj]++;
+  }
+#if defined(OD_CHECKASM)
+  od_pvq_search_pulses_check(y0, *xy, *yy, x, n, i0, k, y, cxy, cyy);
+#endif
+  *xy = cxy;
+  *yy = cyy;
+}
+
+#endif
+#endif
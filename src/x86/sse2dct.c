@@ -300,7 +300,82 @@ OD_SIMD_INLINE od_m256i mul_epi32_256(od_m256i a, int b1) {
   return x;
 }
 
+typedef struct {
+  __m128d lo;
+  __m128d hi;
+} od_m256d;
+
+/*This is overridden by the SSE4.1 version.*/
+#if !defined(OD_FLOOR_PD)
+/*SSE2 has no rounding instructions, so truncate and then correct negative
+   non-integers.
+  This is exact for all values that fit in an int32_t, which is all that the
+   DCT produces.*/
+OD_SIMD_INLINE __m128d od_floor_pd_sse2(__m128d a) {
+  __m128d t;
+  t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(a));
+  return _mm_sub_pd(t, _mm_and_pd(_mm_cmpgt_pd(t, a), _mm_set1_pd(1)));
+}
+
+# define OD_FLOOR_PD od_floor_pd_sse2
+#endif
+
+OD_SIMD_INLINE od_m256d od_mm256_set1_pd(double c) {
+  od_m256d r;
+  r.lo = _mm_set1_pd(c);
+  r.hi = _mm_set1_pd(c);
+  return r;
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_add_pd(od_m256d a, od_m256d b) {
+  od_m256d r;
+  r.lo = _mm_add_pd(a.lo, b.lo);
+  r.hi = _mm_add_pd(a.hi, b.hi);
+  return r;
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_mul_pd(od_m256d a, od_m256d b) {
+  od_m256d r;
+  r.lo = _mm_mul_pd(a.lo, b.lo);
+  r.hi = _mm_mul_pd(a.hi, b.hi);
+  return r;
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_floor_pd(od_m256d a) {
+  od_m256d r;
+  r.lo = OD_FLOOR_PD(a.lo);
+  r.hi = OD_FLOOR_PD(a.hi);
+  return r;
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_cvtepi32lo_pd(od_m256i a) {
+  od_m256d r;
+  r.lo = _mm_cvtepi32_pd(a.lo);
+  r.hi = _mm_cvtepi32_pd(_mm_srli_si128(a.lo, 8));
+  return r;
+}
+
+OD_SIMD_INLINE od_m256d od_mm256_cvtepi32hi_pd(od_m256i a) {
+  od_m256d r;
+  r.lo = _mm_cvtepi32_pd(a.hi);
+  r.hi = _mm_cvtepi32_pd(_mm_srli_si128(a.hi, 8));
+  return r;
+}
+
+OD_SIMD_INLINE od_m256i od_mm256_cvttpd_epi32(od_m256d lo, od_m256d hi) {
+  od_m256i r;
+  r.lo = _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo.lo), _mm_cvttpd_epi32(lo.hi));
+  r.hi = _mm_unpacklo_epi64(_mm_cvttpd_epi32(hi.lo), _mm_cvttpd_epi32(hi.hi));
+  return r;
+}
+
 #define od_bin_fdct8x8_x86 od_bin_fdct8x8_sse2
 #define od_bin_idct8x8_x86 od_bin_idct8x8_sse2
+#define od_bin_fdct16x16_x86 od_bin_fdct16x16_sse2
+#define od_bin_idct16x16_x86 od_bin_idct16x16_sse2
+#define od_bin_fdct32x32_x86 od_bin_fdct32x32_sse2
+#define od_bin_idct32x32_x86 od_bin_idct32x32_sse2
+#define od_bin_fdct64x64_x86 od_bin_fdct64x64_sse2
+#define od_bin_idct64x64_x86 od_bin_idct64x64_sse2
 
 #include "x86dct.h"
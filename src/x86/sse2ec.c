@@ -0,0 +1,174 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include "x86int.h"
+#include "cpu.h"
+
+#include <stdio.h>
+
+#if defined(OD_X86ASM)
+#include <emmintrin.h>
+#include "../entcode.h"
+
+/*The CDFs we search and adapt hold at most 16 entries, so they are loaded as
+   two possibly-overlapping vectors of 8 (or 4, for fewer than 8 entries),
+   one from each end, which never reads past the end of the CDF.*/
+
+#if defined(OD_CHECKASM)
+static void od_ec_cdf_search_check(const uint16_t *cdf, int nsyms,
+ unsigned q, int ret) {
+  int ref_ret;
+  ref_ret = od_ec_cdf_search_c(cdf, nsyms, q);
+  if (ref_ret != ret) {
+    fprintf(stderr, "ASM mismatch: %i!=%i (nsyms %i, q %u)\n",
+     ref_ret, ret, nsyms, q);
+    fprintf(stderr, "od_ec_cdf_search check failed.\n");
+  }
+  OD_ASSERT(ref_ret == ret);
+}
+
+static void od_ec_cdf_adapt_check(const uint16_t *cdf, uint16_t *ref,
+ int val, int n, int increment) {
+  int failed;
+  int i;
+  od_ec_cdf_adapt_c(ref, val, n, increment);
+  failed = 0;
+  for (i = 0; i < n; i++) {
+    if (ref[i] != cdf[i]) {
+      fprintf(stderr, "ASM mismatch: 0x%04X!=0x%04X @ (%i)\n",
+       ref[i], cdf[i], i);
+      failed = 1;
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_ec_cdf_adapt check (val %i, n %i, increment %i) "
+     "failed.\n", val, n, increment);
+  }
+  OD_ASSERT(!failed);
+}
+#endif
+
+/*Returns a mask with two bits set for each of the first n lanes of cdf that
+   are no larger than q.
+  Unsigned saturating subtraction leaves zero in exactly those lanes.*/
+OD_SIMD_INLINE int od_ec_cdf_le_mask(__m128i cdf, __m128i q, int n) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_subs_epu16(cdf, q),
+   _mm_setzero_si128())) & ((1 << 2*n) - 1);
+}
+
+int od_ec_cdf_search_sse2(const uint16_t *cdf, int nsyms, unsigned q) {
+  __m128i lo;
+  __m128i hi;
+  __m128i qv;
+  int lo_mask;
+  int hi_mask;
+  int n;
+  int ret;
+  if (nsyms < 4 || nsyms > 16) return od_ec_cdf_search_c(cdf, nsyms, q);
+  if (nsyms >= 8) {
+    lo = _mm_loadu_si128((const __m128i *)cdf);
+    hi = _mm_loadu_si128((const __m128i *)(cdf + nsyms - 8));
+    n = 8;
+  }
+  else {
+    lo = _mm_loadl_epi64((const __m128i *)cdf);
+    hi = _mm_loadl_epi64((const __m128i *)(cdf + nsyms - 4));
+    n = 4;
+  }
+  qv = _mm_set1_epi16((short)q);
+  lo_mask = od_ec_cdf_le_mask(lo, qv, n);
+  hi_mask = od_ec_cdf_le_mask(hi, qv, n);
+  /*The CDF is non-decreasing, so the lanes no larger than q are a prefix of
+     each vector.
+    If all of the first vector is, the answer lies in the second one, whose
+     first lane is entry nsyms - n.*/
+  if (lo_mask == (1 << 2*n) - 1) ret = nsyms - n + (OD_ILOG(hi_mask) >> 1);
+  else ret = OD_ILOG(lo_mask) >> 1;
+#if defined(OD_CHECKASM)
+  od_ec_cdf_search_check(cdf, nsyms, q, ret);
+#endif
+  return ret;
+}
+
+/*Adapts the lanes of cdf, whose first lane is entry offs of the CDF.*/
+OD_SIMD_INLINE __m128i od_ec_cdf_adapt_lanes(__m128i cdf, int offs,
+ int renorm, __m128i val, __m128i increment) {
+  __m128i idx;
+  idx = _mm_add_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7),
+   _mm_set1_epi16((short)offs));
+  if (renorm) {
+    /*Second term ensures that the pdf is non-null.*/
+    cdf = _mm_add_epi16(_mm_srli_epi16(cdf, 1),
+     _mm_add_epi16(idx, _mm_set1_epi16(1)));
+  }
+  return _mm_add_epi16(cdf,
+   _mm_andnot_si128(_mm_cmpgt_epi16(val, idx), increment));
+}
+
+void od_ec_cdf_adapt_sse2(uint16_t *cdf, int val, int n, int increment) {
+  __m128i lo;
+  __m128i hi;
+  __m128i valv;
+  __m128i incv;
+  int renorm;
+#if defined(OD_CHECKASM)
+  uint16_t ref[16];
+  if (n >= 4 && n <= 16) OD_COPY(ref, cdf, n);
+#endif
+  if (n < 4 || n > 16) {
+    od_ec_cdf_adapt_c(cdf, val, n, increment);
+    return;
+  }
+  renorm = cdf[n - 1] + increment > 32767;
+  valv = _mm_set1_epi16((short)val);
+  incv = _mm_set1_epi16((short)increment);
+  /*Both vectors are loaded before either is stored, and lanes they share get
+     the same result, so the overlap is harmless.*/
+  if (n >= 8) {
+    lo = _mm_loadu_si128((const __m128i *)cdf);
+    hi = _mm_loadu_si128((const __m128i *)(cdf + n - 8));
+    lo = od_ec_cdf_adapt_lanes(lo, 0, renorm, valv, incv);
+    hi = od_ec_cdf_adapt_lanes(hi, n - 8, renorm, valv, incv);
+    _mm_storeu_si128((__m128i *)(cdf + n - 8), hi);
+    _mm_storeu_si128((__m128i *)cdf, lo);
+  }
+  else {
+    lo = _mm_loadl_epi64((const __m128i *)cdf);
+    hi = _mm_loadl_epi64((const __m128i *)(cdf + n - 4));
+    lo = od_ec_cdf_adapt_lanes(lo, 0, renorm, valv, incv);
+    hi = od_ec_cdf_adapt_lanes(hi, n - 4, renorm, valv, incv);
+    _mm_storel_epi64((__m128i *)(cdf + n - 4), hi);
+    _mm_storel_epi64((__m128i *)cdf, lo);
+  }
+#if defined(OD_CHECKASM)
+  od_ec_cdf_adapt_check(cdf, ref, val, n, increment);
+#endif
+}
+
+#endif
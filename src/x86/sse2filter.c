@@ -36,6 +36,52 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "../filter.h"
 
 #if defined(OD_CHECKASM)
+void od_filter_cols_save(od_coeff *ref, const od_coeff *c, int stride, int n,
+ int f) {
+  int k;
+  OD_ASSERT(n <= OD_BSIZE_MAX);
+  for (k = 0; k < 4 << f; k++) {
+    OD_COPY(ref + k*OD_BSIZE_MAX, c + k*stride, n);
+  }
+}
+
+void od_filter_cols_check(const od_coeff *c, int stride, od_coeff *ref,
+ int n, int f, int inv) {
+  int failed;
+  int k;
+  int j;
+  if (inv) (*OD_POST_FILTER_COLS_C[f])(ref, OD_BSIZE_MAX, n);
+  else (*OD_PRE_FILTER_COLS_C[f])(ref, OD_BSIZE_MAX, n);
+  failed = 0;
+  for (k = 0; k < 4 << f; k++) {
+    for (j = 0; j < n; j++) {
+      if (ref[k*OD_BSIZE_MAX + j] != c[k*stride + j]) {
+        fprintf(stderr, "ASM mismatch: %i!=%i @ (%2i,%2i)\n",
+         ref[k*OD_BSIZE_MAX + j], c[k*stride + j], k, j);
+        failed = 1;
+      }
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_%s_filter_cols%i check failed.\n",
+     inv ? "post" : "pre", 4 << f);
+  }
+  OD_ASSERT(!failed);
+}
+
+void od_dir_find8_check(const int16_t *img, int stride, int32_t var,
+ int dir) {
+  int32_t ref_var;
+  int ref_dir;
+  ref_dir = od_dir_find8_c(img, stride, &ref_var);
+  if (ref_dir != dir || ref_var != var) {
+    fprintf(stderr, "ASM mismatch: dir %i!=%i, var %i!=%i\n",
+     ref_dir, dir, ref_var, var);
+    fprintf(stderr, "od_dir_find8 check failed.\n");
+  }
+  OD_ASSERT(ref_dir == dir && ref_var == var);
+}
+
 void od_filter_dering_direction_check(int16_t *y, int ystride, int16_t *in,
  int ln, int threshold, int dir) {
   int16_t dst[OD_BSIZE_MAX*OD_BSIZE_MAX];
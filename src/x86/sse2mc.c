@@ -909,6 +909,546 @@ void od_mc_predict1fmv16_sse2(od_state *state, unsigned char *dst,
 #endif
 }
 
+#if defined(OD_CHECKASM)
+void od_mc_blend_full16_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _log_xblk_sz, int _log_yblk_sz) {
+  int16_t dst[OD_MVBSIZE_MAX*OD_MVBSIZE_MAX];
+  int xblk_sz;
+  int yblk_sz;
+  int failed;
+  int i;
+  int j;
+  int _dst_val;
+  int dst_val;
+  xblk_sz = 1 << _log_xblk_sz;
+  yblk_sz = 1 << _log_yblk_sz;
+  failed = 0;
+  od_mc_blend_full16_c((unsigned char *)dst, xblk_sz << 1, _src,
+   _log_xblk_sz, _log_yblk_sz);
+  for (j = 0; j < yblk_sz; j++) {
+    for (i = 0; i < xblk_sz; i++) {
+      _dst_val = ((int16_t *)(_dst + j*_dystride))[i];
+      dst_val = dst[i + (j << _log_xblk_sz)];
+      if (_dst_val != dst_val) {
+        fprintf(stderr, "ASM mismatch: 0x%04X!=0x%04X @ (%2i,%2i)\n",
+         _dst_val, dst_val, i, j);
+        failed = 1;
+      }
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_mc_blend_full16 %ix%i check failed.\n",
+     (1 << _log_xblk_sz), (1 << _log_yblk_sz));
+  }
+  OD_ASSERT(!failed);
+}
+
+void od_mc_blend_full_split16_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _c, int _s,
+ int _log_xblk_sz, int _log_yblk_sz) {
+  int16_t dst[OD_MVBSIZE_MAX*OD_MVBSIZE_MAX];
+  int xblk_sz;
+  int yblk_sz;
+  int failed;
+  int i;
+  int j;
+  int _dst_val;
+  int dst_val;
+  xblk_sz = 1 << _log_xblk_sz;
+  yblk_sz = 1 << _log_yblk_sz;
+  failed = 0;
+  od_mc_blend_full_split16_c((unsigned char *)dst, xblk_sz << 1, _src, _c, _s,
+   _log_xblk_sz, _log_yblk_sz);
+  for (j = 0; j < yblk_sz; j++) {
+    for (i = 0; i < xblk_sz; i++) {
+      _dst_val = ((int16_t *)(_dst + j*_dystride))[i];
+      dst_val = dst[i + (j << _log_xblk_sz)];
+      if (_dst_val != dst_val) {
+        fprintf(stderr, "ASM mismatch: 0x%04X!=0x%04X @ (%2i,%2i)\n",
+         _dst_val, dst_val, i, j);
+        failed = 1;
+      }
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_mc_blend_full_split16 %ix%i check failed.\n",
+     (1 << _log_xblk_sz), (1 << _log_yblk_sz));
+  }
+  OD_ASSERT(!failed);
+}
+#endif
+
+/*Computes 8 blended 16-bit pixels from 4 images.
+  Both blends can be written as a sum of the 4 images, each multiplied by a
+   16-bit weight, where the weights sum to 1 << shift.
+  The result is then a convex combination of the inputs, which always fits
+   back into 16 bits, and the products can be summed in pairs with
+   _mm_madd_epi16() without overflowing 32 bits.
+  Because this is the same integer expression as the C code, just with its
+   terms regrouped, the result is bit-exact.*/
+OD_SIMD_INLINE __m128i od_mc_blend16_8_sse2(__m128i s0, __m128i s1,
+ __m128i s2, __m128i s3, __m128i w0, __m128i w1, __m128i w2, __m128i w3,
+ __m128i round, __m128i shift) {
+  __m128i lo;
+  __m128i hi;
+  lo = _mm_add_epi32(
+   _mm_madd_epi16(_mm_unpacklo_epi16(s0, s1), _mm_unpacklo_epi16(w0, w1)),
+   _mm_madd_epi16(_mm_unpacklo_epi16(s2, s3), _mm_unpacklo_epi16(w2, w3)));
+  hi = _mm_add_epi32(
+   _mm_madd_epi16(_mm_unpackhi_epi16(s0, s1), _mm_unpackhi_epi16(w0, w1)),
+   _mm_madd_epi16(_mm_unpackhi_epi16(s2, s3), _mm_unpackhi_epi16(w2, w3)));
+  lo = _mm_sra_epi32(_mm_add_epi32(lo, round), shift);
+  hi = _mm_sra_epi32(_mm_add_epi32(hi, round), shift);
+  return _mm_packs_epi32(lo, hi);
+}
+
+/*Blends one row of a block of 16-bit pixels.
+  The weight of image k in column i is w[k] + i*dwdi[k].
+  Rows must be at least 4 pixels wide.*/
+OD_SIMD_INLINE void od_mc_blend16_row_sse2(int16_t *dst,
+ const unsigned char *src[4], int off, int xblk_sz,
+ const int w[4], const int dwdi[4], __m128i round, __m128i shift) {
+  const int16_t *s0;
+  const int16_t *s1;
+  const int16_t *s2;
+  const int16_t *s3;
+  __m128i idx;
+  __m128i w0;
+  __m128i w1;
+  __m128i w2;
+  __m128i w3;
+  __m128i out;
+  int i;
+  s0 = (const int16_t *)src[0] + off;
+  s1 = (const int16_t *)src[1] + off;
+  s2 = (const int16_t *)src[2] + off;
+  s3 = (const int16_t *)src[3] + off;
+  idx = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  w0 = _mm_add_epi16(_mm_set1_epi16(w[0]),
+   _mm_mullo_epi16(idx, _mm_set1_epi16(dwdi[0])));
+  w1 = _mm_add_epi16(_mm_set1_epi16(w[1]),
+   _mm_mullo_epi16(idx, _mm_set1_epi16(dwdi[1])));
+  w2 = _mm_add_epi16(_mm_set1_epi16(w[2]),
+   _mm_mullo_epi16(idx, _mm_set1_epi16(dwdi[2])));
+  w3 = _mm_add_epi16(_mm_set1_epi16(w[3]),
+   _mm_mullo_epi16(idx, _mm_set1_epi16(dwdi[3])));
+  if (xblk_sz == 4) {
+    out = od_mc_blend16_8_sse2(_mm_loadl_epi64((const __m128i *)s0),
+     _mm_loadl_epi64((const __m128i *)s1),
+     _mm_loadl_epi64((const __m128i *)s2),
+     _mm_loadl_epi64((const __m128i *)s3), w0, w1, w2, w3, round, shift);
+    _mm_storel_epi64((__m128i *)dst, out);
+    return;
+  }
+  for (i = 0; i < xblk_sz; i += 8) {
+    out = od_mc_blend16_8_sse2(_mm_loadu_si128((const __m128i *)(s0 + i)),
+     _mm_loadu_si128((const __m128i *)(s1 + i)),
+     _mm_loadu_si128((const __m128i *)(s2 + i)),
+     _mm_loadu_si128((const __m128i *)(s3 + i)), w0, w1, w2, w3,
+     round, shift);
+    _mm_storeu_si128((__m128i *)(dst + i), out);
+    w0 = _mm_add_epi16(w0, _mm_set1_epi16(dwdi[0]*8));
+    w1 = _mm_add_epi16(w1, _mm_set1_epi16(dwdi[1]*8));
+    w2 = _mm_add_epi16(w2, _mm_set1_epi16(dwdi[2]*8));
+    w3 = _mm_add_epi16(w3, _mm_set1_epi16(dwdi[3]*8));
+  }
+}
+
+/*Perform normal bilinear blending on 16-bit pixels.*/
+void od_mc_blend_full16_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz) {
+  int w[4];
+  int dwdi[4];
+  int xblk_sz;
+  int yblk_sz;
+  int log_blk_sz2;
+  __m128i round;
+  __m128i shift;
+  int j;
+  if (log_xblk_sz < 2) {
+    od_mc_blend_full16_c(dst, dystride, src, log_xblk_sz, log_yblk_sz);
+    return;
+  }
+  xblk_sz = 1 << log_xblk_sz;
+  yblk_sz = 1 << log_yblk_sz;
+  log_blk_sz2 = log_xblk_sz + log_yblk_sz;
+  round = _mm_set1_epi32(1 << (log_blk_sz2 - 1));
+  shift = _mm_cvtsi32_si128(log_blk_sz2);
+  for (j = 0; j < yblk_sz; j++) {
+    /*The bilinear weights of the corners (0, 0), (1, 0), (1, 1) and (0, 1)
+       at (i, j) are (xblk_sz - i)*(yblk_sz - j), i*(yblk_sz - j), i*j and
+       (xblk_sz - i)*j.*/
+    w[0] = (yblk_sz - j) << log_xblk_sz;
+    dwdi[0] = j - yblk_sz;
+    w[1] = 0;
+    dwdi[1] = yblk_sz - j;
+    w[2] = 0;
+    dwdi[2] = j;
+    w[3] = j << log_xblk_sz;
+    dwdi[3] = -j;
+    od_mc_blend16_row_sse2((int16_t *)(dst + j*dystride), src, j*xblk_sz,
+     xblk_sz, w, dwdi, round, shift);
+  }
+#if defined(OD_CHECKASM)
+  od_mc_blend_full16_check(dst, dystride, src, log_xblk_sz, log_yblk_sz);
+#endif
+}
+
+/*Perform normal blending on 16-bit pixels with bilinear weights modified
+   for unsplit edges.*/
+void od_mc_blend_full_split16_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz) {
+  int w[4];
+  int dwdi[4];
+  int s0[4];
+  int dsdi[4];
+  int dsdj[4];
+  int ddsdidj[4];
+  int xblk_sz;
+  int yblk_sz;
+  int log_blk_sz2p1;
+  __m128i round;
+  __m128i shift;
+  int j;
+  int k;
+  /*od_mc_setup_s_split() only keeps the weights between 0 and
+     1 << log_blk_sz2p1 for square blocks; otherwise they can overflow 16
+     bits.*/
+  if (log_xblk_sz < 2 || log_xblk_sz != log_yblk_sz) {
+    od_mc_blend_full_split16_c(dst, dystride, src, oc, s,
+     log_xblk_sz, log_yblk_sz);
+    return;
+  }
+  xblk_sz = 1 << log_xblk_sz;
+  yblk_sz = 1 << log_yblk_sz;
+  log_blk_sz2p1 = log_xblk_sz + log_yblk_sz + 1;
+  round = _mm_set1_epi32(1 << (log_blk_sz2p1 - 1));
+  shift = _mm_cvtsi32_si128(log_blk_sz2p1);
+  od_mc_setup_s_split(s0, dsdi, dsdj, ddsdidj,
+   oc, s, log_xblk_sz, log_yblk_sz);
+  for (j = 0; j < yblk_sz; j++) {
+    /*The C version blends the differences from src[0]; folding src[0] back
+       in gives it the weight left over from the other 3 images.*/
+    w[0] = 1 << log_blk_sz2p1;
+    dwdi[0] = 0;
+    for (k = 1; k < 4; k++) {
+      w[k] = s0[k];
+      dwdi[k] = dsdi[k];
+      w[0] -= w[k];
+      dwdi[0] -= dwdi[k];
+    }
+    od_mc_blend16_row_sse2((int16_t *)(dst + j*dystride), src, j*xblk_sz,
+     xblk_sz, w, dwdi, round, shift);
+    for (k = 0; k < 4; k++) {
+      s0[k] += dsdj[k];
+      dsdi[k] += ddsdidj[k];
+    }
+  }
+#if defined(OD_CHECKASM)
+  od_mc_blend_full_split16_check(dst, dystride, src, oc, s,
+   log_xblk_sz, log_yblk_sz);
+#endif
+}
+
+#if defined(OD_CHECKASM)
+void od_mc_blend_multi8_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _log_xblk_sz, int _log_yblk_sz) {
+  unsigned char dst[OD_MVBSIZE_MAX*OD_MVBSIZE_MAX];
+  int xblk_sz;
+  int yblk_sz;
+  int failed;
+  int i;
+  int j;
+  xblk_sz = 1 << _log_xblk_sz;
+  yblk_sz = 1 << _log_yblk_sz;
+  failed = 0;
+  od_mc_blend_multi8_c(dst, xblk_sz, _src, _log_xblk_sz, _log_yblk_sz);
+  for (j = 0; j < yblk_sz; j++) {
+    for (i = 0; i < xblk_sz; i++) {
+      if ((_dst + j*_dystride)[i] != dst[i + (j << _log_xblk_sz)]) {
+        fprintf(stderr, "ASM mismatch: 0x%02X!=0x%02X @ (%2i,%2i)\n",
+         (_dst + j*_dystride)[i], dst[i + (j << _log_xblk_sz)], i, j);
+        failed = 1;
+      }
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_mc_blend_multi8 %ix%i check failed.\n",
+     (1 << _log_xblk_sz), (1 << _log_yblk_sz));
+  }
+  OD_ASSERT(!failed);
+}
+
+void od_mc_blend_multi_split8_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _c, int _s,
+ int _log_xblk_sz, int _log_yblk_sz) {
+  unsigned char dst[OD_MVBSIZE_MAX*OD_MVBSIZE_MAX];
+  int xblk_sz;
+  int yblk_sz;
+  int failed;
+  int i;
+  int j;
+  xblk_sz = 1 << _log_xblk_sz;
+  yblk_sz = 1 << _log_yblk_sz;
+  failed = 0;
+  od_mc_blend_multi_split8_c(dst, xblk_sz, _src, _c, _s,
+   _log_xblk_sz, _log_yblk_sz);
+  for (j = 0; j < yblk_sz; j++) {
+    for (i = 0; i < xblk_sz; i++) {
+      if ((_dst + j*_dystride)[i] != dst[i + (j << _log_xblk_sz)]) {
+        fprintf(stderr, "ASM mismatch: 0x%02X!=0x%02X @ (%2i,%2i)\n",
+         (_dst + j*_dystride)[i], dst[i + (j << _log_xblk_sz)], i, j);
+        failed = 1;
+      }
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_mc_blend_multi_split8 %ix%i check failed.\n",
+     (1 << _log_xblk_sz), (1 << _log_yblk_sz));
+  }
+  OD_ASSERT(!failed);
+}
+#endif
+
+/*Loads n (2, 4, 8 or 16) 8-bit pixels into the low bytes of a vector.*/
+OD_SIMD_INLINE __m128i od_mc_load_u8(const unsigned char *p, int n) {
+  int32_t v32;
+  uint16_t v16;
+  if (n == 16) return _mm_loadu_si128((const __m128i *)p);
+  if (n == 8) return _mm_loadl_epi64((const __m128i *)p);
+  if (n == 4) {
+    memcpy(&v32, p, sizeof(v32));
+    return _mm_cvtsi32_si128(v32);
+  }
+  memcpy(&v16, p, sizeof(v16));
+  return _mm_cvtsi32_si128(v16);
+}
+
+/*Stores the low n (2, 4 or 8) bytes of a vector.*/
+OD_SIMD_INLINE void od_mc_store_u8(unsigned char *p, __m128i v, int n) {
+  int32_t v32;
+  if (n == 8) {
+    _mm_storel_epi64((__m128i *)p, v);
+  }
+  else {
+    v32 = _mm_cvtsi128_si32(v);
+    memcpy(p, &v32, n);
+  }
+}
+
+/*Loads n (1, 2 or 4) 32-bit values into the low lanes of a vector.*/
+OD_SIMD_INLINE __m128i od_mc_load_s32(const int32_t *p, int n) {
+  if (n == 4) return _mm_loadu_si128((const __m128i *)p);
+  if (n == 2) return _mm_loadl_epi64((const __m128i *)p);
+  return _mm_cvtsi32_si128(p[0]);
+}
+
+/*Horizontally low-pass filters one row of n pixels from each of p and q,
+   returning p[2*i - 1] + 2*p[2*i] + p[2*i + 1] plus the same for q in each
+   16-bit lane i, with 4*p[0] + 4*q[0] in lane 0.*/
+OD_SIMD_INLINE __m128i od_mc_blend_multi8_lh(const unsigned char *p,
+ const unsigned char *q, int n) {
+  __m128i mask;
+  __m128i vp;
+  __m128i vq;
+  __m128i e;
+  __m128i o;
+  __m128i lh;
+  mask = _mm_set1_epi16(0xFF);
+  vp = od_mc_load_u8(p, n);
+  vq = od_mc_load_u8(q, n);
+  e = _mm_add_epi16(_mm_and_si128(vp, mask), _mm_and_si128(vq, mask));
+  o = _mm_add_epi16(_mm_srli_epi16(vp, 8), _mm_srli_epi16(vq, 8));
+  lh = _mm_add_epi16(_mm_add_epi16(e, e),
+   _mm_add_epi16(o, _mm_slli_si128(o, 2)));
+  return _mm_insert_epi16(lh, _mm_extract_epi16(e, 0) << 2, 0);
+}
+
+/*Perform multiresolution blending of square 4x4, 8x8 or 16x16 blocks.
+  The low-pass and high-pass bands are computed from the sums of the images
+   in src and drc, which is exactly equivalent to doubling src when drc is
+   the same as src.
+  split selects the handful of special cases in od_mc_blend_multi_split8_c()
+   that are not symmetric, so that the output stays bit-exact.
+
+  Every high-pass term of od_mc_blend_multi8_c() is the difference between
+   some weighted sum of dst_ll and the same weighted sum of src_ll, so it is
+   computed here as a bilinear upsampling of
+   hp = dst_ll - (src_ll << (log_blk_sz2 - 2)), where the last row and column
+   of hp are extrapolated as 2*hp[n - 1] - hp[n - 2].*/
+OD_SIMD_INLINE void od_mc_blend_multi8_nxn(unsigned char *dst, int dystride,
+ const unsigned char *src[4], const unsigned char *drc[4], int log_blk_sz,
+ int split) {
+  __m128i ll[4][8];
+  int32_t hp[4][9][9];
+  unsigned char buf[8];
+  const unsigned char *p;
+  const unsigned char *q;
+  __m128i idx;
+  __m128i nidx;
+  __m128i lh0;
+  __m128i lh1;
+  __m128i lh2;
+  __m128i zero;
+  __m128i round;
+  __m128i shift;
+  __m128i pshift;
+  __m128i cur;
+  __m128i nxt;
+  __m128i curd;
+  __m128i nxtd;
+  __m128i u0;
+  __m128i u1;
+  __m128i u2;
+  __m128i u3;
+  __m128i hi;
+  __m128i lo;
+  int blk_sz;
+  int blk_sz_2;
+  int blk_sz_4;
+  int log_blk_sz2;
+  int side;
+  int c0;
+  int x0;
+  int i;
+  int j;
+  int k;
+  blk_sz = 1 << log_blk_sz;
+  blk_sz_2 = blk_sz >> 1;
+  blk_sz_4 = blk_sz >> 2;
+  log_blk_sz2 = log_blk_sz << 1;
+  /*Compute the low-pass band for each src block.*/
+  for (k = 0; k < 4; k++) {
+    p = src[k];
+    q = drc[k];
+    ll[k][0] = _mm_srai_epi16(_mm_add_epi16(
+     od_mc_blend_multi8_lh(p, q, blk_sz), _mm_set1_epi16(4)), 3);
+    lh2 = od_mc_blend_multi8_lh(p + blk_sz, q + blk_sz, blk_sz);
+    for (j = 1; j < blk_sz_2; j++) {
+      p += blk_sz << 1;
+      q += blk_sz << 1;
+      lh0 = lh2;
+      lh1 = od_mc_blend_multi8_lh(p, q, blk_sz);
+      lh2 = od_mc_blend_multi8_lh(p + blk_sz, q + blk_sz, blk_sz);
+      /*od_mc_blend_multi_split8_c() leaves q out of the first column of the
+         odd rows.*/
+      if (split) lh2 = _mm_insert_epi16(lh2, p[blk_sz] << 2, 0);
+      ll[k][j] = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(lh0, lh2),
+       _mm_add_epi16(_mm_add_epi16(lh1, lh1), _mm_set1_epi16(16))), 5);
+    }
+  }
+  /*Blend the low-pass bands and compute the high-pass weights.*/
+  idx = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  nidx = _mm_sub_epi16(_mm_set1_epi16(blk_sz_2), idx);
+  zero = _mm_setzero_si128();
+  shift = _mm_cvtsi32_si128(log_blk_sz2 - 2);
+  for (j = 0; j < blk_sz_2; j++) {
+    __m128i a;
+    __m128i b;
+    __m128i dll;
+    a = _mm_add_epi16(_mm_mullo_epi16(ll[0][j], nidx),
+     _mm_mullo_epi16(ll[1][j], idx));
+    b = _mm_add_epi16(_mm_mullo_epi16(ll[3][j], nidx),
+     _mm_mullo_epi16(ll[2][j], idx));
+    dll = _mm_add_epi16(_mm_mullo_epi16(a, _mm_set1_epi16(blk_sz_2 - j)),
+     _mm_mullo_epi16(b, _mm_set1_epi16(j)));
+    for (k = 0; k < 4; k++) {
+      __m128i h;
+      h = _mm_sub_epi16(dll, _mm_sll_epi16(ll[k][j], shift));
+      _mm_storeu_si128((__m128i *)hp[k][j],
+       _mm_srai_epi32(_mm_unpacklo_epi16(h, h), 16));
+      _mm_storeu_si128((__m128i *)(hp[k][j] + 4),
+       _mm_srai_epi32(_mm_unpackhi_epi16(h, h), 16));
+    }
+  }
+  for (k = 0; k < 4; k++) {
+    for (j = 0; j < blk_sz_2; j++) {
+      hp[k][j][blk_sz_2] = 2*hp[k][j][blk_sz_2 - 1] - hp[k][j][blk_sz_2 - 2];
+    }
+    for (i = 0; i <= blk_sz_2; i++) {
+      hp[k][blk_sz_2][i] = 2*hp[k][blk_sz_2 - 1][i] - hp[k][blk_sz_2 - 2][i];
+    }
+  }
+  /*Perform the high-pass filtering for each quadrant.*/
+  round = _mm_set1_epi32(1 << (log_blk_sz2 - 1));
+  shift = _mm_cvtsi32_si128(log_blk_sz2);
+  pshift = _mm_cvtsi32_si128(log_blk_sz2 - 1);
+  for (j = 0; j < blk_sz_2; j++) {
+    for (side = 0; side < 2; side++) {
+      k = j < blk_sz_4 ? side : 3 - side;
+      c0 = side*blk_sz_4;
+      x0 = c0 << 1;
+      cur = od_mc_load_s32(hp[k][j] + c0, blk_sz_4);
+      nxt = od_mc_load_s32(hp[k][j] + c0 + 1, blk_sz_4);
+      curd = od_mc_load_s32(hp[k][j + 1] + c0, blk_sz_4);
+      nxtd = od_mc_load_s32(hp[k][j + 1] + c0 + 1, blk_sz_4);
+      u0 = _mm_slli_epi32(cur, 2);
+      u1 = _mm_slli_epi32(_mm_add_epi32(cur, nxt), 1);
+      u2 = _mm_slli_epi32(_mm_add_epi32(cur, curd), 1);
+      u3 = _mm_add_epi32(_mm_add_epi32(cur, nxt), _mm_add_epi32(curd, nxtd));
+      for (i = 0; i < 2; i++) {
+        p = src[k] + ((2*j + i) << log_blk_sz) + x0;
+        q = drc[k] + ((2*j + i) << log_blk_sz) + x0;
+        /*od_mc_blend_multi_split8_c() swaps the last two pixels of q in the
+           even rows of the lower-right quadrant, except the last one.*/
+        if (split && side && i == 0 && j >= blk_sz_4 && j < blk_sz_2 - 1) {
+          memcpy(buf, q, blk_sz_2);
+          buf[blk_sz_2 - 2] = q[blk_sz_2 - 1];
+          buf[blk_sz_2 - 1] = q[blk_sz_2 - 2];
+          q = buf;
+        }
+        lo = _mm_add_epi16(_mm_unpacklo_epi8(od_mc_load_u8(p, blk_sz_2), zero),
+         _mm_unpacklo_epi8(od_mc_load_u8(q, blk_sz_2), zero));
+        hi = _mm_sll_epi32(_mm_unpackhi_epi16(lo, zero), pshift);
+        lo = _mm_sll_epi32(_mm_unpacklo_epi16(lo, zero), pshift);
+        lo = _mm_add_epi32(_mm_add_epi32(lo, round),
+         _mm_unpacklo_epi32(i ? u2 : u0, i ? u3 : u1));
+        hi = _mm_add_epi32(_mm_add_epi32(hi, round),
+         _mm_unpackhi_epi32(i ? u2 : u0, i ? u3 : u1));
+        lo = _mm_sra_epi32(lo, shift);
+        hi = _mm_sra_epi32(hi, shift);
+        od_mc_store_u8(dst + (2*j + i)*dystride + x0,
+         _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero), blk_sz_2);
+      }
+    }
+  }
+}
+
+/*Perform multiresolution bilinear blending.*/
+void od_mc_blend_multi8_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz) {
+  /*od_mc_blend_multi8_c() only supports blocks up to 16x16, and only
+     blends the low-pass bands correctly for square blocks.*/
+  if (log_xblk_sz != log_yblk_sz || log_xblk_sz < 2 || log_xblk_sz > 4) {
+    od_mc_blend_multi8_c(dst, dystride, src, log_xblk_sz, log_yblk_sz);
+    return;
+  }
+  od_mc_blend_multi8_nxn(dst, dystride, src, src, log_xblk_sz, 0);
+#if defined(OD_CHECKASM)
+  od_mc_blend_multi8_check(dst, dystride, src, log_xblk_sz, log_yblk_sz);
+#endif
+}
+
+/*Perform multiresolution bilinear blending with bilinear weights modified
+   for unsplit edges.*/
+void od_mc_blend_multi_split8_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz) {
+  const unsigned char *drc[4];
+  if (log_xblk_sz != log_yblk_sz || log_xblk_sz < 2 || log_xblk_sz > 4) {
+    od_mc_blend_multi_split8_c(dst, dystride, src, oc, s,
+     log_xblk_sz, log_yblk_sz);
+    return;
+  }
+  od_mc_setup_split_ptrs(drc, src, oc, s);
+  od_mc_blend_multi8_nxn(dst, dystride, src, drc, log_xblk_sz, 1);
+#if defined(OD_CHECKASM)
+  od_mc_blend_multi_split8_check(dst, dystride, src, oc, s,
+   log_xblk_sz, log_yblk_sz);
+#endif
+}
+
 #endif
 
 #if defined(OD_GCC_INLINE_ASSEMBLY)
@@ -2090,23 +2630,6 @@ static void od_mc_blend_full_split8_32x32(unsigned char *_dst,int _dystride,
 typedef void (*od_mc_blend_full_split8_fixed_func)(unsigned char *_dst,
  int _dystride,const unsigned char *_src[8]);
 
-/*Sets up a second set of image pointers based on the given split state to
-   properly shift weight from one image to another.*/
-static void od_mc_setup_split_ptrs(const unsigned char *_drc[4],
- const unsigned char *_src[4],int _c,int _s){
-  int j;
-  int k;
-  _drc[_c]=_src[_c];
-  j=(_c+(_s&1))&3;
-  k=(_c+1)&3;
-  _drc[k]=_src[j];
-  j=(_c+(_s&2)+((_s&2)>>1))&3;
-  k=(_c+3)&3;
-  _drc[k]=_src[j];
-  k=_c^2;
-  _drc[k]=_src[k];
-}
-
 /*Perform normal bilinear blending.*/
 void od_mc_blend_full_split8_sse2(unsigned char *_dst,int _dystride,
  const unsigned char *_src[4],int _c,int _s,int _log_xblk_sz,int _log_yblk_sz){
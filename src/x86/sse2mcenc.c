@@ -26,7 +26,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #include "config.h"
 #endif
 
-#include <stdio.h>
 #include "x86enc.h"
 #include "x86int.h"
 
@@ -119,14 +118,7 @@ int32_t od_mc_compute_satd8_4x4_sse2(const unsigned char *src, int systride,
   /*Subtract the offset (8) and round.*/
   satd = (satd + 1 - 8) >> 1;
 #if defined(OD_CHECKASM)
-  {
-    int32_t c_satd;
-    c_satd = od_mc_compute_satd8_4x4_c(src, systride, ref, rystride);
-    if (satd != c_satd) {
-      fprintf(stderr, "od_mc_compute_satd %ix%i check failed: %i!=%i\n",
-       4, 4, satd, c_satd);
-    }
-  }
+  od_mc_compute_satd8_check(src, systride, ref, rystride, 2, satd);
 #endif
   return satd;
 }
@@ -278,14 +270,7 @@ OD_SIMD_INLINE int32_t od_mc_compute_satd8_8x8_part(const unsigned char *src, in
   /*Subtract the offset (32) and round.*/
   satd = (satd + 2 - 32) >> 2;
 #if defined(OD_CHECKASM)
-  {
-    int32_t c_satd;
-    c_satd = od_mc_compute_satd8_8x8_c(src, systride, ref, rystride);
-    if (satd != c_satd) {
-      fprintf(stderr, "od_mc_compute_satd %ix%i check failed: %i!=%i\n",
-      8, 8, satd, c_satd);
-    }
-  }
+  od_mc_compute_satd8_check(src, systride, ref, rystride, 3, satd);
 #endif
   return satd;
 }
@@ -34,10 +34,17 @@ OD_SIMD_INLINE __m128i od_mullo_epi32_sse41(__m128i a, int b) {
 }
 
 #define OD_MULLO_EPI32 od_mullo_epi32_sse41
+#define OD_FLOOR_PD _mm_floor_pd
 
 #define od_bin_fdct4x4_sse2 od_bin_fdct4x4_sse41
 #define od_bin_idct4x4_sse2 od_bin_idct4x4_sse41
 #define od_bin_fdct8x8_sse2 od_bin_fdct8x8_sse41
 #define od_bin_idct8x8_sse2 od_bin_idct8x8_sse41
+#define od_bin_fdct16x16_sse2 od_bin_fdct16x16_sse41
+#define od_bin_idct16x16_sse2 od_bin_idct16x16_sse41
+#define od_bin_fdct32x32_sse2 od_bin_fdct32x32_sse41
+#define od_bin_idct32x32_sse2 od_bin_idct32x32_sse41
+#define od_bin_fdct64x64_sse2 od_bin_fdct64x64_sse41
+#define od_bin_idct64x64_sse2 od_bin_idct64x64_sse41
 
 #include "sse2dct.c"
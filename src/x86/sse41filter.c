@@ -0,0 +1,378 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#if defined(HAVE_CONFIG_H)
+# include "config.h"
+#endif
+
+#include "x86int.h"
+
+#if defined(OD_X86ASM)
+#include <smmintrin.h>
+#include "../filter.h"
+
+#if defined(OD_SSE41_INTRINSICS)
+
+/*Computes (a*p + 32) >> 6 in each lane.*/
+OD_SIMD_INLINE __m128i od_mul_round6_sse41(__m128i a, int p) {
+  return _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(a, _mm_set1_epi32(p)),
+   _mm_set1_epi32(32)), 6);
+}
+
+/*Computes (t << 6)/p in each lane, rounding toward zero like the C integer
+   division.
+  The quotient of a 32-bit integer by p <= 128 is always either exact in
+   double precision or at least 1/p away from the next integer, so truncating
+   it gives the same result.*/
+OD_SIMD_INLINE __m128i od_div_scale6_sse41(__m128i t, int p) {
+  __m128d d;
+  __m128i lo;
+  __m128i hi;
+  d = _mm_set1_pd(p);
+  t = _mm_slli_epi32(t, 6);
+  lo = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(t), d));
+  hi = _mm_cvttpd_epi32(_mm_div_pd(
+   _mm_cvtepi32_pd(_mm_unpackhi_epi64(t, t)), d));
+  return _mm_unpacklo_epi64(lo, hi);
+}
+
+/*The +1/-1 butterflies at the start of both the pre and post filters.*/
+OD_SIMD_INLINE void od_filter_load_butterflies_sse41(__m128i *t,
+ const od_coeff *c, int stride, int n) {
+  int i;
+  for (i = 0; i < n >> 1; i++) {
+    __m128i a;
+    __m128i b;
+    a = _mm_loadu_si128((const __m128i *)(c + i*stride));
+    b = _mm_loadu_si128((const __m128i *)(c + (n - 1 - i)*stride));
+    t[n - 1 - i] = _mm_sub_epi32(a, b);
+    t[i] = _mm_sub_epi32(a, _mm_srai_epi32(t[n - 1 - i], 1));
+  }
+}
+
+/*The +1/-1 butterflies at the end of both the pre and post filters.*/
+OD_SIMD_INLINE void od_filter_store_butterflies_sse41(od_coeff *c,
+ int stride, __m128i *t, int n) {
+  int i;
+  for (i = 0; i < n >> 1; i++) {
+    t[i] = _mm_add_epi32(t[i], _mm_srai_epi32(t[n - 1 - i], 1));
+    _mm_storeu_si128((__m128i *)(c + i*stride), t[i]);
+    _mm_storeu_si128((__m128i *)(c + (n - 1 - i)*stride),
+     _mm_sub_epi32(t[i], t[n - 1 - i]));
+  }
+}
+
+/*Applies the 4 << f point pre filter to 4 adjacent columns.
+  p holds the filter parameters in the same order as OD_FILTER_PARAMS*: the
+   n/2 scale factors, then the n/2 - 1 p and n/2 - 1 u lifting steps of the
+   type-3 rotations used by all of the filters.*/
+OD_SIMD_INLINE void od_pre_filter_cols_x4_sse41(od_coeff *c, int stride,
+ int f, const int *p) {
+  __m128i t[4 << (OD_NBSIZES - 1)];
+  int n;
+  int h;
+  int i;
+  n = 4 << f;
+  h = n >> 1;
+  od_filter_load_butterflies_sse41(t, c, stride, n);
+  /*Scaling factors: the biorthogonal part.
+    Positive values are incremented afterwards so that the scaling is
+     trivially invertible.*/
+  for (i = 0; i < h; i++) {
+    if (p[i] != 64) {
+      __m128i x;
+      x = _mm_srai_epi32(_mm_mullo_epi32(t[h + i], _mm_set1_epi32(p[i])), 6);
+      t[h + i] = _mm_add_epi32(x,
+       _mm_srli_epi32(_mm_sub_epi32(_mm_setzero_si128(), x), 31));
+    }
+  }
+  /*Rotations.*/
+  for (i = h - 2; i >= 0; i--) {
+    t[h + i + 1] = _mm_add_epi32(t[h + i + 1],
+     od_mul_round6_sse41(t[h + i], p[h + i]));
+    t[h + i] = _mm_add_epi32(t[h + i],
+     od_mul_round6_sse41(t[h + i + 1], p[2*h - 1 + i]));
+  }
+  od_filter_store_butterflies_sse41(c, stride, t, n);
+}
+
+/*Applies the 4 << f point post filter to 4 adjacent columns.*/
+OD_SIMD_INLINE void od_post_filter_cols_x4_sse41(od_coeff *c, int stride,
+ int f, const int *p) {
+  __m128i t[4 << (OD_NBSIZES - 1)];
+  int n;
+  int h;
+  int i;
+  n = 4 << f;
+  h = n >> 1;
+  od_filter_load_butterflies_sse41(t, c, stride, n);
+  for (i = 0; i < h - 1; i++) {
+    t[h + i] = _mm_sub_epi32(t[h + i],
+     od_mul_round6_sse41(t[h + i + 1], p[2*h - 1 + i]));
+    t[h + i + 1] = _mm_sub_epi32(t[h + i + 1],
+     od_mul_round6_sse41(t[h + i], p[h + i]));
+  }
+  for (i = 0; i < h; i++) {
+    if (p[i] != 64) t[h + i] = od_div_scale6_sse41(t[h + i], p[i]);
+  }
+  od_filter_store_butterflies_sse41(c, stride, t, n);
+}
+
+OD_SIMD_INLINE void od_filter_cols_sse41(od_coeff *c, int stride, int n,
+ int f, const int *p, int inv) {
+  int j;
+#if defined(OD_CHECKASM)
+  od_coeff ref[(4 << (OD_NBSIZES - 1))*OD_BSIZE_MAX];
+  od_filter_cols_save(ref, c, stride, n, f);
+#endif
+  OD_ASSERT(!(n & 3));
+  for (j = 0; j < n; j += 4) {
+    if (inv) od_post_filter_cols_x4_sse41(c + j, stride, f, p);
+    else od_pre_filter_cols_x4_sse41(c + j, stride, f, p);
+  }
+#if defined(OD_CHECKASM)
+  od_filter_cols_check(c, stride, ref, n, f, inv);
+#endif
+}
+
+void od_pre_filter_cols4_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 0, OD_FILTER_PARAMS4, 0);
+}
+
+void od_post_filter_cols4_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 0, OD_FILTER_PARAMS4, 1);
+}
+
+void od_pre_filter_cols8_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 1, OD_FILTER_PARAMS8, 0);
+}
+
+void od_post_filter_cols8_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 1, OD_FILTER_PARAMS8, 1);
+}
+
+void od_pre_filter_cols16_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 2, OD_FILTER_PARAMS16, 0);
+}
+
+void od_post_filter_cols16_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 2, OD_FILTER_PARAMS16, 1);
+}
+
+void od_pre_filter_cols32_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 3, OD_FILTER_PARAMS32, 0);
+}
+
+void od_post_filter_cols32_sse41(od_coeff *c, int stride, int n) {
+  od_filter_cols_sse41(c, stride, n, 3, OD_FILTER_PARAMS32, 1);
+}
+
+/*Computes (x*m) >> 31 in each 32-bit lane, with the results of lanes 0 and 1
+   added into lane 0 and those of lanes 2 and 3 into lane 2.*/
+OD_SIMD_INLINE __m128i od_divu31_sum_sse41(__m128i x, __m128i m) {
+  __m128i even;
+  __m128i odd;
+  even = _mm_srli_epi64(_mm_mul_epu32(x, m), 31);
+  odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32),
+   _mm_srli_epi64(m, 32)), 31);
+  return _mm_add_epi64(even, odd);
+}
+
+/*Squares the 8 partial sums in p and divides each one by its line length
+   using the reciprocals in m.*/
+OD_SIMD_INLINE __m128i od_dir_cost8_sse41(__m128i p, const uint32_t *m) {
+  __m128i lo;
+  __m128i hi;
+  lo = _mm_unpacklo_epi16(p, _mm_setzero_si128());
+  hi = _mm_unpackhi_epi16(p, _mm_setzero_si128());
+  return _mm_add_epi64(
+   od_divu31_sum_sse41(_mm_madd_epi16(lo, lo),
+   _mm_loadu_si128((const __m128i *)m)),
+   od_divu31_sum_sse41(_mm_madd_epi16(hi, hi),
+   _mm_loadu_si128((const __m128i *)(m + 4))));
+}
+
+/*Computes the costs of directions 4 through 7 for the 8 rows in l.
+  The partial sums of each direction are kept in two vectors a and b, using
+   the layout described for OD_DIR_DIVU31.*/
+OD_SIMD_INLINE __m128i od_dir_costs4_sse41(const __m128i *l) {
+  __m128i p4a;
+  __m128i p4b;
+  __m128i p5a;
+  __m128i p5b;
+  __m128i p6;
+  __m128i p7a;
+  __m128i p7b;
+  __m128i r;
+  __m128i c4;
+  __m128i c5;
+  __m128i c6;
+  __m128i c7;
+  /*Direction 4: row i adds pixel j to partial sum 7 + i - j.*/
+  p4a = l[0];
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[1], 2));
+  p4b = _mm_slli_si128(l[1], 14);
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[2], 4));
+  p4b = _mm_add_epi16(p4b, _mm_slli_si128(l[2], 12));
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[3], 6));
+  p4b = _mm_add_epi16(p4b, _mm_slli_si128(l[3], 10));
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[4], 8));
+  p4b = _mm_add_epi16(p4b, _mm_slli_si128(l[4], 8));
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[5], 10));
+  p4b = _mm_add_epi16(p4b, _mm_slli_si128(l[5], 6));
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[6], 12));
+  p4b = _mm_add_epi16(p4b, _mm_slli_si128(l[6], 4));
+  p4a = _mm_add_epi16(p4a, _mm_srli_si128(l[7], 14));
+  p4b = _mm_add_epi16(p4b, _mm_slli_si128(l[7], 2));
+  /*Directions 5, 6 and 7 work on pairs of rows r: pixel j goes to partial
+     sum 3 - r + j, j and r + j, respectively.*/
+  r = _mm_add_epi16(l[0], l[1]);
+  p5a = _mm_slli_si128(r, 6);
+  p5b = _mm_srli_si128(r, 10);
+  p6 = r;
+  p7a = r;
+  r = _mm_add_epi16(l[2], l[3]);
+  p5a = _mm_add_epi16(p5a, _mm_slli_si128(r, 4));
+  p5b = _mm_add_epi16(p5b, _mm_srli_si128(r, 12));
+  p6 = _mm_add_epi16(p6, r);
+  p7a = _mm_add_epi16(p7a, _mm_slli_si128(r, 2));
+  p7b = _mm_srli_si128(r, 14);
+  r = _mm_add_epi16(l[4], l[5]);
+  p5a = _mm_add_epi16(p5a, _mm_slli_si128(r, 2));
+  p5b = _mm_add_epi16(p5b, _mm_srli_si128(r, 14));
+  p6 = _mm_add_epi16(p6, r);
+  p7a = _mm_add_epi16(p7a, _mm_slli_si128(r, 4));
+  p7b = _mm_add_epi16(p7b, _mm_srli_si128(r, 12));
+  r = _mm_add_epi16(l[6], l[7]);
+  p5a = _mm_add_epi16(p5a, r);
+  p6 = _mm_add_epi16(p6, r);
+  p7a = _mm_add_epi16(p7a, _mm_slli_si128(r, 6));
+  p7b = _mm_add_epi16(p7b, _mm_srli_si128(r, 10));
+  c4 = _mm_add_epi64(od_dir_cost8_sse41(p4a, OD_DIR_DIVU31[0]),
+   od_dir_cost8_sse41(p4b, OD_DIR_DIVU31[1]));
+  c5 = _mm_add_epi64(od_dir_cost8_sse41(p5a, OD_DIR_DIVU31[2]),
+   od_dir_cost8_sse41(p5b, OD_DIR_DIVU31[3]));
+  c7 = _mm_add_epi64(od_dir_cost8_sse41(p7a, OD_DIR_DIVU31[2]),
+   od_dir_cost8_sse41(p7b, OD_DIR_DIVU31[3]));
+  /*All 8 lines of direction 6 have length 8.*/
+  c6 = _mm_add_epi32(
+   _mm_srli_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(p6,
+   _mm_setzero_si128()), _mm_unpacklo_epi16(p6, _mm_setzero_si128())), 3),
+   _mm_srli_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(p6,
+   _mm_setzero_si128()), _mm_unpackhi_epi16(p6, _mm_setzero_si128())), 3));
+  return _mm_hadd_epi32(_mm_hadd_epi32(c4, c5), _mm_hadd_epi32(c6, c7));
+}
+
+/*Transposes the 8x8 block in the rows l, flipping it vertically first, so
+   that t[i][j] = l[7 - j][i].*/
+OD_SIMD_INLINE void od_dir_transpose_sse41(__m128i *t, const __m128i *l) {
+  __m128i a0;
+  __m128i a1;
+  __m128i a2;
+  __m128i a3;
+  __m128i a4;
+  __m128i a5;
+  __m128i a6;
+  __m128i a7;
+  __m128i b0;
+  __m128i b1;
+  __m128i b2;
+  __m128i b3;
+  __m128i b4;
+  __m128i b5;
+  __m128i b6;
+  __m128i b7;
+  a0 = _mm_unpacklo_epi16(l[7], l[6]);
+  a1 = _mm_unpacklo_epi16(l[5], l[4]);
+  a2 = _mm_unpacklo_epi16(l[3], l[2]);
+  a3 = _mm_unpacklo_epi16(l[1], l[0]);
+  a4 = _mm_unpackhi_epi16(l[7], l[6]);
+  a5 = _mm_unpackhi_epi16(l[5], l[4]);
+  a6 = _mm_unpackhi_epi16(l[3], l[2]);
+  a7 = _mm_unpackhi_epi16(l[1], l[0]);
+  b0 = _mm_unpacklo_epi32(a0, a1);
+  b1 = _mm_unpacklo_epi32(a2, a3);
+  b2 = _mm_unpackhi_epi32(a0, a1);
+  b3 = _mm_unpackhi_epi32(a2, a3);
+  b4 = _mm_unpacklo_epi32(a4, a5);
+  b5 = _mm_unpacklo_epi32(a6, a7);
+  b6 = _mm_unpackhi_epi32(a4, a5);
+  b7 = _mm_unpackhi_epi32(a6, a7);
+  t[0] = _mm_unpacklo_epi64(b0, b1);
+  t[1] = _mm_unpackhi_epi64(b0, b1);
+  t[2] = _mm_unpacklo_epi64(b2, b3);
+  t[3] = _mm_unpackhi_epi64(b2, b3);
+  t[4] = _mm_unpacklo_epi64(b4, b5);
+  t[5] = _mm_unpackhi_epi64(b4, b5);
+  t[6] = _mm_unpacklo_epi64(b6, b7);
+  t[7] = _mm_unpackhi_epi64(b6, b7);
+}
+
+/*Directions 0 through 3 of a block are directions 4 through 7 of its
+   flipped transpose, so both halves of the search share the same code.*/
+int od_dir_find8_sse41(const int16_t *img, int stride, int32_t *var) {
+  __m128i l[8];
+  __m128i t[8];
+  int32_t cost[8];
+  int best_cost;
+  int best_dir;
+  int i;
+  for (i = 0; i < 8; i++) {
+    l[i] = _mm_srai_epi16(_mm_loadu_si128((const __m128i *)&img[i*stride]),
+     OD_COEFF_SHIFT);
+  }
+  od_dir_transpose_sse41(t, l);
+  _mm_storeu_si128((__m128i *)&cost[0], od_dir_costs4_sse41(t));
+  _mm_storeu_si128((__m128i *)&cost[4], od_dir_costs4_sse41(l));
+  best_cost = 0;
+  best_dir = 0;
+  for (i = 0; i < 8; i++) {
+    if (cost[i] > best_cost) {
+      best_cost = cost[i];
+      best_dir = i;
+    }
+  }
+  *var = best_cost - cost[(best_dir + 4) & 7];
+#if defined(OD_CHECKASM)
+  od_dir_find8_check(img, stride, *var, best_dir);
+#endif
+  return best_dir;
+}
+
+const od_filter_cols_func OD_PRE_FILTER_COLS_SSE41[OD_NBSIZES] = {
+  od_pre_filter_cols4_sse41,
+  od_pre_filter_cols8_sse41,
+  od_pre_filter_cols16_sse41,
+  od_pre_filter_cols32_sse41
+};
+
+const od_filter_cols_func OD_POST_FILTER_COLS_SSE41[OD_NBSIZES] = {
+  od_post_filter_cols4_sse41,
+  od_post_filter_cols8_sse41,
+  od_post_filter_cols16_sse41,
+  od_post_filter_cols32_sse41
+};
+
+#endif
+#endif
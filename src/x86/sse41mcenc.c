@@ -0,0 +1,274 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "x86enc.h"
+#include "x86int.h"
+
+#if defined(OD_X86ASM)
+#include <smmintrin.h>
+
+#if defined(OD_SSE41_INTRINSICS)
+
+/*Accumulates the absolute differences of 8 16-bit pixels into 4 32-bit
+   lanes.
+  max - min always fits in an unsigned 16-bit value, even when the signed
+   difference would not.*/
+OD_SIMD_INLINE __m128i od_mc_sad16_accum_sse41(__m128i sum,
+ __m128i a, __m128i b) {
+  __m128i d;
+  d = _mm_sub_epi16(_mm_max_epi16(a, b), _mm_min_epi16(a, b));
+  sum = _mm_add_epi32(sum, _mm_cvtepu16_epi32(d));
+  return _mm_add_epi32(sum, _mm_unpackhi_epi16(d, _mm_setzero_si128()));
+}
+
+OD_SIMD_INLINE int32_t od_mc_hsum_epi32_sse41(__m128i sum) {
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+int32_t od_mc_compute_sad16_4x4_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  __m128i sum;
+  int32_t sad;
+  int i;
+  sum = _mm_setzero_si128();
+  for (i = 0; i < 4; i++) {
+    sum = od_mc_sad16_accum_sse41(sum,
+     _mm_loadl_epi64((const __m128i *)src),
+     _mm_loadl_epi64((const __m128i *)ref));
+    src += systride;
+    ref += dystride;
+  }
+  sad = (od_mc_hsum_epi32_sse41(sum) + (1 << OD_COEFF_SHIFT >> 1))
+   >> OD_COEFF_SHIFT;
+#if defined(OD_CHECKASM)
+  od_mc_compute_sad16_check(src - 4*systride, systride, ref - 4*dystride,
+   dystride, 4, 4, sad);
+#endif
+  return sad;
+}
+
+OD_SIMD_INLINE int32_t od_mc_compute_sad16_nxn_sse41(int ln,
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int dystride) {
+  __m128i sum;
+  int32_t sad;
+  int n;
+  int i;
+  int j;
+  n = 1 << ln;
+  sum = _mm_setzero_si128();
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < n; j += 8) {
+      sum = od_mc_sad16_accum_sse41(sum,
+       _mm_loadu_si128((const __m128i *)(src + 2*j)),
+       _mm_loadu_si128((const __m128i *)(ref + 2*j)));
+    }
+    src += systride;
+    ref += dystride;
+  }
+  sad = (od_mc_hsum_epi32_sse41(sum) + (1 << OD_COEFF_SHIFT >> 1))
+   >> OD_COEFF_SHIFT;
+#if defined(OD_CHECKASM)
+  od_mc_compute_sad16_check(src - n*systride, systride, ref - n*dystride,
+   dystride, n, n, sad);
+#endif
+  return sad;
+}
+
+int32_t od_mc_compute_sad16_8x8_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_sse41(3, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad16_16x16_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_sse41(4, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad16_32x32_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_sse41(5, src, systride, ref, dystride);
+}
+
+int32_t od_mc_compute_sad16_64x64_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride) {
+  return od_mc_compute_sad16_nxn_sse41(6, src, systride, ref, dystride);
+}
+
+/*Loads 4 16-bit pixels from src and ref and returns their difference as
+   32-bit values, since the Hadamard transform of 12-bit input overflows
+   16 bits.*/
+OD_SIMD_INLINE __m128i od_mc_load_diff16_x4_sse41(const unsigned char *src,
+ const unsigned char *ref) {
+  return _mm_sub_epi32(
+   _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)src)),
+   _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)ref)));
+}
+
+OD_SIMD_INLINE void od_mc_butterfly_epi32(__m128i *t0, __m128i *t1) {
+  __m128i a;
+  a = *t0;
+  *t0 = _mm_add_epi32(a, *t1);
+  *t1 = _mm_sub_epi32(a, *t1);
+}
+
+/*Applies a 4-point Hadamard transform to the lanes of each of t0 and t1.
+  The outputs are permuted, which does not matter for the SATD.*/
+OD_SIMD_INLINE void od_mc_hadamard4_lanes_x2_sse41(__m128i *t0, __m128i *t1) {
+  __m128i a;
+  __m128i b;
+  a = _mm_hadd_epi32(*t0, *t1);
+  b = _mm_hsub_epi32(*t0, *t1);
+  *t0 = _mm_hadd_epi32(a, b);
+  *t1 = _mm_hsub_epi32(a, b);
+}
+
+OD_SIMD_INLINE __m128i od_mc_abs_sum_epi32_sse41(__m128i sum, __m128i t) {
+  return _mm_add_epi32(sum, _mm_abs_epi32(t));
+}
+
+int32_t od_mc_compute_satd16_4x4_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  __m128i t[4];
+  __m128i sum;
+  int32_t satd;
+  int i;
+  for (i = 0; i < 4; i++) {
+    t[i] = od_mc_load_diff16_x4_sse41(src + i*systride, ref + i*rystride);
+  }
+  /*Vertical transform.*/
+  od_mc_butterfly_epi32(&t[0], &t[1]);
+  od_mc_butterfly_epi32(&t[2], &t[3]);
+  od_mc_butterfly_epi32(&t[0], &t[2]);
+  od_mc_butterfly_epi32(&t[1], &t[3]);
+  /*Horizontal transform.*/
+  od_mc_hadamard4_lanes_x2_sse41(&t[0], &t[1]);
+  od_mc_hadamard4_lanes_x2_sse41(&t[2], &t[3]);
+  sum = _mm_abs_epi32(t[0]);
+  for (i = 1; i < 4; i++) sum = od_mc_abs_sum_epi32_sse41(sum, t[i]);
+  satd = (od_mc_hsum_epi32_sse41(sum) + (1 << (2 + OD_COEFF_SHIFT) >> 1))
+   >> (2 + OD_COEFF_SHIFT);
+#if defined(OD_CHECKASM)
+  od_mc_compute_satd16_check(src, systride, ref, rystride, 2, satd);
+#endif
+  return satd;
+}
+
+/*Computes the SATD of one 8x8 block.
+  Each row is kept as two vectors of 4 32-bit lanes, so the vertical
+   transform is done with whole-vector butterflies, and the horizontal
+   transform with one butterfly between the two halves followed by in-lane
+   horizontal adds and subtracts, without any transpose.*/
+OD_SIMD_INLINE int32_t od_mc_compute_satd16_8x8_part_sse41(
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride) {
+  __m128i l[8];
+  __m128i h[8];
+  __m128i sum;
+  int i;
+  for (i = 0; i < 8; i++) {
+    l[i] = od_mc_load_diff16_x4_sse41(src, ref);
+    h[i] = od_mc_load_diff16_x4_sse41(src + 8, ref + 8);
+    src += systride;
+    ref += rystride;
+  }
+  /*Vertical transform.*/
+  for (i = 0; i < 8; i += 2) {
+    od_mc_butterfly_epi32(&l[i], &l[i + 1]);
+    od_mc_butterfly_epi32(&h[i], &h[i + 1]);
+  }
+  for (i = 0; i < 8; i += 4) {
+    od_mc_butterfly_epi32(&l[i], &l[i + 2]);
+    od_mc_butterfly_epi32(&l[i + 1], &l[i + 3]);
+    od_mc_butterfly_epi32(&h[i], &h[i + 2]);
+    od_mc_butterfly_epi32(&h[i + 1], &h[i + 3]);
+  }
+  for (i = 0; i < 4; i++) {
+    od_mc_butterfly_epi32(&l[i], &l[i + 4]);
+    od_mc_butterfly_epi32(&h[i], &h[i + 4]);
+  }
+  /*Horizontal transform.*/
+  sum = _mm_setzero_si128();
+  for (i = 0; i < 8; i++) {
+    od_mc_butterfly_epi32(&l[i], &h[i]);
+    od_mc_hadamard4_lanes_x2_sse41(&l[i], &h[i]);
+    sum = od_mc_abs_sum_epi32_sse41(sum, l[i]);
+    sum = od_mc_abs_sum_epi32_sse41(sum, h[i]);
+  }
+  return (od_mc_hsum_epi32_sse41(sum) + (1 << (3 + OD_COEFF_SHIFT) >> 1))
+   >> (3 + OD_COEFF_SHIFT);
+}
+
+/*Perform SATD on 8x8 blocks within src and ref then sum the results of
+   each one.*/
+OD_SIMD_INLINE int32_t od_mc_compute_sum_8x8_satd16_sse41(int ln,
+ const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride) {
+  int n;
+  int i;
+  int j;
+  int32_t satd;
+  n = 1 << ln;
+  OD_ASSERT(n >= 8);
+  satd = 0;
+  for (i = 0; i < n; i += 8) {
+    for (j = 0; j < n; j += 8) {
+      satd += od_mc_compute_satd16_8x8_part_sse41(src + i*systride + 2*j,
+       systride, ref + i*rystride + 2*j, rystride);
+    }
+  }
+#if defined(OD_CHECKASM)
+  od_mc_compute_satd16_check(src, systride, ref, rystride, ln, satd);
+#endif
+  return satd;
+}
+
+int32_t od_mc_compute_satd16_8x8_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_sse41(3, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd16_16x16_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_sse41(4, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd16_32x32_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_sse41(5, src, systride, ref, rystride);
+}
+
+int32_t od_mc_compute_satd16_64x64_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride) {
+  return od_mc_compute_sum_8x8_satd16_sse41(6, src, systride, ref, rystride);
+}
+
+#endif
+#endif
@@ -0,0 +1,137 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "x86enc.h"
+#include "x86int.h"
+
+#if defined(OD_X86ASM)
+#include <smmintrin.h>
+
+#if defined(OD_SSE41_INTRINSICS)
+
+void od_pvq_search_pulses_sse41(od_coeff *y, int32_t *xy, int32_t *yy,
+ const int16_t *x, int n, int i, int k) {
+  int32_t cxy;
+  int32_t cyy;
+  int n4;
+#if defined(OD_CHECKASM)
+  od_coeff y0[OD_MAX_PVQ_SIZE];
+  int i0;
+  OD_ASSERT(n <= OD_MAX_PVQ_SIZE);
+  OD_COPY(y0, y, n);
+  i0 = i;
+#endif
+  cxy = *xy;
+  cyy = *yy;
+  n4 = n & ~3;
+  for (; i < k; i++) {
+    OD_ALIGN16(int32_t lane_num[4]);
+    OD_ALIGN16(int32_t lane_den[4]);
+    OD_ALIGN16(int32_t lane_pos[4]);
+    __m128i best_num;
+    __m128i best_den;
+    __m128i best_pos;
+    __m128i pos;
+    __m128i xyv;
+    __m128i yyv;
+    __m128i s;
+    __m128i t;
+    int32_t num;
+    int32_t den;
+    int bestj;
+    int l;
+    int j;
+    s = _mm_cvtsi32_si128(OD_PVQ_SEARCH_NUM_SHIFT(i));
+    t = _mm_cvtsi32_si128(OD_PVQ_SEARCH_DEN_SHIFT(i));
+    xyv = _mm_set1_epi32(cxy);
+    yyv = _mm_set1_epi32(cyy + 1);
+    /*Each lane keeps the first best position among those congruent to it
+       mod 4.*/
+    best_num = _mm_set1_epi32(-1);
+    best_den = _mm_set1_epi32(1);
+    best_pos = _mm_setzero_si128();
+    pos = _mm_setr_epi32(0, 1, 2, 3);
+    for (j = 0; j < n4; j += 4) {
+      __m128i vnum;
+      __m128i vden;
+      __m128i gt;
+      vnum = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i *)(x + j)));
+      vnum = _mm_sra_epi32(_mm_add_epi32(xyv, vnum), s);
+      vnum = _mm_srli_epi32(_mm_mullo_epi32(vnum, vnum), 15);
+      vden = _mm_slli_epi32(_mm_loadu_si128((const __m128i *)(y + j)), 1);
+      vden = _mm_sra_epi32(_mm_add_epi32(yyv, vden), t);
+      gt = _mm_cmpgt_epi32(_mm_mullo_epi32(vnum, best_den),
+       _mm_mullo_epi32(best_num, vden));
+      best_num = _mm_blendv_epi8(best_num, vnum, gt);
+      best_den = _mm_blendv_epi8(best_den, vden, gt);
+      best_pos = _mm_blendv_epi8(best_pos, pos, gt);
+      pos = _mm_add_epi32(pos, _mm_set1_epi32(4));
+    }
+    _mm_store_si128((__m128i *)lane_num, best_num);
+    _mm_store_si128((__m128i *)lane_den, best_den);
+    _mm_store_si128((__m128i *)lane_pos, best_pos);
+    num = lane_num[0];
+    den = lane_den[0];
+    bestj = lane_pos[0];
+    for (l = 1; l < 4; l++) {
+      int32_t a;
+      int32_t b;
+      a = lane_num[l]*den;
+      b = num*lane_den[l];
+      if (a > b || (a == b && lane_pos[l] < bestj)) {
+        num = lane_num[l];
+        den = lane_den[l];
+        bestj = lane_pos[l];
+      }
+    }
+    for (j = n4; j < n; j++) {
+      int32_t jnum;
+      int32_t jden;
+      jnum = (cxy + x[j]) >> OD_PVQ_SEARCH_NUM_SHIFT(i);
+      jnum = jnum*jnum >> 15;
+      jden = (cyy + 2*y[j] + 1) >> OD_PVQ_SEARCH_DEN_SHIFT(i);
+      if (jnum*den > num*jden) {
+        num = jnum;
+        den = jden;
+        bestj = j;
+      }
+    }
+    cxy += x[bestj];
+    cyy += 2*y[bestj] + 1;
+    y[bestj]++;
+  }
+#if defined(OD_CHECKASM)
+  od_pvq_search_pulses_check(y0, *xy, *yy, x, n, i0, k, y, cxy, cyy);
+#endif
+  *xy = cxy;
+  *yy = cyy;
+}
+
+#endif
+#endif
@@ -337,3 +337,1833 @@ void od_bin_idct8x8_x86(od_coeff *x, int xstride,
   od_dct_check(1, ref, x, xstride);
 #endif
 }
+
+OD_SIMD_INLINE void fdct16_kernel(od_m256i *y, const od_m256i *x) {
+  /*83 adds, 16 shifts, 33 "muls".*/
+  /*See od_bin_fdct16() for the derivation.*/
+  od_m256i t0;
+  od_m256i t1;
+  od_m256i t1h;
+  od_m256i t2;
+  od_m256i t2h;
+  od_m256i t3;
+  od_m256i t4;
+  od_m256i t5;
+  od_m256i t6;
+  od_m256i t7;
+  od_m256i t8;
+  od_m256i t8h;
+  od_m256i t9;
+  od_m256i ta;
+  od_m256i tah;
+  od_m256i tb;
+  od_m256i tbh;
+  od_m256i tc;
+  od_m256i tch;
+  od_m256i td;
+  od_m256i tdh;
+  od_m256i te;
+  od_m256i tf;
+  od_m256i tfh;
+  /*Initial permutation:*/
+  t0 = x[0];
+  t8 = x[1];
+  t4 = x[2];
+  tc = x[3];
+  te = x[4];
+  ta = x[5];
+  t6 = x[6];
+  t2 = x[7];
+  t3 = x[8];
+  td = x[9];
+  t9 = x[10];
+  tf = x[11];
+  t1 = x[12];
+  t7 = x[13];
+  tb = x[14];
+  t5 = x[15];
+  /*+1/-1 butterflies:*/
+  t5 = od_mm256_sub_epi32(t0, t5);
+  t8 = od_mm256_add_epi32(t8, tb);
+  t7 = od_mm256_sub_epi32(t4, t7);
+  tc = od_mm256_add_epi32(tc, t1);
+  tf = od_mm256_sub_epi32(te, tf);
+  ta = od_mm256_add_epi32(ta, t9);
+  td = od_mm256_sub_epi32(t6, td);
+  t2 = od_mm256_add_epi32(t2, t3);
+  t0 = od_mm256_sub_epi32(t0, od_mm256_unbiased_rshift32(t5, 1));
+  t8h = od_mm256_unbiased_rshift32(t8, 1);
+  tb = od_mm256_sub_epi32(t8h, tb);
+  t4 = od_mm256_sub_epi32(t4, od_mm256_unbiased_rshift32(t7, 1));
+  tch = od_mm256_unbiased_rshift32(tc, 1);
+  t1 = od_mm256_sub_epi32(tch, t1);
+  te = od_mm256_sub_epi32(te, od_mm256_unbiased_rshift32(tf, 1));
+  tah = od_mm256_unbiased_rshift32(ta, 1);
+  t9 = od_mm256_sub_epi32(tah, t9);
+  t6 = od_mm256_sub_epi32(t6, od_mm256_unbiased_rshift32(td, 1));
+  t2h = od_mm256_unbiased_rshift32(t2, 1);
+  t3 = od_mm256_sub_epi32(t2h, t3);
+  /*+ Embedded 8-point type-II DCT.*/
+  t0 = od_mm256_add_epi32(t0, t2h);
+  t6 = od_mm256_sub_epi32(t8h, t6);
+  t4 = od_mm256_add_epi32(t4, tah);
+  te = od_mm256_sub_epi32(tch, te);
+  t2 = od_mm256_sub_epi32(t0, t2);
+  t8 = od_mm256_sub_epi32(t8, t6);
+  ta = od_mm256_sub_epi32(t4, ta);
+  tc = od_mm256_sub_epi32(tc, te);
+  /*|-+ Embedded 4-point type-II DCT.*/
+  tc = od_mm256_sub_epi32(t0, tc);
+  t8 = od_mm256_add_epi32(t8, t4);
+  t8h = od_mm256_unbiased_rshift32(t8, 1);
+  t4 = od_mm256_sub_epi32(t8h, t4);
+  t0 = od_mm256_sub_epi32(t0, od_mm256_unbiased_rshift32(tc, 1));
+  /*|-|-+ Embedded 2-point type-II DCT.*/
+  t0 = od_mm256_add_epi32(t0, t8h);
+  t8 = od_mm256_sub_epi32(t0, t8);
+  /*|-|-+ Embedded 2-point type-IV DST.*/
+  /*32013/32768 ~= 4*sin(\frac{\pi}{8}) - 2*tan(\frac{\pi}{8}) ~=
+     0.70230660471416898931046248770220*/
+  od_mm256_overflow_check(t4, 23013, 16384, 18);
+  tc = OD_DCT_MLS_EPI32(tc, t4, 23013, 16384, 15);
+  /*10703/16384 ~= \sqrt{1/2}*cos(\frac{\pi}{8})) ~=
+     0.65328148243818826392832158671359*/
+  od_mm256_overflow_check(tc, 10703, 8192, 19);
+  t4 = OD_DCT_MLA_EPI32(t4, tc, 10703, 8192, 14);
+  /*9147/8192 ~= 4*sin(\frac{\pi}{8}) - tan(\frac{\pi}{8}) ~=
+     1.1165201670872640381121512119119*/
+  od_mm256_overflow_check(t4, 9147, 4096, 20);
+  tc = OD_DCT_MLS_EPI32(tc, t4, 9147, 4096, 13);
+  /*|-+ Embedded 4-point type-IV DST.*/
+  /*13573/32768 ~= \sqrt{2} - 1 ~= 0.41421356237309504880168872420970*/
+  od_mm256_overflow_check(ta, 13573, 16384, 21);
+  t6 = OD_DCT_MLA_EPI32(t6, ta, 13573, 16384, 15);
+  /*11585/16384 ~= \sqrt{\frac{1}{2}} ~= 0.70710678118654752440084436210485*/
+  od_mm256_overflow_check(t6, 11585, 8192, 22);
+  ta = OD_DCT_MLS_EPI32(ta, t6, 11585, 8192, 14);
+  /*13573/32768 ~= \sqrt{2} - 1 ~= 0.41421356237309504880168872420970*/
+  od_mm256_overflow_check(ta, 13573, 16384, 23);
+  t6 = OD_DCT_MLA_EPI32(t6, ta, 13573, 16384, 15);
+  ta = od_mm256_add_epi32(ta, te);
+  t2 = od_mm256_add_epi32(t2, t6);
+  te = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(ta, 1), te);
+  t6 = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(t2, 1), t6);
+  /*2775/2048 ~= \frac{\sqrt{2} - cos(\frac{\pi}{16})}{2sin(\frac{\pi}{16})}
+     ~= 1.1108400393486273201524536919723*/
+  od_mm256_overflow_check(t2, 2275, 1024, 24);
+  te = OD_DCT_MLA_EPI32(te, t2, 2275, 1024, 11);
+  /*9041/32768 ~= \sqrt{2}sin(\frac{\pi}{16}) ~=
+     0.27589937928294301233595756366937*/
+  od_mm256_overflow_check(te, 9041, 16384, 25);
+  t2 = OD_DCT_MLS_EPI32(t2, te, 9041, 16384, 15);
+  /*2873/2048 ~=
+     \frac{cos(\frac{\pi}{16}) - \sqrt{\frac{1}{2}}}{sin(\frac{\pi}{16})} ~=
+     1.4028297067142967321050338435598*/
+  od_mm256_overflow_check(t2, 2873, 1024, 26);
+  te = OD_DCT_MLS_EPI32(te, t2, 2873, 1024, 11);
+  /*8593/16384 ~=
+    \frac{\sqrt{2} - cos(\frac{3\pi}{16})}{2sin(\frac{3\pi}{16})} ~=
+    0.52445569924008942966043945081053*/
+  od_mm256_overflow_check(ta, 8593, 8192, 27);
+  t6 = OD_DCT_MLS_EPI32(t6, ta, 8593, 8192, 14);
+  /*12873/16384 ~= \sqrt{2}sin(\frac{3\pi}{16}) ~=
+     0.78569495838710218127789736765722*/
+  od_mm256_overflow_check(t6, 12873, 8192, 28);
+  ta = OD_DCT_MLA_EPI32(ta, t6, 12873, 8192, 14);
+  /*7335/32768
+     ~=\frac{cos(\frac{3\pi}{16})-\sqrt{\frac{1}{2}}}{sin(\frac{3\pi}{16})}
+     ~=0.22384718209265507914012811666071*/
+  od_mm256_overflow_check(ta, 7335, 16384, 29);
+  t6 = OD_DCT_MLA_EPI32(t6, ta, 7335, 16384, 15);
+  /*+ Embedded 8-point type-IV DST.*/
+  /*1035/2048 ~=
+    \frac{\sqrt{2} - cos(\frac{7\pi}{32})}{2sin(\frac{7\pi}{32})} ~=
+    0.50536719493782972897642806316664*/
+  od_mm256_overflow_check(t5, 1035, 1024, 30);
+  t3 = OD_DCT_MLA_EPI32(t3, t5, 1035, 1024, 11);
+  /*14699/16384 ~= \sqrt{2}sin(\frac{7\pi}{32}) ~=
+     0.89716758634263628425064138922084*/
+  od_mm256_overflow_check(t3, 14699, 8192, 31);
+  t5 = OD_DCT_MLS_EPI32(t5, t3, 14699, 8192, 14);
+  /*851/8192 ~=
+    \frac{cos(\frac{7\pi}{32}) - \sqrt{\frac{1}{2}}}{sin(\frac{7\pi}{32}} ~=
+    0.10388456785615844342131055214354*/
+  od_mm256_overflow_check(t5, 851, 4096, 32);
+  t3 = OD_DCT_MLS_EPI32(t3, t5, 851, 4096, 13);
+  /*17515/32768 ~=
+     \frac{\sqrt{2} - cos(\frac{11\pi}{32})}{2sin(\frac{11\pi}{32})} ~=
+     0.53452437516842143578098634302964*/
+  od_mm256_overflow_check(td, 17515, 16384, 33);
+  tb = OD_DCT_MLA_EPI32(tb, td, 17515, 16384, 15);
+  /*20435/16384 ~= \sqrt{2}sin(\frac{11\pi}{32}) ~=
+     1.2472250129866712325719902627977*/
+  od_mm256_overflow_check(tb, 20435, 8192, 34);
+  td = OD_DCT_MLS_EPI32(td, tb, 20435, 8192, 14);
+  /*4379/16384 ~= \frac{\sqrt{\frac{1}{2}}
+     - cos(\frac{11\pi}{32})}{sin(\frac{11\pi}{32})} ~=
+     0.26726880719302561523614336238196*/
+  od_mm256_overflow_check(td, 4379, 8192, 35);
+  tb = OD_DCT_MLA_EPI32(tb, td, 4379, 8192, 14);
+  /*12905/16384 ~=
+     \frac{\sqrt{2} - cos(\frac{3\pi}{32})}{2sin(\frac{3\pi}{32})} ~=
+     0.78762894232967441973847776796517*/
+  od_mm256_overflow_check(t7, 12905, 8192, 36);
+  t9 = OD_DCT_MLA_EPI32(t9, t7, 12905, 8192, 14);
+  /*3363/8192 ~= \sqrt{2}sin(\frac{3\pi}{32}) ~=
+     0.41052452752235738115636923775513*/
+  od_mm256_overflow_check(t9, 3363, 4096, 37);
+  t7 = OD_DCT_MLS_EPI32(t7, t9, 3363, 4096, 13);
+  /*14101/16384 ~=
+     \frac{cos(\frac{3\pi}{32}) - \sqrt{\frac{1}{2}}}{sin(\frac{3\pi}{32})} ~=
+     0.86065016213948579370059934044795*/
+  od_mm256_overflow_check(t7, 14101, 8192, 38);
+  t9 = OD_DCT_MLS_EPI32(t9, t7, 14101, 8192, 14);
+  /*5417/8192 ~=
+     \frac{\sqrt{2} - cos(\frac{15\pi}{32})}{2sin(\frac{15\pi}{32})} ~=
+     0.66128246684651710406296283785232*/
+  od_mm256_overflow_check(tf, 5417, 4096, 39);
+  t1 = OD_DCT_MLA_EPI32(t1, tf, 5417, 4096, 13);
+  /*23059/16384 ~= \sqrt{2}sin(\frac{15\pi}{32}) ~=
+     1.4074037375263824590260782229840*/
+  od_mm256_overflow_check(t1, 23059, 8192, 40);
+  tf = OD_DCT_MLS_EPI32(tf, t1, 23059, 8192, 14);
+  /*20055/32768 ~=
+    \frac{\sqrt{\frac{1}{2}} - cos(\frac{15\pi}{32})}{sin(\frac{15\pi}{32})} ~=
+    0.61203676516793497752436407720666*/
+  od_mm256_overflow_check(tf, 20055, 16384, 41);
+  t1 = OD_DCT_MLA_EPI32(t1, tf, 20055, 16384, 15);
+  tf = od_mm256_sub_epi32(t3, tf);
+  td = od_mm256_add_epi32(td, t9);
+  tfh = od_mm256_unbiased_rshift32(tf, 1);
+  t3 = od_mm256_sub_epi32(t3, tfh);
+  tdh = od_mm256_unbiased_rshift32(td, 1);
+  t9 = od_mm256_sub_epi32(tdh, t9);
+  t1 = od_mm256_add_epi32(t1, t5);
+  tb = od_mm256_sub_epi32(t7, tb);
+  t1h = od_mm256_unbiased_rshift32(t1, 1);
+  t5 = od_mm256_sub_epi32(t1h, t5);
+  tbh = od_mm256_unbiased_rshift32(tb, 1);
+  t7 = od_mm256_sub_epi32(t7, tbh);
+  t3 = od_mm256_add_epi32(t3, tbh);
+  t5 = od_mm256_sub_epi32(tdh, t5);
+  t9 = od_mm256_add_epi32(t9, tfh);
+  t7 = od_mm256_sub_epi32(t1h, t7);
+  tb = od_mm256_sub_epi32(tb, t3);
+  td = od_mm256_sub_epi32(td, t5);
+  tf = od_mm256_sub_epi32(t9, tf);
+  t1 = od_mm256_sub_epi32(t1, t7);
+  /*10947/16384 ~= \frac{1 - cos(\frac{3\pi}{8})}{sin(\frac{3\pi}{8})} ~=
+     0.66817863791929891999775768652308*/
+  od_mm256_overflow_check(tb, 10947, 8192, 42);
+  t5 = OD_DCT_MLS_EPI32(t5, tb, 10947, 8192, 14);
+  /*15137/16384 ~= sin(\frac{3\pi}{8}) ~= 0.92387953251128675612818318939679*/
+  od_mm256_overflow_check(t5, 15137, 8192, 43);
+  tb = OD_DCT_MLA_EPI32(tb, t5, 15137, 8192, 14);
+  /*10947/16384 ~= \frac{1 - cos(\frac{3\pi}{8})}{sin(\frac{3\pi}{8})} ~=
+     0.66817863791929891999775768652308*/
+  od_mm256_overflow_check(tb, 10947, 8192, 44);
+  t5 = OD_DCT_MLS_EPI32(t5, tb, 10947, 8192, 14);
+  /*21895/32768 ~= \frac{1 - cos(\frac{3\pi}{8})}{sin(\frac{3\pi}{8})} ~=
+     0.66817863791929891999775768652308*/
+  od_mm256_overflow_check(t3, 21895, 16384, 45);
+  td = OD_DCT_MLA_EPI32(td, t3, 21895, 16384, 15);
+  /*15137/16384 ~= sin(\frac{3\pi}{8}) ~= 0.92387953251128675612818318939679*/
+  od_mm256_overflow_check(td, 15137, 8192, 46);
+  t3 = OD_DCT_MLS_EPI32(t3, td, 15137, 8192, 14);
+  /*10947/16384 ~= \frac{1 - cos(\frac{3\pi}{8})}{sin(\frac{3\pi}{8})} ~=
+     0.66817863791929891999775768652308*/
+  od_mm256_overflow_check(t3, 10947, 8192, 47);
+  td = OD_DCT_MLA_EPI32(td, t3, 10947, 8192, 14);
+  /*13573/32768 ~= \sqrt{2} - 1 ~= 0.41421356237309504880168872420970*/
+  od_mm256_overflow_check(tf, 13573, 16384, 48);
+  t1 = OD_DCT_MLS_EPI32(t1, tf, 13573, 16384, 15);
+  /*11585/16384 ~= \sqrt{\frac{1}{2}} ~= 0.70710678118654752440084436210485*/
+  od_mm256_overflow_check(t1, 11585, 8192, 49);
+  tf = OD_DCT_MLA_EPI32(tf, t1, 11585, 8192, 14);
+  /*13573/32768 ~= \sqrt{2} - 1 ~= 0.41421356237309504880168872420970*/
+  od_mm256_overflow_check(tf, 13573, 16384, 50);
+  t1 = OD_DCT_MLS_EPI32(t1, tf, 13573, 16384, 15);
+  y[0] = t0;
+  y[1] = t1;
+  y[2] = t2;
+  y[3] = t3;
+  y[4] = t4;
+  y[5] = t5;
+  y[6] = t6;
+  y[7] = t7;
+  y[8] = t8;
+  y[9] = t9;
+  y[10] = ta;
+  y[11] = tb;
+  y[12] = tc;
+  y[13] = td;
+  y[14] = te;
+  y[15] = tf;
+}
+
+OD_SIMD_INLINE void idct16_kernel(od_m256i *x, const od_m256i *y) {
+  od_m256i t0;
+  od_m256i t1;
+  od_m256i t1h;
+  od_m256i t2;
+  od_m256i t2h;
+  od_m256i t3;
+  od_m256i t4;
+  od_m256i t5;
+  od_m256i t6;
+  od_m256i t7;
+  od_m256i t8;
+  od_m256i t8h;
+  od_m256i t9;
+  od_m256i ta;
+  od_m256i tah;
+  od_m256i tb;
+  od_m256i tbh;
+  od_m256i tc;
+  od_m256i tch;
+  od_m256i td;
+  od_m256i tdh;
+  od_m256i te;
+  od_m256i tf;
+  od_m256i tfh;
+  t0 = y[0];
+  t1 = y[1];
+  t2 = y[2];
+  t3 = y[3];
+  t4 = y[4];
+  t5 = y[5];
+  t6 = y[6];
+  t7 = y[7];
+  t8 = y[8];
+  t9 = y[9];
+  ta = y[10];
+  tb = y[11];
+  tc = y[12];
+  td = y[13];
+  te = y[14];
+  tf = y[15];
+  t1 = OD_DCT_MLA_EPI32(t1, tf, 13573, 16384, 15);
+  tf = OD_DCT_MLS_EPI32(tf, t1, 11585, 8192, 14);
+  t1 = od_mm256_add_epi32(t1,
+   od_mm256_add_epi32(OD_DCT_MUL_EPI32(tf, 13573, 16384, 15), t7));
+  td = OD_DCT_MLS_EPI32(td, t3, 10947, 8192, 14);
+  t3 = OD_DCT_MLA_EPI32(t3, td, 15137, 8192, 14);
+  t5 = OD_DCT_MLA_EPI32(t5, tb, 10947, 8192, 14);
+  tb = OD_DCT_MLS_EPI32(tb, t5, 15137, 8192, 14);
+  t5 = OD_DCT_MLA_EPI32(t5, tb, 10947, 8192, 14);
+  td = od_mm256_add_epi32(td,
+   od_mm256_sub_epi32(t5, OD_DCT_MUL_EPI32(t3, 21895, 16384, 15)));
+  tf = od_mm256_sub_epi32(t9, tf);
+  tb = od_mm256_add_epi32(tb, t3);
+  tfh = od_mm256_unbiased_rshift32(tf, 1);
+  t9 = od_mm256_sub_epi32(t9, tfh);
+  tbh = od_mm256_unbiased_rshift32(tb, 1);
+  t3 = od_mm256_add_epi32(t3, od_mm256_sub_epi32(tfh, tbh));
+  t1h = od_mm256_unbiased_rshift32(t1, 1);
+  t7 = od_mm256_add_epi32(od_mm256_sub_epi32(t1h, t7), tbh);
+  tdh = od_mm256_unbiased_rshift32(td, 1);
+  t5 = od_mm256_add_epi32(t5, od_mm256_sub_epi32(t1h, tdh));
+  t9 = od_mm256_sub_epi32(tdh, t9);
+  td = od_mm256_sub_epi32(td, t9);
+  tf = od_mm256_sub_epi32(t3, tf);
+  t1 = od_mm256_sub_epi32(t1,
+   od_mm256_add_epi32(t5, OD_DCT_MUL_EPI32(tf, 20055, 16384, 15)));
+  tf = OD_DCT_MLA_EPI32(tf, t1, 23059, 8192, 14);
+  t1 = OD_DCT_MLS_EPI32(t1, tf, 5417, 4096, 13);
+  tb = od_mm256_sub_epi32(t7, tb);
+  t9 = OD_DCT_MLA_EPI32(t9, t7, 14101, 8192, 14);
+  t7 = OD_DCT_MLA_EPI32(t7, t9, 3363, 4096, 13);
+  t9 = OD_DCT_MLS_EPI32(t9, t7, 12905, 8192, 14);
+  tb = OD_DCT_MLS_EPI32(tb, td, 4379, 8192, 14);
+  td = OD_DCT_MLA_EPI32(td, tb, 20435, 8192, 14);
+  tb = OD_DCT_MLS_EPI32(tb, td, 17515, 16384, 15);
+  t3 = OD_DCT_MLA_EPI32(t3, t5, 851, 4096, 13);
+  t5 = OD_DCT_MLA_EPI32(t5, t3, 14699, 8192, 14);
+  t3 = OD_DCT_MLS_EPI32(t3, t5, 1035, 1024, 11);
+  t6 = OD_DCT_MLS_EPI32(t6, ta, 7335, 16384, 15);
+  ta = OD_DCT_MLS_EPI32(ta, t6, 12873, 8192, 14);
+  te = OD_DCT_MLA_EPI32(te, t2, 2873, 1024, 11);
+  t2 = OD_DCT_MLA_EPI32(t2, te, 9041, 16384, 15);
+  t6 = od_mm256_sub_epi32(od_mm256_sub_epi32(od_mm256_unbiased_rshift32(t2, 1),
+   t6), OD_DCT_MUL_EPI32(ta, 8593, 8192, 14));
+  te = od_mm256_add_epi32(od_mm256_sub_epi32(od_mm256_unbiased_rshift32(ta, 1),
+   te), OD_DCT_MUL_EPI32(t2, 2275, 1024, 11));
+  t2 = od_mm256_sub_epi32(t2, t6);
+  ta = od_mm256_sub_epi32(ta, te);
+  t6 = OD_DCT_MLS_EPI32(t6, ta, 13573, 16384, 15);
+  ta = OD_DCT_MLA_EPI32(ta, t6, 11585, 8192, 14);
+  t6 = OD_DCT_MLS_EPI32(t6, ta, 13573, 16384, 15);
+  tc = OD_DCT_MLA_EPI32(tc, t4, 9147, 4096, 13);
+  t4 = OD_DCT_MLS_EPI32(t4, tc, 10703, 8192, 14);
+  tc = OD_DCT_MLA_EPI32(tc, t4, 23013, 16384, 15);
+  t8 = od_mm256_sub_epi32(t0, t8);
+  t8h = od_mm256_unbiased_rshift32(t8, 1);
+  t0 = od_mm256_sub_epi32(t0,
+   od_mm256_sub_epi32(t8h, od_mm256_unbiased_rshift32(tc, 1)));
+  t4 = od_mm256_sub_epi32(t8h, t4);
+  t8 = od_mm256_add_epi32(t8, od_mm256_sub_epi32(t6, t4));
+  tc = od_mm256_add_epi32(od_mm256_sub_epi32(t0, tc), te);
+  ta = od_mm256_sub_epi32(t4, ta);
+  t2 = od_mm256_sub_epi32(t0, t2);
+  tch = od_mm256_unbiased_rshift32(tc, 1);
+  te = od_mm256_sub_epi32(tch, te);
+  tah = od_mm256_unbiased_rshift32(ta, 1);
+  t4 = od_mm256_sub_epi32(t4, tah);
+  t8h = od_mm256_unbiased_rshift32(t8, 1);
+  t6 = od_mm256_sub_epi32(t8h, t6);
+  t2h = od_mm256_unbiased_rshift32(t2, 1);
+  t0 = od_mm256_sub_epi32(t0, t2h);
+  t3 = od_mm256_sub_epi32(t2h, t3);
+  t6 = od_mm256_add_epi32(t6, od_mm256_unbiased_rshift32(td, 1));
+  t9 = od_mm256_sub_epi32(tah, t9);
+  te = od_mm256_add_epi32(te, od_mm256_unbiased_rshift32(tf, 1));
+  t1 = od_mm256_sub_epi32(tch, t1);
+  t4 = od_mm256_add_epi32(t4, od_mm256_unbiased_rshift32(t7, 1));
+  tb = od_mm256_sub_epi32(t8h, tb);
+  t0 = od_mm256_add_epi32(t0, od_mm256_unbiased_rshift32(t5, 1));
+  x[0] = t0;
+  x[1] = od_mm256_sub_epi32(t8, tb);
+  x[2] = t4;
+  x[3] = od_mm256_sub_epi32(tc, t1);
+  x[4] = te;
+  x[5] = od_mm256_sub_epi32(ta, t9);
+  x[6] = t6;
+  x[7] = od_mm256_sub_epi32(t2, t3);
+  x[8] = t3;
+  x[9] = od_mm256_sub_epi32(t6, td);
+  x[10] = t9;
+  x[11] = od_mm256_sub_epi32(te, tf);
+  x[12] = t1;
+  x[13] = od_mm256_sub_epi32(t4, t7);
+  x[14] = tb;
+  x[15] = od_mm256_sub_epi32(t0, t5);
+}
+
+#define OD_FDCT_2_EPI32(t0, t1) \
+  /* Embedded 2-point orthonormal Type-II fDCT. */ \
+  do { \
+    /* 13573/32768 ~= Tan[pi/8] ~= 0.414213562373095 */ \
+    od_mm256_overflow_check(t1, 13573, 16384, 100); \
+    t0 = OD_DCT_MLS_EPI32(t0, t1, 13573, 16384, 15); \
+    /* 5793/8192 ~= Sin[pi/4] ~= 0.707106781186547 */ \
+    od_mm256_overflow_check(t0, 5793, 4096, 101); \
+    t1 = OD_DCT_MLA_EPI32(t1, t0, 5793, 4096, 13); \
+    /* 3393/8192 ~= Tan[pi/8] ~= 0.414213562373095 */ \
+    od_mm256_overflow_check(t1, 3393, 4096, 102); \
+    t0 = OD_DCT_MLS_EPI32(t0, t1, 3393, 4096, 13); \
+  } \
+  while (0)
+
+#define OD_IDCT_2_EPI32(t0, t1) \
+  /* Embedded 2-point orthonormal Type-II iDCT. */ \
+  do { \
+    /* 3393/8192 ~= Tan[pi/8] ~= 0.414213562373095 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t1, 3393, 4096, 13); \
+    /* 5793/8192 ~= Sin[pi/4] ~= 0.707106781186547 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, t0, 5793, 4096, 13); \
+    /* 13573/32768 ~= Tan[pi/8] ~= 0.414213562373095 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t1, 13573, 16384, 15); \
+  } \
+  while (0)
+
+#define OD_FDST_2_EPI32(t0, t1) \
+  /* Embedded 2-point orthonormal Type-IV fDST. */ \
+  do { \
+    /* 10947/16384 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    od_mm256_overflow_check(t1, 10947, 8192, 103); \
+    t0 = OD_DCT_MLS_EPI32(t0, t1, 10947, 8192, 14); \
+    /* 473/512 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    od_mm256_overflow_check(t0, 473, 256, 104); \
+    t1 = OD_DCT_MLA_EPI32(t1, t0, 473, 256, 9); \
+    /* 10947/16384 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    od_mm256_overflow_check(t1, 10947, 8192, 105); \
+    t0 = OD_DCT_MLS_EPI32(t0, t1, 10947, 8192, 14); \
+  } \
+  while (0)
+
+#define OD_IDST_2_EPI32(t0, t1) \
+  /* Embedded 2-point orthonormal Type-IV iDST. */ \
+  do { \
+    /* 10947/16384 ~= Tan[3*Pi/16]) ~= 0.668178637919299 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t1, 10947, 8192, 14); \
+    /* 473/512 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, t0, 473, 256, 9); \
+    /* 10947/16384 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t1, 10947, 8192, 14); \
+  } \
+  while (0)
+
+#define OD_FDCT_4_ASYM_EPI32(t0, t2, t2h, t1, t3, t3h) \
+  /* Embedded 4-point asymmetric Type-II fDCT. */ \
+  do { \
+    t0 = od_mm256_add_epi32(t0, t3h); \
+    t3 = od_mm256_sub_epi32(t0, t3); \
+    t1 = od_mm256_sub_epi32(t2h, t1); \
+    t2 = od_mm256_sub_epi32(t1, t2); \
+    OD_FDCT_2_EPI32(t0, t2); \
+    OD_FDST_2_EPI32(t3, t1); \
+  } \
+  while (0)
+
+#define OD_IDCT_4_ASYM_EPI32(t0, t2, t1, t1h, t3, t3h) \
+  /* Embedded 4-point asymmetric Type-II iDCT. */ \
+  do { \
+    OD_IDST_2_EPI32(t3, t2); \
+    OD_IDCT_2_EPI32(t0, t1); \
+    t1 = od_mm256_sub_epi32(t2, t1); \
+    t1h = od_mm256_unbiased_rshift32(t1, 1); \
+    t2 = od_mm256_sub_epi32(t1h, t2); \
+    t3 = od_mm256_sub_epi32(t0, t3); \
+    t3h = od_mm256_unbiased_rshift32(t3, 1); \
+    t0 = od_mm256_sub_epi32(t0, t3h); \
+  } \
+  while (0)
+
+#define OD_FDST_4_ASYM_EPI32(t0, t0h, t2, t1, t3) \
+  /* Embedded 4-point asymmetric Type-IV fDST. */ \
+  do { \
+    /* 7489/8192 ~= Tan[Pi/8] + Tan[Pi/4]/2 ~= 0.914213562373095 */ \
+    od_mm256_overflow_check(t1, 7489, 4096, 106); \
+    t2 = OD_DCT_MLS_EPI32(t2, t1, 7489, 4096, 13); \
+    /* 11585/16384 ~= Sin[Pi/4] ~= 0.707106781186548 */ \
+    od_mm256_overflow_check(t1, 11585, 8192, 107); \
+    t1 = OD_DCT_MLA_EPI32(t1, t2, 11585, 8192, 14); \
+    /* -19195/32768 ~= Tan[Pi/8] - Tan[Pi/4] ~= -0.585786437626905 */ \
+    od_mm256_overflow_check(t1, 19195, 16384, 108); \
+    t2 = OD_DCT_MLA_EPI32(t2, t1, 19195, 16384, 15); \
+    t3 = od_mm256_add_epi32(t3, od_mm256_unbiased_rshift32(t2, 1)); \
+    t2 = od_mm256_sub_epi32(t2, t3); \
+    t1 = od_mm256_sub_epi32(t0h, t1); \
+    t0 = od_mm256_sub_epi32(t0, t1); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    od_mm256_overflow_check(t0, 6723, 4096, 109); \
+    t3 = OD_DCT_MLA_EPI32(t3, t0, 6723, 4096, 13); \
+    /* 8035/8192 ~= Sin[7*Pi/16] ~= 0.980785280403230 */ \
+    od_mm256_overflow_check(t3, 8035, 4096, 110); \
+    t0 = OD_DCT_MLS_EPI32(t0, t3, 8035, 4096, 13); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    od_mm256_overflow_check(t0, 6723, 4096, 111); \
+    t3 = OD_DCT_MLA_EPI32(t3, t0, 6723, 4096, 13); \
+    /* 8757/16384 ~= Tan[5*Pi/32] ~= 0.534511135950792 */ \
+    od_mm256_overflow_check(t1, 8757, 8192, 112); \
+    t2 = OD_DCT_MLA_EPI32(t2, t1, 8757, 8192, 14); \
+    /* 6811/8192 ~= Sin[5*Pi/16] ~= 0.831469612302545 */ \
+    od_mm256_overflow_check(t2, 6811, 4096, 113); \
+    t1 = OD_DCT_MLS_EPI32(t1, t2, 6811, 4096, 13); \
+    /* 8757/16384 ~= Tan[5*Pi/32] ~= 0.534511135950792 */ \
+    od_mm256_overflow_check(t1, 8757, 8192, 114); \
+    t2 = OD_DCT_MLA_EPI32(t2, t1, 8757, 8192, 14); \
+  } \
+  while (0)
+
+#define OD_IDST_4_ASYM_EPI32(t0, t0h, t2, t1, t3) \
+  /* Embedded 4-point asymmetric Type-IV iDST. */ \
+  do { \
+    /* 8757/16384 ~= Tan[5*Pi/32] ~= 0.534511135950792 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, t2, 8757, 8192, 14); \
+    /* 6811/8192 ~= Sin[5*Pi/16] ~= 0.831469612302545 */ \
+    t2 = OD_DCT_MLA_EPI32(t2, t1, 6811, 4096, 13); \
+    /* 8757/16384 ~= Tan[5*Pi/32] ~= 0.534511135950792 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, t2, 8757, 8192, 14); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    t3 = OD_DCT_MLS_EPI32(t3, t0, 6723, 4096, 13); \
+    /* 8035/8192 ~= Sin[7*Pi/16] ~= 0.980785280403230 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t3, 8035, 4096, 13); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    t3 = OD_DCT_MLS_EPI32(t3, t0, 6723, 4096, 13); \
+    t0 = od_mm256_add_epi32(t0, t2); \
+    t0h = od_mm256_unbiased_rshift32(t0, 1); \
+    t2 = od_mm256_sub_epi32(t0h, t2); \
+    t1 = od_mm256_add_epi32(t1, t3); \
+    t3 = od_mm256_sub_epi32(t3, od_mm256_unbiased_rshift32(t1, 1)); \
+    /* -19195/32768 ~= Tan[Pi/8] - Tan[Pi/4] ~= -0.585786437626905 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, t2, 19195, 16384, 15); \
+    /* 11585/16384 ~= Sin[Pi/4] ~= 0.707106781186548 */ \
+    t2 = OD_DCT_MLS_EPI32(t2, t1, 11585, 8192, 14); \
+    /* 7489/8192 ~= Tan[Pi/8] + Tan[Pi/4]/2 ~= 0.914213562373095 */ \
+    t1 = OD_DCT_MLA_EPI32(t1, t2, 7489, 4096, 13); \
+  } \
+  while (0)
+
+#define OD_FDCT_8_EPI32(t0, t4, t2, t6, t1, t5, t3, t7) \
+  /* Embedded 8-point orthonormal Type-II fDCT. */ \
+  do { \
+    od_m256i t4h; \
+    od_m256i t6h; \
+    od_m256i t7h; \
+    t7 = od_mm256_sub_epi32(t0, t7); \
+    t7h = od_mm256_unbiased_rshift32(t7, 1); \
+    t0 = od_mm256_sub_epi32(t0, t7h); \
+    t4 = od_mm256_add_epi32(t4, t3); \
+    t4h = od_mm256_unbiased_rshift32(t4, 1); \
+    t3 = od_mm256_sub_epi32(t4h, t3); \
+    t5 = od_mm256_sub_epi32(t2, t5); \
+    t2 = od_mm256_sub_epi32(t2, od_mm256_unbiased_rshift32(t5, 1)); \
+    t6 = od_mm256_add_epi32(t6, t1); \
+    t6h = od_mm256_unbiased_rshift32(t6, 1); \
+    t1 = od_mm256_sub_epi32(t6h, t1); \
+    OD_FDCT_4_ASYM_EPI32(t0, t4, t4h, t2, t6, t6h); \
+    OD_FDST_4_ASYM_EPI32(t7, t7h, t3, t5, t1); \
+  } \
+  while (0)
+
+#define OD_IDCT_8_EPI32(t0, t4, t2, t6, t1, t5, t3, t7) \
+  /* Embedded 8-point orthonormal Type-II iDCT. */ \
+  do { \
+    od_m256i t1h_; \
+    od_m256i t3h_; \
+    od_m256i t7h_; \
+    OD_IDST_4_ASYM_EPI32(t7, t7h_, t5, t6, t4); \
+    OD_IDCT_4_ASYM_EPI32(t0, t2, t1, t1h_, t3, t3h_); \
+    t4 = od_mm256_sub_epi32(t3h_, t4); \
+    t3 = od_mm256_sub_epi32(t3, t4); \
+    t2 = od_mm256_add_epi32(t2, od_mm256_unbiased_rshift32(t5, 1)); \
+    t5 = od_mm256_sub_epi32(t2, t5); \
+    t6 = od_mm256_sub_epi32(t1h_, t6); \
+    t1 = od_mm256_sub_epi32(t1, t6); \
+    t0 = od_mm256_add_epi32(t0, t7h_); \
+    t7 = od_mm256_sub_epi32(t0, t7); \
+  } \
+  while (0)
+
+#define OD_FDST_8_EPI32(t0, t4, t2, t6, t1, t5, t3, t7) \
+  /* Embedded 8-point orthonormal Type-IV fDST. */ \
+  do { \
+    od_m256i t0h; \
+    od_m256i t2h; \
+    od_m256i t5h; \
+    od_m256i t7h; \
+    /* 13573/32768 ~= Tan[Pi/8] ~= 0.414213562373095 */ \
+    od_mm256_overflow_check(t1, 13573, 16384, 115); \
+    t6 = OD_DCT_MLS_EPI32(t6, t1, 13573, 16384, 15); \
+    /* 11585/16384 ~= Sin[Pi/4] ~= 0.707106781186547 */ \
+    od_mm256_overflow_check(t6, 11585, 8192, 116); \
+    t1 = OD_DCT_MLA_EPI32(t1, t6, 11585, 8192, 14); \
+    /* 13573/32768 ~= Tan[Pi/8] ~= 0.414213562373095 */ \
+    od_mm256_overflow_check(t1, 13573, 16384, 117); \
+    t6 = OD_DCT_MLS_EPI32(t6, t1, 13573, 16384, 15); \
+    /* 21895/32768 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    od_mm256_overflow_check(t2, 21895, 16384, 118); \
+    t5 = OD_DCT_MLS_EPI32(t5, t2, 21895, 16384, 15); \
+    /* 15137/16384 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    od_mm256_overflow_check(t5, 15137, 8192, 119); \
+    t2 = OD_DCT_MLA_EPI32(t2, t5, 15137, 8192, 14); \
+    /* 10947/16384 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    od_mm256_overflow_check(t2, 10947, 8192, 120); \
+    t5 = OD_DCT_MLS_EPI32(t5, t2, 10947, 8192, 14); \
+    /* 3259/16384 ~= Tan[Pi/16] ~= 0.198912367379658 */ \
+    od_mm256_overflow_check(t3, 3259, 8192, 121); \
+    t4 = OD_DCT_MLS_EPI32(t4, t3, 3259, 8192, 14); \
+    /* 3135/8192 ~= Sin[Pi/8] ~= 0.382683432365090 */ \
+    od_mm256_overflow_check(t4, 3135, 4096, 122); \
+    t3 = OD_DCT_MLA_EPI32(t3, t4, 3135, 4096, 13); \
+    /* 3259/16384 ~= Tan[Pi/16] ~= 0.198912367379658 */ \
+    od_mm256_overflow_check(t3, 3259, 8192, 123); \
+    t4 = OD_DCT_MLS_EPI32(t4, t3, 3259, 8192, 14); \
+    t7 = od_mm256_add_epi32(t7, t1); \
+    t7h = od_mm256_unbiased_rshift32(t7, 1); \
+    t1 = od_mm256_sub_epi32(t1, t7h); \
+    t2 = od_mm256_sub_epi32(t3, t2); \
+    t2h = od_mm256_unbiased_rshift32(t2, 1); \
+    t3 = od_mm256_sub_epi32(t3, t2h); \
+    t0 = od_mm256_sub_epi32(t0, t6); \
+    t0h = od_mm256_unbiased_rshift32(t0, 1); \
+    t6 = od_mm256_add_epi32(t6, t0h); \
+    t5 = od_mm256_sub_epi32(t4, t5); \
+    t5h = od_mm256_unbiased_rshift32(t5, 1); \
+    t4 = od_mm256_sub_epi32(t4, t5h); \
+    t1 = od_mm256_add_epi32(t1, t5h); \
+    t5 = od_mm256_sub_epi32(t1, t5); \
+    t4 = od_mm256_add_epi32(t4, t0h); \
+    t0 = od_mm256_sub_epi32(t0, t4); \
+    t6 = od_mm256_sub_epi32(t6, t2h); \
+    t2 = od_mm256_add_epi32(t2, t6); \
+    t3 = od_mm256_sub_epi32(t3, t7h); \
+    t7 = od_mm256_add_epi32(t7, t3); \
+    /* TODO: Can we move this into another operation */ \
+    t7 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t7); \
+    /* 7425/8192 ~= Tan[15*Pi/64] ~= 0.906347169019147 */ \
+    od_mm256_overflow_check(t7, 7425, 4096, 124); \
+    t0 = OD_DCT_MLS_EPI32(t0, t7, 7425, 4096, 13); \
+    /* 8153/8192 ~= Sin[15*Pi/32] ~= 0.995184726672197 */ \
+    od_mm256_overflow_check(t0, 8153, 4096, 125); \
+    t7 = OD_DCT_MLA_EPI32(t7, t0, 8153, 4096, 13); \
+    /* 7425/8192 ~= Tan[15*Pi/64] ~= 0.906347169019147 */ \
+    od_mm256_overflow_check(t7, 7425, 4096, 126); \
+    t0 = OD_DCT_MLS_EPI32(t0, t7, 7425, 4096, 13); \
+    /* 4861/32768 ~= Tan[3*Pi/64] ~= 0.148335987538347 */ \
+    od_mm256_overflow_check(t1, 4861, 16384, 127); \
+    t6 = OD_DCT_MLS_EPI32(t6, t1, 4861, 16384, 15); \
+    /* 1189/4096 ~= Sin[3*Pi/32] ~= 0.290284677254462 */ \
+    od_mm256_overflow_check(t6, 1189, 2048, 128); \
+    t1 = OD_DCT_MLA_EPI32(t1, t6, 1189, 2048, 12); \
+    /* 4861/32768 ~= Tan[3*Pi/64] ~= 0.148335987538347 */ \
+    od_mm256_overflow_check(t1, 4861, 16384, 129); \
+    t6 = OD_DCT_MLS_EPI32(t6, t1, 4861, 16384, 15); \
+    /* 2455/4096 ~= Tan[11*Pi/64] ~= 0.599376933681924 */ \
+    od_mm256_overflow_check(t5, 2455, 2048, 130); \
+    t2 = OD_DCT_MLS_EPI32(t2, t5, 2455, 2048, 12); \
+    /* 7225/8192 ~= Sin[11*Pi/32] ~= 0.881921264348355 */ \
+    od_mm256_overflow_check(t2, 7225, 4096, 131); \
+    t5 = OD_DCT_MLA_EPI32(t5, t2, 7225, 4096, 13); \
+    /* 2455/4096 ~= Tan[11*Pi/64] ~= 0.599376933681924 */ \
+    od_mm256_overflow_check(t5, 2455, 2048, 132); \
+    t2 = OD_DCT_MLS_EPI32(t2, t5, 2455, 2048, 12); \
+    /* 11725/32768 ~= Tan[7*Pi/64] ~= 0.357805721314524 */ \
+    od_mm256_overflow_check(t3, 11725, 16384, 133); \
+    t4 = OD_DCT_MLS_EPI32(t4, t3, 11725, 16384, 15); \
+    /* 5197/8192 ~= Sin[7*Pi/32] ~= 0.634393284163645 */ \
+    od_mm256_overflow_check(t4, 5197, 4096, 134); \
+    t3 = OD_DCT_MLA_EPI32(t3, t4, 5197, 4096, 13); \
+    /* 11725/32768 ~= Tan[7*Pi/64] ~= 0.357805721314524 */ \
+    od_mm256_overflow_check(t3, 11725, 16384, 135); \
+    t4 = OD_DCT_MLS_EPI32(t4, t3, 11725, 16384, 15); \
+  } \
+  while (0)
+
+#define OD_IDST_8_EPI32(t0, t4, t2, t6, t1, t5, t3, t7) \
+  /* Embedded 8-point orthonormal Type-IV iDST. */ \
+  do { \
+    od_m256i t0h; \
+    od_m256i t2h; \
+    od_m256i t5h_; \
+    od_m256i t7h_; \
+    /* 11725/32768 ~= Tan[7*Pi/64] ~= 0.357805721314524 */ \
+    t1 = OD_DCT_MLA_EPI32(t1, t6, 11725, 16384, 15); \
+    /* 5197/8192 ~= Sin[7*Pi/32] ~= 0.634393284163645 */ \
+    t6 = OD_DCT_MLS_EPI32(t6, t1, 5197, 4096, 13); \
+    /* 11725/32768 ~= Tan[7*Pi/64] ~= 0.357805721314524 */ \
+    t1 = OD_DCT_MLA_EPI32(t1, t6, 11725, 16384, 15); \
+    /* 2455/4096 ~= Tan[11*Pi/64] ~= 0.599376933681924 */ \
+    t2 = OD_DCT_MLA_EPI32(t2, t5, 2455, 2048, 12); \
+    /* 7225/8192 ~= Sin[11*Pi/32] ~= 0.881921264348355 */ \
+    t5 = OD_DCT_MLS_EPI32(t5, t2, 7225, 4096, 13); \
+    /* 2455/4096 ~= Tan[11*Pi/64] ~= 0.599376933681924 */ \
+    t2 = OD_DCT_MLA_EPI32(t2, t5, 2455, 2048, 12); \
+    /* 4861/32768 ~= Tan[3*Pi/64] ~= 0.148335987538347 */ \
+    t3 = OD_DCT_MLA_EPI32(t3, t4, 4861, 16384, 15); \
+    /* 1189/4096 ~= Sin[3*Pi/32] ~= 0.290284677254462 */ \
+    t4 = OD_DCT_MLS_EPI32(t4, t3, 1189, 2048, 12); \
+    /* 4861/32768 ~= Tan[3*Pi/64] ~= 0.148335987538347 */ \
+    t3 = OD_DCT_MLA_EPI32(t3, t4, 4861, 16384, 15); \
+    /* 7425/8192 ~= Tan[15*Pi/64] ~= 0.906347169019147 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t7, 7425, 4096, 13); \
+    /* 8153/8192 ~= Sin[15*Pi/32] ~= 0.995184726672197 */ \
+    t7 = OD_DCT_MLS_EPI32(t7, t0, 8153, 4096, 13); \
+    /* 7425/8192 ~= Tan[15*Pi/64] ~= 0.906347169019147 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, t7, 7425, 4096, 13); \
+    /* TODO: Can we move this into another operation */ \
+    t7 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t7); \
+    t7 = od_mm256_sub_epi32(t7, t6); \
+    t7h_ = od_mm256_unbiased_rshift32(t7, 1); \
+    t6 = od_mm256_add_epi32(t6, t7h_); \
+    t2 = od_mm256_sub_epi32(t2, t3); \
+    t2h = od_mm256_unbiased_rshift32(t2, 1); \
+    t3 = od_mm256_add_epi32(t3, t2h); \
+    t0 = od_mm256_add_epi32(t0, t1); \
+    t0h = od_mm256_unbiased_rshift32(t0, 1); \
+    t1 = od_mm256_sub_epi32(t1, t0h); \
+    t5 = od_mm256_sub_epi32(t4, t5); \
+    t5h_ = od_mm256_unbiased_rshift32(t5, 1); \
+    t4 = od_mm256_sub_epi32(t4, t5h_); \
+    t1 = od_mm256_add_epi32(t1, t5h_); \
+    t5 = od_mm256_sub_epi32(t1, t5); \
+    t3 = od_mm256_sub_epi32(t3, t0h); \
+    t0 = od_mm256_add_epi32(t0, t3); \
+    t6 = od_mm256_add_epi32(t6, t2h); \
+    t2 = od_mm256_sub_epi32(t6, t2); \
+    t4 = od_mm256_add_epi32(t4, t7h_); \
+    t7 = od_mm256_sub_epi32(t7, t4); \
+    /* 3259/16384 ~= Tan[Pi/16] ~= 0.198912367379658 */ \
+    t1 = OD_DCT_MLA_EPI32(t1, t6, 3259, 8192, 14); \
+    /* 3135/8192 ~= Sin[Pi/8] ~= 0.382683432365090 */ \
+    t6 = OD_DCT_MLS_EPI32(t6, t1, 3135, 4096, 13); \
+    /* 3259/16384 ~= Tan[Pi/16] ~= 0.198912367379658 */ \
+    t1 = OD_DCT_MLA_EPI32(t1, t6, 3259, 8192, 14); \
+    /* 10947/16384 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    t5 = OD_DCT_MLA_EPI32(t5, t2, 10947, 8192, 14); \
+    /* 15137/16384 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    t2 = OD_DCT_MLS_EPI32(t2, t5, 15137, 8192, 14); \
+    /* 21895/32768 ~= Tan[3*Pi/16] ~= 0.668178637919299 */ \
+    t5 = OD_DCT_MLA_EPI32(t5, t2, 21895, 16384, 15); \
+    /* 13573/32768 ~= Tan[Pi/8] ~= 0.414213562373095 */ \
+    t3 = OD_DCT_MLA_EPI32(t3, t4, 13573, 16384, 15); \
+    /* 11585/16384 ~= Sin[Pi/4] ~= 0.707106781186547 */ \
+    t4 = OD_DCT_MLS_EPI32(t4, t3, 11585, 8192, 14); \
+    /* 13573/32768 ~= Tan[Pi/8] ~= 0.414213562373095 */ \
+    t3 = OD_DCT_MLA_EPI32(t3, t4, 13573, 16384, 15); \
+  } \
+  while (0)
+
+#define OD_FDCT_16_ASYM_EPI32(t0, t8, t8h, t4, tc, tch, t2, ta, tah, t6, te, \
+ teh, t1, t9, t9h, t5, td, tdh, t3, tb, tbh, t7, tf, tfh) \
+  /* Embedded 16-point asymmetric Type-II fDCT. */ \
+  do { \
+    t0 = od_mm256_add_epi32(t0, tfh); \
+    tf = od_mm256_sub_epi32(t0, tf); \
+    t1 = od_mm256_sub_epi32(t1, teh); \
+    te = od_mm256_add_epi32(te, t1); \
+    t2 = od_mm256_add_epi32(t2, tdh); \
+    td = od_mm256_sub_epi32(t2, td); \
+    t3 = od_mm256_sub_epi32(t3, tch); \
+    tc = od_mm256_add_epi32(tc, t3); \
+    t4 = od_mm256_add_epi32(t4, tbh); \
+    tb = od_mm256_sub_epi32(t4, tb); \
+    t5 = od_mm256_sub_epi32(t5, tah); \
+    ta = od_mm256_add_epi32(ta, t5); \
+    t6 = od_mm256_add_epi32(t6, t9h); \
+    t9 = od_mm256_sub_epi32(t6, t9); \
+    t7 = od_mm256_sub_epi32(t7, t8h); \
+    t8 = od_mm256_add_epi32(t8, t7); \
+    OD_FDCT_8_EPI32(t0, t8, t4, tc, t2, ta, t6, te); \
+    OD_FDST_8_EPI32(tf, t7, tb, t3, td, t5, t9, t1); \
+  } \
+  while (0)
+
+#define OD_IDCT_16_ASYM_EPI32(t0, t8, t4, tc, t2, ta, t6, te, \
+ t1, t1h, t9, t9h, t5, t5h, td, tdh, t3, t3h, tb, tbh, t7, t7h, tf, tfh) \
+  /* Embedded 16-point asymmetric Type-II iDCT. */ \
+  do { \
+    OD_IDST_8_EPI32(tf, tb, td, t9, te, ta, tc, t8); \
+    OD_IDCT_8_EPI32(t0, t4, t2, t6, t1, t5, t3, t7); \
+    t1 = od_mm256_sub_epi32(t1, te); \
+    t1h = od_mm256_unbiased_rshift32(t1, 1); \
+    te = od_mm256_add_epi32(te, t1h); \
+    t9 = od_mm256_sub_epi32(t6, t9); \
+    t9h = od_mm256_unbiased_rshift32(t9, 1); \
+    t6 = od_mm256_sub_epi32(t6, t9h); \
+    t5 = od_mm256_sub_epi32(t5, ta); \
+    t5h = od_mm256_unbiased_rshift32(t5, 1); \
+    ta = od_mm256_add_epi32(ta, t5h); \
+    td = od_mm256_sub_epi32(t2, td); \
+    tdh = od_mm256_unbiased_rshift32(td, 1); \
+    t2 = od_mm256_sub_epi32(t2, tdh); \
+    t3 = od_mm256_sub_epi32(t3, tc); \
+    t3h = od_mm256_unbiased_rshift32(t3, 1); \
+    tc = od_mm256_add_epi32(tc, t3h); \
+    tb = od_mm256_sub_epi32(t4, tb); \
+    tbh = od_mm256_unbiased_rshift32(tb, 1); \
+    t4 = od_mm256_sub_epi32(t4, tbh); \
+    t7 = od_mm256_sub_epi32(t7, t8); \
+    t7h = od_mm256_unbiased_rshift32(t7, 1); \
+    t8 = od_mm256_add_epi32(t8, t7h); \
+    tf = od_mm256_sub_epi32(t0, tf); \
+    tfh = od_mm256_unbiased_rshift32(tf, 1); \
+    t0 = od_mm256_sub_epi32(t0, tfh); \
+  } \
+  while (0)
+
+#define OD_FDST_16_ASYM_EPI32(t0, t0h, t8, t4, t4h, tc, t2, ta, t6, te, \
+ t1, t9, t5, td, t3, tb, t7, t7h, tf) \
+  /* Embedded 16-point asymmetric Type-IV fDST. */ \
+  do { \
+    od_m256i t2h; \
+    od_m256i t3h; \
+    od_m256i t6h; \
+    od_m256i t8h; \
+    od_m256i t9h; \
+    od_m256i tch; \
+    od_m256i tdh; \
+    /* TODO: Can we move these into another operation */ \
+    t8 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t8); \
+    t9 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t9); \
+    ta = od_mm256_sub_epi32(od_mm256_set1_epi32(0), ta); \
+    tb = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tb); \
+    td = od_mm256_sub_epi32(od_mm256_set1_epi32(0), td); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    od_mm256_overflow_check(te, 13573, 8192, 136); \
+    t1 = OD_DCT_MLS_EPI32(t1, te, 13573, 8192, 14); \
+    /* 11585/32768 ~= Sin[Pi/4]/2 ~= 0.353553390593274 */ \
+    od_mm256_overflow_check(t1, 11585, 16384, 137); \
+    te = OD_DCT_MLA_EPI32(te, t1, 11585, 16384, 15); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    od_mm256_overflow_check(te, 13573, 8192, 138); \
+    t1 = OD_DCT_MLS_EPI32(t1, te, 13573, 8192, 14); \
+    /* 4161/16384 ~= Tan[3*Pi/16] - Tan[Pi/8] ~= 0.253965075546204 */ \
+    od_mm256_overflow_check(td, 4161, 8192, 139); \
+    t2 = OD_DCT_MLA_EPI32(t2, td, 4161, 8192, 14); \
+    /* 15137/16384 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    od_mm256_overflow_check(t2, 15137, 8192, 140); \
+    td = OD_DCT_MLS_EPI32(td, t2, 15137, 8192, 14); \
+    /* 14341/16384 ~= Tan[3*Pi/16] + Tan[Pi/8]/2 ~= 0.875285419105846 */ \
+    od_mm256_overflow_check(td, 14341, 8192, 141); \
+    t2 = OD_DCT_MLA_EPI32(t2, td, 14341, 8192, 14); \
+    /* 14341/16384 ~= Tan[3*Pi/16] + Tan[Pi/8]/2 ~= 0.875285419105846 */ \
+    od_mm256_overflow_check(t3, 14341, 8192, 142); \
+    tc = OD_DCT_MLS_EPI32(tc, t3, 14341, 8192, 14); \
+    /* 15137/16384 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    od_mm256_overflow_check(tc, 15137, 8192, 143); \
+    t3 = OD_DCT_MLA_EPI32(t3, tc, 15137, 8192, 14); \
+    /* 4161/16384 ~= Tan[3*Pi/16] - Tan[Pi/8] ~= 0.253965075546204 */ \
+    od_mm256_overflow_check(t3, 4161, 8192, 144); \
+    tc = OD_DCT_MLS_EPI32(tc, t3, 4161, 8192, 14); \
+    te = od_mm256_sub_epi32(t0h, te); \
+    t0 = od_mm256_sub_epi32(t0, te); \
+    tf = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(t1, 1), tf); \
+    t1 = od_mm256_sub_epi32(t1, tf); \
+    /* TODO: Can we move this into another operation */ \
+    tc = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tc); \
+    t2 = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(tc, 1), t2); \
+    tc = od_mm256_sub_epi32(tc, t2); \
+    t3 = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(td, 1), t3); \
+    td = od_mm256_sub_epi32(t3, td); \
+    /* 7489/8192 ~= Tan[Pi/8] + Tan[Pi/4]/2 ~= 0.914213562373095 */ \
+    od_mm256_overflow_check(t6, 7489, 4096, 145); \
+    t9 = OD_DCT_MLS_EPI32(t9, t6, 7489, 4096, 13); \
+    /* 11585/16384 ~= Sin[Pi/4] ~= 0.707106781186548 */ \
+    od_mm256_overflow_check(t9, 11585, 8192, 146); \
+    t6 = OD_DCT_MLA_EPI32(t6, t9, 11585, 8192, 14); \
+    /* -19195/32768 ~= Tan[Pi/8] - Tan[Pi/4] ~= -0.585786437626905 */ \
+    od_mm256_overflow_check(t6, 19195, 16384, 147); \
+    t9 = OD_DCT_MLA_EPI32(t9, t6, 19195, 16384, 15); \
+    t8 = od_mm256_add_epi32(t8, od_mm256_unbiased_rshift32(t9, 1)); \
+    t9 = od_mm256_sub_epi32(t9, t8); \
+    t6 = od_mm256_sub_epi32(t7h, t6); \
+    t7 = od_mm256_sub_epi32(t7, t6); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    od_mm256_overflow_check(t7, 6723, 4096, 148); \
+    t8 = OD_DCT_MLA_EPI32(t8, t7, 6723, 4096, 13); \
+    /* 16069/16384 ~= Sin[7*Pi/16] ~= 0.980785280403230 */ \
+    od_mm256_overflow_check(t8, 16069, 8192, 149); \
+    t7 = OD_DCT_MLS_EPI32(t7, t8, 16069, 8192, 14); \
+    /* 6723/8192 ~= Tan[7*Pi/32]) ~= 0.820678790828660 */ \
+    od_mm256_overflow_check(t7, 6723, 4096, 150); \
+    t8 = OD_DCT_MLA_EPI32(t8, t7, 6723, 4096, 13); \
+    /* 17515/32768 ~= Tan[5*Pi/32]) ~= 0.534511135950792 */ \
+    od_mm256_overflow_check(t6, 17515, 16384, 151); \
+    t9 = OD_DCT_MLA_EPI32(t9, t6, 17515, 16384, 15); \
+    /* 13623/16384 ~= Sin[5*Pi/16] ~= 0.831469612302545 */ \
+    od_mm256_overflow_check(t9, 13623, 8192, 152); \
+    t6 = OD_DCT_MLS_EPI32(t6, t9, 13623, 8192, 14); \
+    /* 17515/32768 ~= Tan[5*Pi/32] ~= 0.534511135950792 */ \
+    od_mm256_overflow_check(t6, 17515, 16384, 153); \
+    t9 = OD_DCT_MLA_EPI32(t9, t6, 17515, 16384, 15); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    od_mm256_overflow_check(ta, 13573, 8192, 154); \
+    t5 = OD_DCT_MLA_EPI32(t5, ta, 13573, 8192, 14); \
+    /* 11585/32768 ~= Sin[Pi/4]/2 ~= 0.353553390593274 */ \
+    od_mm256_overflow_check(t5, 11585, 16384, 155); \
+    ta = OD_DCT_MLS_EPI32(ta, t5, 11585, 16384, 15); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    od_mm256_overflow_check(ta, 13573, 8192, 156); \
+    t5 = OD_DCT_MLA_EPI32(t5, ta, 13573, 8192, 14); \
+    tb = od_mm256_add_epi32(tb, od_mm256_unbiased_rshift32(t5, 1)); \
+    t5 = od_mm256_sub_epi32(tb, t5); \
+    ta = od_mm256_add_epi32(ta, t4h); \
+    t4 = od_mm256_sub_epi32(t4, ta); \
+    /* 2485/8192 ~= Tan[3*Pi/32] ~= 0.303346683607342 */ \
+    od_mm256_overflow_check(t5, 2485, 4096, 157); \
+    ta = OD_DCT_MLA_EPI32(ta, t5, 2485, 4096, 13); \
+    /* 18205/32768 ~= Sin[3*Pi/16] ~= 0.555570233019602 */ \
+    od_mm256_overflow_check(ta, 18205, 16384, 158); \
+    t5 = OD_DCT_MLS_EPI32(t5, ta, 18205, 16384, 15); \
+    /* 2485/8192 ~= Tan[3*Pi/32] ~= 0.303346683607342 */ \
+    od_mm256_overflow_check(t5, 2485, 4096, 159); \
+    ta = OD_DCT_MLA_EPI32(ta, t5, 2485, 4096, 13); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    od_mm256_overflow_check(t4, 6723, 4096, 160); \
+    tb = OD_DCT_MLS_EPI32(tb, t4, 6723, 4096, 13); \
+    /* 16069/16384 ~= Sin[7*Pi/16] ~= 0.980785280403230 */ \
+    od_mm256_overflow_check(tb, 16069, 8192, 161); \
+    t4 = OD_DCT_MLA_EPI32(t4, tb, 16069, 8192, 14); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    od_mm256_overflow_check(t4, 6723, 4096, 162); \
+    tb = OD_DCT_MLS_EPI32(tb, t4, 6723, 4096, 13); \
+    /* TODO: Can we move this into another operation */ \
+    t5 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t5); \
+    tc = od_mm256_sub_epi32(tc, tf); \
+    tch = od_mm256_unbiased_rshift32(tc, 1); \
+    tf = od_mm256_add_epi32(tf, tch); \
+    t3 = od_mm256_add_epi32(t3, t0); \
+    t3h = od_mm256_unbiased_rshift32(t3, 1); \
+    t0 = od_mm256_sub_epi32(t0, t3h); \
+    td = od_mm256_sub_epi32(td, t1); \
+    tdh = od_mm256_unbiased_rshift32(td, 1); \
+    t1 = od_mm256_add_epi32(t1, tdh); \
+    t2 = od_mm256_add_epi32(t2, te); \
+    t2h = od_mm256_unbiased_rshift32(t2, 1); \
+    te = od_mm256_sub_epi32(te, t2h); \
+    t8 = od_mm256_add_epi32(t8, t4); \
+    t8h = od_mm256_unbiased_rshift32(t8, 1); \
+    t4 = od_mm256_sub_epi32(t8h, t4); \
+    t7 = od_mm256_sub_epi32(tb, t7); \
+    t7h = od_mm256_unbiased_rshift32(t7, 1); \
+    tb = od_mm256_sub_epi32(t7h, tb); \
+    t6 = od_mm256_sub_epi32(t6, ta); \
+    t6h = od_mm256_unbiased_rshift32(t6, 1); \
+    ta = od_mm256_add_epi32(ta, t6h); \
+    t9 = od_mm256_sub_epi32(t5, t9); \
+    t9h = od_mm256_unbiased_rshift32(t9, 1); \
+    t5 = od_mm256_sub_epi32(t5, t9h); \
+    t0 = od_mm256_sub_epi32(t0, t7h); \
+    t7 = od_mm256_add_epi32(t7, t0); \
+    tf = od_mm256_add_epi32(tf, t8h); \
+    t8 = od_mm256_sub_epi32(t8, tf); \
+    te = od_mm256_sub_epi32(te, t6h); \
+    t6 = od_mm256_add_epi32(t6, te); \
+    t1 = od_mm256_add_epi32(t1, t9h); \
+    t9 = od_mm256_sub_epi32(t9, t1); \
+    tb = od_mm256_sub_epi32(tb, tch); \
+    tc = od_mm256_add_epi32(tc, tb); \
+    t4 = od_mm256_add_epi32(t4, t3h); \
+    t3 = od_mm256_sub_epi32(t3, t4); \
+    ta = od_mm256_sub_epi32(ta, tdh); \
+    td = od_mm256_add_epi32(td, ta); \
+    t5 = od_mm256_sub_epi32(t2h, t5); \
+    t2 = od_mm256_sub_epi32(t2, t5); \
+    /* TODO: Can we move these into another operation */ \
+    t8 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t8); \
+    t9 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t9); \
+    ta = od_mm256_sub_epi32(od_mm256_set1_epi32(0), ta); \
+    tb = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tb); \
+    tc = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tc); \
+    td = od_mm256_sub_epi32(od_mm256_set1_epi32(0), td); \
+    tf = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tf); \
+    /* 7799/8192 ~= Tan[31*Pi/128] ~= 0.952079146700925 */ \
+    od_mm256_overflow_check(tf, 7799, 4096, 163); \
+    t0 = OD_DCT_MLS_EPI32(t0, tf, 7799, 4096, 13); \
+    /* 4091/4096 ~= Sin[31*Pi/64] ~= 0.998795456205172 */ \
+    od_mm256_overflow_check(t0, 4091, 2048, 164); \
+    tf = OD_DCT_MLA_EPI32(tf, t0, 4091, 2048, 12); \
+    /* 7799/8192 ~= Tan[31*Pi/128] ~= 0.952079146700925 */ \
+    od_mm256_overflow_check(tf, 7799, 4096, 165); \
+    t0 = OD_DCT_MLS_EPI32(t0, tf, 7799, 4096, 13); \
+    /* 2417/32768 ~= Tan[3*Pi/128] ~= 0.0737644315224493 */ \
+    od_mm256_overflow_check(te, 2417, 16384, 166); \
+    t1 = OD_DCT_MLA_EPI32(t1, te, 2417, 16384, 15); \
+    /* 601/4096 ~= Sin[3*Pi/64] ~= 0.146730474455362 */ \
+    od_mm256_overflow_check(t1, 601, 2048, 167); \
+    te = OD_DCT_MLS_EPI32(te, t1, 601, 2048, 12); \
+    /* 2417/32768 ~= Tan[3*Pi/128] ~= 0.0737644315224493 */ \
+    od_mm256_overflow_check(te, 2417, 16384, 168); \
+    t1 = OD_DCT_MLA_EPI32(t1, te, 2417, 16384, 15); \
+    /* 14525/32768 ~= Tan[17*Pi/128] ~= 0.443269513890864 */ \
+    od_mm256_overflow_check(t8, 14525, 16384, 169); \
+    t7 = OD_DCT_MLS_EPI32(t7, t8, 14525, 16384, 15); \
+    /* 3035/4096 ~= Sin[17*Pi/64] ~= 0.740951125354959 */ \
+    od_mm256_overflow_check(t7, 3035, 2048, 170); \
+    t8 = OD_DCT_MLA_EPI32(t8, t7, 3035, 2048, 12); \
+    /* 7263/16384 ~= Tan[17*Pi/128] ~= 0.443269513890864 */ \
+    od_mm256_overflow_check(t8, 7263, 8192, 171); \
+    t7 = OD_DCT_MLS_EPI32(t7, t8, 7263, 8192, 14); \
+    /* 6393/8192 ~= Tan[27*Pi/128] ~= 0.780407659653944 */ \
+    od_mm256_overflow_check(td, 6393, 4096, 172); \
+    t2 = OD_DCT_MLS_EPI32(t2, td, 6393, 4096, 13); \
+    /* 3973/4096 ~= Sin[27*Pi/64] ~= 0.970031253194544 */ \
+    od_mm256_overflow_check(t2, 3973, 2048, 173); \
+    td = OD_DCT_MLA_EPI32(td, t2, 3973, 2048, 12); \
+    /* 6393/8192 ~= Tan[27*Pi/128] ~= 0.780407659653944 */ \
+    od_mm256_overflow_check(td, 6393, 4096, 174); \
+    t2 = OD_DCT_MLS_EPI32(t2, td, 6393, 4096, 13); \
+    /* 9281/16384 ~= Tan[21*Pi/128] ~= 0.566493002730344 */ \
+    od_mm256_overflow_check(ta, 9281, 8192, 175); \
+    t5 = OD_DCT_MLS_EPI32(t5, ta, 9281, 8192, 14); \
+    /* 7027/8192 ~= Sin[21*Pi/64] ~= 0.857728610000272 */ \
+    od_mm256_overflow_check(t5, 7027, 4096, 176); \
+    ta = OD_DCT_MLA_EPI32(ta, t5, 7027, 4096, 13); \
+    /* 9281/16384 ~= Tan[21*Pi/128] ~= 0.566493002730344 */ \
+    od_mm256_overflow_check(ta, 9281, 8192, 177); \
+    t5 = OD_DCT_MLS_EPI32(t5, ta, 9281, 8192, 14); \
+    /* 11539/16384 ~= Tan[25*Pi/128] ~= 0.704279460865044 */ \
+    od_mm256_overflow_check(tc, 11539, 8192, 178); \
+    t3 = OD_DCT_MLS_EPI32(t3, tc, 11539, 8192, 14); \
+    /* 7713/8192 ~= Sin[25*Pi/64] ~= 0.941544065183021 */ \
+    od_mm256_overflow_check(t3, 7713, 4096, 179); \
+    tc = OD_DCT_MLA_EPI32(tc, t3, 7713, 4096, 13); \
+    /* 11539/16384 ~= Tan[25*Pi/128] ~= 0.704279460865044 */ \
+    od_mm256_overflow_check(tc, 11539, 8192, 180); \
+    t3 = OD_DCT_MLS_EPI32(t3, tc, 11539, 8192, 14); \
+    /* 10375/16384 ~= Tan[23*Pi/128] ~= 0.633243016177569 */ \
+    od_mm256_overflow_check(tb, 10375, 8192, 181); \
+    t4 = OD_DCT_MLS_EPI32(t4, tb, 10375, 8192, 14); \
+    /* 7405/8192 ~= Sin[23*Pi/64] ~= 0.903989293123443 */ \
+    od_mm256_overflow_check(t4, 7405, 4096, 182); \
+    tb = OD_DCT_MLA_EPI32(tb, t4, 7405, 4096, 13); \
+    /* 10375/16384 ~= Tan[23*Pi/128] ~= 0.633243016177569 */ \
+    od_mm256_overflow_check(tb, 10375, 8192, 183); \
+    t4 = OD_DCT_MLS_EPI32(t4, tb, 10375, 8192, 14); \
+    /* 8247/16384 ~= Tan[19*Pi/128] ~= 0.503357699799294 */ \
+    od_mm256_overflow_check(t9, 8247, 8192, 184); \
+    t6 = OD_DCT_MLS_EPI32(t6, t9, 8247, 8192, 14); \
+    /* 1645/2048 ~= Sin[19*Pi/64] ~= 0.803207531480645 */ \
+    od_mm256_overflow_check(t6, 1645, 1024, 185); \
+    t9 = OD_DCT_MLA_EPI32(t9, t6, 1645, 1024, 11); \
+    /* 8247/16384 ~= Tan[19*Pi/128] ~= 0.503357699799294 */ \
+    od_mm256_overflow_check(t9, 8247, 8192, 186); \
+    t6 = OD_DCT_MLS_EPI32(t6, t9, 8247, 8192, 14); \
+  } \
+  while (0)
+
+#define OD_IDST_16_ASYM_EPI32(t0, t0h, t8, t4, tc, t2, t2h, ta, t6, te, teh, \
+ t1, t9, t5, td, t3, tb, t7, tf) \
+  /* Embedded 16-point asymmetric Type-IV iDST. */ \
+  do { \
+    od_m256i t1h_; \
+    od_m256i t3h_; \
+    od_m256i t4h; \
+    od_m256i t6h; \
+    od_m256i t9h_; \
+    od_m256i tbh_; \
+    od_m256i tch; \
+    /* 8247/16384 ~= Tan[19*Pi/128] ~= 0.503357699799294 */ \
+    t6 = OD_DCT_MLA_EPI32(t6, t9, 8247, 8192, 14); \
+    /* 1645/2048 ~= Sin[19*Pi/64] ~= 0.803207531480645 */ \
+    t9 = OD_DCT_MLS_EPI32(t9, t6, 1645, 1024, 11); \
+    /* 8247/16384 ~= Tan[19*Pi/128] ~= 0.503357699799294 */ \
+    t6 = OD_DCT_MLA_EPI32(t6, t9, 8247, 8192, 14); \
+    /* 10375/16384 ~= Tan[23*Pi/128] ~= 0.633243016177569 */ \
+    t2 = OD_DCT_MLA_EPI32(t2, td, 10375, 8192, 14); \
+    /* 7405/8192 ~= Sin[23*Pi/64] ~= 0.903989293123443 */ \
+    td = OD_DCT_MLS_EPI32(td, t2, 7405, 4096, 13); \
+    /* 10375/16384 ~= Tan[23*Pi/128] ~= 0.633243016177569 */ \
+    t2 = OD_DCT_MLA_EPI32(t2, td, 10375, 8192, 14); \
+    /* 11539/16384 ~= Tan[25*Pi/128] ~= 0.704279460865044 */ \
+    tc = OD_DCT_MLA_EPI32(tc, t3, 11539, 8192, 14); \
+    /* 7713/8192 ~= Sin[25*Pi/64] ~= 0.941544065183021 */ \
+    t3 = OD_DCT_MLS_EPI32(t3, tc, 7713, 4096, 13); \
+    /* 11539/16384 ~= Tan[25*Pi/128] ~= 0.704279460865044 */ \
+    tc = OD_DCT_MLA_EPI32(tc, t3, 11539, 8192, 14); \
+    /* 9281/16384 ~= Tan[21*Pi/128] ~= 0.566493002730344 */ \
+    ta = OD_DCT_MLA_EPI32(ta, t5, 9281, 8192, 14); \
+    /* 7027/8192 ~= Sin[21*Pi/64] ~= 0.857728610000272 */ \
+    t5 = OD_DCT_MLS_EPI32(t5, ta, 7027, 4096, 13); \
+    /* 9281/16384 ~= Tan[21*Pi/128] ~= 0.566493002730344 */ \
+    ta = OD_DCT_MLA_EPI32(ta, t5, 9281, 8192, 14); \
+    /* 6393/8192 ~= Tan[27*Pi/128] ~= 0.780407659653944 */ \
+    t4 = OD_DCT_MLA_EPI32(t4, tb, 6393, 4096, 13); \
+    /* 3973/4096 ~= Sin[27*Pi/64] ~= 0.970031253194544 */ \
+    tb = OD_DCT_MLS_EPI32(tb, t4, 3973, 2048, 12); \
+    /* 6393/8192 ~= Tan[27*Pi/128] ~= 0.780407659653944 */ \
+    t4 = OD_DCT_MLA_EPI32(t4, tb, 6393, 4096, 13); \
+    /* 7263/16384 ~= Tan[17*Pi/128] ~= 0.443269513890864 */ \
+    te = OD_DCT_MLA_EPI32(te, t1, 7263, 8192, 14); \
+    /* 3035/4096 ~= Sin[17*Pi/64] ~= 0.740951125354959 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, te, 3035, 2048, 12); \
+    /* 14525/32768 ~= Tan[17*Pi/128] ~= 0.443269513890864 */ \
+    te = OD_DCT_MLA_EPI32(te, t1, 14525, 16384, 15); \
+    /* 2417/32768 ~= Tan[3*Pi/128] ~= 0.0737644315224493 */ \
+    t8 = OD_DCT_MLS_EPI32(t8, t7, 2417, 16384, 15); \
+    /* 601/4096 ~= Sin[3*Pi/64] ~= 0.146730474455362 */ \
+    t7 = OD_DCT_MLA_EPI32(t7, t8, 601, 2048, 12); \
+    /* 2417/32768 ~= Tan[3*Pi/128] ~= 0.0737644315224493 */ \
+    t8 = OD_DCT_MLS_EPI32(t8, t7, 2417, 16384, 15); \
+    /* 7799/8192 ~= Tan[31*Pi/128] ~= 0.952079146700925 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, tf, 7799, 4096, 13); \
+    /* 4091/4096 ~= Sin[31*Pi/64] ~= 0.998795456205172 */ \
+    tf = OD_DCT_MLS_EPI32(tf, t0, 4091, 2048, 12); \
+    /* 7799/8192 ~= Tan[31*Pi/128] ~= 0.952079146700925 */ \
+    t0 = OD_DCT_MLA_EPI32(t0, tf, 7799, 4096, 13); \
+    /* TODO: Can we move these into another operation */ \
+    t1 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t1); \
+    t3 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t3); \
+    t5 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t5); \
+    t9 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t9); \
+    tb = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tb); \
+    td = od_mm256_sub_epi32(od_mm256_set1_epi32(0), td); \
+    tf = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tf); \
+    t4 = od_mm256_add_epi32(t4, ta); \
+    t4h = od_mm256_unbiased_rshift32(t4, 1); \
+    ta = od_mm256_sub_epi32(t4h, ta); \
+    tb = od_mm256_sub_epi32(tb, t5); \
+    tbh_ = od_mm256_unbiased_rshift32(tb, 1); \
+    t5 = od_mm256_add_epi32(t5, tbh_); \
+    tc = od_mm256_add_epi32(tc, t2); \
+    tch = od_mm256_unbiased_rshift32(tc, 1); \
+    t2 = od_mm256_sub_epi32(t2, tch); \
+    t3 = od_mm256_sub_epi32(t3, td); \
+    t3h_ = od_mm256_unbiased_rshift32(t3, 1); \
+    td = od_mm256_add_epi32(td, t3h_); \
+    t9 = od_mm256_add_epi32(t9, t8); \
+    t9h_ = od_mm256_unbiased_rshift32(t9, 1); \
+    t8 = od_mm256_sub_epi32(t8, t9h_); \
+    t6 = od_mm256_sub_epi32(t6, t7); \
+    t6h = od_mm256_unbiased_rshift32(t6, 1); \
+    t7 = od_mm256_add_epi32(t7, t6h); \
+    t1 = od_mm256_add_epi32(t1, tf); \
+    t1h_ = od_mm256_unbiased_rshift32(t1, 1); \
+    tf = od_mm256_sub_epi32(tf, t1h_); \
+    te = od_mm256_sub_epi32(te, t0); \
+    teh = od_mm256_unbiased_rshift32(te, 1); \
+    t0 = od_mm256_add_epi32(t0, teh); \
+    ta = od_mm256_add_epi32(ta, t9h_); \
+    t9 = od_mm256_sub_epi32(ta, t9); \
+    t5 = od_mm256_sub_epi32(t5, t6h); \
+    t6 = od_mm256_add_epi32(t6, t5); \
+    td = od_mm256_sub_epi32(teh, td); \
+    te = od_mm256_sub_epi32(td, te); \
+    t2 = od_mm256_sub_epi32(t1h_, t2); \
+    t1 = od_mm256_sub_epi32(t1, t2); \
+    t7 = od_mm256_add_epi32(t7, t4h); \
+    t4 = od_mm256_sub_epi32(t4, t7); \
+    t8 = od_mm256_sub_epi32(t8, tbh_); \
+    tb = od_mm256_add_epi32(tb, t8); \
+    t0 = od_mm256_add_epi32(t0, tch); \
+    tc = od_mm256_sub_epi32(tc, t0); \
+    tf = od_mm256_sub_epi32(tf, t3h_); \
+    t3 = od_mm256_add_epi32(t3, tf); \
+    /* TODO: Can we move this into another operation */ \
+    ta = od_mm256_sub_epi32(od_mm256_set1_epi32(0), ta); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    td = OD_DCT_MLA_EPI32(td, t2, 6723, 4096, 13); \
+    /* 16069/16384 ~= Sin[7*Pi/16] ~= 0.980785280403230 */ \
+    t2 = OD_DCT_MLS_EPI32(t2, td, 16069, 8192, 14); \
+    /* 6723/8192 ~= Tan[7*Pi/32] ~= 0.820678790828660 */ \
+    td = OD_DCT_MLA_EPI32(td, t2, 6723, 4096, 13); \
+    /* 2485/8192 ~= Tan[3*Pi/32] ~= 0.303346683607342 */ \
+    t5 = OD_DCT_MLS_EPI32(t5, ta, 2485, 4096, 13); \
+    /* 18205/32768 ~= Sin[3*Pi/16] ~= 0.555570233019602 */ \
+    ta = OD_DCT_MLA_EPI32(ta, t5, 18205, 16384, 15); \
+    /* 2485/8192 ~= Tan[3*Pi/32] ~= 0.303346683607342 */ \
+    t5 = OD_DCT_MLS_EPI32(t5, ta, 2485, 4096, 13); \
+    t2 = od_mm256_add_epi32(t2, t5); \
+    t2h = od_mm256_unbiased_rshift32(t2, 1); \
+    t5 = od_mm256_sub_epi32(t5, t2h); \
+    ta = od_mm256_sub_epi32(td, ta); \
+    td = od_mm256_sub_epi32(td, od_mm256_unbiased_rshift32(ta, 1)); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    ta = OD_DCT_MLS_EPI32(ta, t5, 13573, 8192, 14); \
+    /* 11585/32768 ~= Sin[Pi/4]/2 ~= 0.353553390593274 */ \
+    t5 = OD_DCT_MLA_EPI32(t5, ta, 11585, 16384, 15); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    ta = OD_DCT_MLS_EPI32(ta, t5, 13573, 8192, 14); \
+    /* 17515/32768 ~= Tan[5*Pi/32] ~= 0.534511135950792 */ \
+    t9 = OD_DCT_MLS_EPI32(t9, t6, 17515, 16384, 15); \
+    /* 13623/16384 ~= Sin[5*Pi/16] ~= 0.831469612302545 */ \
+    t6 = OD_DCT_MLA_EPI32(t6, t9, 13623, 8192, 14); \
+    /* 17515/32768 ~= Tan[5*Pi/32]) ~= 0.534511135950792 */ \
+    t9 = OD_DCT_MLS_EPI32(t9, t6, 17515, 16384, 15); \
+    /* 6723/8192 ~= Tan[7*Pi/32]) ~= 0.820678790828660 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, te, 6723, 4096, 13); \
+    /* 16069/16384 ~= Sin[7*Pi/16] ~= 0.980785280403230 */ \
+    te = OD_DCT_MLA_EPI32(te, t1, 16069, 8192, 14); \
+    /* 6723/8192 ~= Tan[7*Pi/32]) ~= 0.820678790828660 */ \
+    t1 = OD_DCT_MLS_EPI32(t1, te, 6723, 4096, 13); \
+    te = od_mm256_add_epi32(te, t6); \
+    teh = od_mm256_unbiased_rshift32(te, 1); \
+    t6 = od_mm256_sub_epi32(teh, t6); \
+    t9 = od_mm256_add_epi32(t9, t1); \
+    t1 = od_mm256_sub_epi32(t1, od_mm256_unbiased_rshift32(t9, 1)); \
+    /* -19195/32768 ~= Tan[Pi/8] - Tan[Pi/4] ~= -0.585786437626905 */ \
+    t9 = OD_DCT_MLS_EPI32(t9, t6, 19195, 16384, 15); \
+    /* 11585/16384 ~= Sin[Pi/4] ~= 0.707106781186548 */ \
+    t6 = OD_DCT_MLS_EPI32(t6, t9, 11585, 8192, 14); \
+    /* 7489/8192 ~= Tan[Pi/8] + Tan[Pi/4]/2 ~= 0.914213562373095 */ \
+    t9 = OD_DCT_MLA_EPI32(t9, t6, 7489, 4096, 13); \
+    tb = od_mm256_sub_epi32(tc, tb); \
+    tc = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(tb, 1), tc); \
+    t3 = od_mm256_add_epi32(t3, t4); \
+    t4 = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(t3, 1), t4); \
+    /* TODO: Can we move this into another operation */ \
+    t3 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t3); \
+    t8 = od_mm256_add_epi32(t8, tf); \
+    tf = od_mm256_sub_epi32(od_mm256_unbiased_rshift32(t8, 1), tf); \
+    t0 = od_mm256_add_epi32(t0, t7); \
+    t0h = od_mm256_unbiased_rshift32(t0, 1); \
+    t7 = od_mm256_sub_epi32(t0h, t7); \
+    /* 4161/16384 ~= Tan[3*Pi/16] - Tan[Pi/8] ~= 0.253965075546204 */ \
+    t3 = OD_DCT_MLA_EPI32(t3, tc, 4161, 8192, 14); \
+    /* 15137/16384 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    tc = OD_DCT_MLS_EPI32(tc, t3, 15137, 8192, 14); \
+    /* 14341/16384 ~= Tan[3*Pi/16] + Tan[Pi/8]/2 ~= 0.875285419105846 */ \
+    t3 = OD_DCT_MLA_EPI32(t3, tc, 14341, 8192, 14); \
+    /* 14341/16384 ~= Tan[3*Pi/16] + Tan[Pi/8]/2 ~= 0.875285419105846 */ \
+    t4 = OD_DCT_MLS_EPI32(t4, tb, 14341, 8192, 14); \
+    /* 15137/16384 ~= Sin[3*Pi/8] ~= 0.923879532511287 */ \
+    tb = OD_DCT_MLA_EPI32(tb, t4, 15137, 8192, 14); \
+    /* 4161/16384 ~= Tan[3*Pi/16] - Tan[Pi/8] ~= 0.253965075546204 */ \
+    t4 = OD_DCT_MLS_EPI32(t4, tb, 4161, 8192, 14); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    t8 = OD_DCT_MLA_EPI32(t8, t7, 13573, 8192, 14); \
+    /* 11585/32768 ~= Sin[Pi/4]/2 ~= 0.353553390593274 */ \
+    t7 = OD_DCT_MLS_EPI32(t7, t8, 11585, 16384, 15); \
+    /* 13573/16384 ~= 2*Tan[Pi/8] ~= 0.828427124746190 */ \
+    t8 = OD_DCT_MLA_EPI32(t8, t7, 13573, 8192, 14); \
+    /* TODO: Can we move these into another operation */ \
+    t1 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t1); \
+    t5 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t5); \
+    t9 = od_mm256_sub_epi32(od_mm256_set1_epi32(0), t9); \
+    tb = od_mm256_sub_epi32(od_mm256_set1_epi32(0), tb); \
+    td = od_mm256_sub_epi32(od_mm256_set1_epi32(0), td); \
+  } \
+  while (0)
+
+#define OD_FDCT_32_EPI32(t0, tg, t8, to, t4, tk, tc, ts, t2, ti, ta, tq, t6, \
+ tm, te, tu, t1, th, t9, tp, t5, tl, td, tt, t3, tj, tb, tr, t7, tn, tf, tv) \
+  /* Embedded 32-point orthonormal Type-II fDCT. */ \
+  do { \
+    od_m256i tgh; \
+    od_m256i thh; \
+    od_m256i tih; \
+    od_m256i tkh; \
+    od_m256i tmh; \
+    od_m256i tnh; \
+    od_m256i toh; \
+    od_m256i tqh; \
+    od_m256i tsh; \
+    od_m256i tuh; \
+    od_m256i tvh; \
+    tv = od_mm256_sub_epi32(t0, tv); \
+    tvh = od_mm256_unbiased_rshift32(tv, 1); \
+    t0 = od_mm256_sub_epi32(t0, tvh); \
+    tu = od_mm256_add_epi32(tu, t1); \
+    tuh = od_mm256_unbiased_rshift32(tu, 1); \
+    t1 = od_mm256_sub_epi32(tuh, t1); \
+    tt = od_mm256_sub_epi32(t2, tt); \
+    t2 = od_mm256_sub_epi32(t2, od_mm256_unbiased_rshift32(tt, 1)); \
+    ts = od_mm256_add_epi32(ts, t3); \
+    tsh = od_mm256_unbiased_rshift32(ts, 1); \
+    t3 = od_mm256_sub_epi32(tsh, t3); \
+    tr = od_mm256_sub_epi32(t4, tr); \
+    t4 = od_mm256_sub_epi32(t4, od_mm256_unbiased_rshift32(tr, 1)); \
+    tq = od_mm256_add_epi32(tq, t5); \
+    tqh = od_mm256_unbiased_rshift32(tq, 1); \
+    t5 = od_mm256_sub_epi32(tqh, t5); \
+    tp = od_mm256_sub_epi32(t6, tp); \
+    t6 = od_mm256_sub_epi32(t6, od_mm256_unbiased_rshift32(tp, 1)); \
+    to = od_mm256_add_epi32(to, t7); \
+    toh = od_mm256_unbiased_rshift32(to, 1); \
+    t7 = od_mm256_sub_epi32(toh, t7); \
+    tn = od_mm256_sub_epi32(t8, tn); \
+    tnh = od_mm256_unbiased_rshift32(tn, 1); \
+    t8 = od_mm256_sub_epi32(t8, tnh); \
+    tm = od_mm256_add_epi32(tm, t9); \
+    tmh = od_mm256_unbiased_rshift32(tm, 1); \
+    t9 = od_mm256_sub_epi32(tmh, t9); \
+    tl = od_mm256_sub_epi32(ta, tl); \
+    ta = od_mm256_sub_epi32(ta, od_mm256_unbiased_rshift32(tl, 1)); \
+    tk = od_mm256_add_epi32(tk, tb); \
+    tkh = od_mm256_unbiased_rshift32(tk, 1); \
+    tb = od_mm256_sub_epi32(tkh, tb); \
+    tj = od_mm256_sub_epi32(tc, tj); \
+    tc = od_mm256_sub_epi32(tc, od_mm256_unbiased_rshift32(tj, 1)); \
+    ti = od_mm256_add_epi32(ti, td); \
+    tih = od_mm256_unbiased_rshift32(ti, 1); \
+    td = od_mm256_sub_epi32(tih, td); \
+    th = od_mm256_sub_epi32(te, th); \
+    thh = od_mm256_unbiased_rshift32(th, 1); \
+    te = od_mm256_sub_epi32(te, thh); \
+    tg = od_mm256_add_epi32(tg, tf); \
+    tgh = od_mm256_unbiased_rshift32(tg, 1); \
+    tf = od_mm256_sub_epi32(tgh, tf); \
+    OD_FDCT_16_ASYM_EPI32(t0, tg, tgh, t8, to, toh, t4, tk, tkh, tc, ts, tsh, \
+     t2, ti, tih, ta, tq, tqh, t6, tm, tmh, te, tu, tuh); \
+    OD_FDST_16_ASYM_EPI32(tv, tvh, tf, tn, tnh, t7, tr, tb, tj, t3, \
+     tt, td, tl, t5, tp, t9, th, thh, t1); \
+  } \
+  while (0)
+
+#define OD_IDCT_32_EPI32(t0, tg, t8, to, t4, tk, tc, ts, t2, ti, ta, tq, t6, \
+ tm, te, tu, t1, th, t9, tp, t5, tl, td, tt, t3, tj, tb, tr, t7, tn, tf, tv) \
+  /* Embedded 32-point orthonormal Type-II iDCT. */ \
+  do { \
+    od_m256i t1h; \
+    od_m256i t3h; \
+    od_m256i t5h; \
+    od_m256i t7h; \
+    od_m256i t9h; \
+    od_m256i tbh; \
+    od_m256i tdh; \
+    od_m256i tfh; \
+    od_m256i thh; \
+    od_m256i tth; \
+    od_m256i tvh; \
+    OD_IDST_16_ASYM_EPI32(tv, tvh, tn, tr, tj, tt, tth, tl, tp, th, thh, \
+     tu, tm, tq, ti, ts, tk, to, tg); \
+    OD_IDCT_16_ASYM_EPI32(t0, t8, t4, tc, t2, ta, t6, te, \
+     t1, t1h, t9, t9h, t5, t5h, td, tdh, t3, t3h, tb, tbh, t7, t7h, tf, tfh); \
+    tu = od_mm256_sub_epi32(t1h, tu); \
+    t1 = od_mm256_sub_epi32(t1, tu); \
+    te = od_mm256_add_epi32(te, thh); \
+    th = od_mm256_sub_epi32(te, th); \
+    tm = od_mm256_sub_epi32(t9h, tm); \
+    t9 = od_mm256_sub_epi32(t9, tm); \
+    t6 = od_mm256_add_epi32(t6, od_mm256_unbiased_rshift32(tp, 1)); \
+    tp = od_mm256_sub_epi32(t6, tp); \
+    tq = od_mm256_sub_epi32(t5h, tq); \
+    t5 = od_mm256_sub_epi32(t5, tq); \
+    ta = od_mm256_add_epi32(ta, od_mm256_unbiased_rshift32(tl, 1)); \
+    tl = od_mm256_sub_epi32(ta, tl); \
+    ti = od_mm256_sub_epi32(tdh, ti); \
+    td = od_mm256_sub_epi32(td, ti); \
+    t2 = od_mm256_add_epi32(t2, tth); \
+    tt = od_mm256_sub_epi32(t2, tt); \
+    ts = od_mm256_sub_epi32(t3h, ts); \
+    t3 = od_mm256_sub_epi32(t3, ts); \
+    tc = od_mm256_add_epi32(tc, od_mm256_unbiased_rshift32(tj, 1)); \
+    tj = od_mm256_sub_epi32(tc, tj); \
+    tk = od_mm256_sub_epi32(tbh, tk); \
+    tb = od_mm256_sub_epi32(tb, tk); \
+    t4 = od_mm256_add_epi32(t4, od_mm256_unbiased_rshift32(tr, 1)); \
+    tr = od_mm256_sub_epi32(t4, tr); \
+    to = od_mm256_sub_epi32(t7h, to); \
+    t7 = od_mm256_sub_epi32(t7, to); \
+    t8 = od_mm256_add_epi32(t8, od_mm256_unbiased_rshift32(tn, 1)); \
+    tn = od_mm256_sub_epi32(t8, tn); \
+    tg = od_mm256_sub_epi32(tfh, tg); \
+    tf = od_mm256_sub_epi32(tf, tg); \
+    t0 = od_mm256_add_epi32(t0, tvh); \
+    tv = od_mm256_sub_epi32(t0, tv); \
+  } \
+  while (0)
+
+OD_SIMD_INLINE void fdct32_kernel(od_m256i *y, const od_m256i *x) {
+  /*215 adds, 38 shifts, 87 "muls".*/
+  od_m256i t0;
+  od_m256i t1;
+  od_m256i t2;
+  od_m256i t3;
+  od_m256i t4;
+  od_m256i t5;
+  od_m256i t6;
+  od_m256i t7;
+  od_m256i t8;
+  od_m256i t9;
+  od_m256i ta;
+  od_m256i tb;
+  od_m256i tc;
+  od_m256i td;
+  od_m256i te;
+  od_m256i tf;
+  od_m256i tg;
+  od_m256i th;
+  od_m256i ti;
+  od_m256i tj;
+  od_m256i tk;
+  od_m256i tl;
+  od_m256i tm;
+  od_m256i tn;
+  od_m256i to;
+  od_m256i tp;
+  od_m256i tq;
+  od_m256i tr;
+  od_m256i ts;
+  od_m256i tt;
+  od_m256i tu;
+  od_m256i tv;
+  t0 = x[0];
+  tg = x[1];
+  t8 = x[2];
+  to = x[3];
+  t4 = x[4];
+  tk = x[5];
+  tc = x[6];
+  ts = x[7];
+  t2 = x[8];
+  ti = x[9];
+  ta = x[10];
+  tq = x[11];
+  t6 = x[12];
+  tm = x[13];
+  te = x[14];
+  tu = x[15];
+  t1 = x[16];
+  th = x[17];
+  t9 = x[18];
+  tp = x[19];
+  t5 = x[20];
+  tl = x[21];
+  td = x[22];
+  tt = x[23];
+  t3 = x[24];
+  tj = x[25];
+  tb = x[26];
+  tr = x[27];
+  t7 = x[28];
+  tn = x[29];
+  tf = x[30];
+  tv = x[31];
+  OD_FDCT_32_EPI32(t0, tg, t8, to, t4, tk, tc, ts, t2, ti, ta, tq, t6, tm, te,
+   tu, t1, th, t9, tp, t5, tl, td, tt, t3, tj, tb, tr, t7, tn, tf, tv);
+  y[0] = t0;
+  y[1] = t1;
+  y[2] = t2;
+  y[3] = t3;
+  y[4] = t4;
+  y[5] = t5;
+  y[6] = t6;
+  y[7] = t7;
+  y[8] = t8;
+  y[9] = t9;
+  y[10] = ta;
+  y[11] = tb;
+  y[12] = tc;
+  y[13] = td;
+  y[14] = te;
+  y[15] = tf;
+  y[16] = tg;
+  y[17] = th;
+  y[18] = ti;
+  y[19] = tj;
+  y[20] = tk;
+  y[21] = tl;
+  y[22] = tm;
+  y[23] = tn;
+  y[24] = to;
+  y[25] = tp;
+  y[26] = tq;
+  y[27] = tr;
+  y[28] = ts;
+  y[29] = tt;
+  y[30] = tu;
+  y[31] = tv;
+}
+
+OD_SIMD_INLINE void idct32_kernel(od_m256i *x, const od_m256i *y) {
+  od_m256i t0;
+  od_m256i t1;
+  od_m256i t2;
+  od_m256i t3;
+  od_m256i t4;
+  od_m256i t5;
+  od_m256i t6;
+  od_m256i t7;
+  od_m256i t8;
+  od_m256i t9;
+  od_m256i ta;
+  od_m256i tb;
+  od_m256i tc;
+  od_m256i td;
+  od_m256i te;
+  od_m256i tf;
+  od_m256i tg;
+  od_m256i th;
+  od_m256i ti;
+  od_m256i tj;
+  od_m256i tk;
+  od_m256i tl;
+  od_m256i tm;
+  od_m256i tn;
+  od_m256i to;
+  od_m256i tp;
+  od_m256i tq;
+  od_m256i tr;
+  od_m256i ts;
+  od_m256i tt;
+  od_m256i tu;
+  od_m256i tv;
+  t0 = y[0];
+  tg = y[1];
+  t8 = y[2];
+  to = y[3];
+  t4 = y[4];
+  tk = y[5];
+  tc = y[6];
+  ts = y[7];
+  t2 = y[8];
+  ti = y[9];
+  ta = y[10];
+  tq = y[11];
+  t6 = y[12];
+  tm = y[13];
+  te = y[14];
+  tu = y[15];
+  t1 = y[16];
+  th = y[17];
+  t9 = y[18];
+  tp = y[19];
+  t5 = y[20];
+  tl = y[21];
+  td = y[22];
+  tt = y[23];
+  t3 = y[24];
+  tj = y[25];
+  tb = y[26];
+  tr = y[27];
+  t7 = y[28];
+  tn = y[29];
+  tf = y[30];
+  tv = y[31];
+  OD_IDCT_32_EPI32(t0, tg, t8, to, t4, tk, tc, ts, t2, ti, ta, tq, t6, tm, te,
+   tu, t1, th, t9, tp, t5, tl, td, tt, t3, tj, tb, tr, t7, tn, tf, tv);
+  x[0] = t0;
+  x[1] = t1;
+  x[2] = t2;
+  x[3] = t3;
+  x[4] = t4;
+  x[5] = t5;
+  x[6] = t6;
+  x[7] = t7;
+  x[8] = t8;
+  x[9] = t9;
+  x[10] = ta;
+  x[11] = tb;
+  x[12] = tc;
+  x[13] = td;
+  x[14] = te;
+  x[15] = tf;
+  x[16] = tg;
+  x[17] = th;
+  x[18] = ti;
+  x[19] = tj;
+  x[20] = tk;
+  x[21] = tl;
+  x[22] = tm;
+  x[23] = tn;
+  x[24] = to;
+  x[25] = tp;
+  x[26] = tq;
+  x[27] = tr;
+  x[28] = ts;
+  x[29] = tt;
+  x[30] = tu;
+  x[31] = tv;
+}
+
+OD_SIMD_INLINE void od_mm256_load_rows(od_m256i *t, const od_coeff *x,
+ int xstride, int n) {
+  int i;
+  for (i = 0; i < n; i++) {
+    t[i] = od_mm256_loadu_si256((const od_m256i *)(x + i*xstride));
+  }
+}
+
+OD_SIMD_INLINE void od_mm256_store_rows(od_coeff *x, int xstride,
+ const od_m256i *t, int n) {
+  int i;
+  for (i = 0; i < n; i++) {
+    od_mm256_storeu_si256((od_m256i *)(x + i*xstride), t[i]);
+  }
+}
+
+/*Loads 8 rows of n columns so that t[i] holds column i.*/
+OD_SIMD_INLINE void od_mm256_load_transposed(od_m256i *t, const od_coeff *x,
+ int xstride, int n) {
+  int i;
+  for (i = 0; i < n; i += 8) {
+    load8(x + i, xstride, t + i, t + i + 1, t + i + 2, t + i + 3,
+     t + i + 4, t + i + 5, t + i + 6, t + i + 7);
+    od_mm256_transpose8(t + i, t + i + 1, t + i + 2, t + i + 3,
+     t + i + 4, t + i + 5, t + i + 6, t + i + 7);
+  }
+}
+
+/*Stores t[i] to column i of 8 rows of n columns.*/
+OD_SIMD_INLINE void od_mm256_store_transposed(od_coeff *x, int xstride,
+ od_m256i *t, int n) {
+  int i;
+  for (i = 0; i < n; i += 8) {
+    od_mm256_transpose8(t + i, t + i + 1, t + i + 2, t + i + 3,
+     t + i + 4, t + i + 5, t + i + 6, t + i + 7);
+    store8(x + i, xstride, t[i], t[i + 1], t[i + 2], t[i + 3],
+     t[i + 4], t[i + 5], t[i + 6], t[i + 7]);
+  }
+}
+
+/*The 2-D transforms below work on strips of 8 columns (or rows) at a time,
+   with each lane of a vector computing one of the 1-D transforms of the C
+   version, so that the output is bit-exact.
+  The first pass writes its output transposed, just like the C version.*/
+
+void od_bin_fdct16x16_x86(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride) {
+  OD_ALIGN16(od_coeff z[16*16]);
+  od_m256i t[16];
+  int i;
+#if defined(OD_CHECKASM)
+  od_coeff ref[16*16];
+  od_bin_fdct16x16(ref, 16, x, xstride);
+#endif
+  for (i = 0; i < 16; i += 8) {
+    od_mm256_load_rows(t, x + i, xstride, 16);
+    fdct16_kernel(t, t);
+    od_mm256_store_transposed(z + 16*i, 16, t, 16);
+  }
+  for (i = 0; i < 16; i += 8) {
+    od_mm256_load_rows(t, z + i, 16, 16);
+    fdct16_kernel(t, t);
+    od_mm256_store_transposed(y + ystride*i, ystride, t, 16);
+  }
+#if defined(OD_CHECKASM)
+  od_dct_check(2, ref, y, ystride);
+#endif
+}
+
+void od_bin_idct16x16_x86(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride) {
+  OD_ALIGN16(od_coeff z[16*16]);
+  od_m256i t[16];
+  int i;
+#if defined(OD_CHECKASM)
+  od_coeff ref[16*16];
+  od_bin_idct16x16(ref, 16, y, ystride);
+#endif
+  for (i = 0; i < 16; i += 8) {
+    od_mm256_load_transposed(t, y + ystride*i, ystride, 16);
+    idct16_kernel(t, t);
+    od_mm256_store_rows(z + i, 16, t, 16);
+  }
+  for (i = 0; i < 16; i += 8) {
+    od_mm256_load_transposed(t, z + 16*i, 16, 16);
+    idct16_kernel(t, t);
+    od_mm256_store_rows(x + i, xstride, t, 16);
+  }
+#if defined(OD_CHECKASM)
+  od_dct_check(2, ref, x, xstride);
+#endif
+}
+
+void od_bin_fdct32x32_x86(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride) {
+  OD_ALIGN16(od_coeff z[32*32]);
+  od_m256i t[32];
+  int i;
+#if defined(OD_CHECKASM)
+  od_coeff ref[32*32];
+  od_bin_fdct32x32(ref, 32, x, xstride);
+#endif
+  for (i = 0; i < 32; i += 8) {
+    od_mm256_load_rows(t, x + i, xstride, 32);
+    fdct32_kernel(t, t);
+    od_mm256_store_transposed(z + 32*i, 32, t, 32);
+  }
+  for (i = 0; i < 32; i += 8) {
+    od_mm256_load_rows(t, z + i, 32, 32);
+    fdct32_kernel(t, t);
+    od_mm256_store_transposed(y + ystride*i, ystride, t, 32);
+  }
+#if defined(OD_CHECKASM)
+  od_dct_check(3, ref, y, ystride);
+#endif
+}
+
+void od_bin_idct32x32_x86(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride) {
+  OD_ALIGN16(od_coeff z[32*32]);
+  od_m256i t[32];
+  int i;
+#if defined(OD_CHECKASM)
+  od_coeff ref[32*32];
+  od_bin_idct32x32(ref, 32, y, ystride);
+#endif
+  for (i = 0; i < 32; i += 8) {
+    od_mm256_load_transposed(t, y + ystride*i, ystride, 32);
+    idct32_kernel(t, t);
+    od_mm256_store_rows(z + i, 32, t, 32);
+  }
+  for (i = 0; i < 32; i += 8) {
+    od_mm256_load_transposed(t, z + 32*i, 32, 32);
+    idct32_kernel(t, t);
+    od_mm256_store_rows(x + i, xstride, t, 32);
+  }
+#if defined(OD_CHECKASM)
+  od_dct_check(3, ref, x, xstride);
+#endif
+}
+
+/*The 64-point transforms are computed in double precision.
+  Each lane performs exactly the same sequence of multiplies and adds as
+   od_bin_fdct64() and od_bin_idct64(), which is why these do not use FMA or
+   reassociate the sums.*/
+
+OD_SIMD_INLINE void fdct64_kernel(od_m256i *y, const od_m256i *x) {
+  od_m256d xd[64][2];
+  od_m256d norm;
+  od_m256d half;
+  int i;
+  int j;
+  for (j = 0; j < 64; j++) {
+    xd[j][0] = od_mm256_cvtepi32lo_pd(x[j]);
+    xd[j][1] = od_mm256_cvtepi32hi_pd(x[j]);
+  }
+  norm = od_mm256_set1_pd(sqrt(2.0/64));
+  half = od_mm256_set1_pd(0.5);
+  for (i = 0; i < 64; i++) {
+    od_m256d sum0;
+    od_m256d sum1;
+    sum0 = sum1 = od_mm256_set1_pd(0);
+    for (j = 0; j < 64; j++) {
+      od_m256d c;
+      c = od_mm256_set1_pd(OD_COS_TABLE64[(i*(2*j + 1)) & 0xff]);
+      sum0 = od_mm256_add_pd(sum0, od_mm256_mul_pd(xd[j][0], c));
+      sum1 = od_mm256_add_pd(sum1, od_mm256_mul_pd(xd[j][1], c));
+    }
+    sum0 = od_mm256_mul_pd(norm, sum0);
+    sum1 = od_mm256_mul_pd(norm, sum1);
+    if (i == 0) {
+      sum0 = od_mm256_mul_pd(sum0, od_mm256_set1_pd(M_SQRT1_2));
+      sum1 = od_mm256_mul_pd(sum1, od_mm256_set1_pd(M_SQRT1_2));
+    }
+    y[i] = od_mm256_cvttpd_epi32(
+     od_mm256_floor_pd(od_mm256_add_pd(half, sum0)),
+     od_mm256_floor_pd(od_mm256_add_pd(half, sum1)));
+  }
+}
+
+OD_SIMD_INLINE void idct64_kernel(od_m256i *x, const od_m256i *y) {
+  od_m256d yd[64][2];
+  od_m256d norm;
+  od_m256d half;
+  od_m256d sqrt1_2;
+  int i;
+  int j;
+  for (j = 0; j < 64; j++) {
+    yd[j][0] = od_mm256_cvtepi32lo_pd(y[j]);
+    yd[j][1] = od_mm256_cvtepi32hi_pd(y[j]);
+  }
+  norm = od_mm256_set1_pd(sqrt(2.0/64));
+  half = od_mm256_set1_pd(0.5);
+  sqrt1_2 = od_mm256_set1_pd(M_SQRT1_2);
+  for (i = 0; i < 64; i++) {
+    od_m256d sum0;
+    od_m256d sum1;
+    sum0 = od_mm256_mul_pd(yd[0][0], sqrt1_2);
+    sum1 = od_mm256_mul_pd(yd[0][1], sqrt1_2);
+    for (j = 1; j < 64; j++) {
+      od_m256d c;
+      c = od_mm256_set1_pd(OD_COS_TABLE64[(j*(2*i + 1)) & 0xff]);
+      sum0 = od_mm256_add_pd(sum0, od_mm256_mul_pd(yd[j][0], c));
+      sum1 = od_mm256_add_pd(sum1, od_mm256_mul_pd(yd[j][1], c));
+    }
+    x[i] = od_mm256_cvttpd_epi32(
+     od_mm256_floor_pd(od_mm256_add_pd(half, od_mm256_mul_pd(norm, sum0))),
+     od_mm256_floor_pd(od_mm256_add_pd(half, od_mm256_mul_pd(norm, sum1))));
+  }
+}
+
+void od_bin_fdct64x64_x86(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride) {
+  OD_ALIGN16(od_coeff z[64*64]);
+  od_m256i t[64];
+  int i;
+#if defined(OD_CHECKASM)
+  od_coeff ref[64*64];
+  od_bin_fdct64x64(ref, 64, x, xstride);
+#endif
+  for (i = 0; i < 64; i += 8) {
+    od_mm256_load_rows(t, x + i, xstride, 64);
+    fdct64_kernel(t, t);
+    od_mm256_store_transposed(z + 64*i, 64, t, 64);
+  }
+  for (i = 0; i < 64; i += 8) {
+    od_mm256_load_rows(t, z + i, 64, 64);
+    fdct64_kernel(t, t);
+    od_mm256_store_transposed(y + ystride*i, ystride, t, 64);
+  }
+#if defined(OD_CHECKASM)
+  od_dct_check(4, ref, y, ystride);
+#endif
+}
+
+void od_bin_idct64x64_x86(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride) {
+  OD_ALIGN16(od_coeff z[64*64]);
+  od_m256i t[64];
+  int i;
+#if defined(OD_CHECKASM)
+  od_coeff ref[64*64];
+  od_bin_idct64x64(ref, 64, y, ystride);
+#endif
+  for (i = 0; i < 64; i += 8) {
+    od_mm256_load_transposed(t, y + ystride*i, ystride, 64);
+    idct64_kernel(t, t);
+    od_mm256_store_rows(z + i, 64, t, 64);
+  }
+  for (i = 0; i < 64; i += 8) {
+    od_mm256_load_transposed(t, z + 64*i, 64, 64);
+    idct64_kernel(t, t);
+    od_mm256_store_rows(x + i, xstride, t, 64);
+  }
+#if defined(OD_CHECKASM)
+  od_dct_check(4, ref, x, xstride);
+#endif
+}
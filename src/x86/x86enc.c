@@ -33,13 +33,80 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 
 #include <stdio.h>
 
+#if defined(OD_CHECKASM)
+void od_pvq_search_pulses_check(const od_coeff *y0, int32_t xy0, int32_t yy0,
+ const int16_t *x, int n, int i, int k, const od_coeff *y, int32_t xy,
+ int32_t yy) {
+  od_coeff ref_y[OD_MAX_PVQ_SIZE];
+  int failed;
+  int j;
+  OD_COPY(ref_y, y0, n);
+  od_pvq_search_pulses_c(ref_y, &xy0, &yy0, x, n, i, k);
+  failed = xy != xy0 || yy != yy0;
+  for (j = 0; j < n; j++) {
+    if (ref_y[j] != y[j]) {
+      fprintf(stderr, "ASM mismatch: %i!=%i @ (%i)\n", ref_y[j], y[j], j);
+      failed = 1;
+    }
+  }
+  if (failed) {
+    fprintf(stderr, "od_pvq_search_pulses (n %i, %i to %i pulses) check "
+     "failed.\n", n, i, k);
+  }
+  OD_ASSERT(!failed);
+}
+#endif
+
 void od_enc_opt_vtbl_init_x86(od_enc_ctx *enc) {
   od_enc_opt_vtbl_init_c(enc);
-#if defined(OD_GCC_INLINE_ASSEMBLY)
   if (enc->state.full_precision_references) {
-    /*16-bit routines will go here.*/
+#if defined(OD_SSE41_INTRINSICS)
+    if (enc->state.cpu_flags & OD_CPU_X86_SSE4_1) {
+      enc->opt_vtbl.mc_compute_sad_4x4 =
+       od_mc_compute_sad16_4x4_sse41;
+      enc->opt_vtbl.mc_compute_sad_8x8 =
+       od_mc_compute_sad16_8x8_sse41;
+      enc->opt_vtbl.mc_compute_sad_16x16 =
+       od_mc_compute_sad16_16x16_sse41;
+      enc->opt_vtbl.mc_compute_sad_32x32 =
+       od_mc_compute_sad16_32x32_sse41;
+      enc->opt_vtbl.mc_compute_sad_64x64 =
+       od_mc_compute_sad16_64x64_sse41;
+      enc->opt_vtbl.mc_compute_satd_4x4 =
+       od_mc_compute_satd16_4x4_sse41;
+      enc->opt_vtbl.mc_compute_satd_8x8 =
+       od_mc_compute_satd16_8x8_sse41;
+      enc->opt_vtbl.mc_compute_satd_16x16 =
+       od_mc_compute_satd16_16x16_sse41;
+      enc->opt_vtbl.mc_compute_satd_32x32 =
+       od_mc_compute_satd16_32x32_sse41;
+      enc->opt_vtbl.mc_compute_satd_64x64 =
+       od_mc_compute_satd16_64x64_sse41;
+    }
+#endif
+#if defined(OD_AVX2_INTRINSICS)
+    /*The 4x4 and 8x8 SADs and the 4x4 SATD are too narrow to gain anything
+       from 256-bit vectors, so they stay on SSE4.1.*/
+    if (enc->state.cpu_flags & OD_CPU_X86_AVX2) {
+      enc->opt_vtbl.mc_compute_sad_16x16 =
+       od_mc_compute_sad16_16x16_avx2;
+      enc->opt_vtbl.mc_compute_sad_32x32 =
+       od_mc_compute_sad16_32x32_avx2;
+      enc->opt_vtbl.mc_compute_sad_64x64 =
+       od_mc_compute_sad16_64x64_avx2;
+      enc->opt_vtbl.mc_compute_satd_8x8 =
+       od_mc_compute_satd16_8x8_avx2;
+      enc->opt_vtbl.mc_compute_satd_16x16 =
+       od_mc_compute_satd16_16x16_avx2;
+      enc->opt_vtbl.mc_compute_satd_32x32 =
+       od_mc_compute_satd16_32x32_avx2;
+      enc->opt_vtbl.mc_compute_satd_64x64 =
+       od_mc_compute_satd16_64x64_avx2;
+    }
+#endif
   }
   else{
+#if defined(OD_GCC_INLINE_ASSEMBLY)
     /*8-bit routines go here.*/
     if (enc->state.cpu_flags & OD_CPU_X86_SSE) {
       enc->opt_vtbl.mc_compute_sad_4x4 =
@@ -65,6 +132,32 @@ void od_enc_opt_vtbl_init_x86(od_enc_ctx *enc) {
       enc->opt_vtbl.mc_compute_satd_64x64 =
        od_mc_compute_satd8_64x64_sse2;
     }
+#endif
+#if defined(OD_AVX2_INTRINSICS)
+    if (enc->state.cpu_flags & OD_CPU_X86_AVX2) {
+      enc->opt_vtbl.mc_compute_sad_16x16 =
+       od_mc_compute_sad8_16x16_avx2;
+      enc->opt_vtbl.mc_compute_sad_32x32 =
+       od_mc_compute_sad8_32x32_avx2;
+      enc->opt_vtbl.mc_compute_sad_64x64 =
+       od_mc_compute_sad8_64x64_avx2;
+      enc->opt_vtbl.mc_compute_satd_16x16 =
+       od_mc_compute_satd8_16x16_avx2;
+      enc->opt_vtbl.mc_compute_satd_32x32 =
+       od_mc_compute_satd8_32x32_avx2;
+      enc->opt_vtbl.mc_compute_satd_64x64 =
+       od_mc_compute_satd8_64x64_avx2;
+    }
+#endif
+  }
+#if defined(OD_SSE41_INTRINSICS)
+  if (enc->state.cpu_flags & OD_CPU_X86_SSE4_1) {
+    enc->opt_vtbl.pvq_search_pulses = od_pvq_search_pulses_sse41;
+  }
+#endif
+#if defined(OD_AVX2_INTRINSICS)
+  if (enc->state.cpu_flags & OD_CPU_X86_AVX2) {
+    enc->opt_vtbl.pvq_search_pulses = od_pvq_search_pulses_avx2;
   }
 #endif
 }
@@ -50,4 +50,75 @@ int32_t od_mc_compute_satd8_32x32_sse2(const unsigned char *src, int systride,
 int32_t od_mc_compute_satd8_64x64_sse2(const unsigned char *src, int systride,
  const unsigned char *ref, int dystride);
 
+int32_t od_mc_compute_sad8_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad8_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad8_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+
+int32_t od_mc_compute_satd8_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd8_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd8_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+
+int32_t od_mc_compute_sad16_4x4_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad16_8x8_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad16_16x16_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad16_32x32_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad16_64x64_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+
+int32_t od_mc_compute_satd16_4x4_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_8x8_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_16x16_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_32x32_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_64x64_sse41(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+
+int32_t od_mc_compute_sad16_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad16_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+int32_t od_mc_compute_sad16_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int dystride);
+
+int32_t od_mc_compute_satd16_8x8_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_16x16_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_32x32_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+int32_t od_mc_compute_satd16_64x64_avx2(const unsigned char *src,
+ int systride, const unsigned char *ref, int rystride);
+
+void od_pvq_search_pulses_sse41(od_coeff *y, int32_t *xy, int32_t *yy,
+ const int16_t *x, int n, int i, int k);
+void od_pvq_search_pulses_avx2(od_coeff *y, int32_t *xy, int32_t *yy,
+ const int16_t *x, int n, int i, int k);
+
+# if defined(OD_CHECKASM)
+void od_mc_compute_sad8_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int dystride, int w, int h, int32_t sad);
+void od_mc_compute_satd8_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride, int ln, int32_t satd);
+void od_mc_compute_sad16_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int dystride, int w, int h, int32_t sad);
+void od_mc_compute_satd16_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride, int ln, int32_t satd);
+void od_pvq_search_pulses_check(const od_coeff *y0, int32_t xy0, int32_t yy0,
+ const int16_t *x, int n, int i, int k, const od_coeff *y, int32_t xy,
+ int32_t yy);
+# endif
+
 #endif
@@ -32,11 +32,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 #  define OD_SIMD_INLINE static
 # endif
 
+/*The 64-point DCTs are computed in double precision.
+  The vectorized versions only match the C ones when the compiler also does
+   scalar double arithmetic in SSE2 registers instead of the x87 FPU.*/
+# if defined(__SSE2_MATH__) || defined(_M_X64) || \
+ (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define OD_X86_SSE2_MATH (1)
+# endif
+
 void od_state_opt_vtbl_init_x86(od_state *_state);
 extern const od_filter_dering_direction_func
  OD_DERING_DIRECTION_SSE2[OD_DERINGSIZES];
 extern const od_filter_dering_orthogonal_func
  OD_DERING_ORTHOGONAL_SSE2[OD_DERINGSIZES];
+extern const od_filter_cols_func OD_PRE_FILTER_COLS_SSE41[OD_NBSIZES];
+extern const od_filter_cols_func OD_POST_FILTER_COLS_SSE41[OD_NBSIZES];
+extern const od_filter_cols_func OD_PRE_FILTER_COLS_AVX2[OD_NBSIZES];
+extern const od_filter_cols_func OD_POST_FILTER_COLS_AVX2[OD_NBSIZES];
 void od_mc_predict1fmv8_sse2(od_state *state, unsigned char *_dst,
  const unsigned char *_src, int _systride, int32_t _mvx, int32_t _mvy,
  int _log_xblk_sz,int _log_yblk_sz);
@@ -47,6 +59,39 @@ void od_mc_blend_full8_sse2(unsigned char *_dst,int _dystride,
  const unsigned char *_src[4],int _log_xblk_sz,int _log_yblk_sz);
 void od_mc_blend_full_split8_sse2(unsigned char *_dst,int _dystride,
  const unsigned char *_src[4],int _c,int _s,int _log_xblk_sz,int _log_yblk_sz);
+void od_mc_blend_full16_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz);
+void od_mc_blend_full16_avx2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz);
+void od_mc_blend_full_split16_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz);
+void od_mc_blend_full_split16_avx2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz);
+void od_mc_blend_multi8_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int log_xblk_sz, int log_yblk_sz);
+void od_mc_blend_multi_split8_sse2(unsigned char *dst, int dystride,
+ const unsigned char *src[4], int oc, int s,
+ int log_xblk_sz, int log_yblk_sz);
+# if defined(OD_CHECKASM)
+void od_mc_blend_full16_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _log_xblk_sz, int _log_yblk_sz);
+void od_mc_blend_full_split16_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _c, int _s,
+ int _log_xblk_sz, int _log_yblk_sz);
+void od_mc_blend_multi8_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _log_xblk_sz, int _log_yblk_sz);
+void od_mc_blend_multi_split8_check(unsigned char *_dst, int _dystride,
+ const unsigned char *_src[4], int _c, int _s,
+ int _log_xblk_sz, int _log_yblk_sz);
+void od_filter_cols_save(od_coeff *ref, const od_coeff *c, int stride, int n,
+ int f);
+void od_filter_cols_check(const od_coeff *c, int stride, od_coeff *ref,
+ int n, int f, int inv);
+void od_dir_find8_check(const int16_t *img, int stride, int32_t var,
+ int dir);
+# endif
 void od_bin_fdct4x4_sse2(od_coeff *y, int ystride,
  const od_coeff *x, int xstride);
 void od_bin_fdct4x4_sse41(od_coeff *y, int ystride,
@@ -67,12 +112,66 @@ void od_bin_fdct8x8_avx2(od_coeff *y, int ystride,
  const od_coeff *x, int xstride);
 void od_bin_idct8x8_avx2(od_coeff *x, int xstride,
  const od_coeff *y, int ystride);
+void od_bin_fdct16x16_sse2(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct16x16_sse2(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct16x16_sse41(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct16x16_sse41(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct16x16_avx2(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct16x16_avx2(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct32x32_sse2(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct32x32_sse2(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct32x32_sse41(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct32x32_sse41(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct32x32_avx2(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct32x32_avx2(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct64x64_sse2(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct64x64_sse2(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct64x64_sse41(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct64x64_sse41(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
+void od_bin_fdct64x64_avx2(od_coeff *y, int ystride,
+ const od_coeff *x, int xstride);
+void od_bin_idct64x64_avx2(od_coeff *x, int xstride,
+ const od_coeff *y, int ystride);
 void od_copy_16x16_8_sse2(unsigned char *_dst, int _dstride,
  const unsigned char *_src, int _sstride);
 void od_copy_32x32_8_sse2(unsigned char *_dst, int _dstride,
  const unsigned char *_src, int _sstride);
 void od_copy_64x64_8_sse2(unsigned char *_dst, int _dstride,
  const unsigned char *_src, int _sstride);
+void od_pre_filter_cols4_sse41(od_coeff *c, int stride, int n);
+void od_post_filter_cols4_sse41(od_coeff *c, int stride, int n);
+void od_pre_filter_cols8_sse41(od_coeff *c, int stride, int n);
+void od_post_filter_cols8_sse41(od_coeff *c, int stride, int n);
+void od_pre_filter_cols16_sse41(od_coeff *c, int stride, int n);
+void od_post_filter_cols16_sse41(od_coeff *c, int stride, int n);
+void od_pre_filter_cols32_sse41(od_coeff *c, int stride, int n);
+void od_post_filter_cols32_sse41(od_coeff *c, int stride, int n);
+void od_pre_filter_cols4_avx2(od_coeff *c, int stride, int n);
+void od_post_filter_cols4_avx2(od_coeff *c, int stride, int n);
+void od_pre_filter_cols8_avx2(od_coeff *c, int stride, int n);
+void od_post_filter_cols8_avx2(od_coeff *c, int stride, int n);
+void od_pre_filter_cols16_avx2(od_coeff *c, int stride, int n);
+void od_post_filter_cols16_avx2(od_coeff *c, int stride, int n);
+void od_pre_filter_cols32_avx2(od_coeff *c, int stride, int n);
+void od_post_filter_cols32_avx2(od_coeff *c, int stride, int n);
+int od_dir_find8_sse41(const int16_t *img, int stride, int32_t *var);
+int od_dir_find8_avx2(const int16_t *img, int stride, int32_t *var);
 void od_filter_dering_direction_4x4_sse2(int16_t *y, int ystride,
  int16_t *in, int threshold, int dir);
 void od_filter_dering_direction_8x8_sse2(int16_t *y, int ystride,
@@ -81,4 +180,6 @@ void od_filter_dering_orthogonal_4x4_sse2(int16_t *y, int ystride,
  int16_t *in, int16_t *x, int xstride, int threshold, int dir);
 void od_filter_dering_orthogonal_8x8_sse2(int16_t *y, int ystride,
  int16_t *in, int16_t *x, int xstride, int threshold, int dir);
+int od_ec_cdf_search_sse2(const uint16_t *cdf, int nsyms, unsigned q);
+void od_ec_cdf_adapt_sse2(uint16_t *cdf, int val, int n, int increment);
 #endif
@@ -45,6 +45,83 @@ void od_mc_compute_sad8_check(const unsigned char *src, int systride,
   }
   OD_ASSERT(sad == c_sad);
 }
+
+void od_mc_compute_sad16_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int dystride, int w, int h, int32_t sad) {
+  int32_t c_sad;
+  c_sad = od_mc_compute_sad16_c(src, systride, ref, dystride, w, h);
+  if (sad != c_sad) {
+    fprintf(stderr, "od_mc_compute_sad16 %ix%i check failed: %i!=%i\n",
+     w, h, sad, c_sad);
+  }
+  OD_ASSERT(sad == c_sad);
+}
+
+void od_mc_compute_satd8_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride, int ln, int32_t satd) {
+  int32_t c_satd;
+  switch (ln) {
+    case 2: {
+      c_satd = od_mc_compute_satd8_4x4_c(src, systride, ref, rystride);
+      break;
+    }
+    case 3: {
+      c_satd = od_mc_compute_satd8_8x8_c(src, systride, ref, rystride);
+      break;
+    }
+    case 4: {
+      c_satd = od_mc_compute_satd8_16x16_c(src, systride, ref, rystride);
+      break;
+    }
+    case 5: {
+      c_satd = od_mc_compute_satd8_32x32_c(src, systride, ref, rystride);
+      break;
+    }
+    default: {
+      OD_ASSERT(ln == 6);
+      c_satd = od_mc_compute_satd8_64x64_c(src, systride, ref, rystride);
+      break;
+    }
+  }
+  if (satd != c_satd) {
+    fprintf(stderr, "od_mc_compute_satd %ix%i check failed: %i!=%i\n",
+     1 << ln, 1 << ln, satd, c_satd);
+  }
+  OD_ASSERT(satd == c_satd);
+}
+
+void od_mc_compute_satd16_check(const unsigned char *src, int systride,
+ const unsigned char *ref, int rystride, int ln, int32_t satd) {
+  int32_t c_satd;
+  switch (ln) {
+    case 2: {
+      c_satd = od_mc_compute_satd16_4x4_c(src, systride, ref, rystride);
+      break;
+    }
+    case 3: {
+      c_satd = od_mc_compute_satd16_8x8_c(src, systride, ref, rystride);
+      break;
+    }
+    case 4: {
+      c_satd = od_mc_compute_satd16_16x16_c(src, systride, ref, rystride);
+      break;
+    }
+    case 5: {
+      c_satd = od_mc_compute_satd16_32x32_c(src, systride, ref, rystride);
+      break;
+    }
+    default: {
+      OD_ASSERT(ln == 6);
+      c_satd = od_mc_compute_satd16_64x64_c(src, systride, ref, rystride);
+      break;
+    }
+  }
+  if (satd != c_satd) {
+    fprintf(stderr, "od_mc_compute_satd16 %ix%i check failed: %i!=%i\n",
+     1 << ln, 1 << ln, satd, c_satd);
+  }
+  OD_ASSERT(satd == c_satd);
+}
 # endif
 
 #if defined(OD_GCC_INLINE_ASSEMBLY)
@@ -40,10 +40,19 @@ void od_state_opt_vtbl_init_x86(od_state *_state){
   od_state_opt_vtbl_init_c(_state);
   _state->cpu_flags=od_cpu_flags_get();
   if(_state->full_precision_references) {
-    /*No 16 bit assembly as yet, but it will go here.*/
+    /*16 bit intrinsics for those functions that work on the
+       full-precision reference buffers.*/
     if (_state->cpu_flags&OD_CPU_X86_SSE2) {
 #if defined(OD_SSE2_INTRINSICS)
       _state->opt_vtbl.mc_predict1fmv = od_mc_predict1fmv16_sse2;
+      _state->opt_vtbl.mc_blend_full = od_mc_blend_full16_sse2;
+      _state->opt_vtbl.mc_blend_full_split = od_mc_blend_full_split16_sse2;
+#endif
+#if defined(OD_AVX2_INTRINSICS)
+      if (_state->cpu_flags&OD_CPU_X86_AVX2) {
+        _state->opt_vtbl.mc_blend_full = od_mc_blend_full16_avx2;
+        _state->opt_vtbl.mc_blend_full_split = od_mc_blend_full_split16_avx2;
+      }
 #endif
     }
   }
@@ -56,6 +65,8 @@ void od_state_opt_vtbl_init_x86(od_state *_state){
       _state->opt_vtbl.mc_blend_full_split = od_mc_blend_full_split8_sse2;
 #endif
 #if defined(OD_SSE2_INTRINSICS)
+      _state->opt_vtbl.mc_blend_multi = od_mc_blend_multi8_sse2;
+      _state->opt_vtbl.mc_blend_multi_split = od_mc_blend_multi_split8_sse2;
       _state->opt_vtbl.mc_predict1fmv = od_mc_predict1fmv8_sse2;
       _state->opt_vtbl.od_copy_nxn[4] = od_copy_16x16_8_sse2;
       _state->opt_vtbl.od_copy_nxn[5] = od_copy_32x32_8_sse2;
@@ -69,10 +80,20 @@ void od_state_opt_vtbl_init_x86(od_state *_state){
     _state->opt_vtbl.idct_2d[0] = od_bin_idct4x4_sse2;
     _state->opt_vtbl.fdct_2d[1] = od_bin_fdct8x8_sse2;
     _state->opt_vtbl.idct_2d[1] = od_bin_idct8x8_sse2;
+    _state->opt_vtbl.fdct_2d[2] = od_bin_fdct16x16_sse2;
+    _state->opt_vtbl.idct_2d[2] = od_bin_idct16x16_sse2;
+    _state->opt_vtbl.fdct_2d[3] = od_bin_fdct32x32_sse2;
+    _state->opt_vtbl.idct_2d[3] = od_bin_idct32x32_sse2;
+#if defined(OD_X86_SSE2_MATH)
+    _state->opt_vtbl.fdct_2d[4] = od_bin_fdct64x64_sse2;
+    _state->opt_vtbl.idct_2d[4] = od_bin_idct64x64_sse2;
+#endif
     OD_COPY(_state->opt_vtbl.filter_dering_direction,
      OD_DERING_DIRECTION_SSE2, OD_DERINGSIZES);
     OD_COPY(_state->opt_vtbl.filter_dering_orthogonal,
      OD_DERING_ORTHOGONAL_SSE2, OD_DERINGSIZES);
+    _state->opt_vtbl.cdf_search = od_ec_cdf_search_sse2;
+    _state->opt_vtbl.cdf_adapt = od_ec_cdf_adapt_sse2;
 #endif
 #if defined(OD_SSE41_INTRINSICS)
     if (_state->cpu_flags&OD_CPU_X86_SSE4_1) {
@@ -80,12 +101,38 @@ void od_state_opt_vtbl_init_x86(od_state *_state){
       _state->opt_vtbl.idct_2d[0] = od_bin_idct4x4_sse41;
       _state->opt_vtbl.fdct_2d[1] = od_bin_fdct8x8_sse41;
       _state->opt_vtbl.idct_2d[1] = od_bin_idct8x8_sse41;
+      _state->opt_vtbl.fdct_2d[2] = od_bin_fdct16x16_sse41;
+      _state->opt_vtbl.idct_2d[2] = od_bin_idct16x16_sse41;
+      _state->opt_vtbl.fdct_2d[3] = od_bin_fdct32x32_sse41;
+      _state->opt_vtbl.idct_2d[3] = od_bin_idct32x32_sse41;
+#if defined(OD_X86_SSE2_MATH)
+      _state->opt_vtbl.fdct_2d[4] = od_bin_fdct64x64_sse41;
+      _state->opt_vtbl.idct_2d[4] = od_bin_idct64x64_sse41;
+#endif
+      _state->opt_vtbl.dir_find8 = od_dir_find8_sse41;
+      OD_COPY(_state->opt_vtbl.pre_filter_cols, OD_PRE_FILTER_COLS_SSE41,
+       OD_NBSIZES);
+      OD_COPY(_state->opt_vtbl.post_filter_cols, OD_POST_FILTER_COLS_SSE41,
+       OD_NBSIZES);
     }
 #endif
 #if defined(OD_AVX2_INTRINSICS)
     if (_state->cpu_flags & OD_CPU_X86_AVX2) {
       _state->opt_vtbl.fdct_2d[1] = od_bin_fdct8x8_avx2;
       _state->opt_vtbl.idct_2d[1] = od_bin_idct8x8_avx2;
+      _state->opt_vtbl.fdct_2d[2] = od_bin_fdct16x16_avx2;
+      _state->opt_vtbl.idct_2d[2] = od_bin_idct16x16_avx2;
+      _state->opt_vtbl.fdct_2d[3] = od_bin_fdct32x32_avx2;
+      _state->opt_vtbl.idct_2d[3] = od_bin_idct32x32_avx2;
+#if defined(OD_X86_SSE2_MATH)
+      _state->opt_vtbl.fdct_2d[4] = od_bin_fdct64x64_avx2;
+      _state->opt_vtbl.idct_2d[4] = od_bin_idct64x64_avx2;
+#endif
+      _state->opt_vtbl.dir_find8 = od_dir_find8_avx2;
+      OD_COPY(_state->opt_vtbl.pre_filter_cols, OD_PRE_FILTER_COLS_AVX2,
+       OD_NBSIZES);
+      OD_COPY(_state->opt_vtbl.post_filter_cols, OD_POST_FILTER_COLS_AVX2,
+       OD_NBSIZES);
     }
 #endif
   }
@@ -2,12 +2,14 @@
 #include <stdlib.h>
 #include "../src/dct.h"
 #include "../src/filter.h"
+#include "../src/state.h"
 #include "../src/tf.h"
 
 #define OD_BASIS_SIZE (4*OD_BSIZE_MAX)
 #define OD_BASIS_PULSE 1024
 
 int main(int argc, char *argv[]) {
+  od_state state;
   int ln;
   int n;
   od_coeff x0[OD_BASIS_SIZE*OD_BASIS_SIZE];
@@ -20,6 +22,7 @@ int main(int argc, char *argv[]) {
   double sum[OD_NBSIZES - 1][4];
   (void)argc;
   (void)argv;
+  OD_COPY(state.opt_vtbl.post_filter_cols, OD_POST_FILTER_COLS_C, OD_NBSIZES);
   for (ln = 0; ln < OD_NBSIZES - 1; ln++) {
     n = 4 << ln;
     for (j = 0; j < 2; j++) {
@@ -35,7 +38,8 @@ int main(int argc, char *argv[]) {
             OD_IDCT_2D_C[ln](x1, OD_BASIS_SIZE, x1, OD_BASIS_SIZE);
           }
         }
-        od_postfilter_split(&x0[n*OD_BASIS_SIZE + n], OD_BASIS_SIZE, ln + 1, 0, 0, 0, 0, 1, 1);
+        od_postfilter_split(&state, &x0[n*OD_BASIS_SIZE + n], OD_BASIS_SIZE,
+         ln + 1, 0, 0, 0, 0, 1, 1);
         x1 = &x0[n - 2];
         x2 = &x0[3*n - 2];
         for (l = 0; l < 4*n; l++) {
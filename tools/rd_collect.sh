@@ -33,22 +33,26 @@ case $CODEC in
       exit 1
     fi
 
-    if ((! grep -Fxq "#define OD_DUMP_IMAGES 1" "$DAALA_ROOT/config.h") &&
-        (! grep -Fxq "#define OD_DUMP_RECONS 1" "$DAALA_ROOT/config.h")); then
-      echo "Video dumping not enabled, re-run configure with --enable-dump-recons"
-      exit 1
-    fi
-
     if [ -z "$ENCODER_EXAMPLE" ]; then
       export ENCODER_EXAMPLE=$DAALA_ROOT/examples/encoder_example
     fi
 
+    if [ -z "$DUMP_VIDEO" ]; then
+      export DUMP_VIDEO=$DAALA_ROOT/examples/dump_video
+    fi
+
     if [ ! -x "$ENCODER_EXAMPLE" ]; then
       echo "Executable not found ENCODER_EXAMPLE=$ENCODER_EXAMPLE"
       echo "Do you have the right DAALA_ROOT=$DAALA_ROOT"
       exit 1
     fi
 
+    if [ ! -x "$DUMP_VIDEO" ]; then
+      echo "Executable not found DUMP_VIDEO=$DUMP_VIDEO"
+      echo "Do you have the right DAALA_ROOT=$DAALA_ROOT"
+      exit 1
+    fi
+
     export RD_COLLECT_SUB=$(dirname "$0")/rd_collect_daala.sh
     ;;
   vp8 | vp9)
@@ -18,17 +18,26 @@ HEIGHT=$(head -1 $FILE | cut -d\  -f 3 | tr -d 'H')
 RANGE="5 7 11 16 25 37 55 81 122 181 270 400"
 #RANGE="1 2 3 4 5 6 7 9 11 13 16 20 25 30 37 45 55 67 81 99 122 148 181 221 270 330 400 500"
 
+# Code every quality point in a single pass, sharing the motion search and
+# the other source analysis: the first one with -v, the rest with --ladder.
+LADDER=
+for x in ${RANGE#* }; do
+  LADDER="$LADDER --ladder $x:$BASENAME-$x.ogv"
+done
+$ENCODER_EXAMPLE -k 256 -z 10 -v ${RANGE%% *} $LADDER $FILE -o $BASENAME-${RANGE%% *}.ogv 2> $BASENAME-enc.out
+
 for x in $RANGE; do
-  OD_DUMP_IMAGES_SUFFIX=$BASENAME $ENCODER_EXAMPLE -k 256 -z 10 -v $x $FILE -o $BASENAME.ogv 2> $BASENAME-$x-enc.out
-  SIZE=$(wc -c $BASENAME.ogv | awk '{ print $1 }')
-  $DUMP_PSNR $FILE 00000000out-$BASENAME.y4m > $BASENAME-psnr.out 2> /dev/null
+  SIZE=$(wc -c $BASENAME-$x.ogv | awk '{ print $1 }')
+  $DUMP_VIDEO -o $BASENAME-$x.y4m $BASENAME-$x.ogv 2> /dev/null
+  $DUMP_PSNR $FILE $BASENAME-$x.y4m > $BASENAME-psnr.out 2> /dev/null
   FRAMES=$(cat $BASENAME-psnr.out | grep ^0 | wc -l)
   PIXELS=$(($WIDTH*$HEIGHT*$FRAMES))
   PSNR=$(cat $BASENAME-psnr.out | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
-  PSNRHVS=$($DUMP_PSNRHVS $FILE 00000000out-$BASENAME.y4m 2> /dev/null | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
-  SSIM=$($DUMP_SSIM $FILE 00000000out-$BASENAME.y4m 2> /dev/null | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
-  FASTSSIM=$($DUMP_FASTSSIM -c $FILE 00000000out-$BASENAME.y4m 2> /dev/null | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
-  rm 00000000out-$BASENAME.y4m $BASENAME.ogv $BASENAME-$x-enc.out $BASENAME-psnr.out
+  PSNRHVS=$($DUMP_PSNRHVS $FILE $BASENAME-$x.y4m 2> /dev/null | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
+  SSIM=$($DUMP_SSIM $FILE $BASENAME-$x.y4m 2> /dev/null | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
+  FASTSSIM=$($DUMP_FASTSSIM -c $FILE $BASENAME-$x.y4m 2> /dev/null | grep Total | tr -s ' ' | cut -d\  -f $((4+$PLANE*2)))
+  rm $BASENAME-$x.y4m $BASENAME-$x.ogv $BASENAME-psnr.out
   echo $x $PIXELS $SIZE $PSNR $PSNRHVS $SSIM $FASTSSIM >> $BASENAME.out
   #tail -1 $BASENAME.out
 done
+rm $BASENAME-enc.out
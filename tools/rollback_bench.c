@@ -0,0 +1,219 @@
+/*Daala video codec
+Copyright (c) 2016 Daala project contributors.  All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+- Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+- Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS “AS IS”
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../src/state.h"
+#include "../src/entenc.h"
+#include "../src/generic_code.h"
+
+/*This program measures the cost of the encoder's RDO checkpoints.
+  It replays the checkpoint pattern of one superblock of block-size RDO (the
+   one od_encode_recursive() uses at every complexity from 2 up to 10), with
+   the late skip and PVQ checkpoints of each block, on a real adaptation
+   context.
+  Each superblock is run twice: once saving full copies of the adaptation
+   context, as the encoder used to, and once using the adaptation log.
+  The two must end up in the same state.*/
+
+/*The number of PVQ bands coded for each block size.*/
+static const int BANDS[OD_NBSIZES] = { 1, 4, 7, 10 };
+
+typedef struct rb_ctx rb_ctx;
+typedef struct rb_checkpoint rb_checkpoint;
+
+struct rb_ctx {
+  od_adapt_ctx adapt;
+  od_ec_enc ec;
+  od_ec_log log;
+  /*Nonzero to save full copies of adapt instead of using the log.*/
+  int full_copy;
+  uint32_t seed;
+};
+
+struct rb_checkpoint {
+  od_ec_enc ec;
+  od_adapt_ctx adapt;
+  int log_pos;
+  int redo_start;
+  int redo_end;
+};
+
+static unsigned rb_rand(rb_ctx *ctx, unsigned n) {
+  ctx->seed = ctx->seed*1664525 + 1013904223;
+  return (ctx->seed >> 16)%n;
+}
+
+static void rb_checkpoint_save(rb_ctx *ctx, rb_checkpoint *cp) {
+  od_ec_enc_checkpoint(&cp->ec, &ctx->ec);
+  if (ctx->full_copy) OD_COPY(&cp->adapt, &ctx->adapt, 1);
+  else cp->log_pos = ctx->log.nentries;
+  cp->redo_start = cp->redo_end = 0;
+}
+
+static void rb_rollback(rb_ctx *ctx, const rb_checkpoint *cp) {
+  od_ec_enc_rollback(&ctx->ec, &cp->ec);
+  if (ctx->full_copy) OD_COPY(&ctx->adapt, &cp->adapt, 1);
+  else {
+    od_ec_log_undo(&ctx->log, cp->log_pos);
+    od_ec_enc_redo(&ctx->ec, cp->redo_start, cp->redo_end);
+  }
+}
+
+/*Rolls back to pre after saving the current state in post, the way
+   od_encode_recursive() does after trying not to split.*/
+static void rb_rollback_redo(rb_ctx *ctx, const rb_checkpoint *pre,
+ rb_checkpoint *post) {
+  if (ctx->full_copy) rb_checkpoint_save(ctx, post);
+  else {
+    od_ec_enc_checkpoint(&post->ec, &ctx->ec);
+    post->log_pos = pre->log_pos;
+    od_ec_enc_save_redo(&ctx->ec, pre->log_pos,
+     &post->redo_start, &post->redo_end);
+  }
+  rb_rollback(ctx, pre);
+}
+
+/*Codes the symbols of one block the way od_block_encode() and
+   od_pvq_encode() do.*/
+static void rb_code_block(rb_ctx *ctx, int bs) {
+  od_adapt_ctx *adapt;
+  rb_checkpoint skip_buf;
+  rb_checkpoint pvq_buf;
+  int bandi;
+  adapt = &ctx->adapt;
+  if (bs > 0) rb_checkpoint_save(ctx, &skip_buf);
+  generic_encode(&ctx->ec, &adapt->model_dc[0], rb_rand(ctx, 8), -1,
+   &adapt->ex_dc[0][bs][0], 2);
+  rb_checkpoint_save(ctx, &pvq_buf);
+  od_encode_cdf_adapt(&ctx->ec, rb_rand(ctx, 4), adapt->skip_cdf[2*bs],
+   4 + (bs > 0), adapt->skip_increment);
+  for (bandi = 0; bandi < BANDS[bs]; bandi++) {
+    int *exg;
+    int *pvq_adapt;
+    int tmp;
+    exg = &adapt->pvq.pvq_exg[0][bs][bandi];
+    od_encode_cdf_adapt(&ctx->ec, rb_rand(ctx, 8),
+     adapt->pvq.pvq_gaintheta_cdf[bs*PVQ_MAX_PARTITIONS + bandi], 8,
+     adapt->pvq.pvq_gaintheta_increment);
+    tmp = *exg;
+    generic_encode(&ctx->ec, &adapt->pvq.pvq_param_model[0],
+     rb_rand(ctx, 4), -1, &tmp, 2);
+    od_ec_enc_log(&ctx->ec, exg, sizeof(*exg));
+    OD_IIR_DIADIC(*exg, (int)rb_rand(ctx, 4) << 16, 2);
+    pvq_adapt = adapt->pvq.pvq_codeword_ctx.pvq_adapt
+     + OD_NSB_ADAPT_CTXS*2*bs;
+    od_ec_enc_log(&ctx->ec, pvq_adapt, OD_NSB_ADAPT_CTXS*sizeof(*pvq_adapt));
+    pvq_adapt[OD_ADAPT_K_Q8] += (int)rb_rand(ctx, 16) - 8;
+    pvq_adapt[OD_ADAPT_COUNT_Q8] += (int)rb_rand(ctx, 16) - 8;
+    od_encode_cdf_adapt(&ctx->ec, rb_rand(ctx, 15),
+     adapt->pvq.pvq_codeword_ctx.pvq_k1_cdf[0], 15,
+     adapt->pvq.pvq_codeword_ctx.pvq_k1_increment);
+  }
+  /*The PVQ skip and the late skip RDO each win about one time in four.*/
+  if (rb_rand(ctx, 4) == 0) {
+    rb_rollback(ctx, &pvq_buf);
+    od_encode_cdf_adapt(&ctx->ec, 0, adapt->skip_cdf[2*bs], 4 + (bs > 0),
+     adapt->skip_increment);
+  }
+  if (bs > 0 && rb_rand(ctx, 4) == 0) {
+    rb_rollback(ctx, &skip_buf);
+    od_encode_cdf_adapt(&ctx->ec, 2, adapt->skip_cdf[2*bs], 5,
+     adapt->skip_increment);
+  }
+}
+
+static void rb_code_recursive(rb_ctx *ctx, int bs) {
+  rb_checkpoint pre_encode_buf;
+  rb_checkpoint post_nosplit_buf;
+  int i;
+  if (bs == 0) {
+    rb_code_block(ctx, bs);
+    return;
+  }
+  rb_checkpoint_save(ctx, &pre_encode_buf);
+  rb_code_block(ctx, bs);
+  rb_rollback_redo(ctx, &pre_encode_buf, &post_nosplit_buf);
+  od_encode_cdf_adapt(&ctx->ec, 4, ctx->adapt.skip_cdf[2*bs], 5,
+   ctx->adapt.skip_increment);
+  for (i = 0; i < 4; i++) rb_code_recursive(ctx, bs - 1);
+  if (rb_rand(ctx, 2)) rb_rollback(ctx, &post_nosplit_buf);
+}
+
+static void rb_code_sb(rb_ctx *ctx) {
+  od_ec_log_reset(&ctx->log, &ctx->adapt, sizeof(ctx->adapt));
+  rb_code_recursive(ctx, OD_NBSIZES - 1);
+  od_ec_enc_reset(&ctx->ec);
+}
+
+static void rb_init(rb_ctx *ctx, int full_copy) {
+  od_adapt_ctx_reset(&ctx->adapt, 0);
+  od_ec_enc_init(&ctx->ec, 65025);
+  od_ec_log_init(&ctx->log);
+  ctx->ec.log = full_copy ? NULL : &ctx->log;
+  ctx->full_copy = full_copy;
+  ctx->seed = 0;
+}
+
+static void rb_clear(rb_ctx *ctx) {
+  od_ec_log_clear(&ctx->log);
+  od_ec_enc_clear(&ctx->ec);
+}
+
+int main(int argc, char **argv) {
+  static rb_ctx ctx[2];
+  double t[2];
+  int nsbs;
+  int sbi;
+  int i;
+  nsbs = argc > 1 ? atoi(argv[1]) : 20000;
+  if (nsbs <= 0) {
+    fprintf(stderr, "usage: %s [<superblocks>]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < 2; i++) {
+    clock_t t0;
+    rb_init(ctx + i, i == 0);
+    t0 = clock();
+    for (sbi = 0; sbi < nsbs; sbi++) rb_code_sb(ctx + i);
+    t[i] = (double)(clock() - t0)/CLOCKS_PER_SEC;
+  }
+  if (memcmp(&ctx[0].adapt, &ctx[1].adapt, sizeof(ctx[0].adapt)) != 0) {
+    fprintf(stderr, "Adaptation log and full copy results differ.\n");
+    return EXIT_FAILURE;
+  }
+  printf("od_adapt_ctx: %i bytes, %i superblocks\n",
+   (int)sizeof(ctx[0].adapt), nsbs);
+  printf("full copy:      %9.3f us/superblock\n", 1E6*t[0]/nsbs);
+  printf("adaptation log: %9.3f us/superblock (%.2fx)\n", 1E6*t[1]/nsbs,
+   t[1] > 0 ? t[0]/t[1] : 0);
+  for (i = 0; i < 2; i++) rb_clear(ctx + i);
+  return EXIT_SUCCESS;
+}